@@ -121,6 +121,7 @@ BASE_SCRIPTS= [
     'addressindex.py',
     'spentindex.py',
     'timestampindex.py',
+    'insightindex_build.py',
     'decodescript.py',
     'blockchain.py',
     'disablewallet.py',
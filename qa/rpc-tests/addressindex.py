@@ -16,8 +16,10 @@
 
 from test_framework.test_framework import BitcoinTestFramework
 
+from test_framework.authproxy import JSONRPCException
 from test_framework.util import (
     assert_equal,
+    assert_raises_message,
     start_nodes,
     stop_nodes,
     connect_nodes,
@@ -100,6 +102,12 @@ class AddressIndexTest(BitcoinTestFramework):
             if expected_received is None:
                 expected_received = expected_balance
             assert_equal(bal['received'], expected_received)
+            # the maintained aggregates must match the full index
+            addresses = address if isinstance(address, list) else [address]
+            txcount = sum(len(self.nodes[node_index].getaddresstxids(a)) for a in addresses)
+            utxos = self.nodes[node_index].getaddressutxos({'addresses': addresses})
+            assert_equal(bal['txcount'], txcount)
+            assert_equal(bal['utxocount'], len(utxos))
 
         # begin test
 
@@ -332,6 +340,17 @@ class AddressIndexTest(BitcoinTestFramework):
         deltas_limited = getaddressdeltas(1, [addr1], 109, 109)
         assert_equal(deltas_limited, deltas[3:4])
 
+        # a cursor can be resumed, but not under a range that excludes it
+        page = self.nodes[1].getaddressdeltas(
+            {'addresses': [addr1], 'start': 106, 'end': 111, 'limit': 1})
+        assert_equal(page['deltas'], deltas[0:1])
+        page = self.nodes[1].getaddressdeltas(
+            {'addresses': [addr1], 'start': 106, 'end': 111, 'limit': 1, 'cursor': page['cursor']})
+        assert_equal(page['deltas'], deltas[1:2])
+        assert_raises_message(JSONRPCException, "Cursor is outside the requested height range",
+            self.nodes[1].getaddressdeltas,
+            {'addresses': [addr1], 'start': 109, 'end': 109, 'limit': 1, 'cursor': page['cursor']})
+
         # the full range (also the default)
         deltas_info = getaddressdeltas(1, [addr1], 106, 111, chainInfo=True)
         assert_equal(deltas_info['deltas'], deltas)
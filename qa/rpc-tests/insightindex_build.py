@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 The Zcash developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or https://www.opensource.org/licenses/mit-license.php .
+#
+# Test that enabling -insightexplorer on an existing node builds the insight
+# indexes in the background, and that the result matches a node that had the
+# indexes enabled from the start.
+#
+# RPCs tested here:
+#
+#   getindexinfo
+#
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import (
+    assert_equal,
+    connect_nodes,
+    start_nodes,
+    start_node,
+    stop_node,
+    wait_bitcoinds,
+)
+
+import time
+
+
+class InsightIndexBuildTest(BitcoinTestFramework):
+
+    def __init__(self):
+        super().__init__()
+        self.num_nodes = 2
+        self.cache_behavior = 'clean'
+        self.base_args = [
+            '-debug',
+            '-txindex',
+            '-experimentalfeatures',
+            '-allowdeprecated=getnewaddress',
+        ]
+
+    def setup_network(self):
+        # node 0 has the indexes from the start, node 1 enables them later
+        self.nodes = start_nodes(self.num_nodes, self.options.tmpdir,
+            [self.base_args + ['-insightexplorer'], self.base_args])
+        connect_nodes(self.nodes[0], 1)
+        self.is_network_split = False
+        self.sync_all()
+
+    def run_test(self):
+        self.nodes[0].generate(105)
+        self.sync_all()
+
+        addr = self.nodes[1].getnewaddress()
+        for amount in (1, 2, 3):
+            self.nodes[0].sendtoaddress(addr, amount)
+            self.nodes[0].generate(1)
+        self.nodes[1].sendtoaddress(self.nodes[0].getnewaddress(), 2)
+        self.nodes[1].generate(1)
+        self.sync_all()
+
+        # Enabling the indexes no longer requires -reindex.
+        stop_node(self.nodes[1], 1)
+        wait_bitcoinds()
+        self.nodes[1] = start_node(1, self.options.tmpdir, self.base_args + ['-insightexplorer'])
+        connect_nodes(self.nodes[0], 1)
+
+        # The node keeps following the tip while the indexes are built.
+        self.nodes[0].generate(2)
+        self.sync_all()
+
+        for _ in range(600):
+            info = self.nodes[1].getindexinfo()
+            if all(info[name]['synced'] for name in ('addressindex', 'spentindex', 'timestampindex')):
+                break
+            time.sleep(0.1)
+        info = self.nodes[1].getindexinfo()
+        height = self.nodes[1].getblockcount()
+        for name in ('addressindex', 'spentindex', 'timestampindex'):
+            assert_equal(info[name]['synced'], True)
+            assert_equal(info[name]['best_block_height'], height)
+            assert_equal(info[name]['progress'], 1)
+
+        # The background build must produce the same indexes.
+        for node in self.nodes:
+            assert_equal(node.getaddressbalance(addr), self.nodes[0].getaddressbalance(addr))
+            assert_equal(node.getaddresstxids(addr), self.nodes[0].getaddresstxids(addr))
+            assert_equal(node.getaddressutxos(addr), self.nodes[0].getaddressutxos(addr))
+            assert_equal(node.getaddressdeltas(addr), self.nodes[0].getaddressdeltas(addr))
+        tip_time = self.nodes[0].getblock(self.nodes[0].getbestblockhash())['time']
+        assert_equal(
+            self.nodes[1].getblockhashes(tip_time + 1, 0, {'logicalTimes': True}),
+            self.nodes[0].getblockhashes(tip_time + 1, 0, {'logicalTimes': True}))
+
+        # New blocks are indexed as they are connected.
+        self.nodes[0].sendtoaddress(addr, 4)
+        self.nodes[0].generate(1)
+        self.sync_all()
+        assert_equal(self.nodes[1].getaddressbalance(addr), self.nodes[0].getaddressbalance(addr))
+
+
+if __name__ == '__main__':
+    InsightIndexBuildTest().main()
@@ -29,9 +29,9 @@ def deser_uint256(f):
     return r
 
 # allows simple http get calls
-def http_get_call(host, port, path, response_object = 0):
+def http_get_call(host, port, path, response_object = 0, headers = {}):
     conn = http.client.HTTPConnection(host, port)
-    conn.request('GET', path)
+    conn.request('GET', path, headers=headers)
 
     if response_object:
         return conn.getresponse()
@@ -346,5 +346,39 @@ class RESTTest (BitcoinTestFramework):
         json_obj = json.loads(json_string)
         assert_equal(json_obj['bestblockhash'], bb_hash)
 
+        # headers can start at a height
+        height = self.nodes[0].getblockcount()
+        json_string = http_get_call(url.hostname, url.port, '/rest/headers/5/'+str(height - 4)+self.FORMAT_SEPARATOR+'json')
+        json_obj = json.loads(json_string)
+        assert_equal(len(json_obj), 5)
+        assert_equal(json_obj[4]['hash'], bb_hash)
+
+        # a range of blocks is their concatenated serializations
+        expected = b''.join(hex_str_to_bytes(self.nodes[0].getblock(str(h), 0)) for h in range(height - 4, height + 1))
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height - 4)+'/10'+self.FORMAT_SEPARATOR+'bin', True)
+        assert_equal(response.status, 200)
+        assert_equal(response.read(), expected)
+        hex_string = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height - 4)+'/5'+self.FORMAT_SEPARATOR+'hex')
+        assert_equal(hex_string, expected.hex() + '\n')
+
+        # byte ranges of a block range can be requested
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height - 4)+'/5'+self.FORMAT_SEPARATOR+'bin', True, {'Range': 'bytes=100-'})
+        assert_equal(response.status, 206)
+        assert_equal(response.getheader('Content-Range'), 'bytes 100-%d/%d' % (len(expected) - 1, len(expected)))
+        assert_equal(response.read(), expected[100:])
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height - 4)+'/5'+self.FORMAT_SEPARATOR+'bin', True, {'Range': 'bytes=-10'})
+        assert_equal(response.status, 206)
+        assert_equal(response.read(), expected[-10:])
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height - 4)+'/5'+self.FORMAT_SEPARATOR+'bin', True, {'Range': 'bytes=%d-' % len(expected)})
+        assert_equal(response.status, 416)
+        response = http_get_call(url.hostname, url.port, '/rest/blocks/'+str(height + 1)+'/1'+self.FORMAT_SEPARATOR+'bin', True)
+        assert_equal(response.status, 404)
+
+        # shielded tree state, by hash or height
+        json_string = http_get_call(url.hostname, url.port, '/rest/treestate/'+bb_hash+self.FORMAT_SEPARATOR+'json')
+        assert_equal(json.loads(json_string), self.nodes[0].z_gettreestate(bb_hash))
+        json_string = http_get_call(url.hostname, url.port, '/rest/treestate/'+str(height)+self.FORMAT_SEPARATOR+'json')
+        assert_equal(json.loads(json_string)['hash'], bb_hash)
+
 if __name__ == '__main__':
     RESTTest().main()
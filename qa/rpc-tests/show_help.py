@@ -99,6 +99,11 @@ Options:
        Set the number of script verification threads (IGNORE_NONDETERMINISTIC, 0 = auto, <0 =
        leave that many cores free, default: 0)
 
+  -provingthreads=<n>
+       Set the number of threads used to create zk-SNARK proofs for shielded
+       transactions, independently of -rpcthreads (IGNORE_NONDETERMINISTIC, 0 = auto, <0 =
+       leave that many cores free, default: 0)
+
   -pid=<file>
        Specify pid file. Relative paths will be prefixed by a net-specific
        datadir location. (default: zcashd.pid)
@@ -342,9 +347,24 @@ ZeroMQ notification options:
   -zmqpubrawblock=<address>
        Enable publish raw block in <address>
 
+  -zmqpubrawblockcompact=<address>
+       Enable publish block header and transaction ids in <address>
+
   -zmqpubrawtx=<address>
        Enable publish raw transaction in <address>
 
+  -zmqpubsequence=<address>
+       Enable publish hash of each block connected or disconnected, and each
+       transaction added to or removed from the mempool, with a label in
+       <address>
+
+  -zmqpubqueuesize=<n>
+       Maximum number of notifications waiting to be published (default: 1000)
+
+  -zmqpubqueuepolicy=<policy>
+       What to do with a notification when the queue is full: 'drop' it, or
+       'block' until there is space (default: drop)
+
 Monitoring options:
 
   -metricsallowip=<ip>
@@ -471,7 +491,8 @@ Debugging/Testing options:
 |       -clockoffset (default: 0)
 |
 |  -maxsigcachesize=<n>
-|       Limit total size of signature and bundle caches to <n> MiB (default: 32)
+|       Limit total size of signature, script execution and bundle caches to <n>
+|       MiB (default: 32)
 |
 |  -maxtipage=<n>
 |       Maximum tip age in seconds to consider node in initial block download
@@ -542,6 +563,11 @@ Mining options:
   -equihashsolver=<name>
        Specify the Equihash solver to be used if enabled (default: "default")
 
+  -equihashsolverthreads=<n>
+       Set the number of threads that each coin generation thread uses to solve
+       Equihash with the default solver (-1 = share all cores between the
+       generation threads, default: 1)
+
   -mineraddress=<addr>
        Send mined coins to a specific single address
 
@@ -594,9 +620,22 @@ RPC server options:
 |  -rpcworkqueue=<n>
 |       Set the depth of the work queue to service RPC calls (default: 16)
 |
+|  -rpcworkqueuewait=<n>
+|       When the work queue is full, let up to the same number of RPC calls
+|       again wait at most <n> milliseconds for a thread (0 = reject them,
+|       default: 1000)
+|
 |  -rpcservertimeout=<n>
 |       Timeout during HTTP requests (default: 30)
 |
+  -rpcasyncthreads=<n>
+       Set the number of threads to service async RPC operations such as
+       z_sendmany (1 to 16, 0 = auto, default: 1)
+
+  -rpcasyncprovingjobs=<n>
+       Set the number of async RPC operations that may create proofs at the
+       same time (default: 2)
+
 Metrics Options (only if -daemon and -printtoconsole are not set):
 
   -showmetrics
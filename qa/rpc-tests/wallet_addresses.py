@@ -13,6 +13,7 @@ from test_framework.util import (
     NU5_BRANCH_ID,
 )
 from test_framework.mininode import nuparams
+from test_framework.authproxy import JSONRPCException
 
 # Test wallet address behaviour across network upgrades
 class WalletAddressesTest(BitcoinTestFramework):
@@ -140,6 +141,18 @@ class WalletAddressesTest(BitcoinTestFramework):
         assert_equal(self.nodes[0].getblockcount(), 2)
         # Sprout address generation is no longer allowed
         sapling_2 = self.nodes[0].z_getnewaddress('sapling')
+        # Batched generation continues from the same legacy Sapling key counter
+        sapling_batch = self.nodes[0].z_getnewaddresses(3)
+        assert_equal(len(sapling_batch), 3)
+        for (args, message) in [
+                ((0,), 'count must be greater than zero'),
+                ((1, 'sprout'), 'Invalid address type'),
+        ]:
+            try:
+                self.nodes[0].z_getnewaddresses(*args)
+                raise AssertionError('Should have thrown an exception')
+            except JSONRPCException as e:
+                assert message in e.error['message']
         unified_2 = self.nodes[0].z_getaddressforaccount(account)['address']
         types_and_addresses = [
             ('sapling', sapling_2),
@@ -166,6 +179,9 @@ class WalletAddressesTest(BitcoinTestFramework):
             set([
                 ("m/32'/1'/2147483647'/0'", sapling_1),
                 ("m/32'/1'/2147483647'/1'", sapling_2),
+                ("m/32'/1'/2147483647'/2'", sapling_batch[0]),
+                ("m/32'/1'/2147483647'/3'", sapling_batch[1]),
+                ("m/32'/1'/2147483647'/4'", sapling_batch[2]),
             ]),
         )
 
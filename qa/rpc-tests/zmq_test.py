@@ -13,6 +13,7 @@ from test_framework.util import assert_equal, bytes_to_hex_str, start_nodes
 
 import zmq
 import struct
+from hashlib import sha256
 
 class ZMQTest(BitcoinTestFramework):
 
@@ -28,10 +29,16 @@ class ZMQTest(BitcoinTestFramework):
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashblock")
         self.zmqSubSocket.setsockopt(zmq.SUBSCRIBE, b"hashtx")
         self.zmqSubSocket.connect("tcp://127.0.0.1:%i" % self.port)
+        self.zmqSeqSocket = self.zmqContext.socket(zmq.SUB)
+        self.zmqSeqSocket.setsockopt(zmq.SUBSCRIBE, b"sequence")
+        self.zmqSeqSocket.setsockopt(zmq.SUBSCRIBE, b"rawblockcompact")
+        self.zmqSeqSocket.connect("tcp://127.0.0.1:%i" % self.port)
         return start_nodes(self.num_nodes, self.options.tmpdir, extra_args=[
             [
                 '-zmqpubhashtx=tcp://127.0.0.1:'+str(self.port),
                 '-zmqpubhashblock=tcp://127.0.0.1:'+str(self.port),
+                '-zmqpubsequence=tcp://127.0.0.1:'+str(self.port),
+                '-zmqpubrawblockcompact=tcp://127.0.0.1:'+str(self.port),
                 '-allowdeprecated=getnewaddress',
             ],
             [],
@@ -99,6 +106,45 @@ class ZMQTest(BitcoinTestFramework):
 
         assert_equal(hashRPC, hashZMQ) #blockhash from generate must be equal to the hash received over zmq
 
+        # the sequence topic labels each connected block and each mempool
+        # acceptance, followed by the mempool sequence number, and
+        # rawblockcompact has the header and txids of each new tip
+        blockcount = self.nodes[0].getblockcount()
+        blockhashes = [self.nodes[0].getblockhash(h) for h in range(blockcount - n, blockcount + 1)]
+        sequence = []
+        compact = []
+        while len(sequence) < n + 2 or len(compact) < n + 1:
+            msg = self.zmqSeqSocket.recv_multipart()
+            msgSequence = struct.unpack('<I', msg[-1])[-1]
+            if msg[0] == b"sequence":
+                assert_equal(msgSequence, len(sequence))
+                sequence.append((bytes_to_hex_str(msg[1][:32]), msg[1][32:]))
+            else:
+                assert_equal(msg[0], b"rawblockcompact")
+                assert_equal(msgSequence, len(compact))
+                compact.append(msg[1])
+
+        assert_equal(sequence, [(h, b"C") for h in blockhashes] + [(hashRPC, b"A" + struct.pack('<Q', 1))])
+        for (blkhash, body) in zip(blockhashes, compact):
+            block = self.nodes[0].getblock(blkhash)
+            # only the coinbase transaction, after the header and the count
+            assert_equal(len(block['tx']), 1)
+            assert_equal(body[-33], 1)
+            assert_equal(bytes_to_hex_str(body[-32:][::-1]), block['tx'][0])
+            header = body[:-33]
+            assert_equal(bytes_to_hex_str(sha256(sha256(header).digest()).digest()[::-1]), blkhash)
+
+        # disconnecting the tip is labelled 'D', and connecting it again 'C'
+        tip = self.nodes[0].getbestblockhash()
+        self.nodes[0].invalidateblock(tip)
+        self.nodes[0].reconsiderblock(tip)
+        while len(sequence) < n + 4:
+            msg = self.zmqSeqSocket.recv_multipart()
+            if msg[0] == b"sequence":
+                assert_equal(struct.unpack('<I', msg[-1])[-1], len(sequence))
+                sequence.append((bytes_to_hex_str(msg[1][:32]), msg[1][32:]))
+        assert_equal(sequence[n + 2:], [(tip, b"D"), (tip, b"C")])
+
 
 if __name__ == '__main__':
     ZMQTest ().main ()
@@ -198,13 +198,13 @@ case "$1" in
                 zcash_rpc zcbenchmark parameterloading 10
                 ;;
             createsaplingspend)
-                zcash_rpc zcbenchmark createsaplingspend 10
+                zcash_rpc zcbenchmark createsaplingspend 10 "${@:3}"
                 ;;
             verifysaplingspend)
                 zcash_rpc zcbenchmark verifysaplingspend 1000
                 ;;
             createsaplingoutput)
-                zcash_rpc zcbenchmark createsaplingoutput 50
+                zcash_rpc zcbenchmark createsaplingoutput 50 "${@:3}"
                 ;;
             verifysaplingoutput)
                 zcash_rpc zcbenchmark verifysaplingoutput 1000
@@ -218,6 +218,12 @@ case "$1" in
             solveequihash)
                 zcash_rpc_slow zcbenchmark solveequihash 50 "${@:3}"
                 ;;
+            solveequihashparallel)
+                zcash_rpc_slow zcbenchmark solveequihashparallel 50 "${@:3}"
+                ;;
+            solveequihashscaling)
+                zcash_rpc_slow zcbenchmark solveequihashscaling 10 "${@:3}"
+                ;;
             verifyequihash)
                 zcash_rpc zcbenchmark verifyequihash 1000
                 ;;
@@ -288,6 +294,9 @@ case "$1" in
             solveequihash)
                 zcash_rpc_slow zcbenchmark solveequihash 1 "${@:3}"
                 ;;
+            solveequihashparallel)
+                zcash_rpc_slow zcbenchmark solveequihashparallel 1 "${@:3}"
+                ;;
             verifyequihash)
                 zcash_rpc zcbenchmark verifyequihash 1
                 ;;
@@ -223,6 +223,46 @@ struct CAddressIndexIteratorHeightKey {
     }
 };
 
+/**
+ * Running totals for an address, maintained alongside the address index so
+ * that balance queries don't need to scan the address's full history.
+ */
+struct CAddressBalanceValue {
+    //! Sum of all address index deltas, i.e. the value of the unspent outputs
+    CAmount balance;
+    //! Sum of the values of all outputs to the address (including change)
+    CAmount received;
+    //! Number of transactions that spend from or pay to the address
+    int64_t txCount;
+    //! Number of unspent outputs to the address
+    int64_t utxoCount;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream, typename Operation>
+    inline void SerializationOp(Stream& s, Operation ser_action) {
+        READWRITE(balance);
+        READWRITE(received);
+        READWRITE(txCount);
+        READWRITE(utxoCount);
+    }
+
+    CAddressBalanceValue() {
+        SetNull();
+    }
+
+    void SetNull() {
+        balance = 0;
+        received = 0;
+        txCount = 0;
+        utxoCount = 0;
+    }
+
+    bool IsNull() const {
+        return balance == 0 && received == 0 && txCount == 0 && utxoCount == 0;
+    }
+};
+
 struct CMempoolAddressDelta
 {
     int64_t time;
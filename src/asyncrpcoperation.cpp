@@ -8,9 +8,11 @@
 #include <boost/uuid/uuid_generators.hpp>
 #include <boost/uuid/uuid_io.hpp>
 
+#include <algorithm>
 #include <string>
 #include <ctime>
 #include <chrono>
+#include <condition_variable>
 
 using namespace std;
 
@@ -24,6 +26,68 @@ static std::map<OperationStatus, std::string> OperationStatusMap = {
     {OperationStatus::SUCCESS, "success"}
 };
 
+static std::mutex provingJobsLock;
+static std::condition_variable provingJobsCondition;
+static size_t nProvingJobs = 0;
+static size_t nMaxProvingJobs = 1;
+
+AsyncRPCProvingJob::AsyncRPCProvingJob() {
+    std::unique_lock<std::mutex> guard(provingJobsLock);
+    provingJobsCondition.wait(guard, [] { return nProvingJobs < nMaxProvingJobs; });
+    nProvingJobs++;
+}
+
+AsyncRPCProvingJob::~AsyncRPCProvingJob() {
+    {
+        std::lock_guard<std::mutex> guard(provingJobsLock);
+        nProvingJobs--;
+    }
+    provingJobsCondition.notify_one();
+}
+
+/**
+ * Set the maximum number of proving jobs that may run at once (at least 1).
+ */
+void AsyncRPCProvingJob::setLimit(size_t maxJobs) {
+    {
+        std::lock_guard<std::mutex> guard(provingJobsLock);
+        nMaxProvingJobs = std::max<size_t>(maxJobs, 1);
+    }
+    provingJobsCondition.notify_all();
+}
+
+size_t AsyncRPCProvingJob::getLimit() {
+    std::lock_guard<std::mutex> guard(provingJobsLock);
+    return nMaxProvingJobs;
+}
+
+/**
+ * Add time spent in a phase. Time spent in the same phase more than once is summed.
+ */
+void AsyncRPCOperationTimings::add(const std::string& phase, std::chrono::duration<double> elapsed) {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto& entry : phases_) {
+        if (entry.first == phase) {
+            entry.second += elapsed.count();
+            return;
+        }
+    }
+    phases_.emplace_back(phase, elapsed.count());
+}
+
+/**
+ * Return the recorded phases as an object mapping "<phase>_secs" to seconds,
+ * in the order in which the phases were first recorded.
+ */
+UniValue AsyncRPCOperationTimings::toJSON() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    UniValue obj(UniValue::VOBJ);
+    for (const auto& entry : phases_) {
+        obj.pushKV(entry.first + "_secs", entry.second);
+    }
+    return obj;
+}
+
 /**
  * Every operation instance should have a globally unique id
  */
@@ -32,6 +96,7 @@ AsyncRPCOperation::AsyncRPCOperation() : error_code_(0), error_message_() {
     boost::uuids::uuid uuid = uuidgen();
     id_ = "opid-" + boost::uuids::to_string(uuid);
     creation_time_ = (int64_t)time(NULL);
+    creation_clock_ = std::chrono::system_clock::now();
     set_state(OperationStatus::READY);
 }
 
@@ -41,11 +106,13 @@ AsyncRPCOperation::AsyncRPCOperation(const AsyncRPCOperation& o) :
         error_code_(o.error_code_), error_message_(o.error_message_),
         result_(o.result_)
 {
+    creation_clock_ = o.creation_clock_;
 }
 
 AsyncRPCOperation& AsyncRPCOperation::operator=( const AsyncRPCOperation& other ) {
     this->id_ = other.id_;
     this->creation_time_ = other.creation_time_;
+    this->creation_clock_ = other.creation_clock_;
     this->state_.store(other.state_.load());
     this->start_time_ = other.start_time_;
     this->end_time_ = other.end_time_;
@@ -74,6 +141,7 @@ void AsyncRPCOperation::cancel() {
 void AsyncRPCOperation::start_execution_clock() {
     std::lock_guard<std::mutex> guard(lock_);
     start_time_ = std::chrono::system_clock::now();
+    timings_.add("queue_wait", start_time_ - creation_clock_);
 }
 
 /**
@@ -169,6 +237,10 @@ UniValue AsyncRPCOperation::getStatus() const {
         obj.pushKV("execution_secs", elapsed_seconds.count());
 
     }
+    UniValue timing = timings_.toJSON();
+    if (!timing.empty()) {
+        obj.pushKV("timing", timing);
+    }
     return obj;
 }
 
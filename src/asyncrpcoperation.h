@@ -14,6 +14,8 @@
 #include <thread>
 #include <utility>
 #include <future>
+#include <mutex>
+#include <vector>
 
 #include <univalue.h>
 
@@ -37,6 +39,47 @@ typedef enum class operationStateEnum {
     SUCCESS
 } OperationStatus;
 
+/**
+ * The AsyncRPCQueue schedules interactive operations ahead of bulk ones, and
+ * never lets bulk operations occupy every worker.
+ */
+typedef enum class operationPriorityEnum {
+    INTERACTIVE = 0,
+    BULK
+} OperationPriority;
+
+/**
+ * Wall-clock time spent by an operation in each phase of its execution, for
+ * reporting through z_getoperationstatus.
+ */
+class AsyncRPCOperationTimings {
+public:
+    void add(const std::string& phase, std::chrono::duration<double> elapsed);
+    UniValue toJSON() const;
+
+private:
+    mutable std::mutex lock_;
+    std::vector<std::pair<std::string, double>> phases_;
+};
+
+/**
+ * An operation holds an AsyncRPCProvingJob while it creates the proofs for a
+ * transaction. This bounds the number of proving jobs that run at once, and
+ * with it their memory use, independently of the number of queue workers.
+ */
+class AsyncRPCProvingJob {
+public:
+    // Blocks until a proving slot is free.
+    AsyncRPCProvingJob();
+    ~AsyncRPCProvingJob();
+
+    AsyncRPCProvingJob(const AsyncRPCProvingJob&) = delete;
+    AsyncRPCProvingJob& operator=(const AsyncRPCProvingJob&) = delete;
+
+    static void setLimit(size_t maxJobs);
+    static size_t getLimit();
+};
+
 class AsyncRPCOperation {
 public:
     AsyncRPCOperation();
@@ -62,6 +105,11 @@ public:
         return creation_time_;
     }
 
+    // Override this method to schedule the operation in the bulk lane.
+    virtual OperationPriority getPriority() const {
+        return OperationPriority::INTERACTIVE;
+    }
+
     // Override this method to add data to the default status object.
     virtual UniValue getStatus() const;
 
@@ -107,15 +155,17 @@ protected:
     // the AsyncRPCQueue, which in turn invokes cancel() on all operations.
     // The member variables below are protected rather than private in order to
     // allow subclasses of AsyncRPCOperation the ability to access and update
-    // internal state.  Currently, all operations are executed in a single-thread
-    // by a single worker.
+    // internal state.  An operation is executed by a single worker, but several
+    // operations may be executing at once on different workers.
     mutable std::mutex lock_;   // lock on this when read/writing non-atomics
     UniValue result_;
     int error_code_;
     std::string error_message_;
     std::atomic<OperationStatus> state_;
     std::chrono::time_point<std::chrono::system_clock> start_time_, end_time_;  
+    AsyncRPCOperationTimings timings_;
 
+    // Also records the time the operation spent waiting in the queue.
     void start_execution_clock();
     void stop_execution_clock();
 
@@ -147,6 +197,7 @@ private:
     // Initialized in the operation constructor, never to be modified again.
     AsyncRPCOperationId id_;
     int64_t creation_time_;
+    std::chrono::time_point<std::chrono::system_clock> creation_clock_;
 };
 
 #endif // ZCASH_ASYNCRPCOPERATION_H
@@ -23,6 +23,22 @@ AsyncRPCQueue::~AsyncRPCQueue() {
     closeAndWait();     // join on all worker threads
 }
 
+/**
+ * Return true if a worker may take an operation from the queue.
+ *
+ * Interactive operations are always runnable. Bulk operations are only
+ * runnable while at least one other worker is free to pick up interactive
+ * operations, so a long batch cannot hold up a user-facing send.
+ * The caller must hold lock_.
+ */
+bool AsyncRPCQueue::has_runnable_operation() const {
+    if (!interactive_queue_.empty()) {
+        return true;
+    }
+    size_t maxBulk = workers_.size() > 1 ? workers_.size() - 1 : 1;
+    return !bulk_queue_.empty() && running_bulk_ < maxBulk;
+}
+
 /**
  * A worker will execute this method on a new thread
  */
@@ -33,28 +49,42 @@ void AsyncRPCQueue::run(size_t workerId) {
     while (true) {
         AsyncRPCOperationId key;
         std::shared_ptr<AsyncRPCOperation> operation;
+        bool isBulk = false;
         {
             std::unique_lock<std::mutex> guard(lock_);
-            while (operation_id_queue_.empty() && !isClosed() && !isFinishing()) {
+            while (!has_runnable_operation() && !isClosed() && !isFinishing()) {
                 this->condition_.wait(guard);
             }
 
             // Exit if the queue is empty and we are finishing up
-            if (isFinishing() && operation_id_queue_.empty()) {
+            if (isFinishing() && interactive_queue_.empty() && bulk_queue_.empty()) {
                 break;
             }
 
             // Exit if the queue is closing.
             if (isClosed()) {
-                while (!operation_id_queue_.empty()) {
-                    operation_id_queue_.pop();
-                }
+                interactive_queue_ = {};
+                bulk_queue_ = {};
                 break;
             }
 
-            // Get operation id
-            key = operation_id_queue_.front();
-            operation_id_queue_.pop();
+            // While finishing, there may be bulk operations left that this
+            // worker is not allowed to take yet.
+            if (!has_runnable_operation()) {
+                this->condition_.wait(guard);
+                continue;
+            }
+
+            // Get operation id, preferring the interactive lane
+            if (!interactive_queue_.empty()) {
+                key = interactive_queue_.front();
+                interactive_queue_.pop();
+            } else {
+                key = bulk_queue_.front();
+                bulk_queue_.pop();
+                isBulk = true;
+                running_bulk_++;
+            }
 
             // Search operation map
             AsyncRPCOperationMap::const_iterator iter = operation_map_.find(key);
@@ -70,6 +100,13 @@ void AsyncRPCQueue::run(size_t workerId) {
         } else {
             operation->main();
         }
+
+        if (isBulk) {
+            std::lock_guard<std::mutex> guard(lock_);
+            running_bulk_--;
+            // A worker may have been waiting for this bulk slot.
+            this->condition_.notify_all();
+        }
     }
 }
 
@@ -94,7 +131,11 @@ void AsyncRPCQueue::addOperation(const std::shared_ptr<AsyncRPCOperation> &ptrOp
 
     AsyncRPCOperationId id = ptrOperation->getId();
     operation_map_.emplace(id, ptrOperation);
-    operation_id_queue_.push(id);
+    if (ptrOperation->getPriority() == OperationPriority::BULK) {
+        bulk_queue_.push(id);
+    } else {
+        interactive_queue_.push(id);
+    }
     this->condition_.notify_one();
 }
 
@@ -119,7 +160,7 @@ std::shared_ptr<AsyncRPCOperation> AsyncRPCQueue::popOperationForId(AsyncRPCOper
     std::shared_ptr<AsyncRPCOperation> ptr = getOperationForId(id);
     if (ptr) {
         std::lock_guard<std::mutex> guard(lock_);
-        // Note: if the id still exists in the operationIdQueue, when it gets processed by a worker
+        // Note: if the id still exists in one of the queues, when it gets processed by a worker
         // there will no operation in the map to execute, so nothing will happen.
         operation_map_.erase(id);
     }
@@ -171,7 +212,7 @@ void AsyncRPCQueue::cancelAllOperations() {
  */
 size_t AsyncRPCQueue::getOperationCount() const {
     std::lock_guard<std::mutex> guard(lock_);
-    return operation_id_queue_.size();
+    return interactive_queue_.size() + bulk_queue_.size();
 }
 
 /**
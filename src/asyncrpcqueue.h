@@ -21,6 +21,13 @@
 
 typedef std::unordered_map<AsyncRPCOperationId, std::shared_ptr<AsyncRPCOperation> > AsyncRPCOperationMap; 
 
+/** -rpcasyncthreads default (number of async RPC workers, 0 = auto) */
+static const int DEFAULT_ASYNC_RPC_THREADS = 1;
+/** Maximum number of async RPC workers */
+static const int MAX_ASYNC_RPC_THREADS = 16;
+/** -rpcasyncprovingjobs default (number of operations that may create proofs at once) */
+static const int DEFAULT_ASYNC_RPC_PROVING_JOBS = 2;
+
 
 class AsyncRPCQueue {
 public:
@@ -54,6 +61,7 @@ private:
     // addWorker() will spawn a new thread on run())
     void run(size_t workerId);
     void wait_for_worker_threads();
+    bool has_runnable_operation() const;
 
     // Why this is not a recursive lock: http://www.zaval.org/resources/library/butenhof1.html
     mutable std::mutex lock_;
@@ -61,7 +69,9 @@ private:
     std::atomic<bool> closed_;
     std::atomic<bool> finish_;
     AsyncRPCOperationMap operation_map_;
-    std::queue <AsyncRPCOperationId> operation_id_queue_;
+    std::queue <AsyncRPCOperationId> interactive_queue_;
+    std::queue <AsyncRPCOperationId> bulk_queue_;
+    size_t running_bulk_ = 0;  // number of bulk operations being executed by workers
     std::vector<std::thread> workers_;
 };
 
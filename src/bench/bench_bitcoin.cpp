@@ -5,7 +5,11 @@
 
 #include "bench.h"
 
+#include "crypto/aes.h"
+#include "crypto/chacha20.h"
+#include "crypto/ripemd160.h"
 #include "crypto/sha256.h"
+#include "crypto/sha512.h"
 #include "fs.h"
 #include "key.h"
 #include "main.h"
@@ -19,6 +23,10 @@ int
 main(int argc, char** argv)
 {
     SHA256AutoDetect();
+    SHA512AutoDetect();
+    RIPEMD160AutoDetect();
+    ChaCha20AutoDetect();
+    AESAutoDetect();
     ECC_Start();
     SetupEnvironment();
     fPrintToDebugLog = false; // don't want to write to debug log file
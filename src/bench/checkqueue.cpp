@@ -8,6 +8,8 @@
 #include "main.h"
 #include "checkqueue.h"
 #include "prevector.h"
+#include "crypto/sha256.h"
+#include "uint256.h"
 #include <vector>
 #include <boost/thread/thread.hpp>
 #include "random.h"
@@ -100,5 +102,54 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::State& state)
     tg.interrupt_all();
     tg.join_all();
 }
+
+// This Benchmark shows how the CheckQueue scales with the number of threads
+// (including the master), for checks that take about as long as hashing a
+// few kilobytes. Compare the time per iteration with that of one thread.
+static void CCheckQueueScaling(benchmark::State& state, int nThreads)
+{
+    struct HashJob {
+        uint256 hash;
+        bool operator()()
+        {
+            for (int i = 0; i < 32; i++) {
+                CSHA256().Write(hash.begin(), hash.size()).Finalize(hash.begin());
+            }
+            return true;
+        }
+        void swap(HashJob& x){std::swap(hash, x.hash);};
+    };
+    CCheckQueue<HashJob> queue {QUEUE_BATCH_SIZE};
+    boost::thread_group tg;
+    for (auto x = 1; x < nThreads; ++x) {
+       tg.create_thread([&]{queue.Thread();});
+    }
+    while (state.KeepRunning()) {
+        CCheckQueueControl<HashJob> control(&queue);
+        for (size_t i = 0; i < BATCHES; i++) {
+            std::vector<HashJob> vChecks(BATCH_SIZE);
+            control.Add(vChecks);
+        }
+        control.Wait();
+    }
+    tg.interrupt_all();
+    tg.join_all();
+}
+
+static void CCheckQueueScaling1Thread(benchmark::State& state) { CCheckQueueScaling(state, 1); }
+static void CCheckQueueScaling2Threads(benchmark::State& state) { CCheckQueueScaling(state, 2); }
+static void CCheckQueueScaling4Threads(benchmark::State& state) { CCheckQueueScaling(state, 4); }
+static void CCheckQueueScaling8Threads(benchmark::State& state) { CCheckQueueScaling(state, 8); }
+static void CCheckQueueScaling16Threads(benchmark::State& state) { CCheckQueueScaling(state, 16); }
+static void CCheckQueueScaling32Threads(benchmark::State& state) { CCheckQueueScaling(state, 32); }
+static void CCheckQueueScaling64Threads(benchmark::State& state) { CCheckQueueScaling(state, 64); }
+
 BENCHMARK(CCheckQueueSpeed);
 BENCHMARK(CCheckQueueSpeedPrevectorJob);
+BENCHMARK(CCheckQueueScaling1Thread);
+BENCHMARK(CCheckQueueScaling2Threads);
+BENCHMARK(CCheckQueueScaling4Threads);
+BENCHMARK(CCheckQueueScaling8Threads);
+BENCHMARK(CCheckQueueScaling16Threads);
+BENCHMARK(CCheckQueueScaling32Threads);
+BENCHMARK(CCheckQueueScaling64Threads);
@@ -0,0 +1,84 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "bench.h"
+#include "crypto/aes.h"
+#include "crypto/chacha20.h"
+
+#include <vector>
+
+/* Number of bytes to process per iteration */
+static const uint64_t BUFFER_SIZE = 1000*1000;
+
+/* Number of wallet keys to decrypt per iteration */
+static const size_t WALLET_KEYS = 1024;
+
+static void CHACHA20_1MB(benchmark::State& state)
+{
+    std::vector<uint8_t> key(32, 0);
+    ChaCha20 ctx(key.data(), key.size());
+    ctx.SetIV(0);
+    std::vector<uint8_t> out(BUFFER_SIZE);
+    while (state.KeepRunning()) {
+        ctx.Output(out.data(), out.size());
+    }
+}
+
+// FastRandomContext refills its buffer 64 bytes at a time.
+static void CHACHA20_64BYTES(benchmark::State& state)
+{
+    std::vector<uint8_t> key(32, 0);
+    ChaCha20 ctx(key.data(), key.size());
+    ctx.SetIV(0);
+    uint8_t out[64];
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < BUFFER_SIZE / 64; i++) {
+            ctx.Output(out, sizeof(out));
+        }
+    }
+}
+
+static void AES256CBC_ENCRYPT_1MB(benchmark::State& state)
+{
+    std::vector<uint8_t> key(AES256_KEYSIZE, 0), iv(AES_BLOCKSIZE, 0);
+    std::vector<uint8_t> in(BUFFER_SIZE, 0);
+    std::vector<uint8_t> out(BUFFER_SIZE + AES_BLOCKSIZE);
+    AES256CBCEncrypt enc(key.data(), iv.data(), true);
+    while (state.KeepRunning()) {
+        enc.Encrypt(in.data(), in.size(), out.data());
+    }
+}
+
+static void AES256CBC_DECRYPT_1MB(benchmark::State& state)
+{
+    std::vector<uint8_t> key(AES256_KEYSIZE, 0), iv(AES_BLOCKSIZE, 0);
+    std::vector<uint8_t> in(BUFFER_SIZE, 0);
+    std::vector<uint8_t> out(BUFFER_SIZE);
+    AES256CBCDecrypt dec(key.data(), iv.data(), false);
+    while (state.KeepRunning()) {
+        dec.Decrypt(in.data(), in.size(), out.data());
+    }
+}
+
+// Unlocking an encrypted wallet decrypts each 32-byte transparent secret key,
+// padded to 48 bytes, with its own IV.
+static void AES256CBC_DECRYPT_WALLET_KEYS_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> key(AES256_KEYSIZE, 0), iv(AES_BLOCKSIZE, 0);
+    std::vector<uint8_t> secret(32, 0);
+    std::vector<uint8_t> cipher(48);
+    AES256CBCEncrypt(key.data(), iv.data(), true).Encrypt(secret.data(), secret.size(), cipher.data());
+    std::vector<uint8_t> out(48);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < WALLET_KEYS; i++) {
+            AES256CBCDecrypt(key.data(), iv.data(), true).Decrypt(cipher.data(), cipher.size(), out.data());
+        }
+    }
+}
+
+BENCHMARK(CHACHA20_1MB);
+BENCHMARK(CHACHA20_64BYTES);
+BENCHMARK(AES256CBC_ENCRYPT_1MB);
+BENCHMARK(AES256CBC_DECRYPT_1MB);
+BENCHMARK(AES256CBC_DECRYPT_WALLET_KEYS_1024);
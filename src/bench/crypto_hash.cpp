@@ -9,6 +9,7 @@
 #include "bloom.h"
 #include "random.h"
 #include "util/time.h"
+#include "crypto/hmac_sha512.h"
 #include "crypto/ripemd160.h"
 #include "crypto/sha1.h"
 #include "crypto/sha256.h"
@@ -57,6 +58,79 @@ static void SHA512(benchmark::State& state)
         CSHA512().Write(begin_ptr(in), in.size()).Finalize(hash);
 }
 
+/* Number of short messages to hash per iteration in the batch benchmarks */
+static const size_t BATCH_SIZE = 1024;
+
+// Each batch benchmark is paired with one that hashes the same messages one
+// at a time, so that comparing them shows what the multi-buffer
+// implementation selected for this CPU (if any) gains.
+
+static void RIPEMD160_32b_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(32 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CRIPEMD160::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < BATCH_SIZE; i++) {
+            CRIPEMD160().Write(in.data() + 32 * i, 32).Finalize(out.data() + CRIPEMD160::OUTPUT_SIZE * i);
+        }
+    }
+}
+
+static void RIPEMD160Batch_32b_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(32 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CRIPEMD160::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        RIPEMD160Batch(out.data(), in.data(), 32, BATCH_SIZE);
+    }
+}
+
+static void SHA512_128b_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(128 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CSHA512::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < BATCH_SIZE; i++) {
+            CSHA512().Write(in.data() + 128 * i, 128).Finalize(out.data() + CSHA512::OUTPUT_SIZE * i);
+        }
+    }
+}
+
+static void SHA512Batch_128b_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> in(128 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CSHA512::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        SHA512Batch(out.data(), in.data(), 128, BATCH_SIZE);
+    }
+}
+
+// BIP 32 child key derivation computes HMAC-SHA512 of a 37-byte message,
+// keyed by a 32-byte chain code.
+static void HMAC_SHA512_BIP32_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> keys(32 * BATCH_SIZE, 0);
+    std::vector<uint8_t> msgs(37 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CHMAC_SHA512::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        for (size_t i = 0; i < BATCH_SIZE; i++) {
+            CHMAC_SHA512(keys.data() + 32 * i, 32)
+                .Write(msgs.data() + 37 * i, 37)
+                .Finalize(out.data() + CHMAC_SHA512::OUTPUT_SIZE * i);
+        }
+    }
+}
+
+static void HMAC_SHA512Batch_BIP32_1024(benchmark::State& state)
+{
+    std::vector<uint8_t> keys(32 * BATCH_SIZE, 0);
+    std::vector<uint8_t> msgs(37 * BATCH_SIZE, 0);
+    std::vector<uint8_t> out(CHMAC_SHA512::OUTPUT_SIZE * BATCH_SIZE);
+    while (state.KeepRunning()) {
+        HMAC_SHA512Batch(out.data(), keys.data(), 32, msgs.data(), 37, BATCH_SIZE);
+    }
+}
+
 static void FastRandom_32bit(benchmark::State& state)
 {
     FastRandomContext rng(true);
@@ -85,5 +159,11 @@ BENCHMARK(SHA256);
 BENCHMARK(SHA512);
 
 BENCHMARK(SHA256D64_1024); // 7400
+BENCHMARK(RIPEMD160_32b_1024);
+BENCHMARK(RIPEMD160Batch_32b_1024);
+BENCHMARK(SHA512_128b_1024);
+BENCHMARK(SHA512Batch_128b_1024);
+BENCHMARK(HMAC_SHA512_BIP32_1024);
+BENCHMARK(HMAC_SHA512Batch_BIP32_1024);
 BENCHMARK(FastRandom_32bit);
 BENCHMARK(FastRandom_1bit);
@@ -0,0 +1,105 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "bench.h"
+#include "arith_uint256.h"
+#include "chainparams.h"
+#include "primitives/block.h"
+#include "rpc/cbor.h"
+#include "rpc/protocol.h"
+#include "script/script.h"
+#include "streams.h"
+#include "util/strencodings.h"
+#include "version.h"
+
+#include <univalue.h>
+
+extern void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry);
+
+// Compares the cost of encoding the reply to a bulk data request in each of
+// the encodings supported by the HTTP RPC server.
+
+static CBlock CreateBenchBlock()
+{
+    // A block of transparent transactions, each with two P2PKH inputs and outputs.
+    CBlock block;
+    for (int i = 0; i < 1000; i++) {
+        CMutableTransaction mtx;
+        for (uint32_t j = 0; j < 2; j++) {
+            CTxIn txin(COutPoint(ArithToUint256(arith_uint256(i * 2 + j)), j));
+            txin.scriptSig = CScript() << std::vector<unsigned char>(72, 0x30) << std::vector<unsigned char>(33, 0x02);
+            mtx.vin.push_back(txin);
+            CTxOut txout;
+            txout.nValue = 100000 + i;
+            txout.scriptPubKey = CScript() << OP_DUP << OP_HASH160 << std::vector<unsigned char>(20, j) << OP_EQUALVERIFY << OP_CHECKSIG;
+            mtx.vout.push_back(txout);
+        }
+        block.vtx.push_back(CTransaction(mtx));
+    }
+    return block;
+}
+
+/** The result of getblock with verbosity 2, without the header fields */
+static UniValue BlockTxsToJSON(const CBlock& block)
+{
+    SelectParams(CBaseChainParams::MAIN);
+    UniValue txs(UniValue::VARR);
+    for (const CTransaction& tx : block.vtx) {
+        UniValue objTx(UniValue::VOBJ);
+        TxToJSON(tx, uint256(), objTx);
+        txs.push_back(objTx);
+    }
+    return txs;
+}
+
+static void RPCEncodeBlockRaw(benchmark::State& state)
+{
+    CBlock block = CreateBenchBlock();
+    while (state.KeepRunning()) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << block;
+        std::string reply = ss.str();
+    }
+}
+
+static void RPCEncodeBlockHexJSON(benchmark::State& state)
+{
+    CBlock block = CreateBenchBlock();
+    while (state.KeepRunning()) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << block;
+        std::string reply = JSONRPCReply(HexStr(ss.begin(), ss.end()), NullUniValue, 1);
+    }
+}
+
+static void RPCEncodeVerboseBlockJSON(benchmark::State& state)
+{
+    UniValue txs = BlockTxsToJSON(CreateBenchBlock());
+    while (state.KeepRunning()) {
+        std::string reply = txs.write();
+    }
+}
+
+static void RPCEncodeVerboseBlockCBOR(benchmark::State& state)
+{
+    UniValue txs = BlockTxsToJSON(CreateBenchBlock());
+    while (state.KeepRunning()) {
+        std::string reply = EncodeCBOR(txs);
+    }
+}
+
+static void RPCDecodeVerboseBlockJSON(benchmark::State& state)
+{
+    std::string json = BlockTxsToJSON(CreateBenchBlock()).write();
+    while (state.KeepRunning()) {
+        UniValue txs;
+        txs.read(json);
+    }
+}
+
+BENCHMARK(RPCEncodeBlockRaw);
+BENCHMARK(RPCEncodeBlockHexJSON);
+BENCHMARK(RPCEncodeVerboseBlockJSON);
+BENCHMARK(RPCEncodeVerboseBlockCBOR);
+BENCHMARK(RPCDecodeVerboseBlockJSON);
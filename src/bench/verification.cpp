@@ -7,6 +7,7 @@
 #include "consensus/upgrades.h"
 #include "keystore.h"
 #include "primitives/transaction.h"
+#include "random.h"
 #include "script/interpreter.h"
 #include "script/sign.h"
 #include "streams.h"
@@ -78,6 +79,57 @@ static void ECDSA(benchmark::State& state)
     }
 }
 
+// Verification of the signatures of a transaction that consolidates 100
+// outputs sent to one address, one at a time and as a batch.
+static const int CONSOLIDATION_INPUTS = 100;
+
+static void ConsolidationSignatures(
+    std::vector<uint256>& hashes,
+    std::vector<std::vector<unsigned char>>& sigs,
+    CPubKey& pubkey)
+{
+    CKey key = CKey::TestOnlyRandomKey(true);
+    pubkey = key.GetPubKey();
+    for (int i = 0; i < CONSOLIDATION_INPUTS; i++) {
+        hashes.push_back(GetRandHash());
+        sigs.emplace_back();
+        bool signedHash = key.Sign(hashes.back(), sigs.back());
+        assert(signedHash);
+    }
+}
+
+static void ECDSAConsolidation(benchmark::State& state)
+{
+    std::vector<uint256> hashes;
+    std::vector<std::vector<unsigned char>> sigs;
+    CPubKey pubkey;
+    ConsolidationSignatures(hashes, sigs, pubkey);
+
+    while (state.KeepRunning()) {
+        for (int i = 0; i < CONSOLIDATION_INPUTS; i++) {
+            bool valid = pubkey.Verify(hashes[i], sigs[i]);
+            assert(valid);
+        }
+    }
+}
+
+static void ECDSAConsolidationBatch(benchmark::State& state)
+{
+    std::vector<uint256> hashes;
+    std::vector<std::vector<unsigned char>> sigs;
+    CPubKey pubkey;
+    ConsolidationSignatures(hashes, sigs, pubkey);
+
+    while (state.KeepRunning()) {
+        CPubKeyBatchVerifier batch;
+        for (int i = 0; i < CONSOLIDATION_INPUTS; i++) {
+            batch.Add(pubkey, hashes[i], sigs[i]);
+        }
+        bool valid = batch.Verify();
+        assert(valid);
+    }
+}
+
 static void JoinSplitSig(benchmark::State& state)
 {
     ed25519::VerificationKey joinSplitPubKey;
@@ -136,6 +188,8 @@ static void SaplingOutput(benchmark::State& state)
 }
 
 BENCHMARK(ECDSA);
+BENCHMARK(ECDSAConsolidation);
+BENCHMARK(ECDSAConsolidationBatch);
 BENCHMARK(JoinSplitSig);
 BENCHMARK(SaplingSpend);
 BENCHMARK(SaplingOutput);
@@ -7,6 +7,10 @@
 #define BITCOIN_CHECKQUEUE_H
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include <boost/thread/condition_variable.hpp>
@@ -15,6 +19,11 @@
 
 #include "sync.h"
 
+/** Maximum number of worker threads of a CCheckQueue that have their own queue */
+static const unsigned int MAX_CHECKQUEUE_WORKERS = 64;
+/** Time that a worker aims to spend on one chunk of checks, in nanoseconds */
+static const uint64_t CHECKQUEUE_TARGET_CHUNK_NANOS = 100000;
+
 template <typename T>
 class CCheckQueueControl;
 
@@ -27,11 +36,29 @@ class CCheckQueueControl;
   * onto the queue, where they are processed by N-1 worker threads. When
   * the master is done adding work, it temporarily joins the worker pool
   * as an N'th worker, until all jobs are done.
+  *
+  * Each worker, and the master, has its own queue, and batches are spread
+  * over those queues as they are added. A worker takes checks from its own
+  * queue, and when that is empty, steals them from the others, so workers
+  * mostly don't contend with each other. Checks are taken in chunks sized by
+  * the measured cost of a check: cheap checks are taken many at a time, to
+  * amortise the locking, and expensive ones few at a time, so that the
+  * workers finish at about the same time.
   */
 template <typename T>
 class CCheckQueue
 {
 private:
+    /** The checks queued for one worker. */
+    struct WorkerQueue
+    {
+        boost::mutex mutex;
+        //! The owner takes checks from the back, others steal from the front.
+        std::deque<T> checks;
+        //! The size of checks, so that empty queues can be skipped without locking.
+        std::atomic<size_t> nSize{0};
+    };
+
     //! Mutex to protect the inner state
     boost::mutex mutex;
 
@@ -41,25 +68,33 @@ private:
     //! Master thread blocks on this when out of work
     boost::condition_variable condMaster;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue;
+    //! The queues of the master (at index 0) and the workers.
+    std::unique_ptr<WorkerQueue[]> queues;
 
-    //! The number of workers (including the master) that are idle.
-    int nIdle;
+    //! The number of queues that were allocated.
+    const unsigned int nMaxQueues;
 
-    //! The total number of workers (including the master).
-    int nTotal;
+    /**
+     * The number of queues that are in use. Each worker thread claims one
+     * when it starts; workers beyond nMaxQueues only steal.
+     */
+    std::atomic<unsigned int> nQueues;
+
+    //! The queue that the next batch starts at.
+    std::atomic<unsigned int> nNextQueue;
+
+    //! The number of checks in the queues, that no worker has taken yet.
+    std::atomic<unsigned int> nQueued;
 
     //! The temporary evaluation result.
-    bool fAllOk;
+    std::atomic<bool> fAllOk;
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo;
+    std::atomic<unsigned int> nTodo;
 
     //! Whether we're shutting down.
     bool fQuit;
@@ -67,32 +102,89 @@ private:
     //! The maximum number of elements to be processed in one batch
     unsigned int nBatchSize;
 
+    //! Moving average of the time that one check takes, in nanoseconds.
+    std::atomic<uint64_t> nCheckNanos;
+
+    unsigned int QueuesInUse() const
+    {
+        return std::min(nQueues.load(), nMaxQueues);
+    }
+
+    /** Decide how many work units to process now. */
+    unsigned int ChunkSize() const
+    {
+        // * Aim for chunks that take about CHECKQUEUE_TARGET_CHUNK_NANOS.
+        // * Do not try to do everything at once, but aim for increasingly smaller batches so
+        //   all workers finish approximately simultaneously.
+        // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
+        unsigned int nSize = nBatchSize;
+        uint64_t nCost = nCheckNanos.load(std::memory_order_relaxed);
+        if (nCost > 0) {
+            nSize = std::min<uint64_t>(nSize, CHECKQUEUE_TARGET_CHUNK_NANOS / nCost);
+        }
+        nSize = std::min(nSize, nQueued.load(std::memory_order_relaxed) / (QueuesInUse() + 1));
+        return std::max(1U, nSize);
+    }
+
+    /** Moves up to nMax checks from a queue to vChecks. */
+    bool TakeChecks(WorkerQueue& wq, unsigned int nMax, bool fSteal, std::vector<T>& vChecks)
+    {
+        if (wq.nSize.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        boost::unique_lock<boost::mutex> lock(wq.mutex);
+        unsigned int nNow = std::min((size_t)nMax, wq.checks.size());
+        vChecks.resize(nNow);
+        for (unsigned int i = 0; i < nNow; i++) {
+            // We want the lock on the mutex to be as short as possible, so swap jobs from the
+            // queue to the local batch vector instead of copying.
+            if (fSteal) {
+                vChecks[i].swap(wq.checks.front());
+                wq.checks.pop_front();
+            } else {
+                vChecks[i].swap(wq.checks.back());
+                wq.checks.pop_back();
+            }
+        }
+        wq.nSize = wq.checks.size();
+        nQueued -= nNow;
+        return nNow > 0;
+    }
+
+    /**
+     * Takes the next chunk of checks from the worker's own queue, or if that
+     * is empty, from the queue of another worker. Returns false if no checks
+     * are queued.
+     */
+    bool NextChecks(unsigned int nQueue, std::vector<T>& vChecks)
+    {
+        unsigned int nSize = ChunkSize();
+        unsigned int nInUse = QueuesInUse();
+        if (nQueue < nInUse && TakeChecks(queues[nQueue], nSize, false, vChecks)) {
+            return true;
+        }
+        for (unsigned int i = 1; i <= nInUse; i++) {
+            unsigned int nVictim = (nQueue + i) % nInUse;
+            if (nVictim != nQueue && TakeChecks(queues[nVictim], nSize, true, vChecks)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster = false)
+    bool Loop(unsigned int nQueue, bool fMaster = false)
     {
         boost::condition_variable& cond = fMaster ? condMaster : condWorker;
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
         do {
-            {
+            if (!NextChecks(nQueue, vChecks)) {
                 boost::unique_lock<boost::mutex> lock(mutex);
-                // first do the clean-up of the previous loop run (allowing us to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster)
-                        // We processed the last element; inform the master it can exit and return the result
-                        condMaster.notify_one();
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty()) {
+                // Checks that are queued after this are announced while
+                // holding the mutex, so we can't miss them.
+                if (nQueued == 0) {
                     if ((fMaster || fQuit) && nTodo == 0) {
-                        nTotal--;
                         bool fRet = fAllOk;
                         // reset the status for new work later
                         if (fMaster)
@@ -100,31 +192,33 @@ private:
                         // return the current status
                         return fRet;
                     }
-                    nIdle++;
                     cond.wait(lock); // wait
-                    nIdle--;
                 }
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for increasingly smaller batches so
-                //   all workers finish approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start helping.
-                // * Don't do batches smaller than 1 (duh), or larger than nBatchSize.
-                nNow = std::max(1U, std::min(nBatchSize, (unsigned int)queue.size() / (nTotal + nIdle + 1)));
-                vChecks.resize(nNow);
-                for (unsigned int i = 0; i < nNow; i++) {
-                    // We want the lock on the mutex to be as short as possible, so swap jobs from the global
-                    // queue to the local batch vector instead of copying.
-                    vChecks[i].swap(queue.back());
-                    queue.pop_back();
+                continue;
+            }
+            // execute work, unless a check has failed already
+            unsigned int nNow = vChecks.size();
+            bool fOk = fAllOk;
+            if (fOk) {
+                auto nStart = std::chrono::steady_clock::now();
+                for (T& check : vChecks)
+                    if (fOk)
+                        fOk = check();
+                if (fOk) {
+                    uint64_t nSample = std::max<uint64_t>(1, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - nStart).count() / nNow);
+                    uint64_t nCost = nCheckNanos.load(std::memory_order_relaxed);
+                    nCheckNanos.store(nCost ? (nCost * 7 + nSample) / 8 : nSample, std::memory_order_relaxed);
+                } else {
+                    fAllOk = false;
                 }
-                // Check whether we need to do work at all
-                fOk = fAllOk;
             }
-            // execute work
-            for (T& check : vChecks)
-                if (fOk)
-                    fOk = check();
             vChecks.clear();
+            if (nTodo.fetch_sub(nNow) == nNow && !fMaster) {
+                // We processed the last element; inform the master it can exit and return the result
+                boost::unique_lock<boost::mutex> lock(mutex);
+                condMaster.notify_one();
+            }
         } while (true);
     }
 
@@ -133,32 +227,51 @@ public:
     boost::mutex ControlMutex;
 
     //! Create a new check queue
-    CCheckQueue(unsigned int nBatchSizeIn) : nIdle(0), nTotal(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn) {}
+    CCheckQueue(unsigned int nBatchSizeIn, unsigned int nMaxWorkers = MAX_CHECKQUEUE_WORKERS) :
+        queues(new WorkerQueue[nMaxWorkers + 1]), nMaxQueues(nMaxWorkers + 1), nQueues(1),
+        nNextQueue(0), nQueued(0), fAllOk(true), nTodo(0), fQuit(false), nBatchSize(nBatchSizeIn),
+        nCheckNanos(0) {}
 
     //! Worker thread
     void Thread()
     {
-        Loop();
+        Loop(nQueues++);
     }
 
     //! Wait until execution finishes, and return whether all evaluations were successful.
     bool Wait()
     {
-        return Loop(true);
+        return Loop(0, true);
     }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T>& vChecks)
     {
-        boost::unique_lock<boost::mutex> lock(mutex);
-        for (T& check : vChecks) {
-            queue.push_back(T());
-            check.swap(queue.back());
-        }
+        if (vChecks.empty())
+            return;
         nTodo += vChecks.size();
-        if (vChecks.size() == 1)
+        // Spread the batch over the queues, starting at a different queue
+        // for each batch.
+        unsigned int nInUse = QueuesInUse();
+        unsigned int nPieces = std::min((size_t)nInUse, vChecks.size());
+        unsigned int nFirst = nNextQueue++ % nInUse;
+        size_t nPos = 0;
+        for (unsigned int i = 0; i < nPieces; i++) {
+            size_t nEnd = vChecks.size() * (i + 1) / nPieces;
+            WorkerQueue& wq = queues[(nFirst + i) % nInUse];
+            boost::unique_lock<boost::mutex> lock(wq.mutex);
+            for (size_t j = nPos; j < nEnd; j++) {
+                wq.checks.push_back(T());
+                vChecks[j].swap(wq.checks.back());
+            }
+            wq.nSize = wq.checks.size();
+            nQueued += nEnd - nPos;
+            nPos = nEnd;
+        }
+        boost::unique_lock<boost::mutex> lock(mutex);
+        if (nPieces == 1)
             condWorker.notify_one();
-        else if (vChecks.size() > 1)
+        else
             condWorker.notify_all();
     }
 
@@ -6,6 +6,8 @@
 #include "aes.h"
 #include "crypto/common.h"
 
+#include "compat/cpuid.h"
+
 #include <assert.h>
 #include <string.h>
 
@@ -13,6 +15,78 @@ extern "C" {
 #include "crypto/ctaes/ctaes.c"
 }
 
+namespace aes_aesni
+{
+void Expand256(unsigned char* rk, const unsigned char* key);
+void ExpandDecrypt256(unsigned char* rk, const unsigned char* key);
+void Encrypt256(const unsigned char* rk, unsigned char* out, const unsigned char* in, size_t blocks);
+void Decrypt256(const unsigned char* rk, unsigned char* out, const unsigned char* in, size_t blocks);
+}
+
+namespace
+{
+typedef void (*Expand256Type)(unsigned char*, const unsigned char*);
+typedef void (*Crypt256Type)(const unsigned char*, unsigned char*, const unsigned char*, size_t);
+
+// Set by AESAutoDetect when AES-NI is available. Each AES256Encrypt and
+// AES256Decrypt remembers which implementation its keys were expanded for.
+Expand256Type Expand256 = nullptr;
+Expand256Type ExpandDecrypt256 = nullptr;
+Crypt256Type Encrypt256 = nullptr;
+Crypt256Type Decrypt256 = nullptr;
+
+/** Check the AES-NI implementation, if selected, against ctaes. */
+bool SelfTest()
+{
+    if (!Expand256) return true;
+
+    // FIPS-197 appendix C.3
+    static const unsigned char key[32] = {
+        0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f};
+    static const unsigned char plain[16] = {
+        0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+    static const unsigned char cipher[16] = {
+        0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89};
+
+    unsigned char rk[15 * AES_BLOCKSIZE];
+    unsigned char out[5 * AES_BLOCKSIZE];
+    unsigned char in[5 * AES_BLOCKSIZE];
+
+    Expand256(rk, key);
+    Encrypt256(rk, out, plain, 1);
+    if (memcmp(out, cipher, AES_BLOCKSIZE) != 0) return false;
+
+    // Decrypt enough blocks to cover both the interleaved and the single
+    // block paths.
+    for (int i = 0; i < 5; i++) memcpy(in + AES_BLOCKSIZE * i, cipher, AES_BLOCKSIZE);
+    ExpandDecrypt256(rk, key);
+    Decrypt256(rk, out, in, 5);
+    for (int i = 0; i < 5; i++) {
+        if (memcmp(out + AES_BLOCKSIZE * i, plain, AES_BLOCKSIZE) != 0) return false;
+    }
+
+    return true;
+}
+} // namespace
+
+std::string AESAutoDetect()
+{
+    std::string ret = "ctaes";
+#if defined(ENABLE_AESNI) && defined(HAVE_GETCPUID) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (HaveAESNI()) {
+        Expand256 = aes_aesni::Expand256;
+        ExpandDecrypt256 = aes_aesni::ExpandDecrypt256;
+        Encrypt256 = aes_aesni::Encrypt256;
+        Decrypt256 = aes_aesni::Decrypt256;
+        ret = "aesni(aes256)";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
+
 AES128Encrypt::AES128Encrypt(const unsigned char key[16])
 {
     AES128_init(&ctx, key);
@@ -43,34 +117,62 @@ void AES128Decrypt::Decrypt(unsigned char plaintext[16], const unsigned char cip
     AES128_decrypt(&ctx, 1, plaintext, ciphertext);
 }
 
-AES256Encrypt::AES256Encrypt(const unsigned char key[32])
+void AES128Decrypt::Decrypt(unsigned char* plaintext, const unsigned char* ciphertext, size_t blocks) const
+{
+    AES128_decrypt(&ctx, blocks, plaintext, ciphertext);
+}
+
+AES256Encrypt::AES256Encrypt(const unsigned char key[32]) : fAESNI(Expand256 != nullptr)
 {
-    AES256_init(&ctx, key);
+    if (fAESNI) {
+        Expand256(rk, key);
+    } else {
+        AES256_init(&ctx, key);
+    }
 }
 
 AES256Encrypt::~AES256Encrypt()
 {
     memset(&ctx, 0, sizeof(ctx));
+    memset(rk, 0, sizeof(rk));
 }
 
 void AES256Encrypt::Encrypt(unsigned char ciphertext[16], const unsigned char plaintext[16]) const
 {
-    AES256_encrypt(&ctx, 1, ciphertext, plaintext);
+    if (fAESNI) {
+        Encrypt256(rk, ciphertext, plaintext, 1);
+    } else {
+        AES256_encrypt(&ctx, 1, ciphertext, plaintext);
+    }
 }
 
-AES256Decrypt::AES256Decrypt(const unsigned char key[32])
+AES256Decrypt::AES256Decrypt(const unsigned char key[32]) : fAESNI(ExpandDecrypt256 != nullptr)
 {
-    AES256_init(&ctx, key);
+    if (fAESNI) {
+        ExpandDecrypt256(rk, key);
+    } else {
+        AES256_init(&ctx, key);
+    }
 }
 
 AES256Decrypt::~AES256Decrypt()
 {
     memset(&ctx, 0, sizeof(ctx));
+    memset(rk, 0, sizeof(rk));
 }
 
 void AES256Decrypt::Decrypt(unsigned char plaintext[16], const unsigned char ciphertext[16]) const
 {
-    AES256_decrypt(&ctx, 1, plaintext, ciphertext);
+    Decrypt(plaintext, ciphertext, 1);
+}
+
+void AES256Decrypt::Decrypt(unsigned char* plaintext, const unsigned char* ciphertext, size_t blocks) const
+{
+    if (fAESNI) {
+        Decrypt256(rk, plaintext, ciphertext, blocks);
+    } else {
+        AES256_decrypt(&ctx, blocks, plaintext, ciphertext);
+    }
 }
 
 
@@ -124,9 +226,10 @@ static int CBCDecrypt(const T& dec, const unsigned char iv[AES_BLOCKSIZE], const
     if (size % AES_BLOCKSIZE != 0)
         return 0;
 
-    // Decrypt all data. Padding will be checked in the output.
+    // Decrypt all data. Padding will be checked in the output. The blocks
+    // are decrypted together, as the chaining is only applied afterwards.
+    dec.Decrypt(out, data, size / AES_BLOCKSIZE);
     while (written != size) {
-        dec.Decrypt(out, data + written);
         for (int i = 0; i != AES_BLOCKSIZE; i++)
             *out++ ^= prev[i];
         prev = data + written;
@@ -12,6 +12,9 @@ extern "C" {
 #include "crypto/ctaes/ctaes.h"
 }
 
+#include <stddef.h>
+#include <string>
+
 static const int AES_BLOCKSIZE = 16;
 static const int AES128_KEYSIZE = 16;
 static const int AES256_KEYSIZE = 32;
@@ -38,6 +41,7 @@ public:
     AES128Decrypt(const unsigned char key[16]);
     ~AES128Decrypt();
     void Decrypt(unsigned char plaintext[16], const unsigned char ciphertext[16]) const;
+    void Decrypt(unsigned char* plaintext, const unsigned char* ciphertext, size_t blocks) const;
 };
 
 /** An encryption class for AES-256. */
@@ -45,6 +49,9 @@ class AES256Encrypt
 {
 private:
     AES256_ctx ctx;
+    /** Round keys for the AES-NI implementation, if it was selected when constructed. */
+    unsigned char rk[15 * AES_BLOCKSIZE];
+    bool fAESNI;
 
 public:
     AES256Encrypt(const unsigned char key[32]);
@@ -57,11 +64,15 @@ class AES256Decrypt
 {
 private:
     AES256_ctx ctx;
+    /** Round keys for the AES-NI implementation, if it was selected when constructed. */
+    unsigned char rk[15 * AES_BLOCKSIZE];
+    bool fAESNI;
 
 public:
     AES256Decrypt(const unsigned char key[32]);
     ~AES256Decrypt();
     void Decrypt(unsigned char plaintext[16], const unsigned char ciphertext[16]) const;
+    void Decrypt(unsigned char* plaintext, const unsigned char* ciphertext, size_t blocks) const;
 };
 
 class AES256CBCEncrypt
@@ -116,4 +127,10 @@ private:
     unsigned char iv[AES_BLOCKSIZE];
 };
 
+/** Autodetect the best available AES-256 implementation. Both ctaes and
+ *  AES-NI run in constant time.
+ *  Returns the name of the implementation.
+ */
+std::string AESAutoDetect();
+
 #endif // BITCOIN_CRYPTO_AES_H
@@ -0,0 +1,129 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+//
+// Based on the key expansion in Intel's "Advanced Encryption Standard (AES)
+// New Instructions Set" white paper, by Shay Gueron.
+
+#ifdef ENABLE_AESNI
+
+#include <stddef.h>
+#include <stdint.h>
+#include <wmmintrin.h>
+
+namespace aes_aesni {
+namespace {
+
+__m128i inline Load(const unsigned char* in) { return _mm_loadu_si128((const __m128i*)in); }
+void inline Store(unsigned char* out, __m128i x) { _mm_storeu_si128((__m128i*)out, x); }
+
+/** XOR each 32-bit word of x into all the words that follow it. */
+__m128i inline PrefixXor(__m128i x)
+{
+    x = _mm_xor_si128(x, _mm_slli_si128(x, 4));
+    x = _mm_xor_si128(x, _mm_slli_si128(x, 4));
+    return _mm_xor_si128(x, _mm_slli_si128(x, 4));
+}
+
+/** Derive the next even-numbered round key, which uses the round constant. */
+template <int rcon>
+__m128i inline NextEven(__m128i prev2, __m128i prev1)
+{
+    return _mm_xor_si128(PrefixXor(prev2), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(prev1, rcon), 0xff));
+}
+
+/** Derive the next odd-numbered round key. */
+__m128i inline NextOdd(__m128i prev2, __m128i prev1)
+{
+    return _mm_xor_si128(PrefixXor(prev2), _mm_shuffle_epi32(_mm_aeskeygenassist_si128(prev1, 0), 0xaa));
+}
+
+void inline __attribute__((always_inline)) Expand(__m128i* k, const unsigned char* key)
+{
+    k[0] = Load(key);
+    k[1] = Load(key + 16);
+    k[2] = NextEven<0x01>(k[0], k[1]);
+    k[3] = NextOdd(k[1], k[2]);
+    k[4] = NextEven<0x02>(k[2], k[3]);
+    k[5] = NextOdd(k[3], k[4]);
+    k[6] = NextEven<0x04>(k[4], k[5]);
+    k[7] = NextOdd(k[5], k[6]);
+    k[8] = NextEven<0x08>(k[6], k[7]);
+    k[9] = NextOdd(k[7], k[8]);
+    k[10] = NextEven<0x10>(k[8], k[9]);
+    k[11] = NextOdd(k[9], k[10]);
+    k[12] = NextEven<0x20>(k[10], k[11]);
+    k[13] = NextOdd(k[11], k[12]);
+    k[14] = NextEven<0x40>(k[12], k[13]);
+}
+
+}
+
+/** Expand a 32-byte key into the 15 round keys used to encrypt. */
+void Expand256(unsigned char* rk, const unsigned char* key)
+{
+    __m128i k[15];
+    Expand(k, key);
+    for (int i = 0; i < 15; i++) {
+        Store(rk + 16 * i, k[i]);
+    }
+}
+
+/** Expand a 32-byte key into the 15 round keys used to decrypt, in the order they are applied. */
+void ExpandDecrypt256(unsigned char* rk, const unsigned char* key)
+{
+    __m128i k[15];
+    Expand(k, key);
+    Store(rk, k[14]);
+    for (int i = 1; i < 14; i++) {
+        Store(rk + 16 * i, _mm_aesimc_si128(k[14 - i]));
+    }
+    Store(rk + 16 * 14, k[0]);
+}
+
+void Encrypt256(const unsigned char* rk, unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    for (; blocks > 0; blocks--, in += 16, out += 16) {
+        __m128i x = _mm_xor_si128(Load(in), Load(rk));
+        for (int r = 1; r < 14; r++) {
+            x = _mm_aesenc_si128(x, Load(rk + 16 * r));
+        }
+        Store(out, _mm_aesenclast_si128(x, Load(rk + 16 * 14)));
+    }
+}
+
+void Decrypt256(const unsigned char* rk, unsigned char* out, const unsigned char* in, size_t blocks)
+{
+    // Independent blocks are interleaved four at a time to hide the latency
+    // of the AESDEC instruction.
+    for (; blocks >= 4; blocks -= 4, in += 64, out += 64) {
+        __m128i k = Load(rk);
+        __m128i x0 = _mm_xor_si128(Load(in), k);
+        __m128i x1 = _mm_xor_si128(Load(in + 16), k);
+        __m128i x2 = _mm_xor_si128(Load(in + 32), k);
+        __m128i x3 = _mm_xor_si128(Load(in + 48), k);
+        for (int r = 1; r < 14; r++) {
+            k = Load(rk + 16 * r);
+            x0 = _mm_aesdec_si128(x0, k);
+            x1 = _mm_aesdec_si128(x1, k);
+            x2 = _mm_aesdec_si128(x2, k);
+            x3 = _mm_aesdec_si128(x3, k);
+        }
+        k = Load(rk + 16 * 14);
+        Store(out, _mm_aesdeclast_si128(x0, k));
+        Store(out + 16, _mm_aesdeclast_si128(x1, k));
+        Store(out + 32, _mm_aesdeclast_si128(x2, k));
+        Store(out + 48, _mm_aesdeclast_si128(x3, k));
+    }
+    for (; blocks > 0; blocks--, in += 16, out += 16) {
+        __m128i x = _mm_xor_si128(Load(in), Load(rk));
+        for (int r = 1; r < 14; r++) {
+            x = _mm_aesdec_si128(x, Load(rk + 16 * r));
+        }
+        Store(out, _mm_aesdeclast_si128(x, Load(rk + 16 * 14)));
+    }
+}
+
+}
+
+#endif
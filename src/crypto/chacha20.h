@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
 /** A PRNG class for ChaCha20. */
 class ChaCha20
@@ -24,4 +25,9 @@ public:
     void Output(unsigned char* output, size_t bytes);
 };
 
+/** Autodetect the best available ChaCha20 implementation.
+ *  Returns the name of the implementation.
+ */
+std::string ChaCha20AutoDetect();
+
 #endif // BITCOIN_CRYPTO_CHACHA20_H
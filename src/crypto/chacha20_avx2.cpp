@@ -0,0 +1,99 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifdef ENABLE_AVX2
+
+#include <stdint.h>
+#include <immintrin.h>
+
+namespace chacha20_avx2 {
+namespace {
+
+__m256i inline Add(__m256i x, __m256i y) { return _mm256_add_epi32(x, y); }
+__m256i inline Xor(__m256i x, __m256i y) { return _mm256_xor_si256(x, y); }
+__m256i inline RotL(__m256i x, int n) { return _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - n)); }
+__m256i inline RotL8(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14, 3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14)); }
+__m256i inline RotL16(__m256i x) { return _mm256_shuffle_epi8(x, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13, 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13)); }
+
+void inline __attribute__((always_inline)) QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+{
+    a = Add(a, b); d = RotL16(Xor(d, a));
+    c = Add(c, d); b = RotL(Xor(b, c), 12);
+    a = Add(a, b); d = RotL8(Xor(d, a));
+    c = Add(c, d); b = RotL(Xor(b, c), 7);
+}
+
+/** Write 32 bytes of each of the 8 blocks: the words held by x0..x7, one block per lane. */
+void inline __attribute__((always_inline)) Write8(unsigned char* out, __m256i x0, __m256i x1, __m256i x2, __m256i x3, __m256i x4, __m256i x5, __m256i x6, __m256i x7)
+{
+    __m256i t0 = _mm256_unpacklo_epi32(x0, x1);
+    __m256i t1 = _mm256_unpackhi_epi32(x0, x1);
+    __m256i t2 = _mm256_unpacklo_epi32(x2, x3);
+    __m256i t3 = _mm256_unpackhi_epi32(x2, x3);
+    __m256i t4 = _mm256_unpacklo_epi32(x4, x5);
+    __m256i t5 = _mm256_unpackhi_epi32(x4, x5);
+    __m256i t6 = _mm256_unpacklo_epi32(x6, x7);
+    __m256i t7 = _mm256_unpackhi_epi32(x6, x7);
+    // u[k] holds words 0..3 (low 128 bits) and 4..7 (high 128 bits) of
+    // lanes k and k + 4 respectively.
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    _mm256_storeu_si256((__m256i*)(out + 0 * 64), _mm256_permute2x128_si256(u0, u4, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 1 * 64), _mm256_permute2x128_si256(u1, u5, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 2 * 64), _mm256_permute2x128_si256(u2, u6, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 3 * 64), _mm256_permute2x128_si256(u3, u7, 0x20));
+    _mm256_storeu_si256((__m256i*)(out + 4 * 64), _mm256_permute2x128_si256(u0, u4, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 5 * 64), _mm256_permute2x128_si256(u1, u5, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 6 * 64), _mm256_permute2x128_si256(u2, u6, 0x31));
+    _mm256_storeu_si256((__m256i*)(out + 7 * 64), _mm256_permute2x128_si256(u3, u7, 0x31));
+}
+
+}
+
+/** Compute the 8 keystream blocks that follow the given state, one per lane. */
+void Output_8blocks(const uint32_t* input, unsigned char* out)
+{
+    uint64_t pos = (uint64_t)input[12] | ((uint64_t)input[13] << 32);
+    uint32_t lo[8], hi[8];
+    for (int i = 0; i < 8; i++) {
+        lo[i] = (uint32_t)(pos + i);
+        hi[i] = (uint32_t)((pos + i) >> 32);
+    }
+
+    const __m256i j0 = _mm256_set1_epi32(input[0]), j1 = _mm256_set1_epi32(input[1]);
+    const __m256i j2 = _mm256_set1_epi32(input[2]), j3 = _mm256_set1_epi32(input[3]);
+    const __m256i j4 = _mm256_set1_epi32(input[4]), j5 = _mm256_set1_epi32(input[5]);
+    const __m256i j6 = _mm256_set1_epi32(input[6]), j7 = _mm256_set1_epi32(input[7]);
+    const __m256i j8 = _mm256_set1_epi32(input[8]), j9 = _mm256_set1_epi32(input[9]);
+    const __m256i j10 = _mm256_set1_epi32(input[10]), j11 = _mm256_set1_epi32(input[11]);
+    const __m256i j12 = _mm256_loadu_si256((const __m256i*)lo), j13 = _mm256_loadu_si256((const __m256i*)hi);
+    const __m256i j14 = _mm256_set1_epi32(input[14]), j15 = _mm256_set1_epi32(input[15]);
+
+    __m256i x0 = j0, x1 = j1, x2 = j2, x3 = j3, x4 = j4, x5 = j5, x6 = j6, x7 = j7;
+    __m256i x8 = j8, x9 = j9, x10 = j10, x11 = j11, x12 = j12, x13 = j13, x14 = j14, x15 = j15;
+
+    for (int i = 20; i > 0; i -= 2) {
+        QuarterRound(x0, x4, x8, x12);
+        QuarterRound(x1, x5, x9, x13);
+        QuarterRound(x2, x6, x10, x14);
+        QuarterRound(x3, x7, x11, x15);
+        QuarterRound(x0, x5, x10, x15);
+        QuarterRound(x1, x6, x11, x12);
+        QuarterRound(x2, x7, x8, x13);
+        QuarterRound(x3, x4, x9, x14);
+    }
+
+    Write8(out, Add(x0, j0), Add(x1, j1), Add(x2, j2), Add(x3, j3), Add(x4, j4), Add(x5, j5), Add(x6, j6), Add(x7, j7));
+    Write8(out + 32, Add(x8, j8), Add(x9, j9), Add(x10, j10), Add(x11, j11), Add(x12, j12), Add(x13, j13), Add(x14, j14), Add(x15, j15));
+}
+
+}
+
+#endif
@@ -20,7 +20,9 @@
 #include "crypto/equihash.h"
 #include "util/system.h"
 
+#include <atomic>
 #include <optional>
+#include <thread>
 
 #ifdef ENABLE_MINING
 void eh_HashState::Update(const unsigned char *input, size_t inputLen)
@@ -336,6 +338,166 @@ std::shared_ptr<eh_trunc> TruncatedStepRow<WIDTH>::GetTruncatedIndices(size_t le
     return p;
 }
 
+// Lists shorter than this are hashed and sorted on one thread, as starting
+// threads would take longer than the work itself.
+static const size_t EH_MIN_ROWS_PER_THREAD = 1 << 14;
+// Number of hash outputs that a thread generates between checks for
+// cancellation.
+static const eh_index EH_HASHES_PER_CHUNK = 1 << 10;
+
+/**
+ * Runs f(0), ..., f(nThreads-1) in parallel, f(0) on the calling thread, and
+ * waits for them to finish. f must not throw.
+ */
+template<typename F>
+void EhRunInParallel(unsigned int nThreads, F f)
+{
+    std::vector<std::thread> threads;
+    for (unsigned int t = 1; t < nThreads; t++) {
+        threads.emplace_back(f, t);
+    }
+    f(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+static unsigned int EhThreadsForRows(unsigned int nThreads, size_t nRows)
+{
+    return std::max<size_t>(1, std::min<size_t>(nThreads, nRows / EH_MIN_ROWS_PER_THREAD));
+}
+
+/**
+ * Sorts rows by their first len bytes. The rows are first partitioned in
+ * place into buckets by their first byte, which moves each row at most once;
+ * the buckets are then small enough to sort in cache, and are sorted
+ * independently on up to nThreads threads.
+ */
+template<typename Row>
+void SortRows(std::vector<Row>& X, size_t len, unsigned int nThreads)
+{
+    nThreads = EhThreadsForRows(nThreads, X.size());
+    if (X.size() < EH_MIN_ROWS_PER_THREAD) {
+        std::sort(X.begin(), X.end(), CompareSR(len));
+        return;
+    }
+
+    size_t start[257] = {0};
+    for (const Row& row : X) {
+        start[row.FirstByte() + 1]++;
+    }
+    for (int b = 0; b < 256; b++) {
+        start[b + 1] += start[b];
+    }
+    size_t next[256];
+    std::copy(start, start + 256, next);
+    for (int b = 0; b < 256; b++) {
+        while (next[b] < start[b + 1]) {
+            unsigned char v = X[next[b]].FirstByte();
+            if (v == b) {
+                next[b]++;
+            } else {
+                std::swap(X[next[b]], X[next[v]++]);
+            }
+        }
+    }
+
+    std::atomic<int> nextBucket(0);
+    EhRunInParallel(nThreads, [&](unsigned int) {
+        for (int b = nextBucket++; b < 256; b = nextBucket++) {
+            std::sort(X.begin() + start[b], X.begin() + start[b + 1], CompareSR(len));
+        }
+    });
+}
+
+/**
+ * Fills X with the first nRows rows, spreading the hashing over up to
+ * nThreads threads. setRows(g) sets the rows derived from hash output g.
+ * Only the calling thread checks for cancellation; the others stop when it
+ * finds that the solver was cancelled.
+ */
+template<typename Row, typename SetRows>
+void GenerateRows(std::vector<Row>& X, eh_index nRows, eh_index indicesPerHashOutput,
+                  unsigned int nThreads, SetRows setRows,
+                  const std::function<bool(EhSolverCancelCheck)>& cancelled)
+{
+    nThreads = EhThreadsForRows(nThreads, nRows);
+    X.resize(nRows);
+    const eh_index nHashes = (nRows + indicesPerHashOutput - 1) / indicesPerHashOutput;
+    std::atomic<eh_index> nextHash(0);
+    std::atomic<bool> fCancelled(false);
+    EhRunInParallel(nThreads, [&](unsigned int t) {
+        while (!fCancelled) {
+            eh_index g = nextHash.fetch_add(EH_HASHES_PER_CHUNK);
+            if (g >= nHashes) {
+                break;
+            }
+            for (eh_index end = std::min(g + EH_HASHES_PER_CHUNK, nHashes); g < end; g++) {
+                setRows(g);
+            }
+            if (t == 0 && cancelled(ListGeneration)) {
+                fCancelled = true;
+            }
+        }
+    });
+    if (fCancelled) throw solver_cancelled;
+}
+
+/**
+ * Splits the sorted rows X into up to nThreads segments for finding
+ * collisions on their first len bytes, moving each boundary forward so that
+ * no group of colliding rows spans two segments. Segment t is
+ * [bounds[t], bounds[t+1]).
+ */
+template<typename Row>
+std::vector<size_t> CollisionSegments(std::vector<Row>& X, size_t len, unsigned int nThreads)
+{
+    nThreads = EhThreadsForRows(nThreads, X.size());
+    std::vector<size_t> bounds(nThreads + 1, 0);
+    for (unsigned int t = 1; t < nThreads; t++) {
+        size_t b = std::max(bounds[t - 1], X.size() * t / nThreads);
+        while (b > 0 && b < X.size() && HasCollision(X[b - 1], X[b], len)) {
+            b++;
+        }
+        bounds[t] = b;
+    }
+    bounds[nThreads] = X.size();
+    return bounds;
+}
+
+/**
+ * Calls collide(i, j, t) for each group X[i, i+j) of rows that collide on
+ * their first len bytes, running each segment from CollisionSegments on its
+ * own thread, where t is the group's segment. endSegment(t, end) is called
+ * on the segment's thread after its last group. Only
+ * the calling thread checks for cancellation; the others stop when it finds
+ * that the solver was cancelled.
+ */
+template<typename Row, typename Collide, typename EndSegment>
+void FindCollisions(std::vector<Row>& X, const std::vector<size_t>& bounds, size_t len,
+                    Collide collide, EndSegment endSegment,
+                    const std::function<bool(EhSolverCancelCheck)>& cancelled,
+                    EhSolverCancelCheck check)
+{
+    std::atomic<bool> fCancelled(false);
+    EhRunInParallel(bounds.size() - 1, [&](unsigned int t) {
+        size_t i = bounds[t];
+        while (i < bounds[t + 1] && !fCancelled) {
+            size_t j = 1;
+            while (i + j < bounds[t + 1] && HasCollision(X[i], X[i + j], len)) {
+                j++;
+            }
+            collide(i, j, t);
+            i += j;
+            if (t == 0 && cancelled(check)) {
+                fCancelled = true;
+            }
+        }
+        endSegment(t, i);
+    });
+    if (fCancelled) throw solver_cancelled;
+}
+
 template<unsigned int N, unsigned int K>
 bool Equihash<N,K>::BasicSolve(const eh_HashState& base_state,
                                const std::function<bool(std::vector<unsigned char>)> validBlock,
@@ -364,7 +526,7 @@ bool Equihash<N,K>::BasicSolve(const eh_HashState& base_state,
         LogPrint("pow", "Round %d:\n", r);
         // 2a) Sort the list
         LogPrint("pow", "- Sorting list\n");
-        std::sort(X.begin(), X.end(), CompareSR(CollisionByteLength));
+        SortRows(X, CollisionByteLength, 1);
         if (cancelled(ListSorting)) throw solver_cancelled;
 
         LogPrint("pow", "- Finding collisions\n");
@@ -422,7 +584,7 @@ bool Equihash<N,K>::BasicSolve(const eh_HashState& base_state,
     LogPrint("pow", "Final round:\n");
     if (X.size() > 1) {
         LogPrint("pow", "- Sorting list\n");
-        std::sort(X.begin(), X.end(), CompareSR(hashLen));
+        SortRows(X, hashLen, 1);
         if (cancelled(FinalSorting)) throw solver_cancelled;
         LogPrint("pow", "- Finding collisions\n");
         int i = 0;
@@ -510,7 +672,8 @@ void CollideBranches(std::vector<FullStepRow<WIDTH>>& X, const size_t hlen, cons
 template<unsigned int N, unsigned int K>
 bool Equihash<N,K>::OptimisedSolve(const eh_HashState& base_state,
                                    const std::function<bool(std::vector<unsigned char>)> validBlock,
-                                   const std::function<bool(EhSolverCancelCheck)> cancelled)
+                                   const std::function<bool(EhSolverCancelCheck)> cancelled,
+                                   unsigned int nThreads)
 {
     eh_index init_size { 1 << (CollisionBitLength + 1) };
     eh_index recreate_size { UntruncateIndex(1, 0, CollisionBitLength + 1) };
@@ -527,41 +690,35 @@ bool Equihash<N,K>::OptimisedSolve(const eh_HashState& base_state,
         size_t hashLen = HashLength;
         size_t lenIndices = sizeof(eh_trunc);
         std::vector<TruncatedStepRow<TruncatedWidth>> Xt;
-        Xt.reserve(init_size);
-        unsigned char tmpHash[HashOutput];
-        for (eh_index g = 0; Xt.size() < init_size; g++) {
+        GenerateRows(Xt, init_size, IndicesPerHashOutput, nThreads, [&](eh_index g) {
+            unsigned char tmpHash[HashOutput];
             GenerateHash(base_state, g, tmpHash, HashOutput);
-            for (eh_index i = 0; i < IndicesPerHashOutput && Xt.size() < init_size; i++) {
-                Xt.emplace_back(tmpHash+(i*N/8), N/8, HashLength, CollisionBitLength,
-                                (g*IndicesPerHashOutput)+i, CollisionBitLength + 1);
+            for (eh_index i = 0; i < IndicesPerHashOutput && (g*IndicesPerHashOutput)+i < init_size; i++) {
+                Xt[(g*IndicesPerHashOutput)+i] = TruncatedStepRow<TruncatedWidth>(
+                    tmpHash+(i*N/8), N/8, HashLength, CollisionBitLength,
+                    (g*IndicesPerHashOutput)+i, CollisionBitLength + 1);
             }
-            if (cancelled(ListGeneration)) throw solver_cancelled;
-        }
+        }, cancelled);
 
         // 3) Repeat step 2 until 2n/(k+1) bits remain
         for (int r = 1; r < K && Xt.size() > 0; r++) {
             LogPrint("pow", "Round %d:\n", r);
             // 2a) Sort the list
             LogPrint("pow", "- Sorting list\n");
-            std::sort(Xt.begin(), Xt.end(), CompareSR(CollisionByteLength));
+            SortRows(Xt, CollisionByteLength, nThreads);
             if (cancelled(ListSorting)) throw solver_cancelled;
 
             LogPrint("pow", "- Finding collisions\n");
-            int i = 0;
-            int posFree = 0;
-            std::vector<TruncatedStepRow<TruncatedWidth>> Xc;
-            while (i < Xt.size() - 1) {
+            // Each segment of the list stores its tuples over the rows it
+            // has already used, and keeps those that do not fit in Xc.
+            std::vector<size_t> bounds = CollisionSegments(Xt, CollisionByteLength, nThreads);
+            std::vector<size_t> posFree(bounds.begin(), bounds.end() - 1);
+            std::vector<std::vector<TruncatedStepRow<TruncatedWidth>>> Xc(posFree.size());
+            FindCollisions(Xt, bounds, CollisionByteLength, [&](size_t i, size_t j, unsigned int t) {
                 // 2b) Find next set of unordered pairs with collisions on the next n/(k+1) bits
-                int j = 1;
-                while (i+j < Xt.size() &&
-                        HasCollision(Xt[i], Xt[i+j], CollisionByteLength)) {
-                    j++;
-                }
-
                 // 2c) Calculate tuples (X_i ^ X_j, (i, j))
-                bool checking_for_zero = (i == 0 && Xt[0].IsZero(hashLen));
-                for (int l = 0; l < j - 1; l++) {
-                    for (int m = l + 1; m < j; m++) {
+                for (size_t l = 0; l < j - 1; l++) {
+                    for (size_t m = l + 1; m < j; m++) {
                         // We truncated, so don't check for distinct indices here
                         TruncatedStepRow<TruncatedWidth> Xi {Xt[i+l], Xt[i+m],
                                                              hashLen, lenIndices,
@@ -569,33 +726,44 @@ bool Equihash<N,K>::OptimisedSolve(const eh_HashState& base_state,
                         if (!(Xi.IsZero(hashLen-CollisionByteLength) &&
                               IsProbablyDuplicate<soln_size>(Xi.GetTruncatedIndices(hashLen-CollisionByteLength, 2*lenIndices),
                                                              2*lenIndices))) {
-                            Xc.emplace_back(Xi);
+                            Xc[t].emplace_back(Xi);
                         }
                     }
                 }
 
                 // 2d) Store tuples on the table in-place if possible
-                while (posFree < i+j && Xc.size() > 0) {
-                    Xt[posFree++] = Xc.back();
-                    Xc.pop_back();
+                while (posFree[t] < i+j && Xc[t].size() > 0) {
+                    Xt[posFree[t]++] = Xc[t].back();
+                    Xc[t].pop_back();
                 }
-
-                i += j;
-                if (cancelled(ListColliding)) throw solver_cancelled;
-            }
-
-            // 2e) Handle edge case where final table entry has no collision
-            while (posFree < Xt.size() && Xc.size() > 0) {
-                Xt[posFree++] = Xc.back();
-                Xc.pop_back();
+            }, [&](unsigned int t, size_t end) {
+                // 2e) Handle edge case where final table entry has no collision
+                while (posFree[t] < end && Xc[t].size() > 0) {
+                    Xt[posFree[t]++] = Xc[t].back();
+                    Xc[t].pop_back();
+                }
+            }, cancelled, ListColliding);
+
+            // Close the gaps between the segments' tuples.
+            size_t nStored = 0;
+            size_t nOverflow = 0;
+            for (size_t t = 0; t < posFree.size(); t++) {
+                if (nStored != bounds[t]) {
+                    std::move(Xt.begin() + bounds[t], Xt.begin() + posFree[t], Xt.begin() + nStored);
+                }
+                nStored += posFree[t] - bounds[t];
+                nOverflow += Xc[t].size();
             }
 
-            if (Xc.size() > 0) {
+            if (nOverflow > 0) {
                 // 2f) Add overflow to end of table
-                Xt.insert(Xt.end(), Xc.begin(), Xc.end());
-            } else if (posFree < Xt.size()) {
+                Xt.erase(Xt.begin()+nStored, Xt.end());
+                for (const auto& Xct : Xc) {
+                    Xt.insert(Xt.end(), Xct.begin(), Xct.end());
+                }
+            } else if (nStored < Xt.size()) {
                 // 2g) Remove empty space at the end
-                Xt.erase(Xt.begin()+posFree, Xt.end());
+                Xt.erase(Xt.begin()+nStored, Xt.end());
                 Xt.shrink_to_fit();
             }
 
@@ -608,30 +776,25 @@ bool Equihash<N,K>::OptimisedSolve(const eh_HashState& base_state,
         LogPrint("pow", "Final round:\n");
         if (Xt.size() > 1) {
             LogPrint("pow", "- Sorting list\n");
-            std::sort(Xt.begin(), Xt.end(), CompareSR(hashLen));
+            SortRows(Xt, hashLen, nThreads);
             if (cancelled(FinalSorting)) throw solver_cancelled;
             LogPrint("pow", "- Finding collisions\n");
-            int i = 0;
-            while (i < Xt.size() - 1) {
-                int j = 1;
-                while (i+j < Xt.size() &&
-                        HasCollision(Xt[i], Xt[i+j], hashLen)) {
-                    j++;
-                }
-
-                for (int l = 0; l < j - 1; l++) {
-                    for (int m = l + 1; m < j; m++) {
+            std::vector<size_t> bounds = CollisionSegments(Xt, hashLen, nThreads);
+            std::vector<std::vector<std::shared_ptr<eh_trunc>>> segmentSolns(bounds.size() - 1);
+            FindCollisions(Xt, bounds, hashLen, [&](size_t i, size_t j, unsigned int t) {
+                for (size_t l = 0; l < j - 1; l++) {
+                    for (size_t m = l + 1; m < j; m++) {
                         TruncatedStepRow<FinalTruncatedWidth> res(Xt[i+l], Xt[i+m],
                                                                   hashLen, lenIndices, 0);
                         auto soln = res.GetTruncatedIndices(hashLen, 2*lenIndices);
                         if (!IsProbablyDuplicate<soln_size>(soln, 2*lenIndices)) {
-                            partialSolns.push_back(soln);
+                            segmentSolns[t].push_back(soln);
                         }
                     }
                 }
-
-                i += j;
-                if (cancelled(FinalColliding)) throw solver_cancelled;
+            }, [](unsigned int, size_t) {}, cancelled, FinalColliding);
+            for (const auto& solns : segmentSolns) {
+                partialSolns.insert(partialSolns.end(), solns.begin(), solns.end());
             }
         } else
             LogPrint("pow", "- List is empty\n");
@@ -678,7 +841,7 @@ bool Equihash<N,K>::OptimisedSolve(const eh_HashState& base_state,
                         // 2c) Merge the lists
                         ic->reserve(ic->size() + X[r]->size());
                         ic->insert(ic->end(), X[r]->begin(), X[r]->end());
-                        std::sort(ic->begin(), ic->end(), CompareSR(hashLen));
+                        SortRows(*ic, hashLen, nThreads);
                         if (cancelled(PartialSorting)) throw solver_cancelled;
                         size_t lti = rti-(1<<r);
                         CollideBranches(*ic, hashLen, lenIndices,
@@ -736,7 +899,8 @@ template bool Equihash<96,3>::BasicSolve(const eh_HashState& base_state,
                                          const std::function<bool(EhSolverCancelCheck)> cancelled);
 template bool Equihash<96,3>::OptimisedSolve(const eh_HashState& base_state,
                                              const std::function<bool(std::vector<unsigned char>)> validBlock,
-                                             const std::function<bool(EhSolverCancelCheck)> cancelled);
+                                             const std::function<bool(EhSolverCancelCheck)> cancelled,
+                                             unsigned int nThreads);
 
 // Explicit instantiations for Equihash<200,9>
 template eh_HashState Equihash<200,9>::InitialiseState();
@@ -745,7 +909,8 @@ template bool Equihash<200,9>::BasicSolve(const eh_HashState& base_state,
                                           const std::function<bool(EhSolverCancelCheck)> cancelled);
 template bool Equihash<200,9>::OptimisedSolve(const eh_HashState& base_state,
                                               const std::function<bool(std::vector<unsigned char>)> validBlock,
-                                              const std::function<bool(EhSolverCancelCheck)> cancelled);
+                                              const std::function<bool(EhSolverCancelCheck)> cancelled,
+                                              unsigned int nThreads);
 
 // Explicit instantiations for Equihash<96,5>
 template eh_HashState Equihash<96,5>::InitialiseState();
@@ -754,7 +919,8 @@ template bool Equihash<96,5>::BasicSolve(const eh_HashState& base_state,
                                          const std::function<bool(EhSolverCancelCheck)> cancelled);
 template bool Equihash<96,5>::OptimisedSolve(const eh_HashState& base_state,
                                              const std::function<bool(std::vector<unsigned char>)> validBlock,
-                                             const std::function<bool(EhSolverCancelCheck)> cancelled);
+                                             const std::function<bool(EhSolverCancelCheck)> cancelled,
+                                             unsigned int nThreads);
 
 // Explicit instantiations for Equihash<48,5>
 template eh_HashState Equihash<48,5>::InitialiseState();
@@ -763,6 +929,7 @@ template bool Equihash<48,5>::BasicSolve(const eh_HashState& base_state,
                                          const std::function<bool(EhSolverCancelCheck)> cancelled);
 template bool Equihash<48,5>::OptimisedSolve(const eh_HashState& base_state,
                                              const std::function<bool(std::vector<unsigned char>)> validBlock,
-                                             const std::function<bool(EhSolverCancelCheck)> cancelled);
+                                             const std::function<bool(EhSolverCancelCheck)> cancelled,
+                                             unsigned int nThreads);
 
 #endif // ENABLE_MINING
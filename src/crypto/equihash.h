@@ -86,6 +86,8 @@ protected:
     unsigned char hash[WIDTH];
 
 public:
+    //! An uninitialised row, for lists that are filled in place.
+    StepRow() { }
     StepRow(const unsigned char* hashIn, size_t hInLen,
             size_t hLen, size_t cBitLen);
     ~StepRow() { }
@@ -94,6 +96,7 @@ public:
     StepRow(const StepRow<W>& a);
 
     bool IsZero(size_t len);
+    unsigned char FirstByte() const { return hash[0]; }
     std::string GetHex(size_t len) { return HexStr(hash, hash+len); }
 
     template<size_t W>
@@ -124,6 +127,7 @@ class FullStepRow : public StepRow<WIDTH>
     using StepRow<WIDTH>::hash;
 
 public:
+    FullStepRow() { }
     FullStepRow(const unsigned char* hashIn, size_t hInLen,
                 size_t hLen, size_t cBitLen, eh_index i);
     ~FullStepRow() { }
@@ -153,6 +157,7 @@ class TruncatedStepRow : public StepRow<WIDTH>
     using StepRow<WIDTH>::hash;
 
 public:
+    TruncatedStepRow() { }
     TruncatedStepRow(const unsigned char* hashIn, size_t hInLen,
                      size_t hLen, size_t cBitLen,
                      eh_index i, unsigned int ilen);
@@ -219,7 +224,8 @@ public:
                     const std::function<bool(EhSolverCancelCheck)> cancelled);
     bool OptimisedSolve(const eh_HashState& base_state,
                         const std::function<bool(std::vector<unsigned char>)> validBlock,
-                        const std::function<bool(EhSolverCancelCheck)> cancelled);
+                        const std::function<bool(EhSolverCancelCheck)> cancelled,
+                        unsigned int nThreads = 1);
 };
 
 #include "equihash.tcc"
@@ -267,28 +273,34 @@ inline bool EhBasicSolveUncancellable(unsigned int n, unsigned int k, const eh_H
                         [](EhSolverCancelCheck pos) { return false; });
 }
 
+/**
+ * Runs the optimised solver, hashing and sorting the lists on up to nThreads
+ * threads. validBlock and cancelled are only called on the calling thread.
+ */
 inline bool EhOptimisedSolve(unsigned int n, unsigned int k, const eh_HashState& base_state,
                     const std::function<bool(std::vector<unsigned char>)> validBlock,
-                    const std::function<bool(EhSolverCancelCheck)> cancelled)
+                    const std::function<bool(EhSolverCancelCheck)> cancelled,
+                    unsigned int nThreads = 1)
 {
     if (n == 96 && k == 3) {
-        return Eh96_3.OptimisedSolve(base_state, validBlock, cancelled);
+        return Eh96_3.OptimisedSolve(base_state, validBlock, cancelled, nThreads);
     } else if (n == 200 && k == 9) {
-        return Eh200_9.OptimisedSolve(base_state, validBlock, cancelled);
+        return Eh200_9.OptimisedSolve(base_state, validBlock, cancelled, nThreads);
     } else if (n == 96 && k == 5) {
-        return Eh96_5.OptimisedSolve(base_state, validBlock, cancelled);
+        return Eh96_5.OptimisedSolve(base_state, validBlock, cancelled, nThreads);
     } else if (n == 48 && k == 5) {
-        return Eh48_5.OptimisedSolve(base_state, validBlock, cancelled);
+        return Eh48_5.OptimisedSolve(base_state, validBlock, cancelled, nThreads);
     } else {
         throw std::invalid_argument("Unsupported Equihash parameters");
     }
 }
 
 inline bool EhOptimisedSolveUncancellable(unsigned int n, unsigned int k, const eh_HashState& base_state,
-                    const std::function<bool(std::vector<unsigned char>)> validBlock)
+                    const std::function<bool(std::vector<unsigned char>)> validBlock,
+                    unsigned int nThreads = 1)
 {
     return EhOptimisedSolve(n, k, base_state, validBlock,
-                            [](EhSolverCancelCheck pos) { return false; });
+                            [](EhSolverCancelCheck pos) { return false; }, nThreads);
 }
 #endif // ENABLE_MINING
 
@@ -6,6 +6,7 @@
 #include "crypto/hmac_sha512.h"
 
 #include <string.h>
+#include <vector>
 
 CHMAC_SHA512::CHMAC_SHA512(const unsigned char* key, size_t keylen)
 {
@@ -33,3 +34,42 @@ void CHMAC_SHA512::Finalize(unsigned char hash[OUTPUT_SIZE])
     inner.Finalize(temp);
     outer.Write(temp, 64).Finalize(hash);
 }
+
+void HMAC_SHA512Batch(
+    unsigned char* output,
+    const unsigned char* keys, size_t keylen,
+    const unsigned char* msgs, size_t msglen,
+    size_t n)
+{
+    // Keys longer than a block are replaced by their hashes.
+    std::vector<unsigned char> hashedKeys;
+    if (keylen > 128) {
+        hashedKeys.resize(n * CSHA512::OUTPUT_SIZE);
+        SHA512Batch(hashedKeys.data(), keys, keylen, n);
+        keys = hashedKeys.data();
+        keylen = CSHA512::OUTPUT_SIZE;
+    }
+
+    // inner = SHA512((key ^ ipad) || msg)
+    const size_t innerLen = 128 + msglen;
+    std::vector<unsigned char> inner(n * innerLen, 0);
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* p = inner.data() + i * innerLen;
+        memcpy(p, keys + i * keylen, keylen);
+        for (int j = 0; j < 128; j++) p[j] ^= 0x36;
+        memcpy(p + 128, msgs + i * msglen, msglen);
+    }
+    std::vector<unsigned char> innerHashes(n * CSHA512::OUTPUT_SIZE);
+    SHA512Batch(innerHashes.data(), inner.data(), innerLen, n);
+
+    // output = SHA512((key ^ opad) || inner)
+    const size_t outerLen = 128 + CSHA512::OUTPUT_SIZE;
+    std::vector<unsigned char> outer(n * outerLen, 0);
+    for (size_t i = 0; i < n; i++) {
+        unsigned char* p = outer.data() + i * outerLen;
+        memcpy(p, keys + i * keylen, keylen);
+        for (int j = 0; j < 128; j++) p[j] ^= 0x5c;
+        memcpy(p + 128, innerHashes.data() + i * CSHA512::OUTPUT_SIZE, CSHA512::OUTPUT_SIZE);
+    }
+    SHA512Batch(output, outer.data(), outerLen, n);
+}
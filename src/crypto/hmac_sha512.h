@@ -30,4 +30,14 @@ public:
     void Finalize(unsigned char hash[OUTPUT_SIZE]);
 };
 
+/** Compute HMAC-SHA512 for n pairs of a keylen-byte key and a msglen-byte
+ *  message, using SHA512Batch. Keys and messages are read consecutively from
+ *  keys and msgs, and the 64-byte results are written consecutively to output.
+ */
+void HMAC_SHA512Batch(
+    unsigned char* output,
+    const unsigned char* keys, size_t keylen,
+    const unsigned char* msgs, size_t msglen,
+    size_t n);
+
 #endif // BITCOIN_CRYPTO_HMAC_SHA512_H
@@ -5,10 +5,17 @@
 
 #include "crypto/ripemd160.h"
 
+#include "compat/cpuid.h"
 #include "crypto/common.h"
 
+#include <assert.h>
 #include <string.h>
 
+namespace ripemd160_avx2
+{
+void Transform_8way(uint32_t* s, const unsigned char* const* chunks);
+}
+
 // Internal implementation code.
 namespace
 {
@@ -236,6 +243,76 @@ void Transform(uint32_t* s, const unsigned char* chunk)
 
 } // namespace ripemd160
 
+typedef void (*Transform8WayType)(uint32_t*, const unsigned char* const*);
+
+Transform8WayType Transform_8way = nullptr;
+
+/** Hash eight messages of len bytes each with Transform_8way. */
+void Batch8Way(unsigned char* out, const unsigned char* in, size_t len)
+{
+    uint32_t init[5];
+    ripemd160::Initialize(init);
+    // The eight states are interleaved: word i of lane j is s[8 * i + j].
+    uint32_t s[40];
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 8; j++) {
+            s[8 * i + j] = init[i];
+        }
+    }
+
+    const unsigned char* chunks[8];
+    const size_t full = len / 64;
+    for (size_t b = 0; b < full; b++) {
+        for (int j = 0; j < 8; j++) {
+            chunks[j] = in + j * len + b * 64;
+        }
+        Transform_8way(s, chunks);
+    }
+
+    // The messages have the same length, so their remainders, padding and
+    // length take the same number of blocks.
+    const size_t rest = len % 64;
+    const size_t tail = rest < 56 ? 1 : 2;
+    unsigned char buf[8][128];
+    for (int j = 0; j < 8; j++) {
+        memset(buf[j], 0, sizeof(buf[j]));
+        memcpy(buf[j], in + j * len + full * 64, rest);
+        buf[j][rest] = 0x80;
+        WriteLE64(buf[j] + tail * 64 - 8, (uint64_t)len << 3);
+    }
+    for (size_t b = 0; b < tail; b++) {
+        for (int j = 0; j < 8; j++) {
+            chunks[j] = buf[j] + b * 64;
+        }
+        Transform_8way(s, chunks);
+    }
+
+    for (int j = 0; j < 8; j++) {
+        for (int i = 0; i < 5; i++) {
+            WriteLE32(out + j * 20 + i * 4, s[8 * i + j]);
+        }
+    }
+}
+
+bool SelfTest()
+{
+    // Hash messages that take one and two blocks after their full blocks.
+    for (size_t len : {0, 32, 55, 56, 150}) {
+        unsigned char in[16 * 150];
+        for (size_t i = 0; i < sizeof(in); i++) {
+            in[i] = i * 7;
+        }
+        unsigned char out[16 * 20];
+        RIPEMD160Batch(out, in, len, 16);
+        for (size_t i = 0; i < 16; i++) {
+            unsigned char hash[CRIPEMD160::OUTPUT_SIZE];
+            CRIPEMD160().Write(in + i * len, len).Finalize(hash);
+            if (memcmp(hash, out + i * 20, 20) != 0) return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 ////// RIPEMD160
@@ -291,3 +368,35 @@ CRIPEMD160& CRIPEMD160::Reset()
     ripemd160::Initialize(s);
     return *this;
 }
+
+std::string RIPEMD160AutoDetect()
+{
+    std::string ret = "standard";
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (HaveAVX2()) {
+        Transform_8way = ripemd160_avx2::Transform_8way;
+        ret += ",avx2(8way)";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
+
+void RIPEMD160Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n)
+{
+    if (Transform_8way) {
+        while (n >= 8) {
+            Batch8Way(output, input, len);
+            output += 8 * CRIPEMD160::OUTPUT_SIZE;
+            input += 8 * len;
+            n -= 8;
+        }
+    }
+    while (n) {
+        CRIPEMD160().Write(input, len).Finalize(output);
+        output += CRIPEMD160::OUTPUT_SIZE;
+        input += len;
+        n--;
+    }
+}
@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
 /** A hasher class for RIPEMD-160. */
 class CRIPEMD160
@@ -26,4 +27,16 @@ public:
     CRIPEMD160& Reset();
 };
 
+/** Autodetect the best available RIPEMD160 batch implementation.
+ *  Returns the name of the implementation.
+ */
+std::string RIPEMD160AutoDetect();
+
+/** Compute the RIPEMD160 hashes of n messages of len bytes each.
+ *  The messages are read consecutively from input, and the 20-byte hashes are
+ *  written consecutively to output. Messages are hashed several at a time
+ *  when a multi-buffer implementation is available.
+ */
+void RIPEMD160Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n);
+
 #endif // BITCOIN_CRYPTO_RIPEMD160_H
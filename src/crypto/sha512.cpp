@@ -5,10 +5,17 @@
 
 #include "crypto/sha512.h"
 
+#include "compat/cpuid.h"
 #include "crypto/common.h"
 
+#include <assert.h>
 #include <string.h>
 
+namespace sha512_avx2
+{
+void Transform_4way(uint64_t* s, const unsigned char* const* chunks);
+}
+
 // Internal implementation code.
 namespace
 {
@@ -147,6 +154,76 @@ void Transform(uint64_t* s, const unsigned char* chunk)
 
 } // namespace sha512
 
+typedef void (*Transform4WayType)(uint64_t*, const unsigned char* const*);
+
+Transform4WayType Transform_4way = nullptr;
+
+/** Hash four messages of len bytes each with Transform_4way. */
+void Batch4Way(unsigned char* out, const unsigned char* in, size_t len)
+{
+    uint64_t init[8];
+    sha512::Initialize(init);
+    // The four states are interleaved: word i of lane j is s[4 * i + j].
+    uint64_t s[32];
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 4; j++) {
+            s[4 * i + j] = init[i];
+        }
+    }
+
+    const unsigned char* chunks[4];
+    const size_t full = len / 128;
+    for (size_t b = 0; b < full; b++) {
+        for (int j = 0; j < 4; j++) {
+            chunks[j] = in + j * len + b * 128;
+        }
+        Transform_4way(s, chunks);
+    }
+
+    // The messages have the same length, so their remainders, padding and
+    // length take the same number of blocks.
+    const size_t rest = len % 128;
+    const size_t tail = rest < 112 ? 1 : 2;
+    unsigned char buf[4][256];
+    for (int j = 0; j < 4; j++) {
+        memset(buf[j], 0, sizeof(buf[j]));
+        memcpy(buf[j], in + j * len + full * 128, rest);
+        buf[j][rest] = 0x80;
+        WriteBE64(buf[j] + tail * 128 - 8, (uint64_t)len << 3);
+    }
+    for (size_t b = 0; b < tail; b++) {
+        for (int j = 0; j < 4; j++) {
+            chunks[j] = buf[j] + b * 128;
+        }
+        Transform_4way(s, chunks);
+    }
+
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 8; i++) {
+            WriteBE64(out + j * 64 + i * 8, s[4 * i + j]);
+        }
+    }
+}
+
+bool SelfTest()
+{
+    // Hash messages that take one and two blocks after their full blocks.
+    for (size_t len : {0, 111, 112, 300}) {
+        unsigned char in[8 * 300];
+        for (size_t i = 0; i < sizeof(in); i++) {
+            in[i] = i * 7;
+        }
+        unsigned char out[8 * 64];
+        SHA512Batch(out, in, len, 8);
+        for (size_t i = 0; i < 8; i++) {
+            unsigned char hash[CSHA512::OUTPUT_SIZE];
+            CSHA512().Write(in + i * len, len).Finalize(hash);
+            if (memcmp(hash, out + i * 64, 64) != 0) return false;
+        }
+    }
+    return true;
+}
+
 } // namespace
 
 
@@ -206,3 +283,35 @@ CSHA512& CSHA512::Reset()
     sha512::Initialize(s);
     return *this;
 }
+
+std::string SHA512AutoDetect()
+{
+    std::string ret = "standard";
+#if defined(ENABLE_AVX2) && defined(HAVE_GETCPUID) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (HaveAVX2()) {
+        Transform_4way = sha512_avx2::Transform_4way;
+        ret += ",avx2(4way)";
+    }
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
+
+void SHA512Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n)
+{
+    if (Transform_4way) {
+        while (n >= 4) {
+            Batch4Way(output, input, len);
+            output += 4 * CSHA512::OUTPUT_SIZE;
+            input += 4 * len;
+            n -= 4;
+        }
+    }
+    while (n) {
+        CSHA512().Write(input, len).Finalize(output);
+        output += CSHA512::OUTPUT_SIZE;
+        input += len;
+        n--;
+    }
+}
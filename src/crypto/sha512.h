@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string>
 
 /** A hasher class for SHA-512. */
 class CSHA512
@@ -26,4 +27,16 @@ public:
     CSHA512& Reset();
 };
 
+/** Autodetect the best available SHA512 batch implementation.
+ *  Returns the name of the implementation.
+ */
+std::string SHA512AutoDetect();
+
+/** Compute the SHA512 hashes of n messages of len bytes each.
+ *  The messages are read consecutively from input, and the 64-byte hashes are
+ *  written consecutively to output. Messages are hashed several at a time
+ *  when a multi-buffer implementation is available.
+ */
+void SHA512Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n);
+
 #endif // BITCOIN_CRYPTO_SHA512_H
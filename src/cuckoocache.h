@@ -11,6 +11,7 @@
 #include <cmath>
 #include <cstring>
 #include <memory>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -21,8 +22,12 @@
  *
  * 1. @ref bit_packed_atomic_flags is bit-packed atomic flags for garbage collection
  *
- * 2. @ref cache is a cache which is performant in memory usage and lookup speed. It
- * is lockfree for erase operations. Elements are lazily erased on the next insert.
+ * 2. @ref atomic_element stores a table entry so that it can be read while it is
+ * being written.
+ *
+ * 3. @ref cache is a cache which is performant in memory usage and lookup speed. It
+ * is lockfree for read and erase operations. Elements are lazily erased on the
+ * next insert.
  */
 namespace CuckooCache
 {
@@ -114,6 +119,65 @@ public:
     }
 };
 
+/** @ref atomic_element holds an Element as a sequence of 64-bit atomic words,
+ * which are read and written with `std::memory_order_relaxed`. This makes it
+ * safe to read an element while another thread writes it, at the cost of the
+ * read possibly seeing a mix of the old and new values. Reads only compare an
+ * element against a given value, so such a mix can only cause a false match
+ * if every word matches, which for the high-entropy elements of a cache is
+ * negligibly unlikely.
+ *
+ * On most platforms relaxed atomic loads and stores of 64-bit words compile to
+ * plain loads and stores, so this costs nothing over storing the Element.
+ *
+ * @tparam Element a trivially copyable type whose size is a multiple of 8
+ * bytes, and whose equality is equality of its bytes
+ */
+template <typename Element>
+class atomic_element
+{
+    static_assert(std::is_trivially_copyable<Element>::value, "atomic_element requires a trivially copyable Element");
+    static_assert(sizeof(Element) % sizeof(uint64_t) == 0, "atomic_element requires an Element made of 64-bit words");
+    static constexpr size_t WORDS = sizeof(Element) / sizeof(uint64_t);
+
+    std::array<std::atomic<uint64_t>, WORDS> words;
+
+public:
+    atomic_element()
+    {
+        for (auto& word : words)
+            word.store(0, std::memory_order_relaxed);
+    }
+
+    inline Element load() const
+    {
+        uint64_t buf[WORDS];
+        for (size_t i = 0; i < WORDS; ++i)
+            buf[i] = words[i].load(std::memory_order_relaxed);
+        Element e;
+        std::memcpy(&e, buf, sizeof(Element));
+        return e;
+    }
+
+    inline void store(const Element& e)
+    {
+        uint64_t buf[WORDS];
+        std::memcpy(buf, &e, sizeof(Element));
+        for (size_t i = 0; i < WORDS; ++i)
+            words[i].store(buf[i], std::memory_order_relaxed);
+    }
+
+    inline bool equals(const Element& e) const
+    {
+        uint64_t buf[WORDS];
+        std::memcpy(buf, &e, sizeof(Element));
+        for (size_t i = 0; i < WORDS; ++i)
+            if (words[i].load(std::memory_order_relaxed) != buf[i])
+                return false;
+        return true;
+    }
+};
+
 /** @ref cache implements a cache with properties similar to a cuckoo-set.
  *
  *  The cache is able to hold up to `(~(uint32_t)0) - 1` elements.
@@ -140,16 +204,20 @@ public:
  * User Must Guarantee:
  *
  * 1. Write requires synchronized access (e.g. a lock)
- * 2. Read requires no concurrent Write, synchronized with last insert.
- * 3. Erase requires no concurrent Write, synchronized with last insert.
- * 4. An Erase caller must release all memory before allowing a new Writer.
+ * 2. setup() and setup_bytes() require no concurrent Read or Erase.
+ *
+ * Reads and Erases may run concurrently with an insert(). The table entries
+ * are @ref atomic_element "atomic_elements", so this is well defined, but a
+ * Read may miss an element that is being inserted or moved by the insert, and
+ * an Erase may mark a slot that the insert has just reused. Both only make the
+ * cache forget an element, which is what a cache is allowed to do anyway.
  *
  *
  * Note on function names:
  *   - The name "allow_erase" is used because the real discard happens later.
  *   - The name "please_keep" is used because elements may be erased anyways on insert.
  *
- * @tparam Element should be a movable and copyable type
+ * @tparam Element should be a trivially copyable type, see @ref atomic_element
  * @tparam Hash should be a function/callable which takes a template parameter
  * hash_select and an Element and extracts a hash from it. Should return
  * high-entropy uint32_t hashes for `Hash h; h<0>(e) ... h<7>(e)`.
@@ -159,7 +227,7 @@ class cache
 {
 private:
     /** table stores all the elements */
-    std::vector<Element> table;
+    std::unique_ptr<atomic_element<Element>[]> table;
 
     /** size stores the total available slots in the hash table */
     uint32_t size;
@@ -202,6 +270,9 @@ private:
      */
     const Hash hash_function;
 
+    /** eviction_count counts the elements evicted by insert, see evictions() */
+    std::atomic<uint64_t> eviction_count;
+
     /** compute_hashes is convenience for not having to write out this
      * expression everywhere we use the hash values of an Element.
      *
@@ -302,11 +373,15 @@ private:
         // false) and move all elements in the current epoch to the old epoch
         // but do not call allow_erase on their indices.
         if (epoch_unused_count >= epoch_size) {
+            uint64_t aged = 0;
             for (uint32_t i = 0; i < size; ++i)
                 if (epoch_flags[i])
                     epoch_flags[i] = false;
-                else
+                else {
+                    aged += !collection_flags.bit_is_set(i);
                     allow_erase(i);
+                }
+            eviction_count.fetch_add(aged, std::memory_order_relaxed);
             epoch_heuristic_counter = epoch_size;
         } else
             // reset the epoch_heuristic_counter to next do a scan when worst
@@ -324,7 +399,8 @@ public:
      * call to setup or setup_bytes, otherwise operations may segfault.
      */
     cache() : table(), size(), collection_flags(0), epoch_flags(),
-    epoch_heuristic_counter(), epoch_size(), depth_limit(0), hash_function()
+    epoch_heuristic_counter(), epoch_size(), depth_limit(0), hash_function(),
+    eviction_count(0)
     {
     }
 
@@ -341,7 +417,7 @@ public:
         // depth_limit must be at least one otherwise errors can occur.
         depth_limit = static_cast<uint8_t>(std::log2(static_cast<float>(std::max((uint32_t)2, new_size))));
         size = std::max<uint32_t>(2, new_size);
-        table.resize(size);
+        table.reset(new atomic_element<Element>[size]);
         collection_flags.setup(size);
         epoch_flags.resize(size);
         // Set to 45% as described above
@@ -398,7 +474,7 @@ public:
         // Make sure we have not already inserted this element
         // If we have, make sure that it does not get deleted
         for (uint32_t loc : locs)
-            if (table[loc] == e) {
+            if (table[loc].equals(e)) {
                 please_keep(loc);
                 epoch_flags[loc] = last_epoch;
                 return;
@@ -408,7 +484,7 @@ public:
             for (uint32_t loc : locs) {
                 if (!collection_flags.bit_is_set(loc))
                     continue;
-                table[loc] = std::move(e);
+                table[loc].store(e);
                 please_keep(loc);
                 epoch_flags[loc] = last_epoch;
                 return;
@@ -428,7 +504,9 @@ public:
             * for the next iteration.
             */
             last_loc = locs[(1 + (std::find(locs.begin(), locs.end(), last_loc) - locs.begin())) & 7];
-            std::swap(table[last_loc], e);
+            Element evicted = table[last_loc].load();
+            table[last_loc].store(e);
+            e = evicted;
             // Can't std::swap a std::vector<bool>::reference and a bool&.
             bool epoch = last_epoch;
             last_epoch = epoch_flags[last_loc];
@@ -437,6 +515,17 @@ public:
             // Recompute the locs -- unfortunately happens one too many times!
             locs = compute_hashes(e);
         }
+        eviction_count.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /** evictions returns the number of elements that had not been erased
+     * when insert aged them out of the cache (allowing them to be overwritten)
+     * or dropped them because it ran out of depth. Growth of this number
+     * suggests the cache is too small. Threadsafe.
+     */
+    uint64_t evictions() const
+    {
+        return eviction_count.load(std::memory_order_relaxed);
     }
 
     /** contains iterates through the hash locations for a given element
@@ -470,7 +559,7 @@ public:
     {
         std::array<uint32_t, 8> locs = compute_hashes(e);
         for (uint32_t loc : locs)
-            if (table[loc] == e) {
+            if (table[loc].equals(e)) {
                 if (erase)
                     allow_erase(loc);
                 return true;
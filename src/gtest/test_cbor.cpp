@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include "rpc/cbor.h"
+#include "util/strencodings.h"
+
+#include <univalue.h>
+
+static std::string CBORHex(const UniValue& value)
+{
+    std::string out = EncodeCBOR(value);
+    return HexStr(out.begin(), out.end());
+}
+
+static UniValue ParseJSON(const std::string& str)
+{
+    UniValue value;
+    EXPECT_TRUE(value.read(str));
+    return value;
+}
+
+// Examples from RFC 8949, Appendix A.
+TEST(CBOR, EncodesRFCExamples) {
+    EXPECT_EQ(CBORHex(0), "00");
+    EXPECT_EQ(CBORHex(23), "17");
+    EXPECT_EQ(CBORHex(24), "1818");
+    EXPECT_EQ(CBORHex(100), "1864");
+    EXPECT_EQ(CBORHex(1000), "1903e8");
+    EXPECT_EQ(CBORHex(1000000), "1a000f4240");
+    EXPECT_EQ(CBORHex((int64_t)1000000000000), "1b000000e8d4a51000");
+    EXPECT_EQ(CBORHex(-1), "20");
+    EXPECT_EQ(CBORHex(-1000), "3903e7");
+    EXPECT_EQ(CBORHex(std::numeric_limits<int64_t>::min()), "3b7fffffffffffffff");
+    EXPECT_EQ(CBORHex(1.1), "fb3ff199999999999a");
+    EXPECT_EQ(CBORHex(false), "f4");
+    EXPECT_EQ(CBORHex(true), "f5");
+    EXPECT_EQ(CBORHex(NullUniValue), "f6");
+    EXPECT_EQ(CBORHex(""), "60");
+    EXPECT_EQ(CBORHex("a"), "6161");
+    EXPECT_EQ(CBORHex("IETF"), "6449455446");
+    EXPECT_EQ(CBORHex(UniValue(UniValue::VARR)), "80");
+    EXPECT_EQ(CBORHex(ParseJSON("[1,2,3]")), "83010203");
+    EXPECT_EQ(CBORHex(ParseJSON("{\"a\":1,\"b\":[2,3]}")), "a26161016162820203");
+}
+
+TEST(CBOR, EncodesBytes) {
+    std::vector<unsigned char> data = ParseHex("01020304");
+    std::string out;
+    EncodeCBORBytes(data.data(), data.size(), out);
+    EXPECT_EQ(HexStr(out.begin(), out.end()), "4401020304");
+}
+
+TEST(CBOR, EncodesAmountsAsFloats) {
+    // ValueFromAmount produces fixed-point numbers, which are not integers.
+    EXPECT_EQ(CBORHex(ParseJSON("[1.00000000]")), "81fb3ff0000000000000");
+}
+
+TEST(CBOR, RejectsUnrepresentableNumbers) {
+    EXPECT_THROW(EncodeCBOR(UniValue(UniValue::VNUM, "1e999")), std::runtime_error);
+    EXPECT_THROW(EncodeCBOR(UniValue(UniValue::VNUM, "abc")), std::runtime_error);
+}
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
+#include "arith_uint256.h"
 #include "consensus/validation.h"
 #include "main.h"
 #include "proof_verifier.h"
@@ -41,6 +42,30 @@ TEST(CheckBlock, VersionTooLow) {
     EXPECT_FALSE(CheckBlock(block, state, Params(), verifier, false, false, true));
 }
 
+TEST(CheckBlock, CheckBlockHeadersPoW) {
+    SelectParams(CBaseChainParams::MAIN);
+    const Consensus::Params& params = Params().GetConsensus();
+
+    CBlockHeader valid = Params().GenesisBlock().GetBlockHeader();
+    CBlockHeader badSolution = valid;
+    badSolution.nNonce = ArithToUint256(UintToArith256(valid.nNonce) + 1);
+
+    std::vector<CBlockHeader> headers {valid, badSolution, valid, badSolution, valid};
+    // Headers that are marked as checked are skipped.
+    std::vector<unsigned char> vChecked {0, 0, 0, 1, 0};
+
+    int nPrevScriptCheckThreads = nScriptCheckThreads;
+    nScriptCheckThreads = 3;
+    // Checking stops at the first header that fails, and the headers after
+    // it are not reported as checked.
+    EXPECT_FALSE(CheckBlockHeadersPoW(headers, vChecked, params));
+    EXPECT_EQ(vChecked, std::vector<unsigned char>({1, 0, 0, 1, 0}));
+
+    vChecked = {0, 1, 0, 1, 0};
+    EXPECT_TRUE(CheckBlockHeadersPoW(headers, vChecked, params));
+    EXPECT_EQ(vChecked, std::vector<unsigned char>({1, 1, 1, 1, 1}));
+    nScriptCheckThreads = nPrevScriptCheckThreads;
+}
 
 // Subclass of CTransaction which doesn't call UpdateHash when constructing
 // from a CMutableTransaction.  This enables us to create a CTransaction
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "rpc/jsonstream.h"
+
+#include <univalue.h>
+
+TEST(JSONStreamWriter, MatchesUniValue) {
+    UniValue inner(UniValue::VOBJ);
+    inner.pushKV("a", 1);
+    inner.pushKV("quote\"d", "line\nbreak");
+
+    UniValue array(UniValue::VARR);
+    array.push_back(inner);
+    array.push_back(NullUniValue);
+    array.push_back(UniValue(UniValue::VARR));
+
+    UniValue expected(UniValue::VOBJ);
+    expected.pushKV("empty", UniValue(UniValue::VOBJ));
+    expected.pushKV("array", array);
+    expected.pushKV("value", 1.5);
+
+    std::string out;
+    JSONStreamWriter writer([&](const std::string& data) { out += data; });
+    writer.BeginObject();
+    writer.Key("empty");
+    writer.BeginObject();
+    writer.EndObject();
+    writer.Key("array");
+    writer.BeginArray();
+    writer.BeginObject();
+    writer.PushKV("a", 1);
+    writer.PushKV("quote\"d", "line\nbreak");
+    writer.EndObject();
+    writer.Value(NullUniValue);
+    writer.Value(UniValue(UniValue::VARR));
+    writer.EndArray();
+    writer.PushKV("value", 1.5);
+    writer.EndObject();
+
+    EXPECT_TRUE(out.empty());
+    EXPECT_EQ(writer.BytesFlushed(), 0u);
+    writer.Flush();
+    EXPECT_EQ(out, expected.write());
+    EXPECT_EQ(writer.BytesFlushed(), out.size());
+}
+
+TEST(JSONStreamWriter, FlushesAtThreshold) {
+    std::vector<std::string> chunks;
+    JSONStreamWriter writer([&](const std::string& data) { chunks.push_back(data); }, 16);
+
+    UniValue expected(UniValue::VARR);
+    writer.BeginArray();
+    for (int i = 0; i < 100; i++) {
+        writer.Value(i);
+        expected.push_back(i);
+    }
+    writer.EndArray();
+    writer.Flush();
+
+    EXPECT_GT(chunks.size(), 1u);
+    std::string out;
+    for (const auto& chunk : chunks) {
+        // Only the final flush may be smaller than the threshold.
+        if (&chunk != &chunks.back()) {
+            EXPECT_GE(chunk.size(), 16u);
+        }
+        out += chunk;
+    }
+    EXPECT_EQ(out, expected.write());
+}
+
+TEST(JSONStreamWriter, SinkErrorsPropagate) {
+    JSONStreamWriter writer([](const std::string&) {
+        throw std::runtime_error("disconnected");
+    }, 1);
+    EXPECT_THROW(writer.BeginArray(), std::runtime_error);
+}
+
+TEST(JSONStreamWriter, CloseToCompletesDocument) {
+    std::string out;
+    JSONStreamWriter writer([&](const std::string& data) { out += data; });
+    writer.BeginObject();
+    writer.Key("result");
+    EXPECT_EQ(writer.Depth(), 1u);
+    writer.BeginArray();
+    writer.Value(1);
+    writer.BeginObject();
+    writer.Key("a");
+    writer.CloseTo(1);
+    EXPECT_EQ(writer.Depth(), 1u);
+    writer.PushKV("error", "interrupted");
+    writer.EndObject();
+    writer.Flush();
+
+    UniValue parsed;
+    ASSERT_TRUE(parsed.read(out));
+    EXPECT_EQ(out, "{\"result\":[1,{\"a\":null}],\"error\":\"interrupted\"}");
+}
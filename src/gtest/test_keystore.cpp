@@ -539,6 +539,33 @@ TEST(KeystoreTests, StoreAndRetrieveSpendingKeyInEncryptedStore) {
     ASSERT_EQ(1, addrs.count(addr2));
 }
 
+TEST(KeystoreTests, UnlockManyKeysInEncryptedStore) {
+    // Unlocking decrypts and verifies the keys in parallel; check that every
+    // key is covered.
+    TestCCryptoKeyStore keyStore;
+    uint256 r {GetRandHash()};
+    CKeyingMaterial vMasterKey (r.begin(), r.end());
+
+    std::vector<CKey> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.push_back(CKey::TestOnlyRandomKey(true));
+        ASSERT_TRUE(keyStore.AddKey(keys.back()));
+    }
+    ASSERT_TRUE(keyStore.EncryptKeys(vMasterKey));
+
+    // Unlocking with a slightly-modified vMasterKey should fail
+    CKeyingMaterial vModifiedKey (r.begin(), r.end());
+    vModifiedKey[0] += 1;
+    EXPECT_FALSE(keyStore.Unlock(vModifiedKey));
+
+    ASSERT_TRUE(keyStore.Unlock(vMasterKey));
+    for (const CKey& key : keys) {
+        CKey keyOut;
+        ASSERT_TRUE(keyStore.GetKey(key.GetPubKey().GetID(), keyOut));
+        EXPECT_EQ(key, keyOut);
+    }
+}
+
 TEST(KeystoreTests, StoreAndRetrieveUFVK) {
     SelectParams(CBaseChainParams::TESTNET);
     CBasicKeyStore keyStore;
@@ -127,3 +127,57 @@ TEST(SigHashTest, Zip244RejectsSingleWithoutCorrespondingOutput) {
             std::logic_error);
     }
 }
+
+TEST(SigHashTest, CachedSignatureHashesMatch) {
+    auto parts = DummyV5Transaction();
+    auto v5 = parts.first;
+    auto allPrevOutputs = parts.second;
+
+    auto v4 = v5;
+    v4.nVersionGroupId = SAPLING_VERSION_GROUP_ID;
+    v4.nVersion = SAPLING_TX_VERSION;
+
+    auto saplingBranchId = NetworkUpgradeInfo[Consensus::UPGRADE_SAPLING].nBranchId;
+    auto nu5BranchId = NetworkUpgradeInfo[Consensus::UPGRADE_NU5].nBranchId;
+    CScript scriptCode = allPrevOutputs[0].scriptPubKey;
+
+    std::vector<int> hashTypes {
+        SIGHASH_ALL,
+        SIGHASH_SINGLE,
+        SIGHASH_NONE,
+        SIGHASH_ANYONECANPAY | SIGHASH_ALL,
+        SIGHASH_ANYONECANPAY | SIGHASH_SINGLE,
+        SIGHASH_ANYONECANPAY | SIGHASH_NONE,
+    };
+
+    for (const auto& tx : {CTransaction(v4), CTransaction(v5)}) {
+        PrecomputedTransactionData txdata(tx, allPrevOutputs);
+        PrecomputedTransactionData cachedTxdata(tx, allPrevOutputs);
+        cachedTxdata.CacheSignatureHashes();
+
+        // Look each hash up twice, so that the second lookup hits the cache.
+        for (int round = 0; round < 2; round++) {
+            for (unsigned int nIn = 0; nIn < tx.vin.size(); nIn++) {
+                for (auto nHashType : hashTypes) {
+                    for (auto branchId : {saplingBranchId, nu5BranchId}) {
+                        auto amount = allPrevOutputs[nIn].nValue;
+                        EXPECT_EQ(
+                            SignatureHash(scriptCode, tx, nIn, nHashType, amount, branchId, cachedTxdata),
+                            SignatureHash(scriptCode, tx, nIn, nHashType, amount, branchId, txdata));
+                    }
+                }
+            }
+            for (auto branchId : {saplingBranchId, nu5BranchId}) {
+                EXPECT_EQ(
+                    SignatureHash(CScript(), tx, NOT_AN_INPUT, SIGHASH_ALL, 0, branchId, cachedTxdata),
+                    SignatureHash(CScript(), tx, NOT_AN_INPUT, SIGHASH_ALL, 0, branchId, txdata));
+            }
+            // Errors are not cached.
+            if (tx.nVersion == ZIP225_TX_VERSION) {
+                EXPECT_THROW(
+                    SignatureHash(scriptCode, tx, 0, 0x7f, 0, nu5BranchId, cachedTxdata),
+                    std::logic_error);
+            }
+        }
+    }
+}
@@ -405,6 +405,89 @@ TEST(Validation, ContextualCheckInputsDetectsOldBranchId) {
     RegtestDeactivateBlossom();
 }
 
+TEST(Validation, ContextualCheckInputsUsesScriptExecutionCache) {
+    SelectParams(CBaseChainParams::REGTEST);
+    UpdateNetworkUpgradeParameters(Consensus::UPGRADE_OVERWINTER, 10);
+    UpdateNetworkUpgradeParameters(Consensus::UPGRADE_SAPLING, 20);
+    const CChainParams& params = Params(CBaseChainParams::REGTEST);
+    const Consensus::Params& consensusParams = params.GetConsensus();
+    auto overwinterBranchId = NetworkUpgradeInfo[Consensus::UPGRADE_OVERWINTER].nBranchId;
+
+    CBasicKeyStore keystore;
+    CKey tsk = AddTestCKeyToKeyStore(keystore);
+    auto destination = tsk.GetPubKey().GetID();
+    auto scriptPubKey = GetScriptForDestination(destination);
+    auto otherScriptPubKey = GetScriptForDestination(CKey::TestOnlyRandomKey(true).GetPubKey().GetID());
+
+    CBlock block;
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    auto blockHash = block.GetHash();
+    CBlockIndex fakeIndex {block};
+    mapBlockIndex.insert(std::make_pair(blockHash, &fakeIndex));
+    chainActive.SetTip(&fakeIndex);
+
+    CAmount coinValue(5000);
+    COutPoint utxo;
+    utxo.hash = uint256S("4343434343434343434343434343434343434343434343434343434343434343");
+    utxo.n = 0;
+    CTxOut txOut(coinValue, scriptPubKey);
+    CTxOut otherTxOut(coinValue, otherScriptPubKey);
+
+    ValidationFakeCoinsViewDB fakeDB(blockHash, utxo.hash, txOut, 12);
+    CCoinsViewCache view(&fakeDB);
+    // A view in which the coin can't be spent by the transaction, so that
+    // script checks fail unless they are skipped.
+    ValidationFakeCoinsViewDB otherFakeDB(blockHash, utxo.hash, otherTxOut, 12);
+    CCoinsViewCache otherView(&otherFakeDB);
+
+    auto builder = TransactionBuilder(params, 15, std::nullopt, SaplingMerkleTree::empty_root(), &keystore);
+    builder.AddTransparentInput(utxo, scriptPubKey, coinValue);
+    builder.AddTransparentOutput(destination, 4000);
+    auto tx = builder.Build().GetTxOrThrow();
+    PrecomputedTransactionData txdata(tx, {txOut});
+    PrecomputedTransactionData otherTxdata(tx, {otherTxOut});
+
+    // Not cached yet.
+    {
+        CValidationState state;
+        EXPECT_FALSE(ContextualCheckInputs(
+            tx, state, otherView, true, BLOCK_SCRIPT_VERIFY_FLAGS, true, otherTxdata,
+            consensusParams, overwinterBranchId));
+    }
+
+    // Checking the scripts inline, as mempool acceptance does, caches the result.
+    {
+        CValidationState state;
+        EXPECT_TRUE(ContextualCheckInputs(
+            tx, state, view, true, BLOCK_SCRIPT_VERIFY_FLAGS, true, txdata,
+            consensusParams, overwinterBranchId, nullptr, true));
+    }
+
+    // Only for the same flags.
+    {
+        CValidationState state;
+        EXPECT_FALSE(ContextualCheckInputs(
+            tx, state, otherView, true, MANDATORY_SCRIPT_VERIFY_FLAGS, true, otherTxdata,
+            consensusParams, overwinterBranchId));
+    }
+
+    // With the same flags, the scripts are not run again, as when connecting
+    // a block.
+    {
+        CValidationState state;
+        std::vector<CScriptCheck> vChecks;
+        EXPECT_TRUE(ContextualCheckInputs(
+            tx, state, otherView, true, BLOCK_SCRIPT_VERIFY_FLAGS, false, otherTxdata,
+            consensusParams, overwinterBranchId, &vChecks));
+        EXPECT_TRUE(vChecks.empty());
+    }
+
+    // Tear down
+    chainActive.SetTip(NULL);
+    mapBlockIndex.erase(blockHash);
+    RegtestDeactivateSapling();
+}
+
 TEST(Validation, SetChainPoolValuesAccumulatesWhenParentIsPopulated) {
     SelectParams(CBaseChainParams::REGTEST);
     const auto chainParams = Params();
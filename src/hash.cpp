@@ -85,6 +85,15 @@ void BIP32Hash(const ChainCode &chainCode, unsigned int nChild, unsigned char he
     CHMAC_SHA512(chainCode.begin(), chainCode.size()).Write(&header, 1).Write(data, 32).Write(num, 4).Finalize(output);
 }
 
+void Hash160Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n)
+{
+    std::vector<unsigned char> vSHA256(CSHA256::OUTPUT_SIZE * n);
+    for (size_t i = 0; i < n; i++) {
+        CSHA256().Write(input + len * i, len).Finalize(vSHA256.data() + CSHA256::OUTPUT_SIZE * i);
+    }
+    RIPEMD160Batch(output, vSHA256.data(), CSHA256::OUTPUT_SIZE, n);
+}
+
 #define ROTL(x, b) (uint64_t)(((x) << (b)) | ((x) >> (64 - (b))))
 
 #define SIPROUND do { \
@@ -117,6 +117,12 @@ inline uint160 Hash160(const prevector<N, unsigned char>& vch)
     return Hash160(vch.begin(), vch.end());
 }
 
+/** Compute the 160-bit hashes of n messages of len bytes each.
+ *  The messages are read consecutively from input, and the 20-byte hashes are
+ *  written consecutively to output. The RIPEMD-160 step uses RIPEMD160Batch.
+ */
+void Hash160Batch(unsigned char* output, const unsigned char* input, size_t len, size_t n);
+
 /** A writer stream (for serialization) that computes a 256-bit hash. */
 class CHashWriter
 {
@@ -3,6 +3,8 @@
 #include "chainparams.h"
 #include "httpserver.h"
 #include "key_io.h"
+#include "rpc/cbor.h"
+#include "rpc/jsonstream.h"
 #include "rpc/protocol.h"
 #include "rpc/server.h"
 #include "random.h"
@@ -12,6 +14,7 @@
 #include "ui_interface.h"
 #include "crypto/hmac_sha256.h"
 #include <stdio.h>
+#include <algorithm>
 
 #include <boost/algorithm/string.hpp> // boost::trim
 
@@ -138,6 +141,205 @@ static bool RPCAuthorized(const std::string& strAuth)
     return multiUserAuthorized(strUserPass);
 }
 
+/**
+ * Execute a singleton request with its command's streaming handler, if it has
+ * one, sending the reply to the client in chunks as it is produced.
+ * Returns false if nothing was sent, in which case the request should be
+ * executed normally. Errors raised before any output has been sent are thrown
+ * as usual. After that, the partial result is closed off and the error is
+ * reported in the reply's "error" member, so that the client still receives
+ * a well-formed JSON-RPC reply.
+ */
+static bool HTTPReq_JSONRPCStreaming(HTTPRequest* req, const JSONRequest& jreq)
+{
+    bool fStarted = false;
+    bool fDisconnected = false;
+    JSONStreamWriter writer([&](const std::string& data) {
+        if (!fStarted) {
+            req->WriteHeader("Content-Type", "application/json");
+            req->StartChunkedReply(HTTP_OK);
+            fStarted = true;
+        }
+        if (!req->WriteReplyChunk(data)) {
+            fDisconnected = true;
+            throw std::runtime_error("client stopped reading the reply");
+        }
+    });
+
+    UniValue objError;
+    try {
+        writer.BeginObject();
+        writer.Key("result");
+        if (!tableRPC.executeStreaming(jreq.strMethod, jreq.params, writer)) {
+            assert(!fStarted);
+            return false;
+        }
+    } catch (const UniValue& e) {
+        if (!fStarted) {
+            throw;
+        }
+        objError = e;
+    } catch (const std::exception& e) {
+        if (!fStarted) {
+            throw;
+        }
+        objError = JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+
+    if (fDisconnected) {
+        LogPrintf("%s: %s reply abandoned after %u bytes: client stopped reading the reply\n",
+            __func__, jreq.strMethod, writer.BytesFlushed());
+        req->EndChunkedReply();
+        return true;
+    }
+    if (!objError.isNull()) {
+        LogPrintf("%s: %s failed after %u bytes of the reply were sent: %s\n",
+            __func__, jreq.strMethod, writer.BytesFlushed(), find_value(objError, "message").getValStr());
+        writer.CloseTo(1);
+    }
+    try {
+        writer.PushKV("error", objError);
+        writer.PushKV("id", jreq.id);
+        writer.EndObject();
+        writer.Flush();
+        req->WriteReplyChunk("\n");
+    } catch (const std::exception& e) {
+        LogPrintf("%s: %s reply abandoned after %u bytes: %s\n",
+            __func__, jreq.strMethod, writer.BytesFlushed(), e.what());
+    }
+    req->EndChunkedReply();
+    return true;
+}
+
+/** Encodings of a singleton reply that a client may select with the Accept header */
+enum class RPCReplyEncoding {
+    JSON,
+    /** The JSON-RPC reply object encoded as CBOR */
+    CBOR,
+    /** The raw serialized result alone, for commands with binary results */
+    RAW,
+};
+
+/**
+ * Rank the reply encodings that the client accepts, most preferred first,
+ * from the media ranges and quality values in its Accept header. A range
+ * that names a type overrides wildcards, and on equal quality an explicitly
+ * named type is preferred. JSON is always included, as the last resort.
+ */
+static std::vector<RPCReplyEncoding> GetReplyEncodings(HTTPRequest* req)
+{
+    static const std::pair<RPCReplyEncoding, std::string> mediaTypes[] = {
+        {RPCReplyEncoding::JSON, "application/json"},
+        {RPCReplyEncoding::CBOR, "application/cbor"},
+        {RPCReplyEncoding::RAW, "application/octet-stream"},
+    };
+    static const size_t nTypes = ARRAYLEN(mediaTypes);
+
+    std::pair<bool, std::string> accept = req->GetHeader("Accept");
+    if (!accept.first) {
+        return {RPCReplyEncoding::JSON};
+    }
+
+    // The quality of each type, and how specifically the range that set it
+    // matched: 2 for the type itself, 1 for application/*, 0 for */*.
+    double quality[nTypes];
+    int specificity[nTypes];
+    std::fill(quality, quality + nTypes, 0.0);
+    std::fill(specificity, specificity + nTypes, -1);
+
+    std::vector<std::string> ranges;
+    boost::split(ranges, accept.second, boost::is_any_of(","));
+    for (const std::string& range : ranges) {
+        std::vector<std::string> params;
+        boost::split(params, range, boost::is_any_of(";"));
+        std::string type = boost::to_lower_copy(boost::trim_copy(params[0]));
+
+        double q = 1;
+        for (size_t i = 1; i < params.size(); i++) {
+            std::string param = boost::trim_copy(params[i]);
+            if (boost::istarts_with(param, "q=")) {
+                if (!ParseDouble(param.substr(2), &q) || q < 0 || q > 1)
+                    q = 0;
+            }
+        }
+
+        for (size_t i = 0; i < nTypes; i++) {
+            int nSpecificity;
+            if (type == mediaTypes[i].second) {
+                nSpecificity = 2;
+            } else if (type == "application/*") {
+                nSpecificity = 1;
+            } else if (type == "*/*") {
+                nSpecificity = 0;
+            } else {
+                continue;
+            }
+            if (nSpecificity > specificity[i]) {
+                specificity[i] = nSpecificity;
+                quality[i] = q;
+            }
+        }
+    }
+
+    std::vector<size_t> vOrder;
+    for (size_t i = 0; i < nTypes; i++) {
+        if (quality[i] > 0)
+            vOrder.push_back(i);
+    }
+    std::stable_sort(vOrder.begin(), vOrder.end(), [&](size_t a, size_t b) {
+        if (quality[a] != quality[b])
+            return quality[a] > quality[b];
+        return specificity[a] > specificity[b];
+    });
+
+    std::vector<RPCReplyEncoding> encodings;
+    for (size_t i : vOrder) {
+        encodings.push_back(mediaTypes[i].first);
+    }
+    if (std::find(encodings.begin(), encodings.end(), RPCReplyEncoding::JSON) == encodings.end()) {
+        encodings.push_back(RPCReplyEncoding::JSON);
+    }
+    return encodings;
+}
+
+/**
+ * Send a successful singleton reply in a binary encoding, with the raw
+ * serialized result if the method produced one. Returns false if the result
+ * cannot be sent in that encoding, and nothing has been sent.
+ */
+static bool WriteBinaryReply(HTTPRequest* req, const JSONRequest& jreq, const std::vector<unsigned char>* rawResult, const UniValue& result, RPCReplyEncoding encoding)
+{
+    if (encoding == RPCReplyEncoding::RAW) {
+        if (rawResult == nullptr)
+            return false;
+        req->WriteHeader("Content-Type", "application/octet-stream");
+        req->WriteReply(HTTP_OK, std::string(rawResult->begin(), rawResult->end()));
+        return true;
+    }
+
+    // The same map as JSONRPCReplyObj, but with binary results as byte strings.
+    std::string strReply;
+    try {
+        strReply.push_back('\xa3'); // map of three pairs
+        EncodeCBORText("result", strReply);
+        if (rawResult != nullptr) {
+            EncodeCBORBytes(rawResult->data(), rawResult->size(), strReply);
+        } else {
+            EncodeCBOR(result, strReply);
+        }
+        EncodeCBORText("error", strReply);
+        EncodeCBOR(NullUniValue, strReply);
+        EncodeCBORText("id", strReply);
+        EncodeCBOR(jreq.id, strReply);
+    } catch (const std::runtime_error& e) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, e.what());
+    }
+
+    req->WriteHeader("Content-Type", "application/cbor");
+    req->WriteReply(HTTP_OK, strReply);
+    return true;
+}
+
 static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
 {
     // JSONRPC handles only POST
@@ -178,14 +380,35 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const std::string &)
         if (valRequest.isObject()) {
             jreq.parse(valRequest);
 
-            UniValue result = tableRPC.execute(jreq.strMethod, jreq.params);
+            std::vector<RPCReplyEncoding> encodings = GetReplyEncodings(req);
+            UniValue result;
+            if (encodings[0] == RPCReplyEncoding::JSON) {
+                if (HTTPReq_JSONRPCStreaming(req, jreq)) {
+                    return true;
+                }
+                result = tableRPC.execute(jreq.strMethod, jreq.params);
+            } else {
+                std::vector<unsigned char> rawResult;
+                bool fRaw = tableRPC.executeBinary(jreq.strMethod, jreq.params, rawResult, result);
+
+                // Use the most preferred encoding that can represent the result.
+                for (RPCReplyEncoding encoding : encodings) {
+                    if (encoding == RPCReplyEncoding::JSON)
+                        break;
+                    if (WriteBinaryReply(req, jreq, fRaw ? &rawResult : nullptr, result, encoding))
+                        return true;
+                }
+                if (fRaw) {
+                    result = HexStr(rawResult);
+                }
+            }
 
             // Send reply
             strReply = JSONRPCReply(result, NullUniValue, jreq.id);
 
         // array of requests
         } else if (valRequest.isArray())
-            strReply = JSONRPCExecBatch(valRequest.get_array());
+            strReply = JSONRPCExecBatch(valRequest.get_array(), EnqueueHTTPWork, std::max<size_t>(HTTPWorkerThreadCount(), 1) - 1);
         else
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
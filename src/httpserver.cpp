@@ -4,6 +4,7 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php .
 
 #include "httpserver.h"
+#include "httpworkqueue.h"
 
 #include "chainparamsbase.h"
 #include "compat.h"
@@ -12,8 +13,10 @@
 #include "rpc/protocol.h" // For HTTP status codes
 #include "sync.h"
 #include "ui_interface.h"
+#include "util/time.h"
 
 #include <deque>
+#include <map>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -21,7 +24,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <signal.h>
+#include <condition_variable>
 #include <future>
+#include <mutex>
 
 #include <event2/event.h>
 #include <event2/http.h>
@@ -31,6 +36,8 @@
 #include <event2/util.h>
 #include <event2/keyvalq_struct.h>
 
+#include <rust/metrics.h>
+
 #ifdef EVENT__HAVE_NETINET_IN_H
 #include <netinet/in.h>
 #ifdef _XOPEN_SOURCE_EXTENDED
@@ -40,6 +47,8 @@
 
 /** Maximum size of http request (request line + headers) */
 static const size_t MAX_HEADERS_SIZE = 8192;
+/** How often requests that have waited too long in the work queue are rejected, in milliseconds */
+static const int HTTP_WORKQUEUE_EXPIRE_INTERVAL = 100;
 
 /** HTTP request work item */
 class HTTPWorkItem : public HTTPClosure
@@ -53,6 +62,14 @@ public:
     {
         func(req.get(), path);
     }
+    void Reject()
+    {
+        req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
+    }
+    void RejectExpired()
+    {
+        req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Request waited too long in the work queue");
+    }
 
     std::unique_ptr<HTTPRequest> req;
 
@@ -61,67 +78,6 @@ private:
     HTTPRequestHandler func;
 };
 
-/** Simple work queue for distributing work over multiple threads.
- * Work items are simply callable objects.
- */
-template <typename WorkItem>
-class WorkQueue
-{
-private:
-    /** Mutex protects entire object */
-    Mutex cs;
-    std::condition_variable cond;
-    std::deque<std::unique_ptr<WorkItem>> queue;
-    bool running;
-    size_t maxDepth;
-
-public:
-    WorkQueue(size_t maxDepth) : running(true),
-                                 maxDepth(maxDepth)
-    {
-    }
-    /** Precondition: worker threads have all stopped (they have been joined).
-     */
-    ~WorkQueue()
-    {
-    }
-    /** Enqueue a work item */
-    bool Enqueue(WorkItem* item)
-    {
-        LOCK(cs);
-        if (queue.size() >= maxDepth) {
-            return false;
-        }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
-        cond.notify_one();
-        return true;
-    }
-    /** Thread function */
-    void Run()
-    {
-        while (true) {
-            std::unique_ptr<WorkItem> i;
-            {
-                WAIT_LOCK(cs, lock);
-                while (running && queue.empty())
-                    cond.wait(lock);
-                if (!running)
-                    break;
-                i = std::move(queue.front());
-                queue.pop_front();
-            }
-            (*i)();
-        }
-    }
-    /** Interrupt and exit loops */
-    void Interrupt()
-    {
-        LOCK(cs);
-        running = false;
-        cond.notify_all();
-    }
-};
-
 struct HTTPPathHandler
 {
     HTTPPathHandler() {}
@@ -144,6 +100,8 @@ struct evhttp* eventHTTP = 0;
 static std::vector<CSubNet> rpc_allow_subnets;
 //! Work queue for handling longer requests off the event loop thread
 static WorkQueue<HTTPClosure>* workQueue = 0;
+//! Timer that rejects requests that have waited too long in the work queue
+static HTTPEvent* workQueueExpiry = 0;
 //! Handlers for (sub)paths
 std::vector<HTTPPathHandler> pathHandlers;
 //! Bound listening sockets
@@ -258,20 +216,45 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
+        MetricsIncrementCounter("zcash.rpc.http.requests");
+        std::string client = hreq->GetPeer().ToStringIP();
         std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
         assert(workQueue);
-        if (workQueue->Enqueue(item.get()))
+        if (workQueue->Enqueue(item.get(), client, true))
         {
             item.release(); /* if true, queue took ownership */
         } else {
             LogPrintf("WARNING: request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting\n");
-            item->req->WriteReply(HTTP_INTERNAL, "Work queue depth exceeded");
+            MetricsIncrementCounter("zcash.rpc.http.rejected", "reason", "full");
+            item->Reject();
         }
     } else {
         hreq->WriteReply(HTTP_NOTFOUND);
     }
 }
 
+/** Called by libevent for each new connection; counting them shows how often
+ * clients reuse their connections. Returning NULL lets libevent create the
+ * connection's bufferevent as usual.
+ */
+static struct bufferevent* http_new_connection_cb(struct event_base*, void*)
+{
+    MetricsIncrementCounter("zcash.rpc.http.connections");
+    return nullptr;
+}
+
+/** Reject the requests that have waited too long in the work queue. Runs in the main http thread. */
+static void http_expire_work()
+{
+    for (auto& item : workQueue->Expire()) {
+        LogPrint("http", "Rejecting request that waited too long in the work queue\n");
+        MetricsIncrementCounter("zcash.rpc.http.rejected", "reason", "timeout");
+        item->RejectExpired();
+    }
+    struct timeval tv = {0, HTTP_WORKQUEUE_EXPIRE_INTERVAL * 1000};
+    workQueueExpiry->trigger(&tv);
+}
+
 /** Callback to reject HTTP requests after shutdown. */
 static void http_reject_request_cb(struct evhttp_request* req, void*)
 {
@@ -398,6 +381,7 @@ bool InitHTTPServer()
     evhttp_set_max_headers_size(http, MAX_HEADERS_SIZE);
     evhttp_set_max_body_size(http, MAX_SIZE);
     evhttp_set_gencb(http, http_request_cb, NULL);
+    evhttp_set_bevcb(http, http_new_connection_cb, NULL);
 
     if (!HTTPBindAddresses(http)) {
         LogPrintf("Unable to bind any endpoint for RPC server\n");
@@ -408,11 +392,17 @@ bool InitHTTPServer()
 
     LogPrint("http", "Initialized HTTP server\n");
     int workQueueDepth = std::max((long)GetArg("-rpcworkqueue", DEFAULT_HTTP_WORKQUEUE), 1L);
-    LogPrintf("HTTP: creating work queue of depth %d\n", workQueueDepth);
+    int64_t workQueueWait = std::max(GetArg("-rpcworkqueuewait", DEFAULT_HTTP_WORKQUEUE_WAIT), (int64_t)0);
+    LogPrintf("HTTP: creating work queue of depth %d, overflow wait %dms\n", workQueueDepth, workQueueWait);
 
-    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth);
+    workQueue = new WorkQueue<HTTPClosure>(workQueueDepth, workQueueWait * 1000);
     eventBase = base;
     eventHTTP = http;
+    if (workQueueWait > 0) {
+        workQueueExpiry = new HTTPEvent(eventBase, false, http_expire_work);
+        struct timeval tv = {0, HTTP_WORKQUEUE_EXPIRE_INTERVAL * 1000};
+        workQueueExpiry->trigger(&tv);
+    }
     return true;
 }
 
@@ -453,6 +443,23 @@ void InterruptHTTPServer()
 void StopHTTPServer()
 {
     LogPrint("http", "Stopping HTTP server\n");
+    if (workQueueExpiry) {
+        // The timer runs in the main http thread, so remove it there before
+        // the work queue is deleted.
+        if (threadResult.valid() && threadResult.wait_for(std::chrono::seconds(0)) == std::future_status::timeout) {
+            std::promise<void> removed;
+            HTTPEvent* ev = new HTTPEvent(eventBase, true, [&removed] {
+                delete workQueueExpiry;
+                workQueueExpiry = 0;
+                removed.set_value();
+            });
+            ev->trigger(0);
+            removed.get_future().wait();
+        } else {
+            delete workQueueExpiry;
+            workQueueExpiry = 0;
+        }
+    }
     if (workQueue) {
         LogPrint("http", "Waiting for HTTP worker threads to exit\n");
         for (auto& thread: g_thread_http_workers) {
@@ -519,13 +526,75 @@ void HTTPEvent::trigger(struct timeval* tv)
     else
         evtimer_add(ev, tv); // trigger after timeval passed
 }
+/** Maximum amount of a chunked reply that may be waiting to be sent to the client */
+static const size_t MAX_CHUNKED_REPLY_PENDING = 4 * 1024 * 1024;
+
+/**
+ * Flow control for a chunked reply. Worker threads wait on this while too
+ * much of the reply is queued in the main http thread or in libevent.
+ */
+struct ChunkedReplyState
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    // Bytes passed to the main thread that have not yet been written to the socket.
+    size_t nPending = 0;
+    // Set once the connection has closed.
+    bool fClosed = false;
+    // Bytes handed to libevent since its output buffer was last drained.
+    // Only accessed from the main http thread.
+    size_t nUnflushed = 0;
+};
+
+/** Called by libevent in the main http thread when the connection's output buffer is drained. */
+static void http_chunk_flushed_cb(struct evhttp_connection*, void* arg)
+{
+    ChunkedReplyState* state = (ChunkedReplyState*)arg;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->nPending -= std::min(state->nPending, state->nUnflushed);
+    }
+    state->nUnflushed = 0;
+    state->cond.notify_all();
+}
+
+/** Called by libevent in the main http thread when the connection of a chunked reply closes. */
+static void http_chunked_close_cb(struct evhttp_connection*, void* arg)
+{
+    ChunkedReplyState* state = (ChunkedReplyState*)arg;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->fClosed = true;
+    }
+    state->cond.notify_all();
+}
+
+/** Re-enable reading from the socket. This is the second part of the libevent
+ * workaround in http_request_cb.
+ */
+static void http_reenable_read(struct evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 HTTPRequest::HTTPRequest(struct evhttp_request* req) : req(req),
                                                        replySent(false)
 {
 }
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (!replySent && chunkedReply) {
+        // A chunked reply was abandoned; end it so the request is released.
+        EndChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogPrintf("%s: Unhandled request\n", __func__);
         WriteReply(HTTP_INTERNAL, "Unhandled request");
@@ -586,17 +655,94 @@ void HTTPRequest::WriteReply(int nStatus, const std::string& strReply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02020001) {
-            evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
+        http_reenable_read(req_copy);
+    });
+    ev->trigger(0);
+    replySent = true;
+    req = 0; // transferred back to main thread
+}
+
+/*
+ * The chunked reply methods below each send an event to the main http thread,
+ * which handles them in the order they were triggered.
+ *
+ * If the client disconnects, libevent detaches the request from its connection
+ * but does not free it until the reply is ended, so the request remains valid
+ * until EndChunkedReply's event has run.
+ */
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !chunkedReply && req);
+    chunkedReply = std::make_shared<ChunkedReplyState>();
+    auto req_copy = req;
+    auto state = chunkedReply;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, nStatus]{
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, http_chunked_close_cb, state.get());
+        } else {
+            http_chunked_close_cb(nullptr, state.get());
         }
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(0);
+}
+
+bool HTTPRequest::WriteReplyChunk(const std::string& strChunk)
+{
+    assert(!replySent && chunkedReply && req);
+    auto state = chunkedReply;
+    {
+        // Wait for the client to catch up. libevent closes the connection if
+        // it stops reading for longer than the server timeout; the extra
+        // timeout here only guards against a missed notification.
+        std::unique_lock<std::mutex> lock(state->mutex);
+        auto timeout = std::chrono::seconds(2 * GetArg("-rpcservertimeout", DEFAULT_HTTP_SERVER_TIMEOUT));
+        if (!state->cond.wait_for(lock, timeout, [&]{
+                return state->fClosed || state->nPending < MAX_CHUNKED_REPLY_PENDING; })) {
+            state->fClosed = true;
+        }
+        if (state->fClosed) {
+            return false;
+        }
+        state->nPending += strChunk.size();
+    }
+
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, strChunk.data(), strChunk.size());
+    auto req_copy = req;
+    size_t nSize = strChunk.size();
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state, evb, nSize]{
+        bool fClosed;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            fClosed = state->fClosed;
+        }
+        if (!fClosed) {
+            state->nUnflushed += nSize;
+            evhttp_send_reply_chunk_with_cb(req_copy, evb, http_chunk_flushed_cb, state.get());
+        }
+        evbuffer_free(evb);
+    });
+    ev->trigger(0);
+    return true;
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(!replySent && chunkedReply && req);
+    auto req_copy = req;
+    auto state = chunkedReply;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, state]{
+        // The connection may be reused for another request, which must not
+        // call back into this reply's state.
+        evhttp_connection* conn = evhttp_request_get_connection(req_copy);
+        if (conn) {
+            evhttp_connection_set_closecb(conn, nullptr, nullptr);
+        }
+        evhttp_send_reply_end(req_copy);
+        http_reenable_read(req_copy);
     });
     ev->trigger(0);
     replySent = true;
@@ -662,3 +808,33 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch)
         pathHandlers.erase(i);
     }
 }
+
+/** Work item that runs an arbitrary function */
+class HTTPFunctionWorkItem : public HTTPClosure
+{
+public:
+    explicit HTTPFunctionWorkItem(const std::function<void()>& func) : func(func) {}
+    void operator()() override
+    {
+        func();
+    }
+
+private:
+    std::function<void()> func;
+};
+
+bool EnqueueHTTPWork(const std::function<void()>& func)
+{
+    if (!workQueue)
+        return false;
+    std::unique_ptr<HTTPFunctionWorkItem> item(new HTTPFunctionWorkItem(func));
+    if (!workQueue->Enqueue(item.get()))
+        return false;
+    item.release(); /* queue took ownership */
+    return true;
+}
+
+size_t HTTPWorkerThreadCount()
+{
+    return g_thread_http_workers.size();
+}
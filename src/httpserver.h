@@ -9,9 +9,11 @@
 #include <string>
 #include <stdint.h>
 #include <functional>
+#include <memory>
 
 static const int DEFAULT_HTTP_THREADS=4;
 static const int DEFAULT_HTTP_WORKQUEUE=16;
+static const int DEFAULT_HTTP_WORKQUEUE_WAIT=1000;
 static const int DEFAULT_HTTP_SERVER_TIMEOUT=30;
 
 struct evhttp_request;
@@ -43,6 +45,14 @@ void RegisterHTTPHandler(const std::string &prefix, bool exactMatch, const HTTPR
 /** Unregister handler for prefix */
 void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
 
+/** Run a function on an HTTP worker thread. Returns false if the work queue
+ * is full or the server is not running, in which case func is not called.
+ */
+bool EnqueueHTTPWork(const std::function<void()>& func);
+
+/** Number of HTTP worker threads */
+size_t HTTPWorkerThreadCount();
+
 /** Return evhttp event base. This can be used by submodules to
  * queue timers or custom events.
  */
@@ -55,6 +65,8 @@ class HTTPRequest
 {
 private:
     struct evhttp_request* req;
+    // Set while a chunked reply is being sent
+    std::shared_ptr<struct ChunkedReplyState> chunkedReply;
 
     // For test access
 protected:
@@ -114,6 +126,30 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     virtual void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Start a chunked HTTP reply with status nStatus. The body is then sent
+     * with WriteReplyChunk, and the reply completed with EndChunkedReply, so
+     * that a large reply can be sent while it is being produced.
+     *
+     * @note Write headers before calling this. Use either this or WriteReply,
+     * not both.
+     */
+    virtual void StartChunkedReply(int nStatus);
+
+    /**
+     * Send the next part of a chunked reply. This blocks while too much of
+     * the reply is still waiting to be sent to the client.
+     * Returns false if the client has disconnected or stopped reading, in
+     * which case stop producing the reply and call EndChunkedReply.
+     */
+    virtual bool WriteReplyChunk(const std::string& strChunk);
+
+    /**
+     * Complete a chunked reply. As with WriteReply, this gives the request
+     * back to the main thread.
+     */
+    virtual void EndChunkedReply();
 };
 
 /** Event handler closure.
@@ -122,6 +158,14 @@ class HTTPClosure
 {
 public:
     virtual void operator()() = 0;
+    /** Called instead of operator() if the closure can't be run because the
+     * work queue is full.
+     */
+    virtual void Reject() {}
+    /** Called instead of operator() if the closure waited too long in the
+     * work queue.
+     */
+    virtual void RejectExpired() { Reject(); }
     virtual ~HTTPClosure() {}
 };
 
@@ -0,0 +1,168 @@
+// Copyright (c) 2015 The Bitcoin Core developers
+// Copyright (c) 2017-2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef ZCASH_HTTPWORKQUEUE_H
+#define ZCASH_HTTPWORKQUEUE_H
+
+#include "sync.h"
+#include "util/time.h"
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <rust/metrics.h>
+
+/** Work queue for distributing work over multiple threads.
+ * Work items are simply callable objects.
+ *
+ * Each item belongs to a client, and the threads take items from the clients
+ * in turn, so that a client with many queued requests doesn't delay the
+ * others. Up to maxDepth items are accepted unconditionally. Beyond that, if
+ * maxWait is set, the same number again may wait for up to maxWait
+ * microseconds for a thread. Items that wait longer are rejected with their
+ * RejectExpired method, either by a thread that takes them or by Expire.
+ */
+template <typename WorkItem>
+class WorkQueue
+{
+private:
+    struct Entry
+    {
+        std::unique_ptr<WorkItem> item;
+        int64_t nEnqueued;
+        int64_t nDeadline; // 0 if the item may wait indefinitely
+    };
+
+    /** Mutex protects entire object */
+    Mutex cs;
+    std::condition_variable cond;
+    std::map<std::string, std::deque<Entry>> clients;
+    //! Clients with queued items, in the order they are served
+    std::deque<std::string> ready;
+    size_t depth;
+    bool running;
+    size_t maxDepth;
+    int64_t maxWait;
+
+    void UpdateDepthGauge()
+    {
+        MetricsGauge("zcash.rpc.http.queue.depth", (double)depth);
+    }
+
+public:
+    WorkQueue(size_t maxDepth, int64_t maxWait) : depth(0),
+                                                  running(true),
+                                                  maxDepth(maxDepth),
+                                                  maxWait(maxWait)
+    {
+    }
+    /** Precondition: worker threads have all stopped (they have been joined).
+     */
+    ~WorkQueue()
+    {
+    }
+    /** Enqueue a work item. If fMayWait is false, the item is only accepted
+     * if the queue has not reached its depth.
+     */
+    bool Enqueue(WorkItem* item, const std::string& client = "", bool fMayWait = false)
+    {
+        LOCK(cs);
+        int64_t nNow = GetTimeMicros();
+        int64_t nDeadline = 0;
+        if (depth >= maxDepth) {
+            if (!fMayWait || maxWait <= 0 || depth >= 2 * maxDepth) {
+                return false;
+            }
+            nDeadline = nNow + maxWait;
+            MetricsIncrementCounter("zcash.rpc.http.queue.overflowed");
+        }
+        std::deque<Entry>& clientQueue = clients[client];
+        if (clientQueue.empty()) {
+            ready.push_back(client);
+        }
+        clientQueue.push_back(Entry{std::unique_ptr<WorkItem>(item), nNow, nDeadline});
+        depth++;
+        UpdateDepthGauge();
+        cond.notify_one();
+        return true;
+    }
+    /** Remove the items that have waited past their deadline, and return them. */
+    std::vector<std::unique_ptr<WorkItem>> Expire()
+    {
+        LOCK(cs);
+        std::vector<std::unique_ptr<WorkItem>> expired;
+        int64_t nNow = GetTimeMicros();
+        for (auto it = ready.begin(); it != ready.end(); ) {
+            std::deque<Entry>& clientQueue = clients[*it];
+            for (auto entry = clientQueue.begin(); entry != clientQueue.end(); ) {
+                if (entry->nDeadline != 0 && entry->nDeadline <= nNow) {
+                    expired.push_back(std::move(entry->item));
+                    entry = clientQueue.erase(entry);
+                } else {
+                    ++entry;
+                }
+            }
+            if (clientQueue.empty()) {
+                clients.erase(*it);
+                it = ready.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        if (!expired.empty()) {
+            depth -= expired.size();
+            UpdateDepthGauge();
+        }
+        return expired;
+    }
+    /** Thread function */
+    void Run()
+    {
+        while (true) {
+            Entry entry;
+            {
+                WAIT_LOCK(cs, lock);
+                while (running && ready.empty())
+                    cond.wait(lock);
+                if (!running)
+                    break;
+                std::string client = ready.front();
+                ready.pop_front();
+                std::deque<Entry>& clientQueue = clients[client];
+                entry = std::move(clientQueue.front());
+                clientQueue.pop_front();
+                if (clientQueue.empty()) {
+                    clients.erase(client);
+                } else {
+                    ready.push_back(client);
+                }
+                depth--;
+                UpdateDepthGauge();
+            }
+            int64_t nStart = GetTimeMicros();
+            if (entry.nDeadline != 0 && entry.nDeadline < nStart) {
+                MetricsIncrementCounter("zcash.rpc.http.rejected", "reason", "timeout");
+                entry.item->RejectExpired();
+                continue;
+            }
+            MetricsHistogram("zcash.rpc.http.queued.seconds", (nStart - entry.nEnqueued) * 0.000001);
+            (*entry.item)();
+            MetricsHistogram("zcash.rpc.http.service.seconds", (GetTimeMicros() - nStart) * 0.000001);
+        }
+    }
+    /** Interrupt and exit loops */
+    void Interrupt()
+    {
+        LOCK(cs);
+        running = false;
+        cond.notify_all();
+    }
+};
+
+#endif // ZCASH_HTTPWORKQUEUE_H
@@ -11,15 +11,21 @@
 #include "init.h"
 #include "addrman.h"
 #include "amount.h"
+#include "asyncrpcqueue.h"
 #include "checkpoints.h"
 #include "compat.h"
 #include "consensus/upgrades.h"
 #include "consensus/validation.h"
+#include "crypto/aes.h"
+#include "crypto/chacha20.h"
+#include "crypto/ripemd160.h"
+#include "crypto/sha512.h"
 #include "deprecation.h"
 #include "experimental_features.h"
 #include "fs.h"
 #include "httpserver.h"
 #include "httprpc.h"
+#include "insightindex.h"
 #include "key.h"
 #ifdef ENABLE_MINING
 #include "key_io.h"
@@ -345,6 +351,8 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(_("Keep at most <n> unconnectable transactions in memory (default: %u)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(_("Set the number of script verification threads (%u to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
         -GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
+    strUsage += HelpMessageOpt("-provingthreads=<n>", strprintf(_("Set the number of threads used to create zk-SNARK proofs for shielded transactions, independently of -rpcthreads (%d to %d, 0 = auto, <0 = leave that many cores free, default: %d)"),
+        -GetNumCores(), GetNumCores(), DEFAULT_PROVING_THREADS));
 #ifndef WIN32
     strUsage += HelpMessageOpt("-pid=<file>", strprintf(_("Specify pid file. Relative paths will be prefixed by a net-specific datadir location. (default: %s)"), BITCOIN_PID_FILENAME));
 #endif
@@ -412,7 +420,11 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-zmqpubhashblock=<address>", _("Enable publish hash block in <address>"));
     strUsage += HelpMessageOpt("-zmqpubhashtx=<address>", _("Enable publish hash transaction in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawblock=<address>", _("Enable publish raw block in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubrawblockcompact=<address>", _("Enable publish block header and transaction ids in <address>"));
     strUsage += HelpMessageOpt("-zmqpubrawtx=<address>", _("Enable publish raw transaction in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubsequence=<address>", _("Enable publish hash of each block connected or disconnected, and each transaction added to or removed from the mempool, with a label in <address>"));
+    strUsage += HelpMessageOpt("-zmqpubqueuesize=<n>", strprintf(_("Maximum number of notifications waiting to be published (default: %u)"), DEFAULT_ZMQ_PUB_QUEUE_SIZE));
+    strUsage += HelpMessageOpt("-zmqpubqueuepolicy=<policy>", strprintf(_("What to do with a notification when the queue is full: 'drop' it, or 'block' until there is space (default: %s)"), DEFAULT_ZMQ_PUB_QUEUE_POLICY));
 #endif
 
     strUsage += HelpMessageGroup(_("Monitoring options:"));
@@ -465,7 +477,7 @@ std::string HelpMessage(HelpMessageMode mode)
     {
         strUsage += HelpMessageOpt("-clockoffset=<n>", "Applies offset of <n> seconds to the actual time. Incompatible with -mocktime (default: 0)");
         strUsage += HelpMessageOpt("-mocktime=<n>", "Replace actual time with <n> seconds since epoch. Incompatible with -clockoffset (default: 0)");
-        strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit total size of signature and bundle caches to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
+        strUsage += HelpMessageOpt("-maxsigcachesize=<n>", strprintf("Limit total size of signature, script execution and bundle caches to <n> MiB (default: %u)", DEFAULT_MAX_SIG_CACHE_SIZE));
         strUsage += HelpMessageOpt("-maxtipage=<n>", strprintf("Maximum tip age in seconds to consider node in initial block download (default: %u)", DEFAULT_MAX_TIP_AGE));
     }
     strUsage += HelpMessageOpt("-minrelaytxfee=<amt>", strprintf(_("Transactions must have at least this fee rate (in %s per 1000 bytes) for relaying, mining and transaction creation (default: %s). This is not the only fee constraint."),
@@ -497,6 +509,7 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-gen", strprintf(_("Generate coins (default: %u)"), DEFAULT_GENERATE));
     strUsage += HelpMessageOpt("-genproclimit=<n>", strprintf(_("Set the number of threads for coin generation if enabled (-1 = all cores, default: %d)"), DEFAULT_GENERATE_THREADS));
     strUsage += HelpMessageOpt("-equihashsolver=<name>", _("Specify the Equihash solver to be used if enabled (default: \"default\")"));
+    strUsage += HelpMessageOpt("-equihashsolverthreads=<n>", strprintf(_("Set the number of threads that each coin generation thread uses to solve Equihash with the default solver (-1 = share all cores between the generation threads, default: %d)"), DEFAULT_EQUIHASH_SOLVER_THREADS));
     strUsage += HelpMessageOpt("-mineraddress=<addr>", _("Send mined coins to a specific single address"));
     strUsage += HelpMessageOpt("-minetolocalwallet", strprintf(
             _("Require that mined blocks use a coinbase address in the local wallet (default: %u)"),
@@ -521,11 +534,12 @@ std::string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-rpcthreads=<n>", strprintf(_("Set the number of threads to service RPC calls (default: %d)"), DEFAULT_HTTP_THREADS));
     if (showDebug) {
         strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
+        strUsage += HelpMessageOpt("-rpcworkqueuewait=<n>", strprintf("When the work queue is full, let up to the same number of RPC calls again wait at most <n> milliseconds for a thread (0 = reject them, default: %d)", DEFAULT_HTTP_WORKQUEUE_WAIT));
         strUsage += HelpMessageOpt("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT));
     }
 
-    // Disabled until we can lock notes and also tune performance of the prover which by default uses multiple threads
-    //strUsage += HelpMessageOpt("-rpcasyncthreads=<n>", strprintf(_("Set the number of threads to service Async RPC calls (default: %d)"), 1));
+    strUsage += HelpMessageOpt("-rpcasyncthreads=<n>", strprintf(_("Set the number of threads to service async RPC operations such as z_sendmany (1 to %d, 0 = auto, default: %d)"), MAX_ASYNC_RPC_THREADS, DEFAULT_ASYNC_RPC_THREADS));
+    strUsage += HelpMessageOpt("-rpcasyncprovingjobs=<n>", strprintf(_("Set the number of async RPC operations that may create proofs at the same time (default: %d)"), DEFAULT_ASYNC_RPC_PROVING_JOBS));
 
     if (mode == HMM_BITCOIND) {
         strUsage += HelpMessageGroup(_("Metrics Options (only if -daemon and -printtoconsole are not set):"));
@@ -1063,6 +1077,13 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     // Set up global Rayon threadpool.
     init::rayon_threadpool();
 
+    // Set up the threadpool used to create zk-SNARK proofs.
+    int nProvingThreads = GetArg("-provingthreads", DEFAULT_PROVING_THREADS);
+    if (nProvingThreads <= 0)
+        nProvingThreads += GetNumCores();
+    nProvingThreads = std::max(1, std::min(nProvingThreads, GetNumCores()));
+    init::proving_threadpool(nProvingThreads);
+
     // ********************************************************* Step 2: parameter interactions
     const CChainParams& chainparams = Params();
 
@@ -1466,6 +1487,10 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     // Initialize elliptic curve code
     std::string sha256_algo = SHA256AutoDetect();
     LogPrintf("Using the '%s' SHA256 implementation\n", sha256_algo);
+    LogPrintf("Using the '%s' SHA512 implementation\n", SHA512AutoDetect());
+    LogPrintf("Using the '%s' RIPEMD160 implementation\n", RIPEMD160AutoDetect());
+    LogPrintf("Using the '%s' ChaCha20 implementation\n", ChaCha20AutoDetect());
+    LogPrintf("Using the '%s' AES implementation\n", AESAutoDetect());
     ECC_Start();
 
     // Sanity check
@@ -1504,23 +1529,28 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
     LogPrintf("Using at most %i connections (%i file descriptors available)\n", nMaxConnections, nFD);
     std::ostringstream strErrors;
 
-    // Initialize the validity caches. We currently have three:
+    // Initialize the validity caches. We currently have four:
     // - Transparent signature validity.
+    // - Transparent script validity of whole transactions.
     // - Sapling bundle validity.
     // - Orchard bundle validity.
-    // Assign half of the cap to transparent signatures, and split the rest
-    // between Sapling and Orchard bundles.
+    // Split half of the cap between transparent signatures and transactions,
+    // and the rest between Sapling and Orchard bundles.
     size_t nMaxCacheSize = GetArg("-maxsigcachesize", DEFAULT_MAX_SIG_CACHE_SIZE) * ((size_t) 1 << 20);
     if (nMaxCacheSize <= 0) {
         return InitError(strprintf(_("-maxsigcachesize must be at least 1")));
     }
-    InitSignatureCache(nMaxCacheSize / 2);
+    InitSignatureCache(nMaxCacheSize / 4);
+    InitScriptExecutionCache(nMaxCacheSize / 4);
     bundlecache::init(nMaxCacheSize / 4);
 
+    LogPrintf("Using %d threads for proof creation\n", nProvingThreads);
     LogPrintf("Using %u threads for script verification\n", nScriptCheckThreads);
     if (nScriptCheckThreads) {
-        for (int i=0; i<nScriptCheckThreads-1; i++)
+        for (int i=0; i<nScriptCheckThreads-1; i++) {
             threadGroup.create_thread(&ThreadScriptCheck);
+            threadGroup.create_thread(&ThreadHeaderCheck);
+        }
     }
 
     // Start the lightweight task scheduler thread
@@ -1715,6 +1745,12 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
         AddOneShot(strDest);
 
 #if ENABLE_ZMQ
+    if (mapArgs.count("-zmqpubqueuepolicy")) {
+        ZMQQueuePolicy policy;
+        if (!ParseZMQQueuePolicy(mapArgs["-zmqpubqueuepolicy"], policy))
+            return InitError(strprintf(_("Unknown -zmqpubqueuepolicy: '%s'"), mapArgs["-zmqpubqueuepolicy"]));
+    }
+
     pzmqNotificationInterface = CZMQNotificationInterface::CreateWithArguments(mapArgs);
 
     if (pzmqNotificationInterface) {
@@ -1813,12 +1849,18 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
-                // Check for changed -insightexplorer state
+                // Check for changed -insightexplorer state. Enabling it on an
+                // existing node builds the indexes in the background, which
+                // needs the blocks and undo data of the whole chain.
                 bool fInsightExplorerPreviouslySet = false;
                 pblocktree->ReadFlag("insightexplorer", fInsightExplorerPreviouslySet);
+                bool fStartInsightIndexBuild = false;
                 if (fExperimentalInsightExplorer != fInsightExplorerPreviouslySet) {
-                    strLoadError = _("You need to rebuild the database using -reindex to change -insightexplorer");
-                    break;
+                    if (!fExperimentalInsightExplorer || fHavePruned) {
+                        strLoadError = _("You need to rebuild the database using -reindex to change -insightexplorer");
+                        break;
+                    }
+                    fStartInsightIndexBuild = true;
                 }
 
                 // Check for changed -lightwalletd state
@@ -1829,6 +1871,22 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
                     break;
                 }
 
+                if (fStartInsightIndexBuild) {
+                    LogPrintf("%s: -insightexplorer was enabled; building its indexes in the background\n", __func__);
+                    pblocktree->WriteFlag("insightexplorer", true);
+                    if (!pblocktree->WriteFlag("addressbalanceindex", true)) {
+                        strLoadError = _("Error writing the address balance index flag");
+                        break;
+                    }
+                    fAddressIndex = true;
+                    fSpentIndex = true;
+                    fTimestampIndex = true;
+                }
+                if (!InitInsightIndexBuild(fStartInsightIndexBuild)) {
+                    strLoadError = _("Error loading the state of the insight index build");
+                    break;
+                }
+
                 // Check for changed -prune state.  What we are concerned about is a user who has pruned blocks
                 // in the past, but is now trying to run unpruned.
                 if (fHavePruned && !fPruneMode) {
@@ -2057,6 +2115,13 @@ bool AppInit2(boost::thread_group& threadGroup, CScheduler& scheduler)
 
     threadGroup.create_thread(boost::bind(&ThreadImport, vImportFiles, chainparams));
 
+    // insightexplorer
+    if (IsInsightIndexBuilding()) {
+        threadGroup.create_thread(
+            boost::bind(&TraceThread<void (*)()>, "insightidx", &ThreadInsightIndexBuild)
+        );
+    }
+
     // Wait for genesis block to be processed
     {
         WAIT_LOCK(g_genesis_wait_mutex, lock);
@@ -0,0 +1,266 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "insightindex.h"
+
+#include "addressindex.h"
+#include "chain.h"
+#include "chainparams.h"
+#include "init.h"
+#include "main.h"
+#include "spentindex.h"
+#include "txdb.h"
+#include "undo.h"
+#include "util/system.h"
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+
+#include <boost/thread.hpp>
+
+/** Whether a background build is in progress; only cleared while holding cs_main. */
+static std::atomic<bool> fInsightIndexBuilding(false);
+/** The last block that the background build has indexed. */
+static const CBlockIndex* pindexInsightIndexBest GUARDED_BY(cs_main) = nullptr;
+
+namespace {
+
+/** A block of the active chain that the build is about to index. */
+struct InsightIndexBlock
+{
+    const CBlockIndex* pindex;
+    std::vector<CAddressIndexDbEntry> addressIndex;
+    std::vector<CAddressUnspentDbEntry> addressUnspentIndex;
+    std::vector<CSpentIndexDbEntry> spentIndex;
+};
+
+/**
+ * Computes the index entries for a block from the block and its undo data,
+ * in the same order as ConnectBlock does.
+ */
+bool ReadInsightIndexBlock(InsightIndexBlock& entry, const Consensus::Params& consensusParams)
+{
+    const CBlockIndex* pindex = entry.pindex;
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pindex, consensusParams))
+        return error("%s: failed to read block %s", __func__, pindex->GetBlockHash().ToString());
+    CBlockUndo blockundo;
+    if (!ReadBlockUndoFromDisk(blockundo, pindex))
+        return error("%s: failed to read undo data for block %s", __func__, pindex->GetBlockHash().ToString());
+    if (blockundo.vtxundo.size() + 1 != block.vtx.size())
+        return error("%s: block and undo data inconsistent", __func__);
+
+    for (unsigned int i = 0; i < block.vtx.size(); i++) {
+        const CTransaction& tx = block.vtx[i];
+        const uint256 hash = tx.GetHash();
+
+        if (i > 0) {
+            const CTxUndo& txundo = blockundo.vtxundo[i - 1];
+            if (txundo.vprevout.size() != tx.vin.size())
+                return error("%s: transaction and undo data inconsistent", __func__);
+            for (size_t j = 0; j < tx.vin.size(); j++) {
+                const CTxIn& input = tx.vin[j];
+                const CTxOut& prevout = txundo.vprevout[j].txout;
+                CScript::ScriptType scriptType = prevout.scriptPubKey.GetType();
+                const uint160 addrHash = prevout.scriptPubKey.AddressHash();
+                if (fAddressIndex && scriptType != CScript::UNKNOWN) {
+                    entry.addressIndex.push_back(std::make_pair(
+                        CAddressIndexKey(scriptType, addrHash, pindex->nHeight, i, hash, j, true),
+                        prevout.nValue * -1));
+                    entry.addressUnspentIndex.push_back(std::make_pair(
+                        CAddressUnspentKey(scriptType, addrHash, input.prevout.hash, input.prevout.n),
+                        CAddressUnspentValue()));
+                }
+                if (fSpentIndex) {
+                    entry.spentIndex.push_back(std::make_pair(
+                        CSpentIndexKey(input.prevout.hash, input.prevout.n),
+                        CSpentIndexValue(hash, j, pindex->nHeight, prevout.nValue, scriptType, addrHash)));
+                }
+            }
+        }
+
+        if (fAddressIndex) {
+            for (unsigned int k = 0; k < tx.vout.size(); k++) {
+                const CTxOut& out = tx.vout[k];
+                CScript::ScriptType scriptType = out.scriptPubKey.GetType();
+                if (scriptType != CScript::UNKNOWN) {
+                    const uint160 addrHash = out.scriptPubKey.AddressHash();
+                    entry.addressIndex.push_back(std::make_pair(
+                        CAddressIndexKey(scriptType, addrHash, pindex->nHeight, i, hash, k, false),
+                        out.nValue));
+                    entry.addressUnspentIndex.push_back(std::make_pair(
+                        CAddressUnspentKey(scriptType, addrHash, hash, k),
+                        CAddressUnspentValue(out.nValue, out.scriptPubKey, pindex->nHeight)));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool WriteInsightIndexBlock(const InsightIndexBlock& entry)
+{
+    if (fAddressIndex) {
+        if (!pblocktree->WriteAddressIndex(entry.addressIndex))
+            return error("%s: failed to write address index", __func__);
+        if (!pblocktree->UpdateAddressUnspentIndex(entry.addressUnspentIndex))
+            return error("%s: failed to write address unspent index", __func__);
+    }
+    if (fSpentIndex) {
+        if (!pblocktree->UpdateSpentIndex(entry.spentIndex))
+            return error("%s: failed to write spent index", __func__);
+    }
+    if (fTimestampIndex) {
+        if (!WriteTimestampIndex(entry.pindex))
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Collects the next blocks of the active chain to index. Returns false once
+ * the build has caught up with the tip, in which case it is finished.
+ */
+bool GetNextInsightIndexBlocks(std::vector<InsightIndexBlock>& vBlocks)
+{
+    LOCK(cs_main);
+    const CBlockIndex* pindex = chainActive.Next(pindexInsightIndexBest);
+    if (pindex == nullptr) {
+        // From here on, ConnectBlock keeps the indexes up to date.
+        fInsightIndexBuilding = false;
+        pblocktree->EraseInsightIndexBest();
+        pblocktree->WriteFlag("insightindexbuilding", false);
+        LogPrintf("Insight indexes built up to height %d\n", pindexInsightIndexBest->nHeight);
+        return false;
+    }
+    while (pindex != nullptr && vBlocks.size() < INSIGHT_INDEX_BUILD_BATCH_SIZE) {
+        vBlocks.push_back(InsightIndexBlock{pindex});
+        pindex = chainActive.Next(pindex);
+    }
+    return true;
+}
+
+} // anon namespace
+
+bool InitInsightIndexBuild(bool fStart)
+{
+    LOCK(cs_main);
+    if (fStart) {
+        if (chainActive.Genesis() == nullptr) {
+            return error("%s: no active chain to index", __func__);
+        }
+        // Nothing has been indexed yet, and the genesis block is never indexed.
+        if (!pblocktree->WriteInsightIndexBest(chainActive.Genesis()->GetBlockHash()) ||
+            !pblocktree->WriteFlag("insightindexbuilding", true)) {
+            return error("%s: failed to start index build", __func__);
+        }
+    }
+
+    bool fBuilding = false;
+    pblocktree->ReadFlag("insightindexbuilding", fBuilding);
+    if (!fBuilding) {
+        return true;
+    }
+
+    uint256 hashBest;
+    if (!pblocktree->ReadInsightIndexBest(hashBest)) {
+        return error("%s: failed to read index build progress", __func__);
+    }
+    BlockMap::iterator mi = mapBlockIndex.find(hashBest);
+    if (mi == mapBlockIndex.end()) {
+        return error("%s: index build progress refers to an unknown block", __func__);
+    }
+    // If the block was disconnected while the node was stopped, its entries
+    // were removed with it, so resume from the fork point.
+    pindexInsightIndexBest = chainActive.FindFork(mi->second);
+    if (pindexInsightIndexBest == nullptr) {
+        pindexInsightIndexBest = chainActive.Genesis();
+    }
+    fInsightIndexBuilding = true;
+    LogPrintf("Building insight indexes in the background from height %d\n", pindexInsightIndexBest->nHeight);
+    return true;
+}
+
+bool IsInsightIndexBuilding()
+{
+    return fInsightIndexBuilding;
+}
+
+bool InsightIndexContains(const CBlockIndex* pindex)
+{
+    AssertLockHeld(cs_main);
+    if (!fInsightIndexBuilding) {
+        return true;
+    }
+    return pindexInsightIndexBest->GetAncestor(pindex->nHeight) == pindex;
+}
+
+void InsightIndexBlockDisconnected(const CBlockIndex* pindex)
+{
+    AssertLockHeld(cs_main);
+    if (fInsightIndexBuilding && pindexInsightIndexBest == pindex) {
+        pindexInsightIndexBest = pindex->pprev;
+    }
+}
+
+const CBlockIndex* GetInsightIndexBestBlock()
+{
+    AssertLockHeld(cs_main);
+    return fInsightIndexBuilding ? pindexInsightIndexBest : chainActive.Tip();
+}
+
+void ThreadInsightIndexBuild()
+{
+    const Consensus::Params& consensusParams = Params().GetConsensus();
+    const unsigned int nReaders = std::max(1u, std::min(MAX_INSIGHT_INDEX_BUILD_READERS, std::thread::hardware_concurrency()));
+
+    while (fInsightIndexBuilding) {
+        boost::this_thread::interruption_point();
+
+        std::vector<InsightIndexBlock> vBlocks;
+        if (!GetNextInsightIndexBlocks(vBlocks)) {
+            return;
+        }
+
+        // Reading blocks and undo data dominates the cost of indexing, so
+        // spread it over a few threads.
+        std::vector<std::future<bool>> vReads;
+        for (unsigned int n = 0; n < nReaders; n++) {
+            vReads.push_back(std::async(std::launch::async, [&, n]() {
+                for (size_t i = n; i < vBlocks.size(); i += nReaders) {
+                    if (!ReadInsightIndexBlock(vBlocks[i], consensusParams))
+                        return false;
+                }
+                return true;
+            }));
+        }
+        bool fRead = true;
+        for (auto& read : vReads) {
+            fRead = read.get() && fRead;
+        }
+        if (!fRead) {
+            LogPrintf("Error: failed to read blocks for the insight index build; stopping\n");
+            StartShutdown();
+            return;
+        }
+
+        LOCK(cs_main);
+        for (const InsightIndexBlock& entry : vBlocks) {
+            // A reorg may have disconnected blocks of this batch; the rest of
+            // the new chain is picked up by the next batch.
+            if (entry.pindex->pprev != pindexInsightIndexBest || !chainActive.Contains(entry.pindex)) {
+                break;
+            }
+            if (!WriteInsightIndexBlock(entry)) {
+                LogPrintf("Error: failed to write insight indexes; stopping\n");
+                StartShutdown();
+                return;
+            }
+            pindexInsightIndexBest = entry.pindex;
+        }
+        pblocktree->WriteInsightIndexBest(pindexInsightIndexBest->GetBlockHash());
+    }
+}
@@ -0,0 +1,52 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef BITCOIN_INSIGHTINDEX_H
+#define BITCOIN_INSIGHTINDEX_H
+
+class CBlockIndex;
+
+/** Number of blocks that the background build reads before writing them */
+static const unsigned int INSIGHT_INDEX_BUILD_BATCH_SIZE = 64;
+/** Maximum number of threads that read blocks and undo data for the background build */
+static const unsigned int MAX_INSIGHT_INDEX_BUILD_READERS = 4;
+
+/**
+ * The insight indexes (address, spent and timestamp) can be built in the
+ * background for blocks that were connected before they were enabled. The
+ * build thread reads blocks and their undo data from disk and indexes them in
+ * chain order, while the node keeps following the tip; blocks that are
+ * connected during the build are indexed by the build thread once it reaches
+ * them. Progress is persisted, so an interrupted build resumes on restart.
+ */
+
+/**
+ * Loads the state of the background build when the node starts. If fStart is
+ * true, a new build is started from the genesis block. Requires the block
+ * index to be loaded.
+ */
+bool InitInsightIndexBuild(bool fStart);
+
+/** Whether a background build of the insight indexes is in progress. */
+bool IsInsightIndexBuilding();
+
+/**
+ * Whether the insight indexes contain the entries for this block of the active
+ * chain. Requires cs_main.
+ */
+bool InsightIndexContains(const CBlockIndex* pindex);
+
+/** Notifies the build that the tip was disconnected. Requires cs_main. */
+void InsightIndexBlockDisconnected(const CBlockIndex* pindex);
+
+/**
+ * Returns the last block that the insight indexes contain, which is the tip
+ * unless a background build is in progress. Requires cs_main.
+ */
+const CBlockIndex* GetInsightIndexBestBlock();
+
+/** Thread that runs the background build, if there is one. */
+void ThreadInsightIndexBuild();
+
+#endif // BITCOIN_INSIGHTINDEX_H
@@ -277,6 +277,60 @@ bool CKey::Derive(CKey& keyChild, ChainCode &ccChild, unsigned int nChild, const
     return ret;
 }
 
+std::vector<std::optional<CExtKey>> CExtKey::DeriveRange(unsigned int nChildStart, unsigned int nCount) const {
+    assert(key.IsValid());
+    assert(key.IsCompressed());
+    // The parent's public key, and so its fingerprint, is shared by the
+    // children, and the HMAC-SHA512 keyed by the chain code that derives each
+    // of them is computed in a batch.
+    CPubKey pubkey = key.GetPubKey();
+    assert(pubkey.size() == CPubKey::COMPRESSED_PUBLIC_KEY_SIZE);
+    CKeyID id = pubkey.GetID();
+
+    std::vector<unsigned int> vNormal;
+    for (unsigned int i = 0; i < nCount; i++) {
+        if (((nChildStart + i) >> 31) == 0) {
+            vNormal.push_back(nChildStart + i);
+        }
+    }
+    const size_t MSG_SIZE = CPubKey::COMPRESSED_PUBLIC_KEY_SIZE + 4;
+    std::vector<unsigned char> vKeys(vNormal.size() * 32);
+    std::vector<unsigned char> vMsgs(vNormal.size() * MSG_SIZE);
+    for (size_t i = 0; i < vNormal.size(); i++) {
+        memcpy(vKeys.data() + 32 * i, chaincode.begin(), 32);
+        memcpy(vMsgs.data() + MSG_SIZE * i, pubkey.begin(), CPubKey::COMPRESSED_PUBLIC_KEY_SIZE);
+        WriteBE32(vMsgs.data() + MSG_SIZE * i + CPubKey::COMPRESSED_PUBLIC_KEY_SIZE, vNormal[i]);
+    }
+    std::vector<unsigned char, secure_allocator<unsigned char>> vout(vNormal.size() * 64);
+    HMAC_SHA512Batch(vout.data(), vKeys.data(), 32, vMsgs.data(), MSG_SIZE, vNormal.size());
+
+    std::vector<std::optional<CExtKey>> children;
+    children.reserve(nCount);
+    size_t nNormal = 0;
+    for (unsigned int i = 0; i < nCount; i++) {
+        unsigned int nChild = nChildStart + i;
+        if ((nChild >> 31) != 0) {
+            // Hardened children are derived from the private key.
+            children.push_back(Derive(nChild));
+            continue;
+        }
+        const unsigned char* tweak = vout.data() + 64 * nNormal++;
+        std::vector<unsigned char, secure_allocator<unsigned char>> vchChild(key.begin(), key.end());
+        if (!secp256k1_ec_seckey_tweak_add(secp256k1_context_sign, vchChild.data(), tweak)) {
+            children.push_back(std::nullopt);
+            continue;
+        }
+        CExtKey out;
+        out.nDepth = nDepth + 1;
+        memcpy(&out.vchFingerprint[0], &id, 4);
+        out.nChild = nChild;
+        memcpy(out.chaincode.begin(), tweak + 32, 32);
+        out.key.Set(vchChild.begin(), vchChild.end(), true);
+        children.push_back(out);
+    }
+    return children;
+}
+
 std::optional<CExtKey> CExtKey::Derive(unsigned int _nChild) const {
     CExtKey out;
     out.nDepth = nDepth + 1;
@@ -171,6 +171,12 @@ struct CExtKey {
     void Encode(unsigned char code[BIP32_EXTKEY_SIZE]) const;
     void Decode(const unsigned char code[BIP32_EXTKEY_SIZE]);
     std::optional<CExtKey> Derive(unsigned int nChild) const;
+    /**
+     * Derive the children nChildStart to nChildStart + nCount - 1, with the
+     * same results as calling Derive for each of them. Normal children are
+     * derived together, which is faster than deriving them one at a time.
+     */
+    std::vector<std::optional<CExtKey>> DeriveRange(unsigned int nChildStart, unsigned int nCount) const;
     CExtPubKey Neuter() const;
     template <typename Stream>
     void Serialize(Stream& s) const
@@ -89,6 +89,12 @@ bool CBasicKeyStore::AddKeyPubKey(const CKey& key, const CPubKey &pubkey)
     return true;
 }
 
+void CBasicKeyStore::RemoveKey(const CKeyID &address)
+{
+    LOCK(cs_KeyStore);
+    mapKeys.erase(address);
+}
+
 bool CBasicKeyStore::AddCScript(const CScript& redeemScript)
 {
     if (redeemScript.size() > MAX_SCRIPT_ELEMENT_SIZE)
@@ -191,6 +197,27 @@ bool CBasicKeyStore::AddSaplingSpendingKey(
     return true;
 }
 
+void CBasicKeyStore::RemoveSaplingSpendingKey(
+    const libzcash::SaplingExtendedFullViewingKey &extfvk)
+{
+    LOCK(cs_KeyStore);
+    mapSaplingSpendingKeys.erase(extfvk);
+}
+
+void CBasicKeyStore::RemoveSaplingFullViewingKey(
+    const libzcash::SaplingIncomingViewingKey &ivk)
+{
+    LOCK(cs_KeyStore);
+    mapSaplingFullViewingKeys.erase(ivk);
+}
+
+void CBasicKeyStore::RemoveSaplingPaymentAddress(
+    const libzcash::SaplingPaymentAddress &addr)
+{
+    LOCK(cs_KeyStore);
+    mapSaplingIncomingViewingKeys.erase(addr);
+}
+
 bool CBasicKeyStore::AddSproutViewingKey(const libzcash::SproutViewingKey &vk)
 {
     LOCK(cs_KeyStore);
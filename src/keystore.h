@@ -218,6 +218,8 @@ public:
     std::optional<HDSeed> GetLegacyHDSeed() const;
 
     bool AddKeyPubKey(const CKey& key, const CPubKey &pubkey);
+    //! Removes a key that was added by a wallet operation that failed.
+    void RemoveKey(const CKeyID &address);
     bool GetPubKey(const CKeyID &address, CPubKey& vchPubKeyOut) const;
     bool HaveKey(const CKeyID &address) const
     {
@@ -317,6 +319,10 @@ public:
 
     //! Sapling
     bool AddSaplingSpendingKey(const libzcash::SaplingExtendedSpendingKey &sk);
+    //! Removes keys and addresses that were added by a wallet operation that failed.
+    void RemoveSaplingSpendingKey(const libzcash::SaplingExtendedFullViewingKey &extfvk);
+    void RemoveSaplingFullViewingKey(const libzcash::SaplingIncomingViewingKey &ivk);
+    void RemoveSaplingPaymentAddress(const libzcash::SaplingPaymentAddress &addr);
     bool HaveSaplingSpendingKey(const libzcash::SaplingExtendedFullViewingKey &extfvk) const
     {
         bool result;
@@ -20,6 +20,7 @@
 #include "deprecation.h"
 #include "experimental_features.h"
 #include "init.h"
+#include "insightindex.h"
 #include "key_io.h"
 #include "merkleblock.h"
 #include "metrics.h"
@@ -86,6 +87,8 @@ Mutex g_best_block_mutex;
 std::condition_variable g_best_block_cv;
 uint256 g_best_block;
 int g_best_block_height;
+/** The published snapshot of the chain tip. Only replaced while holding cs_main. */
+static std::shared_ptr<const CChainTipSnapshot> chainTipSnapshot;
 int nScriptCheckThreads = 0;
 std::atomic_bool fImporting(false);
 std::atomic_bool fReindex(false);
@@ -1368,11 +1371,9 @@ bool ContextualCheckShieldedInputs(
     auto dosLevelPotentiallyRelaxing = isMined ? DOS_LEVEL_BLOCK : (
         isInitBlockDownload(consensus) ? 0 : DOS_LEVEL_MEMPOOL);
 
-    auto prevConsensusBranchId = PrevEpochBranchId(consensusBranchId, consensus);
     uint256 dataToBeSigned;
-    uint256 prevDataToBeSigned;
 
-    // Create signature hashes for shielded components.
+    // Create signature hash for shielded components.
     if (!tx.vJoinSplit.empty() ||
         tx.GetSaplingBundle().IsPresent() ||
         tx.GetOrchardBundle().IsPresent())
@@ -1381,7 +1382,6 @@ bool ContextualCheckShieldedInputs(
         CScript scriptCode;
         try {
             dataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, consensusBranchId, txdata);
-            prevDataToBeSigned = SignatureHash(scriptCode, tx, NOT_AN_INPUT, SIGHASH_ALL, 0, prevConsensusBranchId, txdata);
         } catch (std::logic_error ex) {
             // A logic error should never occur because we pass NOT_AN_INPUT and
             // SIGHASH_ALL to SignatureHash().
@@ -1397,7 +1397,17 @@ bool ContextualCheckShieldedInputs(
             // branch ID; if so, inform the node that they need to upgrade. We
             // only check the previous epoch's branch ID, on the assumption that
             // users creating transactions will notice their transactions
-            // failing before a second network upgrade occurs.
+            // failing before a second network upgrade occurs. The signature
+            // hash for that branch ID is only needed here, so it is computed
+            // lazily.
+            auto prevConsensusBranchId = PrevEpochBranchId(consensusBranchId, consensus);
+            uint256 prevDataToBeSigned;
+            try {
+                prevDataToBeSigned = SignatureHash(CScript(), tx, NOT_AN_INPUT, SIGHASH_ALL, 0, prevConsensusBranchId, txdata);
+            } catch (const std::logic_error& ex) {
+                return state.DoS(100, error("ContextualCheckShieldedInputs(): error computing signature hash"),
+                                 REJECT_INVALID, "error-computing-signature-hash");
+            }
             if (ed25519::verify(tx.joinSplitPubKey,
                                 tx.joinSplitSig,
                                 {prevDataToBeSigned.begin(), 32})) {
@@ -2051,23 +2061,29 @@ bool AcceptToMemoryPool(
             return state.DoS(100, false, REJECT_INVALID, "bad-txns-input-value-out-of-range");
         }
         PrecomputedTransactionData txdata(tx, allPrevOutputs);
+        // The transaction is checked against two sets of script flags below,
+        // which need the same signature hashes.
+        txdata.CacheSignatureHashes();
         if (!ContextualCheckInputs(tx, state, view, true, STANDARD_SCRIPT_VERIFY_FLAGS, true, txdata, chainparams.GetConsensus(), consensusBranchId))
         {
             return false;
         }
 
-        // Check again against just the consensus-critical mandatory script
-        // verification flags, in case of bugs in the standard flags that cause
-        // transactions to pass as valid when they're actually invalid. For
-        // instance the STRICTENC flag was incorrectly allowing certain
-        // CHECKSIG NOT scripts to pass, even though they were invalid.
+        // Check again against just the consensus-critical script verification
+        // flags that blocks are checked with, in case of bugs in the standard
+        // flags that cause transactions to pass as valid when they're actually
+        // invalid. For instance the STRICTENC flag was incorrectly allowing
+        // certain CHECKSIG NOT scripts to pass, even though they were invalid.
+        // These include the MANDATORY_SCRIPT_VERIFY_FLAGS. As they are the
+        // flags that ConnectBlock uses, the result is cached for when the
+        // transaction is mined.
         //
         // There is a similar check in CreateNewBlock() to prevent creating
         // invalid blocks, however allowing such transactions into the mempool
         // can be exploited as a DoS attack.
-        if (!ContextualCheckInputs(tx, state, view, true, MANDATORY_SCRIPT_VERIFY_FLAGS, true, txdata, chainparams.GetConsensus(), consensusBranchId))
+        if (!ContextualCheckInputs(tx, state, view, true, BLOCK_SCRIPT_VERIFY_FLAGS, true, txdata, chainparams.GetConsensus(), consensusBranchId, NULL, true))
         {
-            return error("%s: BUG! PLEASE REPORT THIS! ConnectInputs failed against MANDATORY but not STANDARD flags %s, %s",
+            return error("%s: BUG! PLEASE REPORT THIS! ConnectInputs failed against BLOCK but not STANDARD flags %s, %s",
                 __func__, hash.ToString(), FormatStateMessage(state));
         }
 
@@ -2143,13 +2159,18 @@ bool AcceptToMemoryPool(
 }
 
 bool GetTimestampIndex(unsigned int high, unsigned int low, bool fActiveOnly,
-    std::vector<std::pair<uint256, unsigned int> > &hashes)
+    std::vector<std::pair<uint256, unsigned int> > &hashes,
+    size_t nLimit, std::optional<CTimestampIndexKey>* pCursor)
 {
     if (!fTimestampIndex) {
         LogPrint("rpc", "Timestamp index not enabled");
         return false;
     }
-    if (!pblocktree->ReadTimestampIndex(high, low, fActiveOnly, hashes)) {
+    if (IsInsightIndexBuilding()) {
+        LogPrint("rpc", "insight indexes are still being built");
+        return false;
+    }
+    if (!pblocktree->ReadTimestampIndex(high, low, fActiveOnly, hashes, nLimit, pCursor)) {
         LogPrint("rpc", "Unable to get hashes for timestamps");
         return false;
     }
@@ -2163,6 +2184,10 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
         LogPrint("rpc", "Spent index not enabled");
         return false;
     }
+    if (IsInsightIndexBuilding()) {
+        LogPrint("rpc", "insight indexes are still being built");
+        return false;
+    }
     if (mempool.getSpentIndex(key, value))
         return true;
 
@@ -2175,27 +2200,54 @@ bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value)
 
 bool GetAddressIndex(const uint160& addressHash, int type,
                      std::vector<CAddressIndexDbEntry>& addressIndex,
-                     int start, int end)
+                     int start, int end,
+                     size_t nLimit, std::optional<CAddressIndexKey>* pCursor)
 {
     if (!fAddressIndex) {
         LogPrint("rpc", "address index not enabled");
         return false;
     }
-    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end)) {
+    if (IsInsightIndexBuilding()) {
+        LogPrint("rpc", "insight indexes are still being built");
+        return false;
+    }
+    if (!pblocktree->ReadAddressIndex(addressHash, type, addressIndex, start, end, nLimit, pCursor)) {
         LogPrint("rpc", "unable to get txids for address");
         return false;
     }
     return true;
 }
 
+bool GetAddressBalance(const uint160& addressHash, int type, CAddressBalanceValue& balance)
+{
+    if (!fAddressIndex) {
+        LogPrint("rpc", "address index not enabled");
+        return false;
+    }
+    if (IsInsightIndexBuilding()) {
+        LogPrint("rpc", "insight indexes are still being built");
+        return false;
+    }
+    if (!pblocktree->ReadAddressBalance(addressHash, type, balance)) {
+        LogPrint("rpc", "unable to get balance for address");
+        return false;
+    }
+    return true;
+}
+
 bool GetAddressUnspent(const uint160& addressHash, int type,
-                       std::vector<CAddressUnspentDbEntry>& unspentOutputs)
+                       std::vector<CAddressUnspentDbEntry>& unspentOutputs,
+                       size_t nLimit, std::optional<CAddressUnspentKey>* pCursor)
 {
     if (!fAddressIndex) {
         LogPrint("rpc", "address index not enabled");
         return false;
     }
-    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs)) {
+    if (IsInsightIndexBuilding()) {
+        LogPrint("rpc", "insight indexes are still being built");
+        return false;
+    }
+    if (!pblocktree->ReadAddressUnspentIndex(addressHash, type, unspentOutputs, nLimit, pCursor)) {
         LogPrint("rpc", "unable to get txids for address");
         return false;
     }
@@ -2339,6 +2391,71 @@ bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus
     return true;
 }
 
+/**
+ * Opens the block file at the index header that WriteBlockToDisk wrote in
+ * front of the block at pos, and reads the header. Returns the file
+ * positioned at the start of the block, or null on failure.
+ */
+static FILE* OpenRawBlock(unsigned int& nSize, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    if (pos.nPos < CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int)) {
+        error("%s: invalid block position %s", __func__, pos.ToString());
+        return nullptr;
+    }
+    CDiskBlockPos hpos = pos;
+    hpos.nPos -= CMessageHeader::MESSAGE_START_SIZE + sizeof(unsigned int);
+
+    CAutoFile filein(OpenBlockFile(hpos, true), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull()) {
+        error("%s: OpenBlockFile failed for %s", __func__, pos.ToString());
+        return nullptr;
+    }
+
+    try {
+        unsigned char blkStart[CMessageHeader::MESSAGE_START_SIZE];
+        filein >> FLATDATA(blkStart) >> nSize;
+        if (memcmp(blkStart, messageStart, CMessageHeader::MESSAGE_START_SIZE)) {
+            error("%s: block magic mismatch at %s", __func__, pos.ToString());
+            return nullptr;
+        }
+        if (nSize > MAX_SIZE) {
+            error("%s: block size %u too large at %s", __func__, nSize, pos.ToString());
+            return nullptr;
+        }
+    }
+    catch (const std::exception& e) {
+        error("%s: I/O error - %s at %s", __func__, e.what(), pos.ToString());
+        return nullptr;
+    }
+    return filein.release();
+}
+
+bool ReadRawBlockSize(unsigned int& nSize, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    CAutoFile filein(OpenRawBlock(nSize, pos, messageStart), SER_DISK, CLIENT_VERSION);
+    return !filein.IsNull();
+}
+
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart)
+{
+    block.clear();
+
+    unsigned int nSize;
+    CAutoFile filein(OpenRawBlock(nSize, pos, messageStart), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+        return false;
+
+    try {
+        block.resize(nSize);
+        filein.read((char*)block.data(), nSize);
+    }
+    catch (const std::exception& e) {
+        block.clear();
+        return error("%s: I/O error - %s at %s", __func__, e.what(), pos.ToString());
+    }
+    return true;
+}
+
 static std::atomic<bool> IBDLatchToFalse{false};
 // testing-only, allow initial block down state to be set or reset
 bool TestSetIBD(bool ibd) {
@@ -2688,10 +2805,29 @@ void UpdateCoins(const CTransaction& tx, CCoinsViewCache& inputs, int nHeight)
 }
 
 bool CScriptCheck::operator()() {
+    if (!vBatchIn.empty()) {
+        CSignatureBatch batch(cacheStore);
+        bool fBatchValid = VerifyScript(ptxTo->vin[nIn].scriptSig, scriptPubKey, nFlags, BatchingTransactionSignatureChecker(ptxTo, *txdata, nIn, amount, batch), consensusBranchId, &error);
+        for (size_t i = 0; fBatchValid && i < vBatchIn.size(); i++) {
+            fBatchValid = VerifyScript(ptxTo->vin[vBatchIn[i].first].scriptSig, scriptPubKey, nFlags, BatchingTransactionSignatureChecker(ptxTo, *txdata, vBatchIn[i].first, vBatchIn[i].second, batch), consensusBranchId, &error);
+        }
+        if (fBatchValid && batch.Verify()) {
+            return true;
+        }
+        // Fall back to checking the inputs one at a time, so that any invalid
+        // signature is handled exactly as the script requires, and the error
+        // is that of the first invalid input.
+    }
+
     const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
     if (!VerifyScript(scriptSig, scriptPubKey, nFlags, CachingTransactionSignatureChecker(ptxTo, *txdata, nIn, amount, cacheStore), consensusBranchId, &error)) {
         return false;
     }
+    for (const auto& in : vBatchIn) {
+        if (!VerifyScript(ptxTo->vin[in.first].scriptSig, scriptPubKey, nFlags, CachingTransactionSignatureChecker(ptxTo, *txdata, in.first, in.second, cacheStore), consensusBranchId, &error)) {
+            return false;
+        }
+    }
     return true;
 }
 
@@ -2812,7 +2948,8 @@ bool ContextualCheckInputs(
     PrecomputedTransactionData& txdata,
     const Consensus::Params& consensusParams,
     uint32_t consensusBranchId,
-    std::vector<CScriptCheck> *pvChecks)
+    std::vector<CScriptCheck> *pvChecks,
+    bool cacheFullScriptStore)
 {
     if (!tx.IsCoinBase())
     {
@@ -2831,11 +2968,40 @@ bool ContextualCheckInputs(
         // before the last block chain checkpoint. This is safe because block merkle hashes are
         // still computed and checked, and any change will be caught at the next checkpoint.
         if (fScriptChecks) {
+            // A transaction that was found valid with the same flags, when it
+            // was accepted to the mempool, needs no script checks. When the
+            // cache is consulted while connecting a block (cacheStore is not
+            // set), the entry won't be needed again and is marked for eviction.
+            uint256 hashCacheEntry = ScriptExecutionCacheEntry(tx, flags, consensusBranchId);
+            if (ScriptExecutionCacheContains(hashCacheEntry, !cacheStore)) {
+                return true;
+            }
+
+            // Checks that further inputs spending the same P2PKH scriptPubKey
+            // can be added to, by index in pvChecks. Batching only saves
+            // parsing the public key, so it is limited to keep at least as
+            // many checks as there are threads to run them (the script check
+            // threads and the one connecting the block).
+            std::map<CScript, size_t> mapBatchChecks;
+            const size_t nMaxBatchInputs = std::max<size_t>(1, std::min<size_t>(
+                MAX_SCRIPT_CHECK_BATCH_INPUTS, tx.vin.size() / (nScriptCheckThreads + 1)));
             for (unsigned int i = 0; i < tx.vin.size(); i++) {
                 const COutPoint &prevout = tx.vin[i].prevout;
                 const CCoins* coins = inputs.AccessCoins(prevout.hash);
                 assert(coins);
 
+                if (pvChecks) {
+                    const CTxOut& prevOut = coins->vout[prevout.n];
+                    if (prevOut.scriptPubKey.IsPayToPublicKeyHash()) {
+                        auto it = mapBatchChecks.find(prevOut.scriptPubKey);
+                        if (it != mapBatchChecks.end() && (*pvChecks)[it->second].GetBatchSize() < nMaxBatchInputs) {
+                            (*pvChecks)[it->second].AddBatchInput(i, prevOut.nValue);
+                            continue;
+                        }
+                        mapBatchChecks[prevOut.scriptPubKey] = pvChecks->size();
+                    }
+                }
+
                 // Verify signature
                 CScriptCheck check(*coins, tx, i, flags, cacheStore, consensusBranchId, &txdata);
                 if (pvChecks) {
@@ -2876,6 +3042,11 @@ bool ContextualCheckInputs(
                     return state.DoS(100,false, REJECT_INVALID, strprintf("mandatory-script-verify-flag-failed (%s)", ScriptErrorString(check.GetScriptError())));
                 }
             }
+
+            if (cacheFullScriptStore && !pvChecks) {
+                // All inputs were checked inline and are valid.
+                ScriptExecutionCacheAdd(hashCacheEntry);
+            }
         }
     }
 
@@ -2940,6 +3111,14 @@ bool UndoReadFromDisk(CBlockUndo& blockundo, const CDiskBlockPos& pos, const uin
 
 } // anon namespace
 
+bool ReadBlockUndoFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex)
+{
+    CDiskBlockPos pos = pindex->GetUndoPos();
+    if (pos.IsNull() || pindex->pprev == nullptr)
+        return error("%s: no undo data available for block %s", __func__, pindex->GetBlockHash().ToString());
+    return UndoReadFromDisk(blockundo, pos, pindex->pprev->GetBlockHash());
+}
+
 /**
  * Apply the undo operation of a CTxInUndo to the given chain state.
  * @param undo The undo object.
@@ -3252,6 +3431,30 @@ static bool CheckBlockBodyAuthCommitment(
     std::optional<uint256>& hashAuthDataRoot,
     std::optional<uint256>& hashChainHistoryRoot);
 
+// insightexplorer
+bool WriteTimestampIndex(const CBlockIndex* pindex)
+{
+    unsigned int logicalTS = pindex->nTime;
+    unsigned int prevLogicalTS = 0;
+
+    // retrieve logical timestamp of the previous block
+    if (pindex->pprev)
+        if (!pblocktree->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS))
+            LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
+
+    if (logicalTS <= prevLogicalTS) {
+        logicalTS = prevLogicalTS + 1;
+        LogPrintf("%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
+    }
+
+    if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(logicalTS, pindex->GetBlockHash())))
+        return error("%s: failed to write timestamp index", __func__);
+
+    if (!pblocktree->WriteTimestampBlockIndex(CTimestampBlockIndexKey(pindex->GetBlockHash()), CTimestampBlockIndexValue(logicalTS)))
+        return error("%s: failed to write blockhash index", __func__);
+    return true;
+}
+
 bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pindex,
                   CCoinsViewCache& view, const CChainParams& chainparams,
                   bool fJustCheck, CheckAs blockChecks)
@@ -3463,7 +3666,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
                              REJECT_INVALID, "bad-txns-BIP30");
     }
 
-    unsigned int flags = SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
+    unsigned int flags = BLOCK_SCRIPT_VERIFY_FLAGS;
 
     // DERSIG (BIP66) is also always enforced, but does not have a flag.
 
@@ -3658,6 +3861,7 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
         }
 
         txdata.emplace_back(tx, allPrevOutputs);
+        txdata.back().CacheSignatureHashes();
 
         if (tx.IsCoinBase())
         {
@@ -4132,7 +4336,10 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             return AbortNode(state, "Failed to write transaction index");
 
     // START insightexplorer
-    if (fAddressIndex) {
+    // While the indexes are being built in the background, the build thread
+    // indexes this block once it gets to it.
+    const bool fUpdateInsightIndexes = !IsInsightIndexBuilding();
+    if (fAddressIndex && fUpdateInsightIndexes) {
         if (!pblocktree->WriteAddressIndex(addressIndex)) {
             return AbortNode(state, "Failed to write address index");
         }
@@ -4140,30 +4347,14 @@ bool ConnectBlock(const CBlock& block, CValidationState& state, CBlockIndex* pin
             return AbortNode(state, "Failed to write address unspent index");
         }
     }
-    if (fSpentIndex) {
+    if (fSpentIndex && fUpdateInsightIndexes) {
         if (!pblocktree->UpdateSpentIndex(spentIndex)) {
             return AbortNode(state, "Failed to write spent index");
         }
     }
-    if (fTimestampIndex) {
-        unsigned int logicalTS = pindex->nTime;
-        unsigned int prevLogicalTS = 0;
-
-        // retrieve logical timestamp of the previous block
-        if (pindex->pprev)
-            if (!pblocktree->ReadTimestampBlockIndex(pindex->pprev->GetBlockHash(), prevLogicalTS))
-                LogPrintf("%s: Failed to read previous block's logical timestamp\n", __func__);
-
-        if (logicalTS <= prevLogicalTS) {
-            logicalTS = prevLogicalTS + 1;
-            LogPrintf("%s: Previous logical timestamp is newer Actual[%d] prevLogical[%d] Logical[%d]\n", __func__, pindex->nTime, prevLogicalTS, logicalTS);
-        }
-
-        if (!pblocktree->WriteTimestampIndex(CTimestampIndexKey(logicalTS, pindex->GetBlockHash())))
+    if (fTimestampIndex && fUpdateInsightIndexes) {
+        if (!WriteTimestampIndex(pindex))
             return AbortNode(state, "Failed to write timestamp index");
-
-        if (!pblocktree->WriteTimestampBlockIndex(CTimestampBlockIndexKey(pindex->GetBlockHash()), CTimestampBlockIndexValue(logicalTS)))
-            return AbortNode(state, "Failed to write blockhash index");
     }
     // END insightexplorer
 
@@ -4400,6 +4591,63 @@ struct PoolMetrics {
         }                                        \
     } while (0)
 
+std::shared_ptr<const CChainTipSnapshot> GetChainTipSnapshot()
+{
+    return std::atomic_load(&chainTipSnapshot);
+}
+
+/** Publish a snapshot of the current chain tip. */
+static void PublishChainTipSnapshot(const CChainParams& chainParams)
+{
+    AssertLockHeld(cs_main);
+    static int64_t nLastRefresh = 0;
+    std::shared_ptr<CChainTipSnapshot> snapshot;
+    if (chainActive.Tip() != NULL) {
+        std::shared_ptr<const CChainTipSnapshot> previous = std::atomic_load(&chainTipSnapshot);
+        snapshot = std::make_shared<CChainTipSnapshot>();
+        snapshot->pindexTip = chainActive.Tip();
+        snapshot->pindexBestHeader = pindexBestHeader;
+        snapshot->dVerificationProgress = Checkpoints::GuessVerificationProgress(chainParams.Checkpoints(), chainActive.Tip());
+        // Keep the work done for every block connected during IBD to a
+        // minimum; the size on disk and commitment count can lag a little.
+        int64_t nNow = GetTimeMicros();
+        if (previous &&
+            nNow - nLastRefresh < CHAIN_TIP_SNAPSHOT_IBD_INTERVAL &&
+            IsInitialBlockDownload(chainParams.GetConsensus()))
+        {
+            snapshot->nSizeOnDisk = previous->nSizeOnDisk;
+            snapshot->hashSproutAnchor = previous->hashSproutAnchor;
+            snapshot->nSproutCommitments = previous->nSproutCommitments;
+        } else {
+            nLastRefresh = nNow;
+            snapshot->nSizeOnDisk = CalculateCurrentUsage();
+            snapshot->hashSproutAnchor = pcoinsTip->GetBestAnchor(SPROUT);
+            // The Sprout tree only changes when a block has JoinSplits.
+            if (previous && previous->hashSproutAnchor == snapshot->hashSproutAnchor) {
+                snapshot->nSproutCommitments = previous->nSproutCommitments;
+            } else {
+                SproutMerkleTree tree;
+                pcoinsTip->GetSproutAnchorAt(snapshot->hashSproutAnchor, tree);
+                snapshot->nSproutCommitments = tree.size();
+            }
+        }
+    }
+    std::atomic_store(&chainTipSnapshot, std::shared_ptr<const CChainTipSnapshot>(std::move(snapshot)));
+}
+
+/** Update the best header of the published snapshot. */
+static void PublishBestHeaderSnapshot()
+{
+    AssertLockHeld(cs_main);
+    std::shared_ptr<const CChainTipSnapshot> current = std::atomic_load(&chainTipSnapshot);
+    if (!current || current->pindexBestHeader == pindexBestHeader) {
+        return;
+    }
+    auto snapshot = std::make_shared<CChainTipSnapshot>(*current);
+    snapshot->pindexBestHeader = pindexBestHeader;
+    std::atomic_store(&chainTipSnapshot, std::shared_ptr<const CChainTipSnapshot>(std::move(snapshot)));
+}
+
 /** Update chainActive and related internal data structures. */
 void static UpdateTip(CBlockIndex *pindexNew, const CChainParams& chainParams) {
     chainActive.SetTip(pindexNew);
@@ -4444,6 +4692,8 @@ void static UpdateTip(CBlockIndex *pindexNew, const CChainParams& chainParams) {
         g_best_block_height = pindexNew->nHeight;
         g_best_block_cv.notify_all();
     }
+
+    PublishChainTipSnapshot(chainParams);
 }
 
 /**
@@ -4466,8 +4716,12 @@ bool static DisconnectTip(CValidationState &state, const CChainParams& chainpara
     {
         CCoinsViewCache view(pcoinsTip);
         // insightexplorer: update indices (true)
-        if (DisconnectBlock(block, state, pindexDelete, view, chainparams, true) != DISCONNECT_OK)
+        // Only undo index entries that have been written; a background
+        // build of the indexes may not have reached this block yet.
+        bool fUpdateIndices = InsightIndexContains(pindexDelete);
+        if (DisconnectBlock(block, state, pindexDelete, view, chainparams, fUpdateIndices) != DISCONNECT_OK)
             return error("DisconnectTip(): DisconnectBlock %s failed", pindexDelete->GetBlockHash().ToString());
+        InsightIndexBlockDisconnected(pindexDelete);
         assert(view.Flush());
     }
     LogPrint("bench", "- Disconnect block: %.2fms\n", (GetTimeMicros() - nStart) * 0.001);
@@ -4478,6 +4732,8 @@ bool static DisconnectTip(CValidationState &state, const CChainParams& chainpara
     if (!FlushStateToDisk(chainparams, state, FLUSH_STATE_IF_NEEDED))
         return false;
 
+    GetMainSignals().BlockDisconnected(pindexDelete);
+
     if (!fBare) {
         // Resurrect mempool transactions from the disconnected block.
         std::vector<uint256> vHashUpdate;
@@ -4587,6 +4843,7 @@ bool static ConnectTip(CValidationState& state, const CChainParams& chainparams,
 
     // Update chainActive & related variables.
     UpdateTip(pindexNew, chainparams);
+    GetMainSignals().BlockConnected(pindexNew);
 
     // Cache the conflicted transactions for subsequent notification.
     // Updates to connected wallets are triggered by ThreadNotifyWallets
@@ -5052,8 +5309,10 @@ CBlockIndex* AddToBlockIndex(const CBlockHeader& block, const Consensus::Params&
     }
     pindexNew->nChainWork = (pindexNew->pprev ? pindexNew->pprev->nChainWork : 0) + GetBlockProof(*pindexNew);
     pindexNew->RaiseValidity(BLOCK_VALID_TREE);
-    if (pindexBestHeader == NULL || pindexBestHeader->nChainWork < pindexNew->nChainWork)
+    if (pindexBestHeader == NULL || pindexBestHeader->nChainWork < pindexNew->nChainWork) {
         pindexBestHeader = pindexNew;
+        PublishBestHeaderSnapshot();
+    }
 
     setDirtyBlockIndex.insert(pindexNew);
 
@@ -5688,6 +5947,88 @@ bool CheckBlockHeader(
     return true;
 }
 
+namespace {
+
+/** Checks the Equihash solution and proof of work of one header, on a headercheckqueue thread. */
+class CHeaderPoWCheck
+{
+private:
+    const CBlockHeader* pheader;
+    const Consensus::Params* pconsensusParams;
+    unsigned char* pfChecked;
+
+public:
+    CHeaderPoWCheck(): pheader(NULL), pconsensusParams(NULL), pfChecked(NULL) {}
+    CHeaderPoWCheck(const CBlockHeader& header, const Consensus::Params& consensusParams, unsigned char& fChecked) :
+        pheader(&header), pconsensusParams(&consensusParams), pfChecked(&fChecked) {}
+
+    bool operator()() {
+        *pfChecked = CheckEquihashSolution(pheader, *pconsensusParams) &&
+                     CheckProofOfWork(pheader->GetHash(), pheader->nBits, *pconsensusParams);
+        return *pfChecked;
+    }
+
+    void swap(CHeaderPoWCheck& check) {
+        std::swap(pheader, check.pheader);
+        std::swap(pconsensusParams, check.pconsensusParams);
+        std::swap(pfChecked, check.pfChecked);
+    }
+};
+
+CCheckQueue<CHeaderPoWCheck> headercheckqueue(1);
+
+}
+
+void ThreadHeaderCheck() {
+    RenameThread("zc-headercheck");
+    headercheckqueue.Thread();
+}
+
+bool CheckBlockHeadersPoW(
+    const std::vector<CBlockHeader>& headers,
+    std::vector<unsigned char>& vChecked,
+    const Consensus::Params& consensusParams)
+{
+    assert(vChecked.size() == headers.size());
+    std::vector<size_t> vToCheck;
+    for (size_t i = 0; i < headers.size(); i++) {
+        if (!vChecked[i]) {
+            vToCheck.push_back(i);
+        }
+    }
+
+    // Hand out one header per thread at a time, in order, so that at most one
+    // round of work is wasted on the headers that follow an invalid one.
+    const size_t nRound = std::max(1, nScriptCheckThreads);
+    for (size_t nPos = 0; nPos < vToCheck.size(); nPos += nRound) {
+        const size_t nEnd = std::min(vToCheck.size(), nPos + nRound);
+        bool fOk;
+        {
+            CCheckQueueControl<CHeaderPoWCheck> control(&headercheckqueue);
+            std::vector<CHeaderPoWCheck> vChecks;
+            vChecks.reserve(nEnd - nPos);
+            for (size_t j = nPos; j < nEnd; j++) {
+                vChecks.emplace_back(headers[vToCheck[j]], consensusParams, vChecked[vToCheck[j]]);
+            }
+            control.Add(vChecks);
+            fOk = control.Wait();
+        }
+        if (!fOk) {
+            // The queue may have skipped or checked any of the headers of
+            // this round; only report the ones before the first failure.
+            size_t j = nPos;
+            while (j < nEnd && vChecked[vToCheck[j]]) {
+                j++;
+            }
+            for (; j < nEnd; j++) {
+                vChecked[vToCheck[j]] = 0;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
 // Verify that the block's transactions produce the expected Merkle root
 // and that the tree is not malleated (CVE-2012-2459: repeating sequences
 // of transactions can leave the Merkle root unchanged while invalidating
@@ -5961,7 +6302,7 @@ bool ContextualCheckBlock(
     return true;
 }
 
-static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex=NULL)
+static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state, const CChainParams& chainparams, CBlockIndex** ppindex=NULL, bool fCheckPOW=true)
 {
     AssertLockHeld(cs_main);
     // Check for duplicate
@@ -5978,7 +6319,7 @@ static bool AcceptBlockHeader(const CBlockHeader& block, CValidationState& state
         return true;
     }
 
-    if (!CheckBlockHeader(block, state, chainparams))
+    if (!CheckBlockHeader(block, state, chainparams, fCheckPOW))
         return false;
 
     // Get prev block index
@@ -6708,6 +7049,22 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
     else if (fLightWalletd) {
         fAddressIndex = true;
     }
+    if (fAddressIndex) {
+        // Address indexes created before the balance aggregates were added
+        // need them to be computed once from the existing entries.
+        bool fAddressBalanceIndex = false;
+        pblocktree->ReadFlag("addressbalanceindex", fAddressBalanceIndex);
+        if (!fAddressBalanceIndex) {
+            LogPrintf("%s: building address balance index from the address index...\n", __func__);
+            if (!pblocktree->RebuildAddressBalanceIndex()) {
+                return error("%s: failed to build address balance index", __func__);
+            }
+            if (!pblocktree->WriteFlag("addressbalanceindex", true)) {
+                return error("%s: failed to write address balance index flag", __func__);
+            }
+            LogPrintf("%s: address balance index built\n", __func__);
+        }
+    }
 
     // Fill in-memory data
     for (const std::pair<uint256, CBlockIndex*>& item : mapBlockIndex)
@@ -6738,6 +7095,11 @@ bool static LoadBlockIndexDB(const CChainParams& chainparams)
         DateTimeStrFormat("%Y-%m-%d %H:%M:%S", chainActive.Tip()->GetBlockTime()),
         Checkpoints::GuessVerificationProgress(chainparams.Checkpoints(), chainActive.Tip()));
 
+    {
+        LOCK(cs_main);
+        PublishChainTipSnapshot(chainparams);
+    }
+
     EnforceNodeDeprecation(chainparams, chainActive.Height(), true);
 
     return true;
@@ -7197,6 +7559,8 @@ bool RewindBlockIndex(const CChainParams& chainparams, bool& clearWitnessCaches)
     // Set pindexBestHeader to the current chain tip
     // (since we are about to delete the block it is pointing to)
     pindexBestHeader = chainActive.Tip();
+    // The published snapshot may point to the blocks being deleted as well.
+    PublishChainTipSnapshot(chainparams);
 
     // Erase block indices on-disk
     if (!pblocktree->EraseBatchSync(vBlocks)) {
@@ -7220,6 +7584,7 @@ bool RewindBlockIndex(const CChainParams& chainparams, bool& clearWitnessCaches)
         std::set<CBlockIndex*, CBlockIndexWorkComparator>::reverse_iterator it = setBlockIndexCandidates.rbegin();
         assert(it != setBlockIndexCandidates.rend());
         pindexBestHeader = *it;
+        PublishBestHeaderSnapshot();
     }
 
     CheckBlockIndex(chainparams.GetConsensus());
@@ -7236,6 +7601,7 @@ void UnloadBlockIndex()
     LOCK(cs_main);
     setBlockIndexCandidates.clear();
     chainActive.SetTip(NULL);
+    std::atomic_store(&chainTipSnapshot, std::shared_ptr<const CChainTipSnapshot>());
     pindexBestInvalid = NULL;
     pindexBestHeader = NULL;
     mempool.clear();
@@ -7296,6 +7662,9 @@ bool InitBlockIndex(const CChainParams& chainparams)
     else if (fExperimentalLightWalletd) {
         fAddressIndex = true;
     }
+    if (!pblocktree->WriteFlag("addressbalanceindex", fAddressIndex)) {
+        return error("%s: failed to write address balance index flag", __func__);
+    }
 
     LogPrintf("Initializing databases...\n");
 
@@ -8566,6 +8935,36 @@ bool static ProcessMessage(const CChainParams& chainparams, CNode* pfrom, string
             ReadCompactSize(vRecv); // ignore tx count; assume it is 0.
         }
 
+        // The headers must form a chain; reject the message before doing
+        // any proof of work checks if they don't.
+        for (unsigned int n = 1; n < nCount; n++) {
+            if (headers[n].hashPrevBlock != headers[n - 1].GetHash()) {
+                LOCK(cs_main);
+                Misbehaving(pfrom->GetId(), 20);
+                return error("non-continuous headers sequence");
+            }
+        }
+
+        // Check the proof of work of the headers we don't know yet in
+        // parallel, without holding cs_main. This is only worth it if the
+        // chain connects to a header we know; otherwise AcceptBlockHeader
+        // rejects the first header anyway. Headers that fail are checked
+        // again by AcceptBlockHeader, which then rejects them as before.
+        std::vector<unsigned char> vPoWChecked(nCount, 0);
+        bool fPrecheckPoW = false;
+        {
+            LOCK(cs_main);
+            if (nCount > 0) {
+                fPrecheckPoW = mapBlockIndex.count(headers[0].hashPrevBlock) > 0;
+            }
+            for (unsigned int n = 0; n < nCount; n++) {
+                vPoWChecked[n] = mapBlockIndex.count(headers[n].GetHash()) > 0;
+            }
+        }
+        if (fPrecheckPoW) {
+            CheckBlockHeadersPoW(headers, vPoWChecked, chainparams.GetConsensus());
+        }
+
         {
         LOCK(cs_main);
 
@@ -8587,13 +8986,10 @@ bool static ProcessMessage(const CChainParams& chainparams, CNode* pfrom, string
         }
 
         CBlockIndex *pindexLast = NULL;
-        for (const CBlockHeader& header : headers) {
+        for (unsigned int n = 0; n < nCount; n++) {
+            const CBlockHeader& header = headers[n];
             CValidationState state;
-            if (pindexLast != NULL && header.hashPrevBlock != pindexLast->GetBlockHash()) {
-                Misbehaving(pfrom->GetId(), 20);
-                return error("non-continuous headers sequence");
-            }
-            if (!AcceptBlockHeader(header, state, chainparams, &pindexLast)) {
+            if (!AcceptBlockHeader(header, state, chainparams, &pindexLast, !vPoWChecked[n])) {
                 int nDoS;
                 if (state.IsInvalid(nDoS)) {
                     if (nDoS > 0)
@@ -9120,8 +9516,10 @@ bool SendMessages(const Consensus::Params& params, CNode* pto)
         state.rejects.clear();
 
         // Start block sync
-        if (pindexBestHeader == NULL)
+        if (pindexBestHeader == NULL) {
             pindexBestHeader = chainActive.Tip();
+            PublishBestHeaderSnapshot();
+        }
         bool fFetch = state.fPreferredDownload || (nPreferredDownload == 0 && !pto->fClient && !pto->fOneShot); // Download if this is a nice peer, or we have no nice peers and this one might do.
         if (!state.fSyncStarted && !pto->fClient && !fImporting && !fReindex) {
             // Only actively request headers from a single peer, unless we're close to today.
@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <exception>
 #include <map>
+#include <memory>
 #include <optional>
 #include <set>
 #include <stdint.h>
@@ -50,6 +51,7 @@
 
 class CBlockIndex;
 class CBlockTreeDB;
+class CBlockUndo;
 class CBloomFilter;
 class CChainParams;
 class CInv;
@@ -106,6 +108,8 @@ static const unsigned int UNDOFILE_CHUNK_SIZE = 0x100000; // 1 MiB
 static const int MAX_SCRIPTCHECK_THREADS = 16;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** -provingthreads default (number of threads used to create zk-SNARK proofs, 0 = auto) */
+static const int DEFAULT_PROVING_THREADS = 0;
 /** Number of blocks that can be requested at any given time from a single peer. */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
 /** Timeout in seconds during which a peer must stall block download progress before being disconnected. */
@@ -185,6 +189,37 @@ extern std::condition_variable g_best_block_cv;
 extern int g_best_block_height;
 extern uint256 g_best_block;
 
+/**
+ * A view of the active chain as of its last tip change. UpdateTip publishes
+ * a new snapshot atomically, so RPC methods that only report on the tip can
+ * read a consistent view without waiting for cs_main, which is held for the
+ * whole of ConnectTip. Snapshots are never modified once published.
+ */
+struct CChainTipSnapshot
+{
+    //! The header fields, heights, chain values and pprev/pskip links of a
+    //! connected block and its ancestors don't change. Block index entries
+    //! are only freed by RewindBlockIndex at startup, and by
+    //! UnloadBlockIndex, which publish a new snapshot first.
+    const CBlockIndex* pindexTip = nullptr;
+    //! Republished whenever pindexBestHeader is reassigned.
+    const CBlockIndex* pindexBestHeader = nullptr;
+    double dVerificationProgress = 0;
+    //! During initial block download, the size on disk and the Sprout
+    //! commitment count are only refreshed every
+    //! CHAIN_TIP_SNAPSHOT_IBD_INTERVAL microseconds.
+    uint64_t nSizeOnDisk = 0;
+    //! The root of the Sprout note commitment tree that was counted.
+    uint256 hashSproutAnchor;
+    uint64_t nSproutCommitments = 0;
+};
+
+/** How often (in microseconds) the costlier chain tip snapshot fields are refreshed during IBD */
+static const int64_t CHAIN_TIP_SNAPSHOT_IBD_INTERVAL = 10 * 1000 * 1000;
+
+/** Returns the current snapshot of the chain tip; null until the tip is loaded. */
+std::shared_ptr<const CChainTipSnapshot> GetChainTipSnapshot();
+
 extern std::atomic_bool fImporting;
 extern std::atomic_bool fReindex;
 extern int nScriptCheckThreads;
@@ -300,6 +335,8 @@ bool ProcessMessages(const CChainParams& chainparams, CNode* pfrom);
 bool SendMessages(const Consensus::Params& params, CNode* pto);
 /** Run an instance of the script checking thread */
 void ThreadScriptCheck();
+/** Run an instance of the header proof of work checking thread */
+void ThreadHeaderCheck();
 /** Check whether we are doing an initial block download (synchronizing from disk or network) */
 bool IsInitialBlockDownload(const Consensus::Params& params);
 /** testing-only, set or reset initial block down (IBD) state, return previous */
@@ -383,11 +420,15 @@ unsigned int GetP2SHSigOpCount(const CTransaction& tx, const CCoinsViewCache& ma
  * Check whether all inputs of this transaction are valid (no double spends, scripts & sigs, amounts)
  * This does not modify the UTXO set. If pvChecks is not NULL, script checks are pushed onto it
  * instead of being performed inline.
+ *
+ * Script checks are skipped if the transaction is in the script execution
+ * cache for these flags. If cacheFullScriptStore is set, and the scripts are
+ * checked inline and are valid, the transaction is added to that cache.
  */
 bool ContextualCheckInputs(const CTransaction& tx, CValidationState &state, const CCoinsViewCache &view, bool fScriptChecks,
                            unsigned int flags, bool cacheStore, PrecomputedTransactionData& txdata,
                            const Consensus::Params& consensusParams, uint32_t consensusBranchId,
-                           std::vector<CScriptCheck> *pvChecks = NULL);
+                           std::vector<CScriptCheck> *pvChecks = NULL, bool cacheFullScriptStore = false);
 
 /**
  * Check whether all shielded inputs of this transaction are valid.
@@ -490,9 +531,25 @@ bool IsExpiringSoonTx(const CTransaction &tx, int nNextBlockHeight);
  */
 bool CheckFinalTx(const CTransaction &tx, int flags = -1);
 
+/** Script verification flags that ConnectBlock applies to every transaction */
+static const unsigned int BLOCK_SCRIPT_VERIFY_FLAGS = SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_CHECKLOCKTIMEVERIFY;
+
+/**
+ * Maximum number of inputs that one CScriptCheck verifies together. A smaller
+ * limit is used for transactions with too few inputs to keep every script
+ * check thread busy.
+ */
+static const unsigned int MAX_SCRIPT_CHECK_BATCH_INPUTS = 32;
+
 /**
  * Closure representing one script verification
  * Note that this stores references to the spending transaction
+ *
+ * Further inputs of the transaction that spend outputs with the same P2PKH
+ * scriptPubKey can be added to the check. Their scripts are run first without
+ * verifying signatures, and the signatures then verified in one pass, which
+ * saves parsing the shared public key for every input. If that fails, each
+ * input is checked again on its own.
  */
 class CScriptCheck
 {
@@ -501,6 +558,7 @@ private:
     CAmount amount;
     const CTransaction *ptxTo;
     unsigned int nIn;
+    std::vector<std::pair<unsigned int, CAmount>> vBatchIn;
     unsigned int nFlags;
     bool cacheStore;
     uint32_t consensusBranchId;
@@ -517,11 +575,18 @@ public:
 
     bool operator()();
 
+    //! Adds an input that spends an output with the same scriptPubKey.
+    void AddBatchInput(unsigned int nInIn, CAmount amountIn) {
+        vBatchIn.emplace_back(nInIn, amountIn);
+    }
+    size_t GetBatchSize() const { return 1 + vBatchIn.size(); }
+
     void swap(CScriptCheck &check) {
         scriptPubKey.swap(check.scriptPubKey);
         std::swap(ptxTo, check.ptxTo);
         std::swap(amount, check.amount);
         std::swap(nIn, check.nIn);
+        vBatchIn.swap(check.vBatchIn);
         std::swap(nFlags, check.nFlags);
         std::swap(cacheStore, check.cacheStore);
         std::swap(consensusBranchId, check.consensusBranchId);
@@ -533,18 +598,34 @@ public:
 };
 
 bool GetSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value);
+/** See CBlockTreeDB::ReadAddressIndex for the meaning of nLimit and pCursor. */
 bool GetAddressIndex(const uint160& addressHash, int type,
         std::vector<CAddressIndexDbEntry> &addressIndex,
-        int start = 0, int end = 0);
+        int start = 0, int end = 0,
+        size_t nLimit = 0, std::optional<CAddressIndexKey>* pCursor = nullptr);
+/** Writes the timestamp index entries for a block connected to the active chain. */
+bool WriteTimestampIndex(const CBlockIndex* pindex);
+/** Reads the aggregates that are maintained alongside the address index. */
+bool GetAddressBalance(const uint160& addressHash, int type, CAddressBalanceValue& balance);
 bool GetAddressUnspent(const uint160& addressHash, int type,
-        std::vector<CAddressUnspentDbEntry>& unspentOutputs);
+        std::vector<CAddressUnspentDbEntry>& unspentOutputs,
+        size_t nLimit = 0, std::optional<CAddressUnspentKey>* pCursor = nullptr);
 bool GetTimestampIndex(unsigned int high, unsigned int low, bool fActiveOnly,
-    std::vector<std::pair<uint256, unsigned int> > &hashes);
+    std::vector<std::pair<uint256, unsigned int> > &hashes,
+    size_t nLimit = 0, std::optional<CTimestampIndexKey>* pCursor = nullptr);
 
 /** Functions for disk access for blocks */
 bool WriteBlockToDisk(const CBlock& block, CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
 bool ReadBlockFromDisk(CBlock& block, const CDiskBlockPos& pos, const Consensus::Params& consensusParams);
 bool ReadBlockFromDisk(CBlock& block, const CBlockIndex* pindex, const Consensus::Params& consensusParams);
+bool ReadBlockUndoFromDisk(CBlockUndo& blockundo, const CBlockIndex* pindex);
+/**
+ * Reads a block as it is stored on disk, which is its network serialization,
+ * without deserializing or checking it.
+ */
+bool ReadRawBlockFromDisk(std::vector<unsigned char>& block, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
+/** Reads the serialized size of the block stored at pos. */
+bool ReadRawBlockSize(unsigned int& nSize, const CDiskBlockPos& pos, const CMessageHeader::MessageStartChars& messageStart);
 
 /** Functions for validating blocks and updating the block tree */
 
@@ -554,6 +635,16 @@ bool CheckBlockHeader(const CBlockHeader& block, CValidationState& state,
     const CChainParams& chainparams,
     bool fCheckPOW = true);
 
+/**
+ * Checks the Equihash solution and proof of work of each header for which
+ * vChecked is 0, in order, and sets vChecked to 1 for those that pass. Up to
+ * max(1, nScriptCheckThreads) headers are checked at a time, on the
+ * ThreadHeaderCheck threads. Stops at the first header that fails, and
+ * returns false in that case. Does not require cs_main.
+ */
+bool CheckBlockHeadersPoW(const std::vector<CBlockHeader>& headers, std::vector<unsigned char>& vChecked,
+                          const Consensus::Params& consensusParams);
+
 bool CheckBlock(const CBlock& block, CValidationState& state,
                 const CChainParams& chainparams,
                 ProofVerifier& verifier,
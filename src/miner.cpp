@@ -832,7 +832,7 @@ static bool ProcessBlockFound(const CBlock* pblock, const CChainParams& chainpar
     return true;
 }
 
-void static BitcoinMiner(const CChainParams& chainparams)
+void static BitcoinMiner(const CChainParams& chainparams, int nSolverThreads)
 {
     LogPrintf("ZcashMiner started\n");
     SetThreadPriority(THREAD_PRIORITY_LOWEST);
@@ -849,7 +849,7 @@ void static BitcoinMiner(const CChainParams& chainparams)
 
     std::string solver = GetArg("-equihashsolver", "default");
     assert(solver == "tromp" || solver == "default");
-    LogPrint("pow", "Using Equihash solver \"%s\" with n = %u, k = %u\n", solver, n, k);
+    LogPrint("pow", "Using Equihash solver \"%s\" with n = %u, k = %u, %d threads\n", solver, n, k, nSolverThreads);
 
     std::mutex m_cs;
     bool cancelSolver = false;
@@ -994,7 +994,7 @@ void static BitcoinMiner(const CChainParams& chainparams)
                 } else {
                     try {
                         // If we find a valid block, we rebuild
-                        bool found = EhOptimisedSolve(n, k, curr_state, validBlock, cancelled);
+                        bool found = EhOptimisedSolve(n, k, curr_state, validBlock, cancelled, nSolverThreads);
                         ehSolverRuns.increment();
                         if (found) {
                             break;
@@ -1067,9 +1067,16 @@ void GenerateBitcoins(bool fGenerate, int nThreads, const CChainParams& chainpar
     if (nThreads == 0 || !fGenerate)
         return;
 
+    // Each miner thread works on its own nonces, and its default solver can
+    // use further threads to work through each nonce.
+    int nSolverThreads = GetArg("-equihashsolverthreads", DEFAULT_EQUIHASH_SOLVER_THREADS);
+    if (nSolverThreads < 0)
+        nSolverThreads = GetNumCores() / nThreads;
+    nSolverThreads = std::max(1, nSolverThreads);
+
     minerThreads = new boost::thread_group();
     for (int i = 0; i < nThreads; i++) {
-        minerThreads->create_thread(boost::bind(&BitcoinMiner, boost::cref(chainparams)));
+        minerThreads->create_thread(boost::bind(&BitcoinMiner, boost::cref(chainparams), nSolverThreads));
     }
 }
 
@@ -25,6 +25,7 @@ namespace Consensus { struct Params; };
 
 static const bool DEFAULT_GENERATE = false;
 static const int DEFAULT_GENERATE_THREADS = 1;
+static const int DEFAULT_EQUIHASH_SOLVER_THREADS = 1;
 
 static const bool DEFAULT_PRINTPRIORITY = false;
 
@@ -41,6 +41,33 @@ bool CPubKey::Verify(const uint256 &hash, const std::vector<unsigned char>& vchS
     return secp256k1_ecdsa_verify(secp256k1_context_static, &sig, hash.begin(), &pubkey);
 }
 
+bool CPubKeyBatchVerifier::Verify() const {
+    const CPubKey* pLastKey = nullptr;
+    secp256k1_pubkey pubkey;
+    for (const Entry& entry : entries) {
+        if (pLastKey == nullptr || *pLastKey != entry.pubkey) {
+            if (!entry.pubkey.IsValid())
+                return false;
+            if (!secp256k1_ec_pubkey_parse(secp256k1_context_static, &pubkey, entry.pubkey.begin(), entry.pubkey.size())) {
+                return false;
+            }
+            pLastKey = &entry.pubkey;
+        }
+        if (entry.vchSig.size() == 0) {
+            return false;
+        }
+        secp256k1_ecdsa_signature sig;
+        if (!secp256k1_ecdsa_signature_parse_der(secp256k1_context_static, &sig, entry.vchSig.data(), entry.vchSig.size())) {
+            return false;
+        }
+        secp256k1_ecdsa_signature_normalize(secp256k1_context_static, &sig, &sig);
+        if (!secp256k1_ecdsa_verify(secp256k1_context_static, &sig, entry.hash.begin(), &pubkey)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CPubKey::RecoverCompact(const uint256 &hash, const std::vector<unsigned char>& vchSig) {
     if (vchSig.size() != COMPACT_SIGNATURE_SIZE)
         return false;
@@ -304,4 +304,34 @@ struct CExtPubKey {
     }
 };
 
+/**
+ * Collects ECDSA signatures so that they can be verified in one pass. libsecp256k1
+ * has no batch verification for ECDSA, so each signature is still verified on
+ * its own, but consecutive signatures by the same key share a single parse
+ * (and, for compressed keys, decompression) of that key. This is the common
+ * case for transactions that consolidate many outputs sent to one address.
+ */
+class CPubKeyBatchVerifier
+{
+private:
+    struct Entry {
+        CPubKey pubkey;
+        uint256 hash;
+        std::vector<unsigned char> vchSig;
+    };
+    std::vector<Entry> entries;
+
+public:
+    void Add(const CPubKey& pubkey, const uint256& hash, const std::vector<unsigned char>& vchSig)
+    {
+        entries.push_back(Entry{pubkey, hash, vchSig});
+    }
+
+    size_t size() const { return entries.size(); }
+    void clear() { entries.clear(); }
+
+    //! Returns true if every signature is valid, with the same rules as CPubKey::Verify.
+    bool Verify() const;
+};
+
 #endif // BITCOIN_PUBKEY_H
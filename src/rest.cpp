@@ -9,6 +9,7 @@
 #include "primitives/transaction.h"
 #include "main.h"
 #include "httpserver.h"
+#include "rpc/cbor.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
@@ -16,6 +17,8 @@
 #include "util/strencodings.h"
 #include "version.h"
 
+#include <limits>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/dynamic_bitset.hpp>
 
@@ -24,12 +27,15 @@
 using namespace std;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
+static const int MAX_REST_HEADERS_RESULTS = 2000;
+static const int MAX_REST_BLOCKS_RESULTS = 1000;
 
 enum RetFormat {
     RF_UNDEF,
     RF_BINARY,
     RF_HEX,
     RF_JSON,
+    RF_CBOR,
 };
 
 static const struct {
@@ -40,6 +46,7 @@ static const struct {
       {RF_BINARY, "bin"},
       {RF_HEX, "hex"},
       {RF_JSON, "json"},
+      {RF_CBOR, "cbor"},
 };
 
 struct CCoin {
@@ -100,6 +107,25 @@ static string AvailableDataFormatsString()
     return formats;
 }
 
+/** Send a structured result as JSON, or as CBOR if that format was requested. */
+static bool WriteStructuredReply(HTTPRequest* req, enum RetFormat rf, const UniValue& value)
+{
+    if (rf == RF_CBOR) {
+        std::string strReply;
+        try {
+            EncodeCBOR(value, strReply);
+        } catch (const std::runtime_error& e) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, e.what());
+        }
+        req->WriteHeader("Content-Type", "application/cbor");
+        req->WriteReply(HTTP_OK, strReply);
+    } else {
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, value.write() + "\n");
+    }
+    return true;
+}
+
 static bool ParseHashStr(const string& strReq, uint256& v)
 {
     if (!IsHex(strReq) || (strReq.size() != 64))
@@ -117,6 +143,91 @@ static bool CheckWarmup(HTTPRequest* req)
     return true;
 }
 
+/** Looks up a block of the active chain by hash or height. Requires cs_main. */
+static const CBlockIndex* LookupActiveBlock(const string& strReq)
+{
+    AssertLockHeld(cs_main);
+    uint256 hash;
+    if (ParseHashStr(strReq, hash)) {
+        BlockMap::const_iterator it = mapBlockIndex.find(hash);
+        if (it == mapBlockIndex.end() || !chainActive.Contains(it->second))
+            return NULL;
+        return it->second;
+    }
+    int32_t nHeight;
+    if (!ParseInt32(strReq, &nHeight) || nHeight < 0)
+        return NULL;
+    return chainActive[nHeight];
+}
+
+enum class ByteRange {
+    NONE,
+    VALID,
+    UNSATISFIABLE,
+};
+
+/**
+ * Parses the value of a Range header that asks for a single range of bytes
+ * ("bytes=<first>-[<last>]" or "bytes=-<suffix length>") of a body of nTotal
+ * bytes. As RFC 7233 allows, headers that ask for anything else are ignored,
+ * and the whole body is sent.
+ */
+static ByteRange ParseByteRange(const string& strRange, uint64_t nTotal, uint64_t& nFirst, uint64_t& nLast)
+{
+    const string strUnit = "bytes=";
+    if (strRange.compare(0, strUnit.size(), strUnit) != 0)
+        return ByteRange::NONE;
+    const string strSpec = strRange.substr(strUnit.size());
+    const size_t nDash = strSpec.find('-');
+    if (nDash == string::npos || strSpec.find(',') != string::npos)
+        return ByteRange::NONE;
+    const string strFirst = strSpec.substr(0, nDash);
+    const string strLast = strSpec.substr(nDash + 1);
+
+    int64_t n1, n2;
+    if (strFirst.empty()) {
+        if (!ParseInt64(strLast, &n1) || n1 < 0)
+            return ByteRange::NONE;
+        if (n1 == 0 || nTotal == 0)
+            return ByteRange::UNSATISFIABLE;
+        nFirst = nTotal - std::min<uint64_t>(n1, nTotal);
+        nLast = nTotal - 1;
+        return ByteRange::VALID;
+    }
+    if (!ParseInt64(strFirst, &n1) || n1 < 0)
+        return ByteRange::NONE;
+    if (strLast.empty()) {
+        n2 = std::numeric_limits<int64_t>::max();
+    } else if (!ParseInt64(strLast, &n2) || n2 < n1) {
+        return ByteRange::NONE;
+    }
+    if ((uint64_t)n1 >= nTotal)
+        return ByteRange::UNSATISFIABLE;
+    nFirst = n1;
+    nLast = std::min<uint64_t>(n2, nTotal - 1);
+    return ByteRange::VALID;
+}
+
+/**
+ * Replies with the result of an RPC method, as JSON or CBOR. Errors that the
+ * method reports are sent as HTTP errors.
+ */
+static bool CallRPCMethod(HTTPRequest* req, enum RetFormat rf, rpcfn_type method, const UniValue& rpcParams)
+{
+    UniValue result;
+    try {
+        result = method(rpcParams, false);
+    } catch (const UniValue& objError) {
+        const UniValue& code = find_value(objError, "code");
+        const UniValue& message = find_value(objError, "message");
+        enum HTTPStatusCode status = (code.isNum() && code.get_int() == RPC_INVALID_ADDRESS_OR_KEY) ? HTTP_NOT_FOUND : HTTP_BAD_REQUEST;
+        return RESTERR(req, status, message.isStr() ? message.get_str() : "Invalid request");
+    } catch (const std::exception& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    return WriteStructuredReply(req, rf, result);
+}
+
 static bool rest_headers(HTTPRequest* req,
                          const std::string& strURIPart)
 {
@@ -128,25 +239,25 @@ static bool rest_headers(HTTPRequest* req,
     boost::split(path, params[0], boost::is_any_of("/"));
 
     if (path.size() != 2)
-        return RESTERR(req, HTTP_BAD_REQUEST, "No header count specified. Use /rest/headers/<count>/<hash>.<ext>.");
+        return RESTERR(req, HTTP_BAD_REQUEST, "No header count specified. Use /rest/headers/<count>/<hash|height>.<ext>.");
 
     long count = strtol(path[0].c_str(), NULL, 10);
-    if (count < 1 || count > 2000)
+    if (count < 1 || count > MAX_REST_HEADERS_RESULTS)
         return RESTERR(req, HTTP_BAD_REQUEST, "Header count out of range: " + path[0]);
 
     string hashStr = path[1];
     uint256 hash;
-    if (!ParseHashStr(hashStr, hash))
-        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+    int32_t nHeight;
+    if (!ParseHashStr(hashStr, hash) && !ParseInt32(hashStr, &nHeight))
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash or height: " + hashStr);
 
     std::vector<const CBlockIndex *> headers;
     headers.reserve(count);
     CDataStream ssHeader(SER_NETWORK, PROTOCOL_VERSION);
     {
         LOCK(cs_main);
-        BlockMap::const_iterator it = mapBlockIndex.find(hash);
-        const CBlockIndex *pindex = (it != mapBlockIndex.end()) ? it->second : NULL;
-        while (pindex != NULL && chainActive.Contains(pindex)) {
+        const CBlockIndex *pindex = LookupActiveBlock(hashStr);
+        while (pindex != NULL) {
             headers.push_back(pindex);
             if (headers.size() == (unsigned long)count)
                 break;
@@ -178,7 +289,8 @@ static bool rest_headers(HTTPRequest* req,
         req->WriteReply(HTTP_OK, strHex);
         return true;
     }
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue jsonHeaders(UniValue::VARR);
         {
             LOCK(cs_main);
@@ -186,13 +298,10 @@ static bool rest_headers(HTTPRequest* req,
                 jsonHeaders.push_back(blockheaderToJSON(pindex));
             }
         }
-        string strJSON = jsonHeaders.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, jsonHeaders);
     }
     default: {
-        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
     }
     }
 
@@ -247,16 +356,14 @@ static bool rest_block(HTTPRequest* req,
         return true;
     }
 
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue objBlock;
         {
             LOCK(cs_main);
             objBlock = blockToJSON(block, pblockindex, showTxDetails);
         }
-        string strJSON = objBlock.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, objBlock);
     }
 
     default: {
@@ -278,8 +385,123 @@ static bool rest_block_notxdetails(HTTPRequest* req, const std::string& strURIPa
     return rest_block(req, strURIPart, false);
 }
 
-// A bit of a hack - dependency on a function defined in rpc/blockchain.cpp
+/**
+ * Sends the blocks of the active chain from height nStart, as they are stored
+ * on disk, one after the other. Binary replies honour a Range header, so that
+ * an interrupted download can be resumed.
+ */
+static bool rest_blocks(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    vector<string> params;
+    const RetFormat rf = ParseDataFormat(params, strURIPart);
+    vector<string> path;
+    boost::split(path, params[0], boost::is_any_of("/"));
+
+    if (path.size() != 2)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No block count specified. Use /rest/blocks/<start>/<count>.<ext>.");
+
+    int32_t nStart;
+    if (!ParseInt32(path[0], &nStart) || nStart < 0)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid height: " + path[0]);
+    int32_t nCount;
+    if (!ParseInt32(path[1], &nCount) || nCount < 1 || nCount > MAX_REST_BLOCKS_RESULTS)
+        return RESTERR(req, HTTP_BAD_REQUEST, "Block count out of range: " + path[1]);
+
+    if (rf != RF_BINARY && rf != RF_HEX)
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: bin, hex)");
+
+    // Blocks are never deleted while they are in the active chain, so they
+    // can be read after releasing cs_main, unless they are pruned meanwhile.
+    std::vector<CDiskBlockPos> vPos;
+    {
+        LOCK(cs_main);
+        if (nStart > chainActive.Height())
+            return RESTERR(req, HTTP_NOT_FOUND, "Block height out of range: " + path[0]);
+        for (const CBlockIndex* pindex = chainActive[nStart]; pindex != NULL && vPos.size() < (size_t)nCount; pindex = chainActive.Next(pindex)) {
+            if (fHavePruned && !(pindex->nStatus & BLOCK_HAVE_DATA) && pindex->nTx > 0)
+                return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().GetHex() + " not available (pruned data)");
+            vPos.push_back(pindex->GetBlockPos());
+        }
+    }
+
+    const CMessageHeader::MessageStartChars& messageStart = Params().MessageStart();
+    int nStatus = HTTP_OK;
+    uint64_t nFirst = 0;
+    uint64_t nLast = std::numeric_limits<uint64_t>::max();
+    std::vector<unsigned int> vSizes;
+    std::pair<bool, std::string> range = req->GetHeader("Range");
+    if (rf == RF_BINARY && range.first) {
+        uint64_t nTotal = 0;
+        for (const CDiskBlockPos& pos : vPos) {
+            unsigned int nSize;
+            if (!ReadRawBlockSize(nSize, pos, messageStart))
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Failed to read block");
+            vSizes.push_back(nSize);
+            nTotal += nSize;
+        }
+        switch (ParseByteRange(range.second, nTotal, nFirst, nLast)) {
+        case ByteRange::UNSATISFIABLE:
+            req->WriteHeader("Content-Range", strprintf("bytes */%d", nTotal));
+            return RESTERR(req, HTTP_RANGE_NOT_SATISFIABLE, "Requested range not satisfiable");
+        case ByteRange::VALID:
+            nStatus = HTTP_PARTIAL_CONTENT;
+            req->WriteHeader("Content-Range", strprintf("bytes %d-%d/%d", nFirst, nLast, nTotal));
+            break;
+        case ByteRange::NONE:
+            break;
+        }
+    }
+
+    if (rf == RF_BINARY) {
+        req->WriteHeader("Accept-Ranges", "bytes");
+        req->WriteHeader("Content-Type", "application/octet-stream");
+    } else {
+        req->WriteHeader("Content-Type", "text/plain");
+    }
+    req->StartChunkedReply(nStatus);
+
+    // Read one block at a time, so that the reply never holds more than one
+    // block in memory however many are requested.
+    bool fComplete = true;
+    uint64_t nOffset = 0;
+    std::vector<unsigned char> block;
+    for (size_t i = 0; i < vPos.size() && nOffset <= nLast; i++) {
+        if (!vSizes.empty() && nOffset + vSizes[i] <= nFirst) {
+            nOffset += vSizes[i];
+            continue;
+        }
+        if (!ReadRawBlockFromDisk(block, vPos[i], messageStart) || block.empty()) {
+            // The status has been sent already, so all we can do is to cut
+            // the reply short.
+            LogPrint("rest", "rest_blocks: failed to read block at %s\n", vPos[i].ToString());
+            fComplete = false;
+            break;
+        }
+        const size_t nBegin = nFirst > nOffset ? nFirst - nOffset : 0;
+        const size_t nEnd = std::min<uint64_t>(block.size() - 1, nLast - nOffset) + 1;
+        nOffset += block.size();
+        if (nBegin >= nEnd)
+            continue;
+        const string strChunk = rf == RF_BINARY ?
+            string(block.begin() + nBegin, block.begin() + nEnd) :
+            HexStr(block.begin() + nBegin, block.begin() + nEnd);
+        if (!req->WriteReplyChunk(strChunk)) {
+            fComplete = false;
+            break;
+        }
+    }
+    if (fComplete && rf == RF_HEX)
+        req->WriteReplyChunk("\n");
+    req->EndChunkedReply();
+    return true;
+}
+
+// A bit of a hack - dependency on functions defined in rpc/blockchain.cpp
 UniValue getblockchaininfo(const UniValue& params, bool fHelp);
+UniValue z_gettreestate(const UniValue& params, bool fHelp);
+UniValue z_getsubtreesbyindex(const UniValue& params, bool fHelp);
 
 static bool rest_chaininfo(HTTPRequest* req, const std::string& strURIPart)
 {
@@ -289,16 +511,72 @@ static bool rest_chaininfo(HTTPRequest* req, const std::string& strURIPart)
     const RetFormat rf = ParseDataFormat(params, strURIPart);
 
     switch (rf) {
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue rpcParams(UniValue::VARR);
         UniValue chainInfoObject = getblockchaininfo(rpcParams, false);
-        string strJSON = chainInfoObject.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, chainInfoObject);
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json, cbor)");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_treestate(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    vector<string> params;
+    const RetFormat rf = ParseDataFormat(params, strURIPart);
+
+    switch (rf) {
+    case RF_JSON:
+    case RF_CBOR: {
+        UniValue rpcParams(UniValue::VARR);
+        rpcParams.push_back(params[0]);
+        return CallRPCMethod(req, rf, &z_gettreestate, rpcParams);
     }
     default: {
-        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json, cbor)");
+    }
+    }
+
+    // not reached
+    return true; // continue to process further HTTP reqs on this cxn
+}
+
+static bool rest_subtrees(HTTPRequest* req, const std::string& strURIPart)
+{
+    if (!CheckWarmup(req))
+        return false;
+    vector<string> params;
+    const RetFormat rf = ParseDataFormat(params, strURIPart);
+    vector<string> path;
+    boost::split(path, params[0], boost::is_any_of("/"));
+
+    if (path.size() != 2 && path.size() != 3)
+        return RESTERR(req, HTTP_BAD_REQUEST, "No start index specified. Use /rest/subtrees/<pool>/<start>[/<limit>].<ext>.");
+
+    UniValue rpcParams(UniValue::VARR);
+    rpcParams.push_back(path[0]);
+    for (size_t i = 1; i < path.size(); i++) {
+        int32_t n;
+        if (!ParseInt32(path[i], &n) || n < 0)
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid index or limit: " + path[i]);
+        rpcParams.push_back(n);
+    }
+
+    switch (rf) {
+    case RF_JSON:
+    case RF_CBOR: {
+        return CallRPCMethod(req, rf, &z_getsubtreesbyindex, rpcParams);
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json, cbor)");
     }
     }
 
@@ -314,16 +592,13 @@ static bool rest_mempool_info(HTTPRequest* req, const std::string& strURIPart)
     const RetFormat rf = ParseDataFormat(params, strURIPart);
 
     switch (rf) {
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue mempoolInfoObject = mempoolInfoToJSON();
-
-        string strJSON = mempoolInfoObject.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, mempoolInfoObject);
     }
     default: {
-        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json, cbor)");
     }
     }
 
@@ -339,16 +614,13 @@ static bool rest_mempool_contents(HTTPRequest* req, const std::string& strURIPar
     const RetFormat rf = ParseDataFormat(params, strURIPart);
 
     switch (rf) {
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue mempoolObject = mempoolToJSON(true);
-
-        string strJSON = mempoolObject.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, mempoolObject);
     }
     default: {
-        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json, cbor)");
     }
     }
 
@@ -391,13 +663,11 @@ static bool rest_tx(HTTPRequest* req, const std::string& strURIPart)
         return true;
     }
 
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue objTx(UniValue::VOBJ);
         TxToJSON(tx, hashBlock, objTx);
-        string strJSON = objTx.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, objTx);
     }
 
     default: {
@@ -490,7 +760,8 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
         break;
     }
 
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         if (!fInputParsed)
             return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Error: empty request");
         break;
@@ -567,7 +838,8 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
         return true;
     }
 
-    case RF_JSON: {
+    case RF_JSON:
+    case RF_CBOR: {
         UniValue objGetUTXOResponse(UniValue::VOBJ);
 
         // pack in some essentials
@@ -591,11 +863,7 @@ static bool rest_getutxos(HTTPRequest* req, const std::string& strURIPart)
         }
         objGetUTXOResponse.pushKV("utxos", utxos);
 
-        // return json string
-        string strJSON = objGetUTXOResponse.write() + "\n";
-        req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(HTTP_OK, strJSON);
-        return true;
+        return WriteStructuredReply(req, rf, objGetUTXOResponse);
     }
     default: {
         return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: " + AvailableDataFormatsString() + ")");
@@ -617,6 +885,9 @@ static const struct {
       {"/rest/mempool/info", rest_mempool_info},
       {"/rest/mempool/contents", rest_mempool_contents},
       {"/rest/headers/", rest_headers},
+      {"/rest/blocks/", rest_blocks},
+      {"/rest/treestate/", rest_treestate},
+      {"/rest/subtrees/", rest_subtrees},
       {"/rest/getutxos", rest_getutxos},
 };
 
@@ -10,10 +10,12 @@
 #include "checkpoints.h"
 #include "consensus/validation.h"
 #include "experimental_features.h"
+#include "insightindex.h"
 #include "key_io.h"
 #include "main.h"
 #include "metrics.h"
 #include "primitives/transaction.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "streams.h"
 #include "sync.h"
@@ -304,6 +306,18 @@ UniValue blockToJSON(const CBlock& block, const CBlockIndex* blockindex, bool tx
     return result;
 }
 
+/**
+ * Returns the published snapshot of the chain tip, which these methods read
+ * instead of taking cs_main.
+ */
+static std::shared_ptr<const CChainTipSnapshot> GetTipSnapshot()
+{
+    std::shared_ptr<const CChainTipSnapshot> snapshot = GetChainTipSnapshot();
+    if (!snapshot)
+        throw JSONRPCError(RPC_IN_WARMUP, "The chain tip has not been loaded yet");
+    return snapshot;
+}
+
 UniValue getblockcount(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() != 0)
@@ -318,8 +332,7 @@ UniValue getblockcount(const UniValue& params, bool fHelp)
             + HelpExampleRpc("getblockcount", "")
         );
 
-    LOCK(cs_main);
-    return chainActive.Height();
+    return GetTipSnapshot()->pindexTip->nHeight;
 }
 
 UniValue getbestblockhash(const UniValue& params, bool fHelp)
@@ -335,8 +348,7 @@ UniValue getbestblockhash(const UniValue& params, bool fHelp)
             + HelpExampleRpc("getbestblockhash", "")
         );
 
-    LOCK(cs_main);
-    return chainActive.Tip()->GetBlockHash().GetHex();
+    return GetTipSnapshot()->pindexTip->GetBlockHash().GetHex();
 }
 
 UniValue getdifficulty(const UniValue& params, bool fHelp)
@@ -352,8 +364,37 @@ UniValue getdifficulty(const UniValue& params, bool fHelp)
             + HelpExampleRpc("getdifficulty", "")
         );
 
-    LOCK(cs_main);
-    return GetNetworkDifficulty();
+    return GetNetworkDifficulty(GetTipSnapshot()->pindexTip);
+}
+
+static UniValue mempoolEntryToJSON(const CTxMemPoolEntry& e)
+{
+    AssertLockHeld(mempool.cs);
+    UniValue info(UniValue::VOBJ);
+    info.pushKV("size", (int)e.GetTxSize());
+    info.pushKV("fee", ValueFromAmount(e.GetFee()));
+    info.pushKV("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
+    info.pushKV("time", e.GetTime());
+    info.pushKV("height", (int)e.GetHeight());
+    info.pushKV("descendantcount", e.GetCountWithDescendants());
+    info.pushKV("descendantsize", e.GetSizeWithDescendants());
+    info.pushKV("descendantfees", e.GetModFeesWithDescendants());
+    const CTransaction& tx = e.GetTx();
+    set<string> setDepends;
+    for (const CTxIn& txin : tx.vin)
+    {
+        if (mempool.exists(txin.prevout.hash))
+            setDepends.insert(txin.prevout.hash.ToString());
+    }
+
+    UniValue depends(UniValue::VARR);
+    for (const string& dep : setDepends)
+    {
+        depends.push_back(dep);
+    }
+
+    info.pushKV("depends", depends);
+    return info;
 }
 
 UniValue mempoolToJSON(bool fVerbose = false)
@@ -365,30 +406,7 @@ UniValue mempoolToJSON(bool fVerbose = false)
         for (const CTxMemPoolEntry& e : mempool.mapTx)
         {
             const uint256& hash = e.GetTx().GetHash();
-            UniValue info(UniValue::VOBJ);
-            info.pushKV("size", (int)e.GetTxSize());
-            info.pushKV("fee", ValueFromAmount(e.GetFee()));
-            info.pushKV("modifiedfee", ValueFromAmount(e.GetModifiedFee()));
-            info.pushKV("time", e.GetTime());
-            info.pushKV("height", (int)e.GetHeight());
-            info.pushKV("descendantcount", e.GetCountWithDescendants());
-            info.pushKV("descendantsize", e.GetSizeWithDescendants());
-            info.pushKV("descendantfees", e.GetModFeesWithDescendants());
-            const CTransaction& tx = e.GetTx();
-            set<string> setDepends;
-            for (const CTxIn& txin : tx.vin)
-            {
-                if (mempool.exists(txin.prevout.hash))
-                    setDepends.insert(txin.prevout.hash.ToString());
-            }
-
-            UniValue depends(UniValue::VARR);
-            for (const string& dep : setDepends)
-            {
-                depends.push_back(dep);
-            }
-
-            info.pushKV("depends", depends);
+            UniValue info = mempoolEntryToJSON(e);
             o.pushKV(hash.ToString(), info);
         }
         return o;
@@ -449,6 +467,43 @@ UniValue getrawmempool(const UniValue& params, bool fHelp)
     return mempoolToJSON(fVerbose);
 }
 
+/** Number of entries written per acquisition of mempool.cs by getrawmempool_stream */
+static const size_t MEMPOOL_STREAM_BATCH_SIZE = 1000;
+
+/**
+ * Streaming handler for verbose getrawmempool. The entries are looked up in
+ * batches, so that mempool.cs is not held while the reply is being sent;
+ * transactions that leave the mempool in the meantime are omitted.
+ */
+static bool getrawmempool_stream(const UniValue& params, JSONStreamWriter& writer)
+{
+    if (params.size() == 0 || !params[0].get_bool())
+        return false;
+
+    vector<uint256> vtxid;
+    mempool.queryHashes(vtxid);
+
+    writer.BeginObject();
+    for (size_t nStart = 0; nStart < vtxid.size(); nStart += MEMPOOL_STREAM_BATCH_SIZE) {
+        size_t nEnd = std::min(vtxid.size(), nStart + MEMPOOL_STREAM_BATCH_SIZE);
+        std::vector<std::pair<std::string, UniValue>> vEntries;
+        {
+            LOCK(mempool.cs);
+            for (size_t i = nStart; i < nEnd; i++) {
+                auto it = mempool.mapTx.find(vtxid[i]);
+                if (it != mempool.mapTx.end()) {
+                    vEntries.emplace_back(vtxid[i].ToString(), mempoolEntryToJSON(*it));
+                }
+            }
+        }
+        for (const auto& entry : vEntries) {
+            writer.PushKV(entry.first, entry.second);
+        }
+    }
+    writer.EndObject();
+    return true;
+}
+
 // insightexplorer
 UniValue getblockdeltas(const UniValue& params, bool fHelp)
 {
@@ -532,6 +587,30 @@ UniValue getblockdeltas(const UniValue& params, bool fHelp)
     return blockToDeltasJSON(block, pblockindex);
 }
 
+/** Version of the cursor tokens returned by paginated getblockhashes queries */
+static const unsigned char BLOCK_HASHES_CURSOR_VERSION = 1;
+
+// Decodes a getblockhashes cursor, which must lie within the queried range.
+static CTimestampIndexKey DecodeBlockHashesCursor(const UniValue& token, unsigned int high, unsigned int low)
+{
+    if (!IsHex(token.get_str())) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    try {
+        CDataStream ss(ParseHex(token.get_str()), SER_NETWORK, PROTOCOL_VERSION);
+        unsigned char version;
+        CTimestampIndexKey key;
+        ss >> version >> key;
+        if (version != BLOCK_HASHES_CURSOR_VERSION || !ss.empty() ||
+            key.timestamp < low || key.timestamp >= high) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        return key;
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+}
+
 // insightexplorer
 UniValue getblockhashes(const UniValue& params, bool fHelp)
 {
@@ -541,7 +620,7 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
     }
     if (fHelp || params.size() < 2)
         throw runtime_error(
-            "getblockhashes high low ( {\"noOrphans\": true|false, \"logicalTimes\": true|false} )\n"
+            "getblockhashes high low ( {\"noOrphans\": true|false, \"logicalTimes\": true|false, \"limit\": n, \"cursor\": \"token\"} )\n"
             "\nReturns array of hashes of blocks within the timestamp range provided,\n"
             "\ngreater or equal to low, less than high.\n"
             + disabledMsg +
@@ -552,6 +631,8 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
             "    {\n"
             "      \"noOrphans\": true|false      (boolean) will only include blocks on the main chain\n"
             "      \"logicalTimes\": true|false   (boolean) will include logical timestamps with hashes\n"
+            "      \"limit\": n                   (numeric) return at most this many hashes, and a cursor for the next page\n"
+            "      \"cursor\": \"token\"           (string) the cursor returned by the previous page of the same query\n"
             "    }\n"
             "\nResult:\n"
             "[\n"
@@ -564,6 +645,11 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
             "    \"logicalts\": n         (numeric) The logical timestamp\n"
             "  }\n"
             "]\n"
+            "or, if limit is given\n"
+            "{\n"
+            "  \"blockhashes\": [...]     (array) The hashes of the page, as above\n"
+            "  \"cursor\": \"token\"       (string) The cursor for the next page, or null if this is the last page\n"
+            "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getblockhashes", "1558141697 1558141576")
             + HelpExampleRpc("getblockhashes", "1558141697, 1558141576")
@@ -579,6 +665,8 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
     unsigned int low = params[1].get_int();
     bool fActiveOnly = false;
     bool fLogicalTS = false;
+    size_t nLimit = 0;
+    std::optional<CTimestampIndexKey> cursor;
 
     if (params.size() > 2) {
         UniValue noOrphans = find_value(params[2].get_obj(), "noOrphans");
@@ -588,12 +676,25 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
         UniValue returnLogical = find_value(params[2].get_obj(), "logicalTimes");
         if (!returnLogical.isNull())
             fLogicalTS = returnLogical.get_bool();
+
+        UniValue limit = find_value(params[2].get_obj(), "limit");
+        if (!limit.isNull()) {
+            if (limit.get_int() <= 0) {
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit must be positive");
+            }
+            nLimit = limit.get_int();
+
+            UniValue token = find_value(params[2].get_obj(), "cursor");
+            if (!token.isNull()) {
+                cursor = DecodeBlockHashesCursor(token, high, low);
+            }
+        }
     }
 
     std::vector<std::pair<uint256, unsigned int> > blockHashes;
     {
         LOCK(cs_main);
-        if (!GetTimestampIndex(high, low, fActiveOnly, blockHashes)) {
+        if (!GetTimestampIndex(high, low, fActiveOnly, blockHashes, nLimit, &cursor)) {
             throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
                 "No information available for block hashes");
         }
@@ -610,6 +711,70 @@ UniValue getblockhashes(const UniValue& params, bool fHelp)
             result.push_back(it->first.GetHex());
         }
     }
+
+    if (nLimit > 0) {
+        UniValue page(UniValue::VOBJ);
+        page.pushKV("blockhashes", result);
+        if (cursor.has_value()) {
+            CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+            ss << BLOCK_HASHES_CURSOR_VERSION << cursor.value();
+            page.pushKV("cursor", HexStr(ss.begin(), ss.end()));
+        } else {
+            page.pushKV("cursor", NullUniValue);
+        }
+        return page;
+    }
+    return result;
+}
+
+// insightexplorer
+UniValue getindexinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getindexinfo\n"
+            "\nReturns the status of the optional indexes that are enabled.\n"
+            "\nThe insight explorer indexes are built in the background when -insightexplorer is\n"
+            "enabled on an existing node; until they are synced, the methods that use them fail.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"name\": {                  (json object) The name of the index\n"
+            "    \"synced\": true|false,     (boolean) Whether the index contains every block of the active chain\n"
+            "    \"best_block_height\": n,   (numeric) The height of the last block in the index\n"
+            "    \"progress\": x.xxx         (numeric) Estimate of the progress of the index build, between 0 and 1\n"
+            "  }, ...\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getindexinfo", "")
+            + HelpExampleRpc("getindexinfo", "")
+        );
+
+    LOCK(cs_main);
+
+    auto indexInfo = [](const CBlockIndex* pindexBest) {
+        int nHeight = pindexBest ? pindexBest->nHeight : -1;
+        int nTipHeight = chainActive.Height();
+        UniValue info(UniValue::VOBJ);
+        info.pushKV("synced", pindexBest == chainActive.Tip());
+        info.pushKV("best_block_height", nHeight);
+        info.pushKV("progress", nTipHeight > 0 ? std::max(nHeight, 0) / (double)nTipHeight : 1.0);
+        return info;
+    };
+
+    UniValue result(UniValue::VOBJ);
+    if (fTxIndex) {
+        result.pushKV("txindex", indexInfo(chainActive.Tip()));
+    }
+    const CBlockIndex* pindexInsightBest = GetInsightIndexBestBlock();
+    if (fAddressIndex) {
+        result.pushKV("addressindex", indexInfo(pindexInsightBest));
+    }
+    if (fSpentIndex) {
+        result.pushKV("spentindex", indexInfo(pindexInsightBest));
+    }
+    if (fTimestampIndex) {
+        result.pushKV("timestampindex", indexInfo(pindexInsightBest));
+    }
     return result;
 }
 
@@ -725,6 +890,67 @@ UniValue getblockheader(const UniValue& params, bool fHelp)
     }
 }
 
+/** Binary result handler for getblockheader with verbose=false. */
+static bool getblockheader_binary(const UniValue& params, std::vector<unsigned char>& result)
+{
+    if (params.size() < 2 || params[1].get_bool())
+        return false;
+
+    LOCK(cs_main);
+
+    uint256 hash(uint256S(params[0].get_str()));
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+    ssBlock << mapBlockIndex[hash]->GetBlockHeader();
+    result.assign(ssBlock.begin(), ssBlock.end());
+    return true;
+}
+
+static int ParseGetBlockVerbosity(const UniValue& params)
+{
+    int verbosity = 1;
+    if (params.size() > 1) {
+        if(params[1].isNum()) {
+            verbosity = params[1].get_int();
+        } else {
+            verbosity = params[1].get_bool() ? 1 : 0;
+        }
+    }
+
+    if (verbosity < 0 || verbosity > 2) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Verbosity must be in range from 0 to 2");
+    }
+    return verbosity;
+}
+
+/** Look up a block by hash or height and read it from disk. */
+static CBlockIndex* ReadBlockForRPC(std::string strHash, CBlock& block)
+{
+    AssertLockHeld(cs_main);
+
+    // If height is supplied, find the hash
+    if (strHash.size() < (2 * sizeof(uint256))) {
+        strHash = chainActive[parseHeightArg(strHash, chainActive.Height())]->GetBlockHash().GetHex();
+    }
+
+    uint256 hash(uint256S(strHash));
+
+    if (mapBlockIndex.count(hash) == 0)
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+
+    CBlockIndex* pblockindex = mapBlockIndex[hash];
+
+    if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block not available (pruned data)");
+
+    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+
+    return pblockindex;
+}
+
 UniValue getblock(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() < 1 || params.size() > 2)
@@ -808,49 +1034,89 @@ UniValue getblock(const UniValue& params, bool fHelp)
 
     LOCK(cs_main);
 
-    std::string strHash = params[0].get_str();
-
-    // If height is supplied, find the hash
-    if (strHash.size() < (2 * sizeof(uint256))) {
-        strHash = chainActive[parseHeightArg(strHash, chainActive.Height())]->GetBlockHash().GetHex();
-    }
+    int verbosity = ParseGetBlockVerbosity(params);
 
-    uint256 hash(uint256S(strHash));
+    CBlock block;
+    CBlockIndex* pblockindex = ReadBlockForRPC(params[0].get_str(), block);
 
-    int verbosity = 1;
-    if (params.size() > 1) {
-        if(params[1].isNum()) {
-            verbosity = params[1].get_int();
-        } else {
-            verbosity = params[1].get_bool() ? 1 : 0;
-        }
+    if (verbosity == 0)
+    {
+        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+        ssBlock << block;
+        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
+        return strHex;
     }
 
-    if (verbosity < 0 || verbosity > 2) {
-        throw JSONRPCError(RPC_INVALID_PARAMETER, "Verbosity must be in range from 0 to 2");
-    }
+    return blockToJSON(block, pblockindex, verbosity >= 2);
+}
 
-    if (mapBlockIndex.count(hash) == 0)
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block not found");
+/** Binary result handler for getblock with verbosity 0. */
+static bool getblock_binary(const UniValue& params, std::vector<unsigned char>& result)
+{
+    if (ParseGetBlockVerbosity(params) != 0)
+        return false;
+
+    LOCK(cs_main);
 
     CBlock block;
-    CBlockIndex* pblockindex = mapBlockIndex[hash];
+    ReadBlockForRPC(params[0].get_str(), block);
 
-    if (fHavePruned && !(pblockindex->nStatus & BLOCK_HAVE_DATA) && pblockindex->nTx > 0)
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Block not available (pruned data)");
+    CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
+    ssBlock << block;
+    result.assign(ssBlock.begin(), ssBlock.end());
+    return true;
+}
 
-    if(!ReadBlockFromDisk(block, pblockindex, Params().GetConsensus()))
-        throw JSONRPCError(RPC_INTERNAL_ERROR, "Can't read block from disk");
+/** Number of transactions converted per acquisition of cs_main by getblock_stream */
+static const size_t BLOCK_STREAM_BATCH_SIZE = 100;
 
-    if (verbosity == 0)
+/**
+ * Streaming handler for getblock with verbosity 2, where the transaction
+ * details of a large block can be many times the size of the block itself.
+ * The transactions are converted in batches under cs_main, which the spent
+ * index lookups need, and each batch is written after it has been released.
+ */
+static bool getblock_stream(const UniValue& params, JSONStreamWriter& writer)
+{
+    if (ParseGetBlockVerbosity(params) != 2)
+        return false;
+
+    CBlock block;
+    UniValue header;
     {
-        CDataStream ssBlock(SER_NETWORK, PROTOCOL_VERSION);
-        ssBlock << block;
-        std::string strHex = HexStr(ssBlock.begin(), ssBlock.end());
-        return strHex;
+        LOCK(cs_main);
+        CBlockIndex* pblockindex = ReadBlockForRPC(params[0].get_str(), block);
+        header = blockToJSON(block, pblockindex, false);
     }
 
-    return blockToJSON(block, pblockindex, verbosity >= 2);
+    writer.BeginObject();
+    for (size_t i = 0; i < header.size(); i++) {
+        const std::string& key = header.getKeys()[i];
+        if (key != "tx") {
+            writer.PushKV(key, header.getValues()[i]);
+            continue;
+        }
+        writer.Key(key);
+        writer.BeginArray();
+        for (size_t nStart = 0; nStart < block.vtx.size(); nStart += BLOCK_STREAM_BATCH_SIZE) {
+            size_t nEnd = std::min(block.vtx.size(), nStart + BLOCK_STREAM_BATCH_SIZE);
+            std::vector<UniValue> vTxs;
+            {
+                LOCK(cs_main);
+                for (size_t n = nStart; n < nEnd; n++) {
+                    UniValue objTx(UniValue::VOBJ);
+                    TxToJSON(block.vtx[n], uint256(), objTx);
+                    vTxs.push_back(std::move(objTx));
+                }
+            }
+            for (const UniValue& objTx : vTxs) {
+                writer.Value(objTx);
+            }
+        }
+        writer.EndArray();
+    }
+    writer.EndObject();
+    return true;
 }
 
 UniValue gettxoutsetinfo(const UniValue& params, bool fHelp)
@@ -1000,10 +1266,10 @@ UniValue verifychain(const UniValue& params, bool fHelp)
 }
 
 /** Implementation of IsSuperMajority with better feedback */
-static UniValue SoftForkMajorityDesc(int minVersion, CBlockIndex* pindex, int nRequired, const Consensus::Params& consensusParams)
+static UniValue SoftForkMajorityDesc(int minVersion, const CBlockIndex* pindex, int nRequired, const Consensus::Params& consensusParams)
 {
     int nFound = 0;
-    CBlockIndex* pstart = pindex;
+    const CBlockIndex* pstart = pindex;
     for (int i = 0; i < consensusParams.nMajorityWindow && pstart != NULL; i++)
     {
         if (pstart->nVersion >= minVersion)
@@ -1019,7 +1285,7 @@ static UniValue SoftForkMajorityDesc(int minVersion, CBlockIndex* pindex, int nR
     return rv;
 }
 
-static UniValue SoftForkDesc(const std::string &name, int version, CBlockIndex* pindex, const Consensus::Params& consensusParams)
+static UniValue SoftForkDesc(const std::string &name, int version, const CBlockIndex* pindex, const Consensus::Params& consensusParams)
 {
     UniValue rv(UniValue::VOBJ);
     rv.pushKV("id", name);
@@ -1126,30 +1392,32 @@ UniValue getblockchaininfo(const UniValue& params, bool fHelp)
             + HelpExampleRpc("getblockchaininfo", "")
         );
 
-    LOCK(cs_main);
+    // Everything except the IBD state and the prune height is read from the
+    // snapshot of the tip. IsInitialBlockDownload only takes cs_main until
+    // IBD has finished.
+    std::shared_ptr<const CChainTipSnapshot> snapshot = GetTipSnapshot();
+    const CBlockIndex* tip = snapshot->pindexTip;
+    bool fInitialBlockDownload = IsInitialBlockDownload(Params().GetConsensus());
 
     UniValue obj(UniValue::VOBJ);
     obj.pushKV("chain",                 Params().NetworkIDString());
-    obj.pushKV("blocks",                (int)chainActive.Height());
-    obj.pushKV("initial_block_download_complete", !IsInitialBlockDownload(Params().GetConsensus()));
-    obj.pushKV("headers",               pindexBestHeader ? pindexBestHeader->nHeight : -1);
-    obj.pushKV("bestblockhash",         chainActive.Tip()->GetBlockHash().GetHex());
-    obj.pushKV("difficulty",            (double)GetNetworkDifficulty());
-    obj.pushKV("verificationprogress",  Checkpoints::GuessVerificationProgress(Params().Checkpoints(), chainActive.Tip()));
-    obj.pushKV("chainwork",             chainActive.Tip()->nChainWork.GetHex());
+    obj.pushKV("blocks",                tip->nHeight);
+    obj.pushKV("initial_block_download_complete", !fInitialBlockDownload);
+    obj.pushKV("headers",               snapshot->pindexBestHeader ? snapshot->pindexBestHeader->nHeight : -1);
+    obj.pushKV("bestblockhash",         tip->GetBlockHash().GetHex());
+    obj.pushKV("difficulty",            (double)GetNetworkDifficulty(tip));
+    obj.pushKV("verificationprogress",  snapshot->dVerificationProgress);
+    obj.pushKV("chainwork",             tip->nChainWork.GetHex());
     obj.pushKV("pruned",                fPruneMode);
-    obj.pushKV("size_on_disk",          CalculateCurrentUsage());
+    obj.pushKV("size_on_disk",          snapshot->nSizeOnDisk);
 
-    if (IsInitialBlockDownload(Params().GetConsensus()))
-        obj.pushKV("estimatedheight",       EstimateNetHeight(Params().GetConsensus(), (int)chainActive.Height(), chainActive.Tip()->GetMedianTimePast()));
+    if (fInitialBlockDownload)
+        obj.pushKV("estimatedheight",       EstimateNetHeight(Params().GetConsensus(), tip->nHeight, tip->GetMedianTimePast()));
     else
-        obj.pushKV("estimatedheight",       (int)chainActive.Height());
+        obj.pushKV("estimatedheight",       tip->nHeight);
 
-    SproutMerkleTree tree;
-    pcoinsTip->GetSproutAnchorAt(pcoinsTip->GetBestAnchor(SPROUT), tree);
-    obj.pushKV("commitments",           static_cast<uint64_t>(tree.size()));
+    obj.pushKV("commitments",           snapshot->nSproutCommitments);
 
-    CBlockIndex* tip = chainActive.Tip();
     obj.pushKV("chainSupply", ValuePoolDesc(std::nullopt, tip->nChainTotalSupply, std::nullopt));
     UniValue valuePools(UniValue::VARR);
     valuePools.push_back(ValuePoolDesc("transparent", tip->nChainTransparentValue, std::nullopt));
@@ -1181,7 +1449,9 @@ UniValue getblockchaininfo(const UniValue& params, bool fHelp)
 
     if (fPruneMode)
     {
-        CBlockIndex *block = chainActive.Tip();
+        // nStatus changes as blocks are pruned.
+        LOCK(cs_main);
+        const CBlockIndex *block = tip;
         while (block && block->pprev && (block->pprev->nStatus & BLOCK_HAVE_DATA))
             block = block->pprev;
 
@@ -1676,6 +1946,7 @@ static const CRPCCommand commands[] =
     // insightexplorer
     { "blockchain",         "getblockdeltas",         &getblockdeltas,         false },
     { "blockchain",         "getblockhashes",         &getblockhashes,         true  },
+    { "blockchain",         "getindexinfo",           &getindexinfo,           true  },
 
     /* Not shown in help */
     { "hidden",             "invalidateblock",        &invalidateblock,        true  },
@@ -1686,4 +1957,19 @@ void RegisterBlockchainRPCCommands(CRPCTable &tableRPC)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         tableRPC.appendCommand(commands[vcidx].name, &commands[vcidx]);
+
+    tableRPC.appendStreamingCommand("getblock", &getblock_stream);
+    tableRPC.appendStreamingCommand("getrawmempool", &getrawmempool_stream);
+
+    // Read-only queries that may be run concurrently within a batch request.
+    for (const char* name : {
+            "getblockchaininfo", "getbestblockhash", "getblockcount", "getblock",
+            "getblockhash", "getblockheader", "getchaintips", "z_gettreestate",
+            "z_getsubtreesbyindex", "getdifficulty", "getmempoolinfo", "getrawmempool",
+            "gettxout", "getblockdeltas", "getblockhashes", "getindexinfo"}) {
+        tableRPC.appendConcurrentCommand(name);
+    }
+
+    tableRPC.appendBinaryResultCommand("getblock", &getblock_binary);
+    tableRPC.appendBinaryResultCommand("getblockheader", &getblockheader_binary);
 }
@@ -0,0 +1,127 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "rpc/cbor.h"
+
+#include "crypto/common.h"
+#include "util/strencodings.h"
+
+#include <cstring>
+#include <stdexcept>
+
+enum CBORMajorType : uint8_t {
+    CBOR_UNSIGNED = 0,
+    CBOR_NEGATIVE = 1,
+    CBOR_BYTES = 2,
+    CBOR_TEXT = 3,
+    CBOR_ARRAY = 4,
+    CBOR_MAP = 5,
+};
+
+static const uint8_t CBOR_FALSE = 0xf4;
+static const uint8_t CBOR_TRUE = 0xf5;
+static const uint8_t CBOR_NULL = 0xf6;
+static const uint8_t CBOR_FLOAT64 = 0xfb;
+
+/** Append the initial byte(s) of a data item, using the shortest form. */
+static void EncodeHead(CBORMajorType type, uint64_t arg, std::string& out)
+{
+    unsigned char buf[9];
+    uint8_t major = type << 5;
+    if (arg < 24) {
+        out.push_back(major | arg);
+    } else if (arg <= 0xff) {
+        out.push_back(major | 24);
+        out.push_back(arg);
+    } else if (arg <= 0xffff) {
+        buf[0] = major | 25;
+        buf[1] = arg >> 8;
+        buf[2] = arg;
+        out.append((const char*)buf, 3);
+    } else if (arg <= 0xffffffff) {
+        buf[0] = major | 26;
+        WriteBE32(buf + 1, arg);
+        out.append((const char*)buf, 5);
+    } else {
+        buf[0] = major | 27;
+        WriteBE64(buf + 1, arg);
+        out.append((const char*)buf, 9);
+    }
+}
+
+static void EncodeNumber(const std::string& str, std::string& out)
+{
+    int64_t n;
+    if (str.find_first_of(".eE") == std::string::npos && ParseInt64(str, &n)) {
+        if (n >= 0) {
+            EncodeHead(CBOR_UNSIGNED, n, out);
+        } else {
+            // -1 - n, without overflowing for INT64_MIN
+            EncodeHead(CBOR_NEGATIVE, ~static_cast<uint64_t>(n), out);
+        }
+        return;
+    }
+
+    double d;
+    if (!ParseDouble(str, &d)) {
+        throw std::runtime_error("Cannot encode number as CBOR: " + str);
+    }
+    uint64_t bits;
+    static_assert(sizeof(bits) == sizeof(d), "double must be 64 bits");
+    std::memcpy(&bits, &d, sizeof(bits));
+    unsigned char buf[9];
+    buf[0] = CBOR_FLOAT64;
+    WriteBE64(buf + 1, bits);
+    out.append((const char*)buf, 9);
+}
+
+void EncodeCBORText(const std::string& str, std::string& out)
+{
+    EncodeHead(CBOR_TEXT, str.size(), out);
+    out += str;
+}
+
+void EncodeCBORBytes(const unsigned char* data, size_t len, std::string& out)
+{
+    EncodeHead(CBOR_BYTES, len, out);
+    out.append((const char*)data, len);
+}
+
+void EncodeCBOR(const UniValue& value, std::string& out)
+{
+    switch (value.getType()) {
+    case UniValue::VNULL:
+        out.push_back(CBOR_NULL);
+        break;
+    case UniValue::VBOOL:
+        out.push_back(value.get_bool() ? CBOR_TRUE : CBOR_FALSE);
+        break;
+    case UniValue::VNUM:
+        EncodeNumber(value.getValStr(), out);
+        break;
+    case UniValue::VSTR:
+        EncodeCBORText(value.get_str(), out);
+        break;
+    case UniValue::VARR:
+        EncodeHead(CBOR_ARRAY, value.size(), out);
+        for (size_t i = 0; i < value.size(); i++) {
+            EncodeCBOR(value[i], out);
+        }
+        break;
+    case UniValue::VOBJ:
+        EncodeHead(CBOR_MAP, value.size(), out);
+        for (size_t i = 0; i < value.size(); i++) {
+            EncodeCBORText(value.getKeys()[i], out);
+            EncodeCBOR(value.getValues()[i], out);
+        }
+        break;
+    }
+}
+
+std::string EncodeCBOR(const UniValue& value)
+{
+    std::string out;
+    EncodeCBOR(value, out);
+    return out;
+}
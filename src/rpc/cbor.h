@@ -0,0 +1,31 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef ZCASH_RPC_CBOR_H
+#define ZCASH_RPC_CBOR_H
+
+#include <univalue.h>
+
+#include <string>
+
+/**
+ * Append the CBOR (RFC 8949) encoding of a JSON value to out.
+ *
+ * Objects and arrays become definite-length maps and arrays, and strings
+ * become text strings. Integral numbers that fit in 64 bits are encoded as
+ * integers, and all other numbers as double-precision floats.
+ *
+ * @throws std::runtime_error if a number cannot be represented as a double.
+ */
+void EncodeCBOR(const UniValue& value, std::string& out);
+
+std::string EncodeCBOR(const UniValue& value);
+
+/** Append a CBOR text string. */
+void EncodeCBORText(const std::string& str, std::string& out);
+
+/** Append a CBOR byte string. */
+void EncodeCBORBytes(const unsigned char* data, size_t len, std::string& out);
+
+#endif // ZCASH_RPC_CBOR_H
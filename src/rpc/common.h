@@ -50,6 +50,7 @@ static const CRPCConvertTable rpcCvtTable =
     { "getrawmempool",               {{}, {o}} },
     { "getblockdeltas",              {{o}, {}} },
     { "getblockhashes",              {{o, o}, {o}} },
+    { "getindexinfo",                {{}, {}} },
     { "getblockhash",                {{o}, {}} },
     { "getblockheader",              {{s}, {o}} },
     { "getblock",                    {{s}, {o}} },
@@ -163,6 +164,7 @@ static const CRPCConvertTable rpcCvtTable =
     { "zcsamplejoinsplit",           {{}, {}} },
     { "zcbenchmark",                 {{s, o}, {o}} },
     { "z_getnewaddress",             {{}, {s}} },
+    { "z_getnewaddresses",           {{o}, {s}} },
     { "z_getnewaccount",             {{}, {}} },
     { "z_getaddressforaccount",      {{o}, {o, o}} },
     { "z_listaccounts",              {{}, {}} },
@@ -184,6 +186,7 @@ static const CRPCConvertTable rpcCvtTable =
     { "z_listoperationids",          {{}, {s}} },
     { "z_getnotescount",             {{}, {o, o}} },
     // server
+    { "getrpcinfo",                  {{}, {}} },
     { "help",                        {{}, {s}} },
     { "setlogfilter",                {{s}, {}} },
     { "stop",                        {{}, {o}} },
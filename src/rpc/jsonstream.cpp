@@ -0,0 +1,107 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "rpc/jsonstream.h"
+
+#include <cassert>
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t nFlushSize) :
+    sink(sink), nFlushSize(nFlushSize)
+{
+}
+
+void JSONStreamWriter::BeginElement()
+{
+    if (fAfterKey) {
+        fAfterKey = false;
+        return;
+    }
+    if (!vEmpty.empty()) {
+        if (!vEmpty.back()) {
+            buffer += ',';
+        }
+        vEmpty.back() = false;
+    }
+}
+
+void JSONStreamWriter::Append(const std::string& str)
+{
+    buffer += str;
+    if (buffer.size() >= nFlushSize) {
+        Flush();
+    }
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    BeginElement();
+    vEmpty.push_back(true);
+    closers += '}';
+    Append("{");
+}
+
+void JSONStreamWriter::EndObject()
+{
+    assert(!vEmpty.empty() && !fAfterKey && closers.back() == '}');
+    vEmpty.pop_back();
+    closers.pop_back();
+    Append("}");
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    BeginElement();
+    vEmpty.push_back(true);
+    closers += ']';
+    Append("[");
+}
+
+void JSONStreamWriter::EndArray()
+{
+    assert(!vEmpty.empty() && !fAfterKey && closers.back() == ']');
+    vEmpty.pop_back();
+    closers.pop_back();
+    Append("]");
+}
+
+void JSONStreamWriter::Key(const std::string& key)
+{
+    assert(!vEmpty.empty() && !fAfterKey);
+    BeginElement();
+    // Let UniValue handle the escaping.
+    buffer += UniValue(key).write();
+    buffer += ':';
+    fAfterKey = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    BeginElement();
+    Append(value.write());
+}
+
+void JSONStreamWriter::CloseTo(size_t nDepth)
+{
+    if (fAfterKey) {
+        Value(NullUniValue);
+    }
+    while (vEmpty.size() > nDepth) {
+        if (closers.back() == '}') {
+            EndObject();
+        } else {
+            EndArray();
+        }
+    }
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (buffer.empty()) {
+        return;
+    }
+    std::string out;
+    out.swap(buffer);
+    nFlushed += out.size();
+    sink(out);
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#ifndef ZCASH_RPC_JSONSTREAM_H
+#define ZCASH_RPC_JSONSTREAM_H
+
+#include <univalue.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/** Amount of output JSONStreamWriter buffers before passing it to its sink */
+static const size_t DEFAULT_JSON_STREAM_FLUSH_SIZE = 64 * 1024;
+
+/**
+ * Writes a JSON document incrementally, so that a large result never has to
+ * be held in memory as a single UniValue tree or string.
+ *
+ * Containers are opened and closed explicitly, and leaf values (or small
+ * subtrees) are written as UniValues. Output is buffered and handed to the
+ * sink whenever the buffer reaches the flush size, and when Flush() is
+ * called. The sink may throw to abort the writer's caller, for example when
+ * the client has disconnected.
+ *
+ * The output is compact, and identical to UniValue::write() of the
+ * equivalent tree.
+ */
+class JSONStreamWriter
+{
+public:
+    typedef std::function<void(const std::string&)> Sink;
+
+    explicit JSONStreamWriter(Sink sink, size_t nFlushSize = DEFAULT_JSON_STREAM_FLUSH_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+
+    /** Write the key of the next member of the current object. */
+    void Key(const std::string& key);
+
+    /** Write a value: a member value after Key(), or an array element. */
+    void Value(const UniValue& value);
+
+    void PushKV(const std::string& key, const UniValue& value)
+    {
+        Key(key);
+        Value(value);
+    }
+
+    /** Number of containers that are currently open. */
+    size_t Depth() const { return vEmpty.size(); }
+
+    /**
+     * Close open containers until only nDepth remain, writing null for a
+     * member whose key has been written without a value. This completes a
+     * document whose writer was interrupted part way through a value.
+     */
+    void CloseTo(size_t nDepth);
+
+    /** Pass any buffered output to the sink. */
+    void Flush();
+
+    /** Number of bytes that have been passed to the sink. */
+    size_t BytesFlushed() const { return nFlushed; }
+
+private:
+    Sink sink;
+    size_t nFlushSize;
+    size_t nFlushed = 0;
+    std::string buffer;
+    // One entry per open container: whether it has no elements yet.
+    std::vector<bool> vEmpty;
+    // The closing bracket of each open container.
+    std::string closers;
+    // Whether a key has just been written and its value is expected next.
+    bool fAfterKey = false;
+
+    void BeginElement();
+    void Append(const std::string& str);
+};
+
+#endif // ZCASH_RPC_JSONSTREAM_H
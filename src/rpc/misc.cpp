@@ -12,6 +12,7 @@
 #include "main.h"
 #include "net.h"
 #include "netbase.h"
+#include "rpc/jsonstream.h"
 #include "rpc/server.h"
 #include "txmempool.h"
 #include "util/system.h"
@@ -712,6 +713,177 @@ UniValue getaddressmempool(const UniValue& params, bool fHelp)
     return result;
 }
 
+// insightexplorer
+/** Version of the cursor tokens returned by paginated address index queries */
+static const unsigned char ADDRESS_INDEX_CURSOR_VERSION = 1;
+
+/** Number of entries that getaddressdeltas_stream reads from the index at a time */
+static const size_t ADDRESS_INDEX_STREAM_BATCH_SIZE = 10000;
+
+/**
+ * Position of a paginated query in the index entries of a list of addresses,
+ * which are read in address list order and then in index key order.
+ */
+template<typename Key>
+struct AddressIndexPosition
+{
+    //! Position in the address list
+    size_t nAddress = 0;
+    //! Key of the next entry to read for that address, unset to start at its first entry
+    std::optional<Key> key;
+
+    bool AtEnd(const std::vector<std::pair<uint160, int>>& addresses) const
+    {
+        return nAddress >= addresses.size();
+    }
+};
+
+// Returns the "limit" of a paginated query, or 0 if the query is not paginated.
+static size_t getPageLimit(const UniValue& options)
+{
+    if (!options.isObject()) {
+        return 0;
+    }
+    UniValue limit = find_value(options.get_obj(), "limit");
+    if (limit.isNull()) {
+        return 0;
+    }
+    if (limit.get_int() <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Limit must be positive");
+    }
+    return limit.get_int();
+}
+
+template<typename Key>
+static UniValue encodeIndexCursor(
+    const std::vector<std::pair<uint160, int>>& addresses,
+    const AddressIndexPosition<Key>& pos)
+{
+    if (pos.AtEnd(addresses)) {
+        return NullUniValue;
+    }
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << ADDRESS_INDEX_CURSOR_VERSION << (uint32_t)pos.nAddress << pos.key.has_value();
+    if (pos.key.has_value()) {
+        ss << pos.key.value();
+    }
+    return HexStr(ss.begin(), ss.end());
+}
+
+// Whether the key of a cursor lies within the height range [start, end] of
+// the query it is used with. Unspent outputs are not queried by height.
+static bool isCursorInRange(const CAddressIndexKey& key, int start, int end)
+{
+    return key.blockHeight >= start && key.blockHeight <= end;
+}
+
+static bool isCursorInRange(const CAddressUnspentKey&, int, int)
+{
+    return true;
+}
+
+// Decodes the "cursor" of a paginated query. The cursor is only valid for
+// the same list of addresses as the query that returned it, and its key
+// must lie within the height range of the query, so that resuming under a
+// different range can't return entries outside that range.
+template<typename Key>
+static AddressIndexPosition<Key> decodeIndexCursor(
+    const UniValue& options,
+    const std::vector<std::pair<uint160, int>>& addresses,
+    int start, int end)
+{
+    AddressIndexPosition<Key> pos;
+    if (!options.isObject()) {
+        return pos;
+    }
+    UniValue cursor = find_value(options.get_obj(), "cursor");
+    if (cursor.isNull()) {
+        return pos;
+    }
+    if (!IsHex(cursor.get_str())) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    try {
+        CDataStream ss(ParseHex(cursor.get_str()), SER_NETWORK, PROTOCOL_VERSION);
+        unsigned char version;
+        uint32_t nAddress;
+        bool fHasKey;
+        ss >> version >> nAddress >> fHasKey;
+        if (fHasKey) {
+            Key key;
+            ss >> key;
+            pos.key = key;
+        }
+        pos.nAddress = nAddress;
+        if (version != ADDRESS_INDEX_CURSOR_VERSION || !ss.empty() || pos.AtEnd(addresses) ||
+            (pos.key.has_value() && (pos.key->hashBytes != addresses[nAddress].first ||
+                                     (int)pos.key->type != addresses[nAddress].second))) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+        }
+        if (pos.key.has_value() && !isCursorInRange(pos.key.value(), start, end)) {
+            throw JSONRPCError(RPC_INVALID_PARAMETER, "Cursor is outside the requested height range");
+        }
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    return pos;
+}
+
+// Reads up to nLimit entries from pos onwards, advancing pos. The read
+// function reads the entries of a single address, as GetAddressIndex does.
+template<typename Key, typename Entry, typename ReadFn>
+static void readAddressIndexPage(
+    const std::vector<std::pair<uint160, int>>& addresses,
+    size_t nLimit,
+    AddressIndexPosition<Key>& pos,
+    std::vector<Entry>& entries,
+    ReadFn read)
+{
+    const size_t nInitialSize = entries.size();
+    while (!pos.AtEnd(addresses)) {
+        size_t nRead = entries.size() - nInitialSize;
+        if (nRead == nLimit) {
+            return;
+        }
+        const auto& address = addresses[pos.nAddress];
+        if (!read(address.first, address.second, nLimit - nRead, &pos.key, entries)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
+                "No information available for address");
+        }
+        if (pos.key.has_value()) {
+            // The page was filled before the end of this address's entries.
+            return;
+        }
+        pos.nAddress++;
+    }
+}
+
+static void getAddressIndexPage(
+    const std::vector<std::pair<uint160, int>>& addresses,
+    int start, int end, size_t nLimit,
+    AddressIndexPosition<CAddressIndexKey>& pos,
+    std::vector<CAddressIndexDbEntry>& addressIndex)
+{
+    readAddressIndexPage(addresses, nLimit, pos, addressIndex,
+        [&](const uint160& hash, int type, size_t nRemaining,
+            std::optional<CAddressIndexKey>* pCursor, std::vector<CAddressIndexDbEntry>& entries) {
+            return GetAddressIndex(hash, type, entries, start, end, nRemaining, pCursor);
+        });
+}
+
+static void getAddressUnspentPage(
+    const std::vector<std::pair<uint160, int>>& addresses,
+    size_t nLimit,
+    AddressIndexPosition<CAddressUnspentKey>& pos,
+    std::vector<CAddressUnspentDbEntry>& unspentOutputs)
+{
+    readAddressIndexPage(addresses, nLimit, pos, unspentOutputs,
+        [&](const uint160& hash, int type, size_t nRemaining,
+            std::optional<CAddressUnspentKey>* pCursor, std::vector<CAddressUnspentDbEntry>& entries) {
+            return GetAddressUnspent(hash, type, entries, nRemaining, pCursor);
+        });
+}
+
 // insightexplorer
 UniValue getaddressutxos(const UniValue& params, bool fHelp)
 {
@@ -721,7 +893,7 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
     }
     if (fHelp || params.size() != 1)
         throw runtime_error(
-            "getaddressutxos {\"addresses\": [\"taddr\", ...], (\"chainInfo\": true|false)}\n"
+            "getaddressutxos {\"addresses\": [\"taddr\", ...], (\"chainInfo\": true|false), (\"limit\": n), (\"cursor\": \"token\")}\n"
             "\nReturns all unspent outputs for an address.\n"
             + disabledMsg +
             "\nArguments:\n"
@@ -732,6 +904,8 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
             "      ,...\n"
             "    ],\n"
             "  \"chainInfo\"  (boolean, optional, default=false) Include chain info with results\n"
+            "  \"limit\"      (number, optional) Return at most this many outputs, and a cursor for the next page\n"
+            "  \"cursor\"     (string, optional) The cursor returned by the previous page of the same query\n"
             "}\n"
             "(or)\n"
             "\"address\"  (string) The base58check encoded address\n"
@@ -761,7 +935,12 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
             "    ],\n"
             "  \"hash\"              (string)  The block hash\n"
             "  \"height\"            (numeric) The block height\n"
+            "}\n\n"
+            "(or, if limit is given, an object with the \"utxos\" of the page, the chain info if requested, and):\n\n"
+            "{\n"
+            "  \"cursor\"            (string)  The cursor for the next page, or null if this is the last page\n"
             "}\n"
+            "\nWith a limit, outputs are ordered by address and then by txid, and only sorted by height within a page.\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressutxos", "'{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"], \"chainInfo\": true}'")
             + HelpExampleRpc("getaddressutxos", "{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"], \"chainInfo\": true}")
@@ -783,10 +962,18 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
     if (!getAddressesFromParams(params, addresses)) {
         throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
     }
+    size_t nLimit = getPageLimit(params[0]);
     std::vector<CAddressUnspentDbEntry> unspentOutputs;
-    for (const auto& it : addresses) {
-        if (!GetAddressUnspent(it.first, it.second, unspentOutputs)) {
-            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+    UniValue nextCursor;
+    if (nLimit > 0) {
+        auto pos = decodeIndexCursor<CAddressUnspentKey>(params[0], addresses, 0, 0);
+        getAddressUnspentPage(addresses, nLimit, pos, unspentOutputs);
+        nextCursor = encodeIndexCursor(addresses, pos);
+    } else {
+        for (const auto& it : addresses) {
+            if (!GetAddressUnspent(it.first, it.second, unspentOutputs)) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "No information available for address");
+            }
         }
     }
     std::sort(unspentOutputs.begin(), unspentOutputs.end(),
@@ -811,11 +998,16 @@ UniValue getaddressutxos(const UniValue& params, bool fHelp)
         utxos.push_back(output);
     }
 
-    if (!includeChainInfo)
+    if (!includeChainInfo && nLimit == 0)
         return utxos;
 
     UniValue result(UniValue::VOBJ);
     result.pushKV("utxos", utxos);
+    if (nLimit > 0) {
+        result.pushKV("cursor", nextCursor);
+    }
+    if (!includeChainInfo)
+        return result;
 
     LOCK(cs_main);  // for chainActive
     result.pushKV("hash", chainActive.Tip()->GetBlockHash().GetHex());
@@ -886,7 +1078,7 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
     }
     if (fHelp || params.size() != 1)
         throw runtime_error(
-            "getaddressdeltas {\"addresses\": [\"taddr\", ...], (\"start\": n), (\"end\": n), (\"chainInfo\": true|false)}\n"
+            "getaddressdeltas {\"addresses\": [\"taddr\", ...], (\"start\": n), (\"end\": n), (\"chainInfo\": true|false), (\"limit\": n), (\"cursor\": \"token\")}\n"
             "\nReturns all changes for an address.\n"
             "\nReturns information about all changes to the given transparent addresses within the given (inclusive)\n"
             "\nblock height range, default is the full blockchain."
@@ -904,6 +1096,8 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
             "  \"start\"       (number, optional) The start block height\n"
             "  \"end\"         (number, optional) The end block height\n"
             "  \"chainInfo\"   (boolean, optional, default=false) Include chain info in results, only applies if start and end specified\n"
+            "  \"limit\"       (number, optional) Return at most this many deltas, and a cursor for the next page\n"
+            "  \"cursor\"      (string, optional) The cursor returned by the previous page of the same query\n"
             "}\n"
             "(or)\n"
             "\"address\"       (string) The base58check encoded address\n"
@@ -939,6 +1133,10 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
             "      \"hash\"          (string)  The end block hash\n"
             "      \"height\"        (numeric) The height of the end block\n"
             "    }\n"
+            "}\n\n"
+            "(or, if limit is given, an object with the \"deltas\" of the page, the chain info if requested, and):\n\n"
+            "{\n"
+            "  \"cursor\"          (string)  The cursor for the next page, or null if this is the last page\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressdeltas", "'{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"], \"start\": 1000, \"end\": 2000, \"chainInfo\": true}'")
@@ -954,9 +1152,21 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
     int end = 0;
     getHeightRange(params, start, end);
 
+    size_t nLimit = getPageLimit(params[0]);
+
     std::vector<std::pair<uint160, int>> addresses;
     std::vector<std::pair<CAddressIndexKey, CAmount>> addressIndex;
-    getAddressesInHeightRange(params, start, end, addresses, addressIndex);
+    UniValue nextCursor;
+    if (nLimit > 0) {
+        if (!getAddressesFromParams(params, addresses)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+        }
+        auto pos = decodeIndexCursor<CAddressIndexKey>(params[0], addresses, start, end);
+        getAddressIndexPage(addresses, start, end, nLimit, pos, addressIndex);
+        nextCursor = encodeIndexCursor(addresses, pos);
+    } else {
+        getAddressesInHeightRange(params, start, end, addresses, addressIndex);
+    }
 
     bool includeChainInfo = false;
     if (params[0].isObject()) {
@@ -983,12 +1193,20 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
         deltas.push_back(delta);
     }
 
-    UniValue result(UniValue::VOBJ);
-
-    if (!(includeChainInfo && start > 0 && end > 0)) {
+    bool fChainInfo = includeChainInfo && start > 0 && end > 0;
+    if (!fChainInfo && nLimit == 0) {
         return deltas;
     }
 
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("deltas", deltas);
+    if (nLimit > 0) {
+        result.pushKV("cursor", nextCursor);
+    }
+    if (!fChainInfo) {
+        return result;
+    }
+
     UniValue startInfo(UniValue::VOBJ);
     UniValue endInfo(UniValue::VOBJ);
     {
@@ -1002,13 +1220,105 @@ UniValue getaddressdeltas(const UniValue& params, bool fHelp)
     startInfo.pushKV("height", start);
     endInfo.pushKV("height", end);
 
-    result.pushKV("deltas", deltas);
     result.pushKV("start", startInfo);
     result.pushKV("end", endInfo);
 
     return result;
 }
 
+// insightexplorer
+/**
+ * Streaming handler for getaddressdeltas. The deltas are read from the index
+ * in batches, so the full result is never held in memory. The first batch is
+ * read before anything is written, so that configuration and address errors
+ * are still reported normally.
+ */
+static bool getaddressdeltas_stream(const UniValue& params, JSONStreamWriter& writer)
+{
+    if (!(fExperimentalInsightExplorer || fExperimentalLightWalletd) || params.size() != 1) {
+        return false;
+    }
+    if (getPageLimit(params[0]) > 0) {
+        // Paginated queries are small by construction.
+        return false;
+    }
+
+    int start = 0;
+    int end = 0;
+    getHeightRange(params, start, end);
+
+    std::vector<std::pair<uint160, int>> addresses;
+    if (!getAddressesFromParams(params, addresses)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+    }
+
+    bool includeChainInfo = false;
+    if (params[0].isObject()) {
+        UniValue chainInfo = find_value(params[0].get_obj(), "chainInfo");
+        if (!chainInfo.isNull()) {
+            includeChainInfo = chainInfo.get_bool();
+        }
+    }
+
+    // The results only involve the requested addresses, so encode each once.
+    std::map<std::pair<unsigned int, uint160>, std::string> encoded;
+    for (const auto& it : addresses) {
+        std::string address;
+        if (!getAddressFromIndex(it.second, it.first, address)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Unknown address type");
+        }
+        encoded.emplace(std::make_pair((unsigned int)it.second, it.first), address);
+    }
+
+    bool fChainInfo = includeChainInfo && start > 0 && end > 0;
+    UniValue startInfo(UniValue::VOBJ);
+    UniValue endInfo(UniValue::VOBJ);
+    if (fChainInfo) {
+        LOCK(cs_main);  // for chainActive
+        if (start > chainActive.Height() || end > chainActive.Height()) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Start or end is outside chain range");
+        }
+        startInfo.pushKV("hash", chainActive[start]->GetBlockHash().GetHex());
+        endInfo.pushKV("hash", chainActive[end]->GetBlockHash().GetHex());
+        startInfo.pushKV("height", start);
+        endInfo.pushKV("height", end);
+    }
+
+    AddressIndexPosition<CAddressIndexKey> pos;
+    std::vector<CAddressIndexDbEntry> addressIndex;
+    getAddressIndexPage(addresses, start, end, ADDRESS_INDEX_STREAM_BATCH_SIZE, pos, addressIndex);
+
+    if (fChainInfo) {
+        writer.BeginObject();
+        writer.Key("deltas");
+    }
+    writer.BeginArray();
+    while (true) {
+        for (const auto& it : addressIndex) {
+            UniValue delta(UniValue::VOBJ);
+            delta.pushKV("address", encoded.at(std::make_pair(it.first.type, it.first.hashBytes)));
+            delta.pushKV("blockindex", (int)it.first.txindex);
+            delta.pushKV("height", it.first.blockHeight);
+            delta.pushKV("index", (int)it.first.index);
+            delta.pushKV("satoshis", it.second);
+            delta.pushKV("txid", it.first.txhash.GetHex());
+            writer.Value(delta);
+        }
+        if (pos.AtEnd(addresses)) {
+            break;
+        }
+        addressIndex.clear();
+        getAddressIndexPage(addresses, start, end, ADDRESS_INDEX_STREAM_BATCH_SIZE, pos, addressIndex);
+    }
+    writer.EndArray();
+    if (fChainInfo) {
+        writer.PushKV("start", startInfo);
+        writer.PushKV("end", endInfo);
+        writer.EndObject();
+    }
+    return true;
+}
+
 // insightexplorer
 UniValue getaddressbalance(const UniValue& params, bool fHelp)
 {
@@ -1035,6 +1345,8 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
             "{\n"
             "  \"balance\"  (string) The current balance in " + MINOR_CURRENCY_UNIT + "\n"
             "  \"received\"  (string) The total number of " + MINOR_CURRENCY_UNIT + " received (including change)\n"
+            "  \"txcount\"  (numeric) The number of transactions involving each address, summed over the addresses\n"
+            "  \"utxocount\"  (numeric) The number of unspent outputs\n"
             "}\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddressbalance", "'{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"]}'")
@@ -1047,22 +1359,32 @@ UniValue getaddressbalance(const UniValue& params, bool fHelp)
     }
 
     std::vector<std::pair<uint160, int>> addresses;
-    std::vector<std::pair<CAddressIndexKey, CAmount>> addressIndex;
-    // this method doesn't take start and end block height params, so set
-    // to zero (full range, entire blockchain)
-    getAddressesInHeightRange(params, 0, 0, addresses, addressIndex);
+    if (!getAddressesFromParams(params, addresses)) {
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+    }
 
+    // The address index maintains running totals for each address, so this
+    // doesn't need to read the addresses' histories.
     CAmount balance = 0;
     CAmount received = 0;
-    for (const auto& it : addressIndex) {
-        if (it.second > 0) {
-            received += it.second;
+    int64_t txCount = 0;
+    int64_t utxoCount = 0;
+    for (const auto& it : addresses) {
+        CAddressBalanceValue totals;
+        if (!GetAddressBalance(it.first, it.second, totals)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY,
+                "No information available for address");
         }
-        balance += it.second;
+        balance += totals.balance;
+        received += totals.received;
+        txCount += totals.txCount;
+        utxoCount += totals.utxoCount;
     }
     UniValue result(UniValue::VOBJ);
     result.pushKV("balance", balance);
     result.pushKV("received", received);
+    result.pushKV("txcount", txCount);
+    result.pushKV("utxocount", utxoCount);
     return result;
 }
 
@@ -1075,7 +1397,7 @@ UniValue getaddresstxids(const UniValue& params, bool fHelp)
     }
     if (fHelp || params.size() != 1)
         throw runtime_error(
-            "getaddresstxids {\"addresses\": [\"taddr\", ...], (\"start\": n), (\"end\": n)}\n"
+            "getaddresstxids {\"addresses\": [\"taddr\", ...], (\"start\": n), (\"end\": n), (\"limit\": n), (\"cursor\": \"token\")}\n"
             "\nReturns the txids for given transparent addresses within the given (inclusive)\n"
             "\nblock height range, default is the full blockchain."
             "\nIf start or end are not specified, they default to zero."
@@ -1094,6 +1416,8 @@ UniValue getaddresstxids(const UniValue& params, bool fHelp)
             "    ]\n"
             "  \"start\" (number, optional) The start block height\n"
             "  \"end\" (number, optional) The end block height\n"
+            "  \"limit\" (number, optional) Read at most this many address index entries, and return a cursor for the next page\n"
+            "  \"cursor\" (string, optional) The cursor returned by the previous page of the same query\n"
             "}\n"
             "(or)\n"
             "\"address\"  (string) The base58check encoded address\n"
@@ -1101,7 +1425,13 @@ UniValue getaddresstxids(const UniValue& params, bool fHelp)
             "[\n"
             "  \"transactionid\"  (string) The transaction id\n"
             "  ,...\n"
-            "]\n"
+            "]\n\n"
+            "(or, if limit is given):\n\n"
+            "{\n"
+            "  \"txids\"      (array)  The txids of the page, as above\n"
+            "  \"cursor\"     (string) The cursor for the next page, or null if this is the last page\n"
+            "}\n"
+            "\nWith a limit, pages follow the order of the addresses, and txids are only sorted and de-duplicated within a page.\n"
             "\nExamples:\n"
             + HelpExampleCli("getaddresstxids", "'{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"], \"start\": 1000, \"end\": 2000}'")
             + HelpExampleRpc("getaddresstxids", "{\"addresses\": [\"tmYXBYJj1K7vhejSec5osXK2QsGa5MTisUQ\"], \"start\": 1000, \"end\": 2000}")
@@ -1116,9 +1446,21 @@ UniValue getaddresstxids(const UniValue& params, bool fHelp)
     int end = 0;
     getHeightRange(params, start, end);
 
+    size_t nLimit = getPageLimit(params[0]);
+
     std::vector<std::pair<uint160, int>> addresses;
     std::vector<std::pair<CAddressIndexKey, CAmount>> addressIndex;
-    getAddressesInHeightRange(params, start, end, addresses, addressIndex);
+    UniValue nextCursor;
+    if (nLimit > 0) {
+        if (!getAddressesFromParams(params, addresses)) {
+            throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address");
+        }
+        auto pos = decodeIndexCursor<CAddressIndexKey>(params[0], addresses, start, end);
+        getAddressIndexPage(addresses, start, end, nLimit, pos, addressIndex);
+        nextCursor = encodeIndexCursor(addresses, pos);
+    } else {
+        getAddressesInHeightRange(params, start, end, addresses, addressIndex);
+    }
 
     // This is an ordered set, sorted by (height,txindex) so result also sorted by height.
     std::set<std::tuple<int, int, std::string>> txids;
@@ -1136,6 +1478,12 @@ UniValue getaddresstxids(const UniValue& params, bool fHelp)
         result.push_back(std::get<2>(it));
     }
 
+    if (nLimit > 0) {
+        UniValue page(UniValue::VOBJ);
+        page.pushKV("txids", result);
+        page.pushKV("cursor", nextCursor);
+        return page;
+    }
     return result;
 }
 
@@ -1212,6 +1560,17 @@ static UniValue RPCLockedMemoryInfo()
     return obj;
 }
 
+static UniValue RPCValidityCacheInfo(const ValidityCacheStats& stats)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("max_entries", uint64_t(stats.nMaxEntries));
+    obj.pushKV("hits", stats.nHits);
+    obj.pushKV("misses", stats.nMisses);
+    obj.pushKV("inserts", stats.nInserts);
+    obj.pushKV("evictions", stats.nEvictions);
+    return obj;
+}
+
 UniValue getmemoryinfo(const UniValue& params, bool fHelp)
 {
     /* Please, avoid using the word "pool" here in the RPC interface or help,
@@ -1230,6 +1589,20 @@ UniValue getmemoryinfo(const UniValue& params, bool fHelp)
             "    \"locked\": xxxxxx,       (numeric) Amount of bytes that succeeded locking. If this number is smaller than total, locking pages failed at some point and key data could be swapped to disk.\n"
             "    \"chunks_used\": xxxxx,   (numeric) Number allocated chunks\n"
             "    \"chunks_free\": xxxxx,   (numeric) Number unused chunks\n"
+            "  },\n"
+            "  \"signature_cache\": {      (json object) Information about the cache of valid transparent signatures (see -maxsigcachesize)\n"
+            "    \"max_entries\": xxxxx,   (numeric) Number of entries the cache can hold\n"
+            "    \"hits\": xxxxx,          (numeric) Number of signatures found in the cache since the node started\n"
+            "    \"misses\": xxxxx,        (numeric) Number of signatures not found in the cache\n"
+            "    \"inserts\": xxxxx,       (numeric) Number of signatures added to the cache\n"
+            "    \"evictions\": xxxxx,     (numeric) Number of entries dropped to make room before they were used. If this grows, consider a larger cache\n"
+            "  },\n"
+            "  \"script_execution_cache\": { (json object) Information about the cache of transactions whose transparent inputs are valid (see -maxsigcachesize)\n"
+            "    \"max_entries\": xxxxx,   (numeric) Number of entries the cache can hold\n"
+            "    \"hits\": xxxxx,          (numeric) Number of transactions found in the cache since the node started\n"
+            "    \"misses\": xxxxx,        (numeric) Number of transactions not found in the cache\n"
+            "    \"inserts\": xxxxx,       (numeric) Number of transactions added to the cache\n"
+            "    \"evictions\": xxxxx,     (numeric) Number of entries dropped to make room before they were used\n"
             "  }\n"
             "}\n"
             "\nExamples:\n"
@@ -1238,6 +1611,8 @@ UniValue getmemoryinfo(const UniValue& params, bool fHelp)
         );
     UniValue obj(UniValue::VOBJ);
     obj.pushKV("locked", RPCLockedMemoryInfo());
+    obj.pushKV("signature_cache", RPCValidityCacheInfo(GetSignatureCacheStats()));
+    obj.pushKV("script_execution_cache", RPCValidityCacheInfo(GetScriptExecutionCacheStats()));
     return obj;
 }
 
@@ -1270,4 +1645,13 @@ void RegisterMiscRPCCommands(CRPCTable &tableRPC)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         tableRPC.appendCommand(commands[vcidx].name, &commands[vcidx]);
+
+    tableRPC.appendStreamingCommand("getaddressdeltas", &getaddressdeltas_stream);
+
+    // Read-only queries that may be run concurrently within a batch request.
+    for (const char* name : {
+            "getaddresstxids", "getaddressbalance", "getaddressdeltas",
+            "getaddressutxos", "getaddressmempool", "getspentinfo"}) {
+        tableRPC.appendConcurrentCommand(name);
+    }
 }
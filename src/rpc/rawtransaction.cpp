@@ -337,6 +337,46 @@ void TxToJSON(const CTransaction& tx, const uint256 hashBlock, UniValue& entry)
     }
 }
 
+/**
+ * Find the transaction requested by getrawtransaction, in the block given by
+ * the optional third parameter. Returns that block's index, or nullptr if no
+ * block was given.
+ */
+static CBlockIndex* FindRawTransaction(const UniValue& params, CTransaction& tx, uint256& hash_block)
+{
+    AssertLockHeld(cs_main);
+
+    uint256 hash = ParseHashV(params[0], "parameter 1");
+    CBlockIndex* blockindex = nullptr;
+
+    if (params.size() > 2) {
+        uint256 blockhash = ParseHashV(params[2], "parameter 3");
+        if (!blockhash.IsNull()) {
+            BlockMap::iterator it = mapBlockIndex.find(blockhash);
+            if (it == mapBlockIndex.end()) {
+                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block hash not found");
+            }
+            blockindex = it->second;
+        }
+    }
+
+    if (!GetTransaction(hash, tx, Params().GetConsensus(), hash_block, true, blockindex)) {
+        std::string errmsg;
+        if (blockindex) {
+            if (!(blockindex->nStatus & BLOCK_HAVE_DATA)) {
+                throw JSONRPCError(RPC_MISC_ERROR, "Block not available");
+            }
+            errmsg = "No such transaction found in the provided block";
+        } else {
+            errmsg = fTxIndex
+              ? "No such mempool or blockchain transaction"
+              : "No such mempool transaction. Use -txindex to enable blockchain transaction queries";
+        }
+        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, errmsg + ". Use gettransaction for wallet transactions.");
+    }
+    return blockindex;
+}
+
 UniValue getrawtransaction(const UniValue& params, bool fHelp)
 {
     if (fHelp || params.size() < 1 || params.size() > 3)
@@ -507,42 +547,13 @@ UniValue getrawtransaction(const UniValue& params, bool fHelp)
 
     LOCK(cs_main);
 
-    bool in_active_chain = true;
-    uint256 hash = ParseHashV(params[0], "parameter 1");
-    CBlockIndex* blockindex = nullptr;
-
     bool fVerbose = false;
     if (params.size() > 1)
         fVerbose = (params[1].get_int() != 0);
 
-    if (params.size() > 2) {
-        uint256 blockhash = ParseHashV(params[2], "parameter 3");
-        if (!blockhash.IsNull()) {
-            BlockMap::iterator it = mapBlockIndex.find(blockhash);
-            if (it == mapBlockIndex.end()) {
-                throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Block hash not found");
-            }
-            blockindex = it->second;
-            in_active_chain = chainActive.Contains(blockindex);
-        }
-    }
-
     CTransaction tx;
     uint256 hash_block;
-    if (!GetTransaction(hash, tx, Params().GetConsensus(), hash_block, true, blockindex)) {
-        std::string errmsg;
-        if (blockindex) {
-            if (!(blockindex->nStatus & BLOCK_HAVE_DATA)) {
-                throw JSONRPCError(RPC_MISC_ERROR, "Block not available");
-            }
-            errmsg = "No such transaction found in the provided block";
-        } else {
-            errmsg = fTxIndex
-              ? "No such mempool or blockchain transaction"
-              : "No such mempool transaction. Use -txindex to enable blockchain transaction queries";
-        }
-        throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, errmsg + ". Use gettransaction for wallet transactions.");
-    }
+    CBlockIndex* blockindex = FindRawTransaction(params, tx, hash_block);
 
     string strHex = EncodeHexTx(tx);
 
@@ -550,34 +561,15 @@ UniValue getrawtransaction(const UniValue& params, bool fHelp)
         return strHex;
 
     UniValue result(UniValue::VOBJ);
-    if (blockindex) result.pushKV("in_active_chain", in_active_chain);
+    if (blockindex) result.pushKV("in_active_chain", chainActive.Contains(blockindex));
     result.pushKV("hex", strHex);
     TxToJSON(tx, hash_block, result);
     return result;
 }
 
-UniValue gettxoutproof(const UniValue& params, bool fHelp)
+/** Build the serialized proof requested by gettxoutproof. */
+static std::vector<unsigned char> GetTxOutProof(const UniValue& params)
 {
-    if (fHelp || (params.size() != 1 && params.size() != 2))
-        throw runtime_error(
-            "gettxoutproof [\"txid\",...] ( blockhash )\n"
-            "\nReturns a hex-encoded proof that \"txid\" was included in a block.\n"
-            "\nNOTE: By default this function only works sometimes. This is when there is an\n"
-            "unspent output in the utxo for this transaction. To make it always work,\n"
-            "you need to maintain a transaction index, using the -txindex command line option or\n"
-            "specify the block in which the transaction is included in manually (by blockhash).\n"
-            "\nReturn the raw transaction data.\n"
-            "\nArguments:\n"
-            "1. \"txids\"       (string) A json array of txids to filter\n"
-            "    [\n"
-            "      \"txid\"     (string) A transaction hash\n"
-            "      ,...\n"
-            "    ]\n"
-            "2. \"block hash\"  (string, optional) If specified, looks for txid in the block with this hash\n"
-            "\nResult:\n"
-            "\"data\"           (string) A string that is a serialized, hex-encoded data for the proof.\n"
-        );
-
     set<uint256> setTxids;
     uint256 oneTxid;
     UniValue txids = params[0].get_array();
@@ -633,8 +625,57 @@ UniValue gettxoutproof(const UniValue& params, bool fHelp)
     CDataStream ssMB(SER_NETWORK, PROTOCOL_VERSION);
     CMerkleBlock mb(block, setTxids);
     ssMB << mb;
-    std::string strHex = HexStr(ssMB.begin(), ssMB.end());
-    return strHex;
+    return std::vector<unsigned char>(ssMB.begin(), ssMB.end());
+}
+
+UniValue gettxoutproof(const UniValue& params, bool fHelp)
+{
+    if (fHelp || (params.size() != 1 && params.size() != 2))
+        throw runtime_error(
+            "gettxoutproof [\"txid\",...] ( blockhash )\n"
+            "\nReturns a hex-encoded proof that \"txid\" was included in a block.\n"
+            "\nNOTE: By default this function only works sometimes. This is when there is an\n"
+            "unspent output in the utxo for this transaction. To make it always work,\n"
+            "you need to maintain a transaction index, using the -txindex command line option or\n"
+            "specify the block in which the transaction is included in manually (by blockhash).\n"
+            "\nReturn the raw transaction data.\n"
+            "\nArguments:\n"
+            "1. \"txids\"       (string) A json array of txids to filter\n"
+            "    [\n"
+            "      \"txid\"     (string) A transaction hash\n"
+            "      ,...\n"
+            "    ]\n"
+            "2. \"block hash\"  (string, optional) If specified, looks for txid in the block with this hash\n"
+            "\nResult:\n"
+            "\"data\"           (string) A string that is a serialized, hex-encoded data for the proof.\n"
+        );
+
+    return HexStr(GetTxOutProof(params));
+}
+
+/** Binary result handler for getrawtransaction with verbose=0. */
+static bool getrawtransaction_binary(const UniValue& params, std::vector<unsigned char>& result)
+{
+    if (params.size() > 1 && params[1].get_int() != 0)
+        return false;
+
+    LOCK(cs_main);
+
+    CTransaction tx;
+    uint256 hash_block;
+    FindRawTransaction(params, tx, hash_block);
+
+    CDataStream ssTx(SER_NETWORK, PROTOCOL_VERSION);
+    ssTx << tx;
+    result.assign(ssTx.begin(), ssTx.end());
+    return true;
+}
+
+/** Binary result handler for gettxoutproof. */
+static bool gettxoutproof_binary(const UniValue& params, std::vector<unsigned char>& result)
+{
+    result = GetTxOutProof(params);
+    return true;
 }
 
 UniValue verifytxoutproof(const UniValue& params, bool fHelp)
@@ -1337,4 +1378,14 @@ void RegisterRawTransactionRPCCommands(CRPCTable &tableRPC)
 {
     for (unsigned int vcidx = 0; vcidx < ARRAYLEN(commands); vcidx++)
         tableRPC.appendCommand(commands[vcidx].name, &commands[vcidx]);
+
+    // Read-only queries that may be run concurrently within a batch request.
+    for (const char* name : {
+            "getrawtransaction", "decoderawtransaction", "decodescript",
+            "gettxoutproof", "verifytxoutproof"}) {
+        tableRPC.appendConcurrentCommand(name);
+    }
+
+    tableRPC.appendBinaryResultCommand("getrawtransaction", &getrawtransaction_binary);
+    tableRPC.appendBinaryResultCommand("gettxoutproof", &gettxoutproof_binary);
 }
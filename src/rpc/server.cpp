@@ -11,12 +11,15 @@
 #include "key_io.h"
 #include "random.h"
 #include "rpc/common.h"
+#include "rpc/jsonstream.h"
 #include "sync.h"
 #include "ui_interface.h"
 #include "util/system.h"
 #include "util/strencodings.h"
 #include "asyncrpcqueue.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 
 #include <univalue.h>
@@ -291,6 +294,120 @@ UniValue stop(const UniValue& params, bool fHelp)
     return "Zcash server stopping";
 }
 
+/** Latency of a kind of RPC call */
+struct RPCLatencyStats
+{
+    uint64_t nCalls = 0;
+    int64_t nTotalMicros = 0;
+    int64_t nMaxMicros = 0;
+
+    void Add(int64_t nMicros)
+    {
+        nCalls++;
+        nTotalMicros += nMicros;
+        nMaxMicros = std::max(nMaxMicros, nMicros);
+    }
+
+    void PushKVs(UniValue& obj) const
+    {
+        obj.pushKV("calls", nCalls);
+        obj.pushKV("total_ms", nTotalMicros / 1000.0);
+        obj.pushKV("avg_ms", nCalls == 0 ? 0.0 : nTotalMicros / 1000.0 / nCalls);
+        obj.pushKV("max_ms", nMaxMicros / 1000.0);
+    }
+};
+
+struct RPCMethodStats
+{
+    RPCLatencyStats latency;
+    uint64_t nErrors = 0;
+};
+
+struct RPCBatchStats
+{
+    RPCLatencyStats latency;
+    uint64_t nBatches = 0;
+    uint64_t nRequests = 0;
+    uint64_t nConcurrentRequests = 0;
+};
+
+static Mutex cs_rpcStats;
+static std::map<std::string, RPCMethodStats> mapRPCMethodStats GUARDED_BY(cs_rpcStats);
+static RPCBatchStats rpcBatchStats GUARDED_BY(cs_rpcStats);
+
+/** Records the latency of a command when it goes out of scope. */
+class RPCCallTimer
+{
+private:
+    const std::string& strMethod;
+    int64_t nTimeStart;
+public:
+    bool fError = true;
+
+    RPCCallTimer(const std::string& strMethod) : strMethod(strMethod), nTimeStart(GetTimeMicros()) {}
+    ~RPCCallTimer()
+    {
+        int64_t nMicros = GetTimeMicros() - nTimeStart;
+        LOCK(cs_rpcStats);
+        RPCMethodStats& stats = mapRPCMethodStats[strMethod];
+        stats.latency.Add(nMicros);
+        if (fError)
+            stats.nErrors++;
+    }
+};
+
+UniValue getrpcinfo(const UniValue& params, bool fHelp)
+{
+    if (fHelp || params.size() != 0)
+        throw runtime_error(
+            "getrpcinfo\n"
+            "\nReturns latency statistics for the RPC calls handled since startup.\n"
+            "\nResult:\n"
+            "{\n"
+            "  \"methods\": {              (json object) statistics for each method that has been called\n"
+            "    \"method\": {\n"
+            "      \"calls\": n,            (numeric) number of calls, including failed calls\n"
+            "      \"total_ms\": n,         (numeric) total execution time in milliseconds\n"
+            "      \"avg_ms\": n,           (numeric) average execution time in milliseconds\n"
+            "      \"max_ms\": n,           (numeric) longest execution time in milliseconds\n"
+            "      \"errors\": n            (numeric) number of calls that failed\n"
+            "    }, ...\n"
+            "  },\n"
+            "  \"batches\": {\n"
+            "    \"calls\": n,              (numeric) number of batch requests\n"
+            "    \"total_ms\": n,           (numeric) total time taken by batch requests in milliseconds\n"
+            "    \"avg_ms\": n,             (numeric) average time taken by a batch request in milliseconds\n"
+            "    \"max_ms\": n,             (numeric) longest time taken by a batch request in milliseconds\n"
+            "    \"requests\": n,           (numeric) total number of requests in those batches\n"
+            "    \"concurrent_requests\": n (numeric) number of those requests that were executed concurrently\n"
+            "  }\n"
+            "}\n"
+            "\nExamples:\n"
+            + HelpExampleCli("getrpcinfo", "")
+            + HelpExampleRpc("getrpcinfo", "")
+        );
+
+    UniValue methods(UniValue::VOBJ);
+    UniValue batches(UniValue::VOBJ);
+    {
+        LOCK(cs_rpcStats);
+        for (const auto& [name, stats] : mapRPCMethodStats) {
+            UniValue obj(UniValue::VOBJ);
+            stats.latency.PushKVs(obj);
+            obj.pushKV("errors", stats.nErrors);
+            methods.pushKV(name, obj);
+        }
+        rpcBatchStats.latency.PushKVs(batches);
+        batches.pushKV("requests", rpcBatchStats.nRequests);
+        batches.pushKV("concurrent_requests", rpcBatchStats.nConcurrentRequests);
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("methods", methods);
+    ret.pushKV("batches", batches);
+    return ret;
+}
+
 /**
  * Call Table
  */
@@ -298,6 +415,7 @@ static const CRPCCommand vRPCCommands[] =
 { //  category              name                      actor (function)         okSafeMode
   //  --------------------- ------------------------  -----------------------  ----------
     /* Overall control/query calls */
+    { "control",            "getrpcinfo",             &getrpcinfo,             true  },
     { "control",            "help",                   &help,                   true  },
     { "control",            "setlogfilter",           &setlogfilter,           true  },
     { "control",            "stop",                   &stop,                   true  },
@@ -343,20 +461,17 @@ bool StartRPC()
     fRPCRunning = true;
     g_rpcSignals.Started();
 
-    // Launch one async rpc worker.  The ability to launch multiple workers is not recommended at present and thus the option is disabled.
-    getAsyncRPCQueue()->addWorker();
-/*
-    int n = GetArg("-rpcasyncthreads", 1);
-    if (n<1) {
-        LogPrintf("ERROR: Invalid value %d for -rpcasyncthreads.  Must be at least 1.\n", n);
-        strerr = strprintf(_("An error occurred while setting up the Async RPC threads, invalid parameter value of %d (must be at least 1)."), n);
-        uiInterface.ThreadSafeMessageBox(strerr, "", CClientUIInterface::MSG_ERROR);
-        StartShutdown();
-        return;
+    int nAsyncThreads = GetArg("-rpcasyncthreads", DEFAULT_ASYNC_RPC_THREADS);
+    if (nAsyncThreads <= 0) {
+        // Scale with the machine, leaving cores for proving.
+        nAsyncThreads = GetNumCores() / 2;
     }
-    for (int i = 0; i < n; i++)
+    nAsyncThreads = std::max(1, std::min(nAsyncThreads, MAX_ASYNC_RPC_THREADS));
+    AsyncRPCProvingJob::setLimit(std::max(1, (int)GetArg("-rpcasyncprovingjobs", DEFAULT_ASYNC_RPC_PROVING_JOBS)));
+    LogPrintf("Using %d async RPC workers, at most %d proving at once\n",
+        nAsyncThreads, AsyncRPCProvingJob::getLimit());
+    for (int i = 0; i < nAsyncThreads; i++)
         getAsyncRPCQueue()->addWorker();
-*/
     return true;
 }
 
@@ -457,16 +572,97 @@ static UniValue JSONRPCExecOne(const UniValue& req)
     return rpc_result;
 }
 
-std::string JSONRPCExecBatch(const UniValue& vReq)
+/** Shared state of a run of batch requests being executed concurrently */
+struct ConcurrentBatchRun
 {
+    const UniValue& vReq;
+    const size_t nEnd;
+    std::atomic<size_t> nNext;
+    std::vector<UniValue> results;
+
+    Mutex cs;
+    std::condition_variable cond;
+    size_t nDone GUARDED_BY(cs) = 0;
+
+    ConcurrentBatchRun(const UniValue& vReq, size_t nBegin, size_t nEnd) :
+        vReq(vReq), nEnd(nEnd), nNext(nBegin), results(nEnd - nBegin) {}
+
+    /**
+     * Execute requests from the run until none are left unclaimed. Only
+     * claimed requests are accessed, so helpers that start after the caller
+     * has finished waiting do nothing.
+     */
+    void Work()
+    {
+        size_t nBegin = nEnd - results.size();
+        size_t idx;
+        while ((idx = nNext++) < nEnd) {
+            results[idx - nBegin] = JSONRPCExecOne(vReq[idx]);
+            LOCK(cs);
+            if (++nDone == results.size()) {
+                cond.notify_all();
+            }
+        }
+    }
+};
+
+static bool IsConcurrentRequest(const UniValue& req)
+{
+    if (!req.isObject())
+        return false;
+    const UniValue& method = find_value(req.get_obj(), "method");
+    return method.isStr() && tableRPC.isConcurrent(method.get_str());
+}
+
+std::string JSONRPCExecBatch(const UniValue& vReq, const RPCTaskDispatcher& dispatch, size_t nMaxHelpers)
+{
+    int64_t nTimeStart = GetTimeMicros();
+    size_t nConcurrent = 0;
+
     UniValue ret(UniValue::VARR);
-    for (size_t reqIdx = 0; reqIdx < vReq.size(); reqIdx++)
-        ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+    size_t reqIdx = 0;
+    while (reqIdx < vReq.size()) {
+        size_t runEnd = reqIdx;
+        if (dispatch && nMaxHelpers > 0) {
+            while (runEnd < vReq.size() && IsConcurrentRequest(vReq[runEnd]))
+                runEnd++;
+        }
+        if (runEnd - reqIdx < 2) {
+            ret.push_back(JSONRPCExecOne(vReq[reqIdx]));
+            reqIdx++;
+            continue;
+        }
+
+        auto run = std::make_shared<ConcurrentBatchRun>(vReq, reqIdx, runEnd);
+        size_t nHelpers = std::min(nMaxHelpers, runEnd - reqIdx - 1);
+        for (size_t i = 0; i < nHelpers; i++) {
+            if (!dispatch([run]() { run->Work(); }))
+                break;
+        }
+        run->Work();
+        {
+            WAIT_LOCK(run->cs, lock);
+            while (run->nDone < run->results.size())
+                run->cond.wait(lock);
+        }
+        for (const UniValue& result : run->results)
+            ret.push_back(result);
+        nConcurrent += runEnd - reqIdx;
+        reqIdx = runEnd;
+    }
+
+    {
+        LOCK(cs_rpcStats);
+        rpcBatchStats.nBatches++;
+        rpcBatchStats.nRequests += vReq.size();
+        rpcBatchStats.nConcurrentRequests += nConcurrent;
+        rpcBatchStats.latency.Add(GetTimeMicros() - nTimeStart);
+    }
 
     return ret.write() + "\n";
 }
 
-UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params) const
+const CRPCCommand* CRPCTable::prepareCommand(const std::string &strMethod, const UniValue &params) const
 {
     // Return immediately if in warmup
     {
@@ -482,45 +678,104 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
 
     g_rpcSignals.PreCommand(*pcmd);
 
+    auto paramRange = rpcCvtTable.find(strMethod);
+    if (paramRange != rpcCvtTable.end()) {
+        auto numRequired = paramRange->second.first.size();
+        auto numOptional = paramRange->second.second.size();
+        if (params.size() < numRequired || numRequired + numOptional < params.size()) {
+            std::string helpMsg;
+            try {
+                // help gets thrown – if it doesn’t throw, then no help message
+                pcmd->actor(params, true);
+            } catch (const std::runtime_error& err) {
+                helpMsg = std::string("\n\n") + err.what();
+            }
+            throw JSONRPCError(
+                RPC_INVALID_PARAMS,
+                strprintf(
+                        "%s for method `%s`. Needed %s, but received %u%s",
+                        params.size() < numRequired
+                        ? "Not enough parameters"
+                        : "Too many parameters",
+                        strMethod,
+                        numOptional == 0
+                        ? strprintf("exactly %u", numRequired)
+                        : strprintf("at least %u and at most %u", numRequired, numRequired + numOptional),
+                        params.size(),
+                        helpMsg));
+        }
+    } else {
+        throw JSONRPCError(
+                RPC_INTERNAL_ERROR,
+                "Parameters for "
+                + strMethod
+                + " not found – this is an internal error, please report it.");
+    }
+    return pcmd;
+}
+
+UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params) const
+{
+    const CRPCCommand *pcmd = prepareCommand(strMethod, params);
+
     try
     {
         // Execute
-        auto paramRange = rpcCvtTable.find(strMethod);
-        if (paramRange != rpcCvtTable.end()) {
-            auto numRequired = paramRange->second.first.size();
-            auto numOptional = paramRange->second.second.size();
-            if (params.size() < numRequired || numRequired + numOptional < params.size()) {
-                std::string helpMsg;
-                try {
-                    // help gets thrown – if it doesn’t throw, then no help message
-                    pcmd->actor(params, true);
-                } catch (const std::runtime_error& err) {
-                    helpMsg = std::string("\n\n") + err.what();
-                }
-                throw JSONRPCError(
-                    RPC_INVALID_PARAMS,
-                    strprintf(
-                            "%s for method `%s`. Needed %s, but received %u%s",
-                            params.size() < numRequired
-                            ? "Not enough parameters"
-                            : "Too many parameters",
-                            strMethod,
-                            numOptional == 0
-                            ? strprintf("exactly %u", numRequired)
-                            : strprintf("at least %u and at most %u", numRequired, numRequired + numOptional),
-                            params.size(),
-                            helpMsg));
-            } else {
-                return pcmd->actor(params, false);
-            }
-        } else {
-            throw JSONRPCError(
-                    RPC_INTERNAL_ERROR,
-                    "Parameters for "
-                    + strMethod
-                    + " not found – this is an internal error, please report it.");
+        RPCCallTimer timer(pcmd->name);
+        UniValue result = pcmd->actor(params, false);
+        timer.fError = false;
+        return result;
+    }
+    catch (const std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
+
+bool CRPCTable::executeStreaming(const std::string &strMethod, const UniValue &params, JSONStreamWriter& writer) const
+{
+    auto it = mapStreamingCommands.find(strMethod);
+    if (it == mapStreamingCommands.end())
+        return false;
+
+    const CRPCCommand *pcmd = prepareCommand(strMethod, params);
+
+    try
+    {
+        RPCCallTimer timer(pcmd->name);
+        if (!it->second(params, writer)) {
+            // The handler declined these params; run the method as usual,
+            // rather than having the caller prepare it a second time.
+            writer.Value(pcmd->actor(params, false));
         }
+        timer.fError = false;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        throw JSONRPCError(RPC_MISC_ERROR, e.what());
+    }
+}
 
+bool CRPCTable::executeBinary(const std::string &strMethod, const UniValue &params, std::vector<unsigned char>& bytes, UniValue& result) const
+{
+    auto it = mapBinaryResultCommands.find(strMethod);
+    if (it == mapBinaryResultCommands.end()) {
+        result = execute(strMethod, params);
+        return false;
+    }
+
+    const CRPCCommand *pcmd = prepareCommand(strMethod, params);
+
+    try
+    {
+        RPCCallTimer timer(pcmd->name);
+        bool fBinary = it->second(params, bytes);
+        if (!fBinary) {
+            result = pcmd->actor(params, false);
+        }
+        timer.fError = false;
+        return fBinary;
     }
     catch (const std::exception& e)
     {
@@ -528,6 +783,49 @@ UniValue CRPCTable::execute(const std::string &strMethod, const UniValue &params
     }
 }
 
+bool CRPCTable::appendStreamingCommand(const std::string& name, rpcstreamfn_type actor)
+{
+    if (IsRPCRunning())
+        return false;
+
+    // The command must already be registered, and can only have one streaming handler.
+    if (mapCommands.count(name) == 0 || mapStreamingCommands.count(name))
+        return false;
+
+    mapStreamingCommands[name] = actor;
+    return true;
+}
+
+bool CRPCTable::appendConcurrentCommand(const std::string& name)
+{
+    if (IsRPCRunning())
+        return false;
+
+    if (mapCommands.count(name) == 0)
+        return false;
+
+    setConcurrentCommands.insert(name);
+    return true;
+}
+
+bool CRPCTable::isConcurrent(const std::string& name) const
+{
+    return setConcurrentCommands.count(name) > 0;
+}
+
+bool CRPCTable::appendBinaryResultCommand(const std::string& name, rpcbinaryfn_type actor)
+{
+    if (IsRPCRunning())
+        return false;
+
+    // The command must already be registered, and can only have one binary result handler.
+    if (mapCommands.count(name) == 0 || mapBinaryResultCommands.count(name))
+        return false;
+
+    mapBinaryResultCommands[name] = actor;
+    return true;
+}
+
 std::vector<std::string> CRPCTable::listCommands() const
 {
     std::vector<std::string> commandList;
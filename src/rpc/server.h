@@ -14,9 +14,11 @@
 
 #include <list>
 #include <map>
+#include <set>
 #include <stdint.h>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include <univalue.h>
 
@@ -33,6 +35,7 @@ namespace RPCServer
 
 class CBlockIndex;
 class CNetAddr;
+class JSONStreamWriter;
 
 class JSONRequest
 {
@@ -119,6 +122,21 @@ void RPCRunLater(const std::string& name, std::function<void(void)> func, int64_
 
 typedef UniValue(*rpcfn_type)(const UniValue& params, bool fHelp);
 
+/**
+ * A handler that writes a command's result incrementally. It returns false,
+ * without writing anything, to leave the request to the command's normal
+ * actor. Handlers must not hold cs_main or other contended locks while
+ * writing, because writing blocks while the client is slow to read.
+ */
+typedef bool(*rpcstreamfn_type)(const UniValue& params, JSONStreamWriter& writer);
+
+/**
+ * A handler that produces a command's result as the raw serialized data that
+ * its actor would return hex-encoded. It returns false, without setting
+ * result, to leave the request to the command's normal actor.
+ */
+typedef bool(*rpcbinaryfn_type)(const UniValue& params, std::vector<unsigned char>& result);
+
 class CRPCCommand
 {
 public:
@@ -135,6 +153,11 @@ class CRPCTable
 {
 private:
     std::map<std::string, const CRPCCommand*> mapCommands;
+    std::map<std::string, rpcstreamfn_type> mapStreamingCommands;
+    std::set<std::string> setConcurrentCommands;
+    std::map<std::string, rpcbinaryfn_type> mapBinaryResultCommands;
+
+    const CRPCCommand* prepareCommand(const std::string &method, const UniValue &params) const;
 public:
     CRPCTable();
     const CRPCCommand* operator[](const std::string& name) const;
@@ -149,6 +172,26 @@ public:
      */
     UniValue execute(const std::string &method, const UniValue &params) const;
 
+    /**
+     * Execute a method with its streaming handler, writing the result to writer.
+     * If the handler declines these params, the method is executed as usual
+     * and its result written to writer.
+     * @returns false if the method has no streaming handler, in which case
+     * nothing has been written.
+     * @throws an exception (UniValue) when an error happens.
+     */
+    bool executeStreaming(const std::string &method, const UniValue &params, JSONStreamWriter& writer) const;
+
+    /**
+     * Execute a method with its binary result handler, if it has one.
+     * @returns true if the handler set bytes to the raw serialized result, or
+     * false if the method has no binary result handler or it declined these
+     * params, in which case the method is executed as usual and its result
+     * set in result.
+     * @throws an exception (UniValue) when an error happens.
+     */
+    bool executeBinary(const std::string &method, const UniValue &params, std::vector<unsigned char>& bytes, UniValue& result) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -162,6 +205,30 @@ public:
      * Commands cannot be overwritten (returns false).
      */
     bool appendCommand(const std::string& name, const CRPCCommand* pcmd);
+
+    /**
+     * Adds a streaming handler for a command that is already in the dispatch
+     * table. The command's actor still provides its help, and handles requests
+     * the streaming handler declines and requests that are part of a batch.
+     */
+    bool appendStreamingCommand(const std::string& name, rpcstreamfn_type actor);
+
+    /**
+     * Marks a command that is already in the dispatch table as safe to run
+     * concurrently with, and reorder relative to, other such commands in the
+     * same batch request. This should only be used for read-only commands.
+     */
+    bool appendConcurrentCommand(const std::string& name);
+
+    /** Whether a command may be run concurrently within a batch request. */
+    bool isConcurrent(const std::string& name) const;
+
+    /**
+     * Adds a binary result handler for a command that is already in the
+     * dispatch table. Clients that request a binary encoding receive the
+     * handler's result as raw bytes, rather than the actor's hex string.
+     */
+    bool appendBinaryResultCommand(const std::string& name, rpcbinaryfn_type actor);
 };
 
 extern CRPCTable tableRPC;
@@ -189,7 +256,20 @@ extern void EnsureWalletIsUnlocked();
 bool StartRPC();
 void InterruptRPC();
 void StopRPC();
-std::string JSONRPCExecBatch(const UniValue& vReq);
+
+/**
+ * Schedules a task to be run on another thread. Returns false if the task
+ * could not be scheduled, in which case it will not be run.
+ */
+typedef std::function<bool(const std::function<void()>&)> RPCTaskDispatcher;
+
+/**
+ * Execute a batch request. Runs of consecutive requests for concurrent
+ * commands are spread over the calling thread and up to nMaxHelpers tasks
+ * scheduled with dispatch; everything else is executed in order on the
+ * calling thread. The replies are always returned in request order.
+ */
+std::string JSONRPCExecBatch(const UniValue& vReq, const RPCTaskDispatcher& dispatch = nullptr, size_t nMaxHelpers = 0);
 
 extern std::string experimentalDisabledHelpMsg(const std::string& rpc, const std::vector<std::string>& enableArgs);
 
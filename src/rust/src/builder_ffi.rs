@@ -24,6 +24,7 @@ use zcash_protocol::{consensus::BranchId, memo::MemoBytes, value::ZatBalance};
 
 use crate::{
     bridge::ffi::OrchardUnauthorizedBundlePtr,
+    in_proving_threadpool,
     transaction_ffi::{MapTransparent, TransparentAuth},
     ORCHARD_PK, ORCHARD_PK_INSECURE,
 };
@@ -207,7 +208,10 @@ pub extern "C" fn orchard_unauthorized_bundle_prove_and_sign(
     // the historical insecure circuit (`ORCHARD_PK_INSECURE`, reached only pre-NU6.2 on
     // regtest). Reading the version from the bundle keeps it the single source of truth, so the
     // proving key cannot disagree with the circuit the actions were built against.
-    let proof = match bundle.circuit_version() {
+    //
+    // An Orchard bundle has a single proof covering all of its actions, so there is nothing to
+    // split up here; Halo 2 parallelizes internally, within the proving threadpool.
+    let proof = in_proving_threadpool(|| match bundle.circuit_version() {
         OrchardCircuitVersion::FixedPostNu6_2 => bundle.create_proof(
             ORCHARD_PK
                 .get()
@@ -217,7 +221,7 @@ pub extern "C" fn orchard_unauthorized_bundle_prove_and_sign(
         OrchardCircuitVersion::InsecurePreNu6_2 => {
             bundle.create_proof(&ORCHARD_PK_INSECURE, &mut rng)
         }
-    };
+    });
     let res = proof.and_then(|b| b.apply_signatures(rng, *sighash, &signing_keys));
 
     match res {
@@ -7,8 +7,9 @@ use sapling::circuit::{OutputParameters, SpendParameters};
 use tracing::info;
 
 use crate::{
-    ORCHARD_PK, ORCHARD_VK_FIXED, ORCHARD_VK_INSECURE, SAPLING_OUTPUT_PARAMS, SAPLING_OUTPUT_VK,
-    SAPLING_SPEND_PARAMS, SAPLING_SPEND_VK, SPROUT_GROTH16_PARAMS_PATH, SPROUT_GROTH16_VK,
+    ORCHARD_PK, ORCHARD_VK_FIXED, ORCHARD_VK_INSECURE, PROVING_THREADPOOL, SAPLING_OUTPUT_PARAMS,
+    SAPLING_OUTPUT_VK, SAPLING_SPEND_PARAMS, SAPLING_SPEND_VK, SPROUT_GROTH16_PARAMS_PATH,
+    SPROUT_GROTH16_VK,
 };
 
 #[cxx::bridge]
@@ -16,6 +17,7 @@ mod ffi {
     #[namespace = "init"]
     extern "Rust" {
         fn rayon_threadpool();
+        fn proving_threadpool(threads: usize);
         fn zksnark_params(sprout_path: String, load_proving_keys: bool);
     }
 }
@@ -27,6 +29,19 @@ fn rayon_threadpool() {
         .expect("Only initialized once");
 }
 
+/// Sets up the threadpool used to create zk-SNARK proofs. If `threads` is zero, the pool
+/// has one thread per available core.
+fn proving_threadpool(threads: usize) {
+    let pool = rayon::ThreadPoolBuilder::new()
+        .num_threads(threads)
+        .thread_name(|i| format!("zc-prover-{}", i))
+        .build()
+        .expect("Proving threadpool should be constructible");
+    if PROVING_THREADPOOL.set(pool).is_err() {
+        panic!("Only initialized once");
+    }
+}
+
 /// Loads the zk-SNARK parameters into memory and saves paths as necessary.
 /// Only called once.
 ///
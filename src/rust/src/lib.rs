@@ -96,6 +96,20 @@ static ORCHARD_VK_INSECURE: LazyLock<orchard::circuit::VerifyingKey> = LazyLock:
 static ORCHARD_VK_FIXED: LazyLock<orchard::circuit::VerifyingKey> =
     LazyLock::new(orchard::circuit::VerifyingKey::build);
 
+// A dedicated pool for creating zk-SNARK proofs, sized by `-provingthreads`, so that
+// proving a transaction with many shielded spends and outputs cannot starve the global
+// Rayon pool used for batch validation and wallet scanning.
+static PROVING_THREADPOOL: OnceLock<rayon::ThreadPool> = OnceLock::new();
+
+/// Runs `op` inside the proving threadpool if it has been configured, or on the current
+/// thread (and the global Rayon pool) otherwise.
+fn in_proving_threadpool<R: Send>(op: impl FnOnce() -> R + Send) -> R {
+    match PROVING_THREADPOOL.get() {
+        Some(pool) => pool.install(op),
+        None => op(),
+    }
+}
+
 /// Converts CtOption<t> into Option<T>
 fn de_ct<T>(ct: CtOption<T>) -> Option<T> {
     if ct.is_some().into() {
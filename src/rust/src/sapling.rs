@@ -5,15 +5,18 @@
 use std::convert::{TryFrom, TryInto};
 use std::io;
 use std::mem;
+use std::sync::Mutex;
 
 use bellman::groth16::Proof;
 use bls12_381::Bls12;
 use group::GroupEncoding;
 use memuse::DynamicUsage;
 use rand_core::{OsRng, RngCore};
+use rayon::prelude::*;
 use sapling::keys::EphemeralSecretKey;
 use sapling::{
     builder::BundleType,
+    bundle::GrothProofBytes,
     circuit::{self, OutputParameters, SpendParameters},
     keys::{OutgoingViewingKey, SpendAuthorizingKey},
     note::ExtractedNoteCommitment,
@@ -40,6 +43,7 @@ use super::{
 use crate::params::Network;
 use crate::{
     bundlecache::{sapling_bundle_validity_cache, sapling_bundle_validity_cache_mut, CacheEntries},
+    in_proving_threadpool,
     streams::CppStream,
 };
 
@@ -384,6 +388,81 @@ impl OutputProver for StaticTxProver {
     }
 }
 
+/// A prover that hands out proofs created ahead of time, in the order in which the bundle
+/// requests them. This lets us create the proofs for a bundle in parallel while still using
+/// the bundle's own logic to attach them.
+struct PrecomputedProofs(Mutex<std::vec::IntoIter<GrothProofBytes>>);
+
+impl PrecomputedProofs {
+    fn new(proofs: Vec<GrothProofBytes>) -> Self {
+        PrecomputedProofs(Mutex::new(proofs.into_iter()))
+    }
+
+    fn next_proof(&self) -> GrothProofBytes {
+        self.0
+            .lock()
+            .unwrap()
+            .next()
+            .expect("A proof was precomputed for every spend and output")
+    }
+}
+
+impl SpendProver for PrecomputedProofs {
+    type Proof = GrothProofBytes;
+
+    fn prepare_circuit(
+        proof_generation_key: ProofGenerationKey,
+        diversifier: Diversifier,
+        rseed: Rseed,
+        value: NoteValue,
+        alpha: jubjub::Fr,
+        rcv: ValueCommitTrapdoor,
+        anchor: bls12_381::Scalar,
+        merkle_path: MerklePath,
+    ) -> Option<circuit::Spend> {
+        <StaticTxProver as SpendProver>::prepare_circuit(
+            proof_generation_key,
+            diversifier,
+            rseed,
+            value,
+            alpha,
+            rcv,
+            anchor,
+            merkle_path,
+        )
+    }
+
+    fn create_proof<R: RngCore>(&self, _: circuit::Spend, _: &mut R) -> Self::Proof {
+        self.next_proof()
+    }
+
+    fn encode_proof(proof: Self::Proof) -> GrothProofBytes {
+        proof
+    }
+}
+
+impl OutputProver for PrecomputedProofs {
+    type Proof = GrothProofBytes;
+
+    fn prepare_circuit(
+        esk: &EphemeralSecretKey,
+        payment_address: PaymentAddress,
+        rcm: jubjub::Fr,
+        value: NoteValue,
+        rcv: ValueCommitTrapdoor,
+    ) -> circuit::Output {
+        <StaticTxProver as OutputProver>::prepare_circuit(esk, payment_address, rcm, value, rcv)
+    }
+
+    fn create_proof<R: RngCore>(&self, _: circuit::Output, _: &mut R) -> Self::Proof {
+        self.next_proof()
+    }
+
+    fn encode_proof(proof: Self::Proof) -> GrothProofBytes {
+        proof
+    }
+}
+
 pub(crate) struct SaplingBuilder {
     builder: sapling::builder::Builder,
     extsks: Vec<ExtendedSpendingKey>,
@@ -475,12 +554,62 @@ impl SaplingBuilder {
 
     fn build(self) -> Result<SaplingUnauthorizedBundle, String> {
         let Self { builder, extsks } = self;
-        let prover = crate::sapling::StaticTxProver;
         let rng = OsRng;
         let bundle = builder
             .build::<StaticTxProver, StaticTxProver, _, ZatBalance>(&extsks, rng)
             .map_err(|e| format!("Failed to build Sapling bundle: {}", e))?
-            .map(|(bundle, _)| bundle.create_proofs(&prover, &prover, rng, ()));
+            .map(|(bundle, _)| {
+                // Every spend and output proof is independent of the others, so we create
+                // them in parallel and then hand them to the bundle in order.
+                let spend_circuits = bundle
+                    .shielded_spends()
+                    .iter()
+                    .map(|spend| spend.zkproof().clone())
+                    .collect::<Vec<_>>();
+                let output_circuits = bundle
+                    .shielded_outputs()
+                    .iter()
+                    .map(|output| output.zkproof().clone())
+                    .collect::<Vec<_>>();
+
+                let (spend_proofs, output_proofs) = in_proving_threadpool(|| {
+                    rayon::join(
+                        || {
+                            spend_circuits
+                                .into_par_iter()
+                                .map(|circuit| {
+                                    let proof = SpendProver::create_proof(
+                                        &StaticTxProver,
+                                        circuit,
+                                        &mut OsRng,
+                                    );
+                                    <StaticTxProver as SpendProver>::encode_proof(proof)
+                                })
+                                .collect::<Vec<_>>()
+                        },
+                        || {
+                            output_circuits
+                                .into_par_iter()
+                                .map(|circuit| {
+                                    let proof = OutputProver::create_proof(
+                                        &StaticTxProver,
+                                        circuit,
+                                        &mut OsRng,
+                                    );
+                                    <StaticTxProver as OutputProver>::encode_proof(proof)
+                                })
+                                .collect::<Vec<_>>()
+                        },
+                    )
+                });
+
+                bundle.create_proofs(
+                    &PrecomputedProofs::new(spend_proofs),
+                    &PrecomputedProofs::new(output_proofs),
+                    rng,
+                    (),
+                )
+            });
         Ok(SaplingUnauthorizedBundle {
             bundle,
             signing_keys: extsks.into_iter().map(|extsk| extsk.expsk.ask).collect(),
@@ -1202,7 +1202,26 @@ SigVersion SignatureHashVersion(const CTransaction& txTo)
     }
 }
 
-uint256 SignatureHash(
+bool SignatureHashCache::Get(const Key& key, uint256& hash) const
+{
+    std::lock_guard<std::mutex> lock(cs);
+    auto it = hashes.find(key);
+    if (it == hashes.end()) {
+        return false;
+    }
+    hash = it->second;
+    return true;
+}
+
+void SignatureHashCache::Set(const Key& key, const uint256& hash)
+{
+    std::lock_guard<std::mutex> lock(cs);
+    hashes.emplace(key, hash);
+}
+
+namespace {
+
+uint256 ComputeSignatureHash(
     const CScript& scriptCode,
     const CTransaction& txTo,
     unsigned int nIn,
@@ -1377,6 +1396,35 @@ uint256 SignatureHash(
     return ss.GetHash();
 }
 
+} // anon namespace
+
+uint256 SignatureHash(
+    const CScript& scriptCode,
+    const CTransaction& txTo,
+    unsigned int nIn,
+    int nHashType,
+    const CAmount& amount,
+    uint32_t consensusBranchId,
+    const PrecomputedTransactionData& txdata)
+{
+    if (!txdata.sighashCache) {
+        return ComputeSignatureHash(scriptCode, txTo, nIn, nHashType, amount, consensusBranchId, txdata);
+    }
+
+    // ZIP 244 signature hashes don't commit to the scriptCode, amount or
+    // consensus branch ID that we are given, so leave them out of the key.
+    SignatureHashCache::Key key = SignatureHashVersion(txTo) == SIGVERSION_ZIP244 ?
+        SignatureHashCache::Key(nIn, nHashType, 0, 0, CScript()) :
+        SignatureHashCache::Key(nIn, nHashType, consensusBranchId, amount, scriptCode);
+    uint256 hash;
+    if (!txdata.sighashCache->Get(key, hash)) {
+        // Invalid uses of the hash type throw, and are not cached.
+        hash = ComputeSignatureHash(scriptCode, txTo, nIn, nHashType, amount, consensusBranchId, txdata);
+        txdata.sighashCache->Set(key, hash);
+    }
+    return hash;
+}
+
 bool TransactionSignatureChecker::VerifySignature(
     const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
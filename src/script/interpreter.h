@@ -12,6 +12,10 @@
 
 #include <rust/transaction.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
 #include <vector>
 #include <stdint.h>
 #include <string>
@@ -93,11 +97,38 @@ enum
 
 bool CheckSignatureEncoding(const std::vector<unsigned char> &vchSig, unsigned int flags, ScriptError* serror);
 
+/**
+ * Signature hashes of a transaction, keyed by (nIn, nHashType,
+ * consensusBranchId, amount, scriptCode). Safe to share between the threads
+ * that check the transaction's scripts.
+ */
+class SignatureHashCache
+{
+public:
+    typedef std::tuple<unsigned int, int, uint32_t, CAmount, CScript> Key;
+
+    bool Get(const Key& key, uint256& hash) const;
+    void Set(const Key& key, const uint256& hash);
+
+private:
+    mutable std::mutex cs;
+    std::map<Key, uint256> hashes;
+};
+
 struct PrecomputedTransactionData
 {
     uint256 hashPrevouts, hashSequence, hashOutputs, hashJoinSplits, hashShieldedSpends, hashShieldedOutputs;
     /** Precomputed transaction parts. */
     std::unique_ptr<PrecomputedTxParts, decltype(&zcash_transaction_precomputed_free)> preTx;
+    /**
+     * Signature hashes computed so far, if CacheSignatureHashes() was called.
+     * This lets the script checks (including both rounds of them in
+     * AcceptToMemoryPool and each key of a multisig) and the shielded checks
+     * compute each signature hash only once. Caching is opt-in because the
+     * signing code reuses a PrecomputedTransactionData while it fills in the
+     * transaction.
+     */
+    std::unique_ptr<SignatureHashCache> sighashCache;
 
     PrecomputedTransactionData(
         const CTransaction& tx,
@@ -108,6 +139,9 @@ struct PrecomputedTransactionData
         const unsigned char* allPrevOutputs,
         size_t allPrevOutputsLen);
 
+    /** Enables caching of the signature hashes of the transaction. */
+    void CacheSignatureHashes() { sighashCache.reset(new SignatureHashCache()); }
+
 private:
     void SetPrecomputed(
         const CTransaction& tx,
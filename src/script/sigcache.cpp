@@ -6,20 +6,77 @@
 
 #include "sigcache.h"
 
+#include "crypto/common.h"
 #include "memusage.h"
+#include "primitives/transaction.h"
 #include "pubkey.h"
 #include "random.h"
 #include "uint256.h"
 #include "util/system.h"
 
 #include "cuckoocache.h"
-#include <boost/thread.hpp>
+
+#include <atomic>
+#include <mutex>
 
 namespace {
+/**
+ * Hit and miss counters for a cache that is looked up from many threads at
+ * once. Each thread increments the slot it was assigned on first use, so that
+ * the script check threads don't contend on a shared cache line; the slots
+ * are summed when the counters are read.
+ */
+class CLookupCounters
+{
+private:
+    static constexpr size_t SLOTS = 64;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> nHits{0};
+        std::atomic<uint64_t> nMisses{0};
+    };
+    Slot slots[SLOTS];
+
+    static size_t ThreadSlot()
+    {
+        static std::atomic<size_t> nNextSlot{0};
+        thread_local size_t nSlot = nNextSlot.fetch_add(1, std::memory_order_relaxed) % SLOTS;
+        return nSlot;
+    }
+
+public:
+    void Add(bool fHit)
+    {
+        Slot& slot = slots[ThreadSlot()];
+        (fHit ? slot.nHits : slot.nMisses).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t Hits() const
+    {
+        uint64_t n = 0;
+        for (const Slot& slot : slots) n += slot.nHits.load(std::memory_order_relaxed);
+        return n;
+    }
+
+    uint64_t Misses() const
+    {
+        uint64_t n = 0;
+        for (const Slot& slot : slots) n += slot.nMisses.load(std::memory_order_relaxed);
+        return n;
+    }
+};
+
 /**
  * Valid signature cache, to avoid doing expensive ECDSA signature checking
  * twice for every transaction (once when accepted into memory pool, and
  * again when accepted into the block chain)
+ *
+ * Lookups don't take a lock, so that the script check threads never wait for
+ * mempool acceptance to insert an entry; inserts are serialized by cs_sigcache.
+ * See CuckooCache::cache for what a lookup may observe during an insert.
+ *
+ * The same structure, with another nonce, caches transactions whose scripts
+ * are all valid.
  */
 class CSignatureCache
 {
@@ -28,7 +85,11 @@ private:
     uint256 nonce;
     typedef CuckooCache::cache<uint256, SignatureCacheHasher> map_type;
     map_type setValid;
-    boost::shared_mutex cs_sigcache;
+    std::mutex cs_sigcache;
+    uint32_t nMaxEntries = 0;
+    CLookupCounters lookups;
+    //! Only updated under cs_sigcache, but read without it
+    std::atomic<uint64_t> nInserts{0};
 
 public:
     CSignatureCache()
@@ -42,21 +103,45 @@ public:
         CSHA256().Write(nonce.begin(), 32).Write(hash.begin(), 32).Write(&pubkey[0], pubkey.size()).Write(&vchSig[0], vchSig.size()).Finalize(entry.begin());
     }
 
+    //! Script execution entries are SHA256(nonce || txid || auth digest || flags || consensus branch ID)
+    void
+    ComputeEntry(uint256& entry, const WTxId& wtxid, unsigned int flags, uint32_t consensusBranchId)
+    {
+        unsigned char buf[8];
+        WriteLE32(buf, flags);
+        WriteLE32(buf + 4, consensusBranchId);
+        CSHA256().Write(nonce.begin(), 32).Write(wtxid.hash.begin(), 32).Write(wtxid.authDigest.begin(), 32).Write(buf, sizeof(buf)).Finalize(entry.begin());
+    }
+
     bool
     Get(const uint256& entry, const bool erase)
     {
-        boost::shared_lock<boost::shared_mutex> lock(cs_sigcache);
-        return setValid.contains(entry, erase);
+        bool fFound = setValid.contains(entry, erase);
+        lookups.Add(fFound);
+        return fFound;
     }
 
     void Set(uint256& entry)
     {
-        boost::unique_lock<boost::shared_mutex> lock(cs_sigcache);
+        std::lock_guard<std::mutex> lock(cs_sigcache);
         setValid.insert(entry);
+        nInserts.fetch_add(1, std::memory_order_relaxed);
     }
     uint32_t setup_bytes(size_t n)
     {
-        return setValid.setup_bytes(n);
+        nMaxEntries = setValid.setup_bytes(n);
+        return nMaxEntries;
+    }
+
+    ValidityCacheStats GetStats() const
+    {
+        ValidityCacheStats stats;
+        stats.nMaxEntries = nMaxEntries;
+        stats.nHits = lookups.Hits();
+        stats.nMisses = lookups.Misses();
+        stats.nInserts = nInserts.load(std::memory_order_relaxed);
+        stats.nEvictions = setValid.evictions();
+        return stats;
     }
 };
 
@@ -67,6 +152,7 @@ public:
  * signatureCache could be made local to VerifySignature.
 */
 static CSignatureCache signatureCache;
+static CSignatureCache scriptExecutionCache;
 }
 
 // To be called once in AppInit2/TestingSetup to initialize the signatureCache
@@ -78,6 +164,41 @@ void InitSignatureCache(size_t nMaxCacheSize)
             (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
 }
 
+ValidityCacheStats GetSignatureCacheStats()
+{
+    return signatureCache.GetStats();
+}
+
+void InitScriptExecutionCache(size_t nMaxCacheSize)
+{
+    if (nMaxCacheSize <= 0) return;
+    size_t nElems = scriptExecutionCache.setup_bytes(nMaxCacheSize);
+    LogPrintf("Using %zu MiB out of %zu requested for script execution cache, able to store %zu elements\n",
+            (nElems*sizeof(uint256)) >>20, nMaxCacheSize>>20, nElems);
+}
+
+uint256 ScriptExecutionCacheEntry(const CTransaction& tx, unsigned int flags, uint32_t consensusBranchId)
+{
+    uint256 entry;
+    scriptExecutionCache.ComputeEntry(entry, tx.GetWTxId(), flags, consensusBranchId);
+    return entry;
+}
+
+bool ScriptExecutionCacheContains(const uint256& entry, bool erase)
+{
+    return scriptExecutionCache.Get(entry, erase);
+}
+
+void ScriptExecutionCacheAdd(uint256& entry)
+{
+    scriptExecutionCache.Set(entry);
+}
+
+ValidityCacheStats GetScriptExecutionCacheStats()
+{
+    return scriptExecutionCache.GetStats();
+}
+
 bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
 {
     uint256 entry;
@@ -90,3 +211,29 @@ bool CachingTransactionSignatureChecker::VerifySignature(const std::vector<unsig
         signatureCache.Set(entry);
     return true;
 }
+
+void CSignatureBatch::Add(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash)
+{
+    uint256 entry;
+    signatureCache.ComputeEntry(entry, sighash, vchSig, pubkey);
+    if (signatureCache.Get(entry, !store))
+        return;
+    verifier.Add(pubkey, sighash, vchSig);
+    if (store)
+        vCacheEntries.push_back(entry);
+}
+
+bool CSignatureBatch::Verify()
+{
+    if (!verifier.Verify())
+        return false;
+    for (uint256& entry : vCacheEntries)
+        signatureCache.Set(entry);
+    return true;
+}
+
+bool BatchingTransactionSignatureChecker::VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash) const
+{
+    batch.Add(vchSig, pubkey, sighash);
+    return true;
+}
@@ -7,6 +7,7 @@
 #ifndef BITCOIN_SCRIPT_SIGCACHE_H
 #define BITCOIN_SCRIPT_SIGCACHE_H
 
+#include "pubkey.h"
 #include "script/interpreter.h"
 
 #include <vector>
@@ -17,6 +18,7 @@
 static const unsigned int DEFAULT_MAX_SIG_CACHE_SIZE = 32;
 
 class CPubKey;
+class CTransaction;
 
 /**
  * We're hashing a nonce into the entries themselves, so we don't need extra
@@ -50,6 +52,73 @@ public:
     bool VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const;
 };
 
+/**
+ * Signatures that a group of inputs check, to be verified together once their
+ * scripts have run. Signatures that are in the signature cache are not added.
+ */
+class CSignatureBatch
+{
+private:
+    bool store;
+    CPubKeyBatchVerifier verifier;
+    std::vector<uint256> vCacheEntries;
+
+public:
+    CSignatureBatch(bool storeIn) : store(storeIn) {}
+
+    void Add(const std::vector<unsigned char>& vchSig, const CPubKey& pubkey, const uint256& sighash);
+    //! Verifies the signatures, adding them to the signature cache if they are valid and store is set.
+    bool Verify();
+    size_t size() const { return verifier.size(); }
+};
+
+/**
+ * Records the signatures that a script checks in a CSignatureBatch instead of
+ * verifying them, and reports them as valid. A script that succeeds with this
+ * checker is only valid if the batch then verifies; if it does not, the script
+ * must be run again with a checker that verifies each signature, to find out
+ * what it does with the invalid one.
+ */
+class BatchingTransactionSignatureChecker : public TransactionSignatureChecker
+{
+private:
+    CSignatureBatch& batch;
+
+public:
+    BatchingTransactionSignatureChecker(const CTransaction* txToIn, PrecomputedTransactionData& txdataIn, unsigned int nInIn, const CAmount& amount, CSignatureBatch& batchIn) : TransactionSignatureChecker(txToIn, txdataIn, nInIn, amount), batch(batchIn) {}
+
+    bool VerifySignature(const std::vector<unsigned char>& vchSig, const CPubKey& vchPubKey, const uint256& sighash) const;
+};
+
 void InitSignatureCache(size_t nMaxCacheSize);
 
+struct ValidityCacheStats
+{
+    //! Number of entries the cache can hold
+    uint32_t nMaxEntries;
+    //! Lookups that found, and did not find, a valid signature
+    uint64_t nHits;
+    uint64_t nMisses;
+    uint64_t nInserts;
+    //! Entries that had not been used yet when they were dropped to make room
+    uint64_t nEvictions;
+};
+
+ValidityCacheStats GetSignatureCacheStats();
+
+/**
+ * The script execution cache holds transactions whose transparent inputs all
+ * passed script verification, keyed by their wtxid, the script verification
+ * flags and the consensus branch ID. The spent coins need not be part of the
+ * key, as the txid commits to the outpoints that determine them. Entries are
+ * added when a transaction is accepted to the mempool, so that connecting a
+ * block of transactions that were already seen skips running their scripts.
+ */
+void InitScriptExecutionCache(size_t nMaxCacheSize);
+uint256 ScriptExecutionCacheEntry(const CTransaction& tx, unsigned int flags, uint32_t consensusBranchId);
+//! If erase is set and the entry is found, it is marked to be evicted first.
+bool ScriptExecutionCacheContains(const uint256& entry, bool erase);
+void ScriptExecutionCacheAdd(uint256& entry);
+ValidityCacheStats GetScriptExecutionCacheStats();
+
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -138,4 +138,23 @@ BOOST_AUTO_TEST_CASE(bip32_test2) {
     RunTest(test2);
 }
 
+BOOST_AUTO_TEST_CASE(bip32_derive_range) {
+    std::vector<unsigned char> seed = ParseHex(test1.strHexMaster);
+    CExtKey key = CExtKey::Master(&seed[0], seed.size()).value();
+
+    // Cover a range that is not a multiple of the hash batch width, and one
+    // that crosses into the hardened indices.
+    for (unsigned int nStart : {0u, 0x7ffffff0u}) {
+        auto children = key.DeriveRange(nStart, 37);
+        BOOST_CHECK_EQUAL(children.size(), 37);
+        for (unsigned int i = 0; i < children.size(); i++) {
+            auto expected = key.Derive(nStart + i);
+            BOOST_CHECK(expected.has_value());
+            BOOST_CHECK(children[i].has_value());
+            BOOST_CHECK(children[i].value() == expected.value());
+        }
+    }
+    BOOST_CHECK(key.DeriveRange(0, 0).empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
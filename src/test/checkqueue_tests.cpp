@@ -147,9 +147,9 @@ typedef CCheckQueue<FrozenCleanupCheck> FrozenCleanup_Queue;
 /** This test case checks that the CCheckQueue works properly
  * with each specified size_t Checks pushed.
  */
-void Correct_Queue_range(std::vector<size_t> range)
+void Correct_Queue_range(std::vector<size_t> range, unsigned int nMaxWorkers = MAX_CHECKQUEUE_WORKERS)
 {
-    auto small_queue = std::unique_ptr<Correct_Queue>(new Correct_Queue {QUEUE_BATCH_SIZE});
+    auto small_queue = std::unique_ptr<Correct_Queue>(new Correct_Queue {QUEUE_BATCH_SIZE, nMaxWorkers});
     boost::thread_group tg;
     for (auto x = 0; x < nScriptCheckThreads; ++x) {
        tg.create_thread([&]{small_queue->Thread();});
@@ -210,6 +210,17 @@ BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Random)
     Correct_Queue_range(range);
 }
 
+/** Test that workers without a queue of their own steal all the checks they run
+ */
+BOOST_AUTO_TEST_CASE(test_CheckQueue_Correct_Stealing)
+{
+    std::vector<size_t> range;
+    for (size_t i = 1; i < 100000; i *= 7)
+        range.push_back(i);
+    Correct_Queue_range(range, 0);
+    Correct_Queue_range(range, 2);
+}
+
 
 /** Test that failing checks are caught */
 BOOST_AUTO_TEST_CASE(test_CheckQueue_Catches_Failure)
@@ -482,6 +482,75 @@ BOOST_AUTO_TEST_CASE(chacha20_testvector)
                  "fab78c9");
 }
 
+BOOST_AUTO_TEST_CASE(chacha20_long_output)
+{
+    // Long outputs are produced several blocks at a time when possible; they
+    // must match the keystream produced one block at a time. Start just below
+    // a 32-bit block counter boundary to cover the carry.
+    std::vector<unsigned char> key(32);
+    for (auto& c : key) {
+        c = InsecureRandBits(8);
+    }
+    for (uint64_t seek : {(uint64_t)0, (uint64_t)0xfffffffa}) {
+        for (size_t len : {511, 512, 513, 1100, 4096}) {
+            ChaCha20 rng(key.data(), key.size());
+            rng.SetIV(0x0706050403020100ULL);
+            rng.Seek(seek);
+            std::vector<unsigned char> out1(len + 64), out2(len + 64 + 63);
+            rng.Output(out1.data(), len);
+            rng.Output(out1.data() + len, 64);
+
+            ChaCha20 blockwise(key.data(), key.size());
+            blockwise.SetIV(0x0706050403020100ULL);
+            blockwise.Seek(seek);
+            for (size_t pos = 0; pos < len + 64; pos += 64) {
+                blockwise.Output(out2.data() + pos, 64);
+            }
+            BOOST_CHECK(std::equal(out1.begin(), out1.begin() + len, out2.begin()));
+            // The stream continues from the next whole block.
+            size_t next = (len + 63) / 64 * 64;
+            BOOST_CHECK(std::equal(out1.begin() + len, out1.end(), out2.begin() + next));
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(aes256_cbc_multiblock)
+{
+    // CBC decryption decrypts all blocks in one call, which AES-NI interleaves;
+    // check it against decrypting one block at a time.
+    std::vector<unsigned char> key(AES256_KEYSIZE), iv(AES_BLOCKSIZE);
+    for (auto& c : key) {
+        c = InsecureRandBits(8);
+    }
+    for (auto& c : iv) {
+        c = InsecureRandBits(8);
+    }
+    for (int len : {1, 16, 48, 63, 64, 65, 100, 1000}) {
+        std::vector<unsigned char> in(len);
+        for (auto& c : in) {
+            c = InsecureRandBits(8);
+        }
+        std::vector<unsigned char> cipher(len + AES_BLOCKSIZE);
+        int size = AES256CBCEncrypt(key.data(), iv.data(), true).Encrypt(in.data(), len, cipher.data());
+        BOOST_CHECK_EQUAL(size, (len / AES_BLOCKSIZE + 1) * AES_BLOCKSIZE);
+
+        std::vector<unsigned char> out(size);
+        BOOST_CHECK_EQUAL(AES256CBCDecrypt(key.data(), iv.data(), true).Decrypt(cipher.data(), size, out.data()), len);
+        BOOST_CHECK(std::equal(in.begin(), in.end(), out.begin()));
+
+        AES256Decrypt dec(key.data());
+        std::vector<unsigned char> expected(size);
+        for (int pos = 0; pos < size; pos += AES_BLOCKSIZE) {
+            dec.Decrypt(expected.data() + pos, cipher.data() + pos);
+            const unsigned char* prev = pos == 0 ? iv.data() : cipher.data() + pos - AES_BLOCKSIZE;
+            for (int i = 0; i < AES_BLOCKSIZE; i++) {
+                expected[pos + i] ^= prev[i];
+            }
+        }
+        BOOST_CHECK(std::equal(in.begin(), in.end(), expected.begin()));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(countbits_tests)
 {
     FastRandomContext ctx;
@@ -520,4 +589,68 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha512_batch)
+{
+    // Lengths that need one or two padding blocks, with and without full blocks.
+    for (size_t len : {0, 37, 111, 112, 128, 300}) {
+        for (size_t n = 0; n <= 9; ++n) {
+            std::vector<unsigned char> in(len * n);
+            for (auto& c : in) {
+                c = InsecureRandBits(8);
+            }
+            std::vector<unsigned char> out1(64 * n), out2(64 * n);
+            for (size_t j = 0; j < n; ++j) {
+                CSHA512().Write(in.data() + len * j, len).Finalize(out1.data() + 64 * j);
+            }
+            SHA512Batch(out2.data(), in.data(), len, n);
+            BOOST_CHECK(out1 == out2);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ripemd160_batch)
+{
+    for (size_t len : {0, 32, 55, 56, 64, 150}) {
+        for (size_t n = 0; n <= 17; ++n) {
+            std::vector<unsigned char> in(len * n);
+            for (auto& c : in) {
+                c = InsecureRandBits(8);
+            }
+            std::vector<unsigned char> out1(20 * n), out2(20 * n);
+            for (size_t j = 0; j < n; ++j) {
+                CRIPEMD160().Write(in.data() + len * j, len).Finalize(out1.data() + 20 * j);
+            }
+            RIPEMD160Batch(out2.data(), in.data(), len, n);
+            BOOST_CHECK(out1 == out2);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(hmac_sha512_batch)
+{
+    // BIP 32 derivation uses 32-byte keys and 37-byte messages; also cover
+    // keys that are hashed first.
+    for (size_t keylen : {32, 128, 200}) {
+        for (size_t msglen : {0, 37, 200}) {
+            for (size_t n = 0; n <= 9; ++n) {
+                std::vector<unsigned char> keys(keylen * n), msgs(msglen * n);
+                for (auto& c : keys) {
+                    c = InsecureRandBits(8);
+                }
+                for (auto& c : msgs) {
+                    c = InsecureRandBits(8);
+                }
+                std::vector<unsigned char> out1(64 * n), out2(64 * n);
+                for (size_t j = 0; j < n; ++j) {
+                    CHMAC_SHA512(keys.data() + keylen * j, keylen)
+                        .Write(msgs.data() + msglen * j, msglen)
+                        .Finalize(out1.data() + 64 * j);
+                }
+                HMAC_SHA512Batch(out2.data(), keys.data(), keylen, msgs.data(), msglen, n);
+                BOOST_CHECK(out1 == out2);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
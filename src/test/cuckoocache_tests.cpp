@@ -379,4 +379,82 @@ BOOST_AUTO_TEST_CASE(cuckoocache_generations)
     test_cache_generations<CuckooCache::cache<uint256, SignatureCacheHasher>>();
 }
 
+/* Test that lookups may run while another thread inserts: they never find an
+ * element that was not inserted, and still find elements that the inserts do
+ * not displace.
+ */
+template <typename Cache>
+void test_cache_read_during_insert(size_t megabytes)
+{
+    local_rand_ctx = FastRandomContext(true);
+    Cache set{};
+    size_t bytes = megabytes * (1 << 20);
+    uint32_t n = set.setup_bytes(bytes);
+    std::vector<uint256> hashes(n);
+    for (uint32_t i = 0; i < n; ++i)
+        insecure_GetRandHash(hashes[i]);
+    std::vector<uint256> absent(n / 4);
+    for (uint32_t i = 0; i < absent.size(); ++i)
+        insecure_GetRandHash(absent[i]);
+
+    // Fill a quarter of the cache, then insert another half while looking up
+    for (uint32_t i = 0; i < n / 4; ++i)
+        set.insert(hashes[i]);
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    std::atomic<size_t> fakes{0};
+    std::atomic<size_t> found{0};
+    for (uint32_t x = 0; x < 3; ++x) {
+        threads.emplace_back([&] {
+            do {
+                size_t nFound = 0;
+                for (uint32_t i = 0; i < n / 4; ++i) {
+                    if (set.contains(absent[i], false))
+                        ++fakes;
+                    nFound += set.contains(hashes[i], false);
+                }
+                found = nFound;
+            } while (!done);
+        });
+    }
+    for (uint32_t i = n / 4; i < 3 * n / 4; ++i)
+        set.insert(hashes[i]);
+    done = true;
+    for (std::thread& t : threads)
+        t.join();
+
+    BOOST_CHECK_EQUAL(fakes.load(), 0);
+    // The cache is only three quarters full, so (almost) nothing was dropped
+    BOOST_CHECK(found.load() > (n / 4) * 0.99);
+    for (uint32_t i = 0; i < 3 * n / 4; ++i)
+        BOOST_CHECK(set.contains(hashes[i], false) || set.evictions() > 0);
+}
+BOOST_AUTO_TEST_CASE(cuckoocache_read_during_insert_ok)
+{
+    size_t megabytes = 4;
+    test_cache_read_during_insert<CuckooCache::cache<uint256, SignatureCacheHasher>>(megabytes);
+}
+
+/* Test that the cache counts the elements it drops when it is full */
+BOOST_AUTO_TEST_CASE(cuckoocache_evictions)
+{
+    local_rand_ctx = FastRandomContext(true);
+    CuckooCache::cache<uint256, SignatureCacheHasher> set{};
+    uint32_t n = set.setup(1000);
+    BOOST_CHECK_EQUAL(set.evictions(), 0);
+    for (uint32_t i = 0; i < n / 2; ++i) {
+        uint256 h;
+        insecure_GetRandHash(h);
+        set.insert(h);
+    }
+    BOOST_CHECK_EQUAL(set.evictions(), 0);
+    for (uint32_t i = 0; i < 4 * n; ++i) {
+        uint256 h;
+        insecure_GetRandHash(h);
+        set.insert(h);
+    }
+    BOOST_CHECK(set.evictions() > 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END();
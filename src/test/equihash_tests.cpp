@@ -81,6 +81,17 @@ void TestEquihashSolvers(unsigned int n, unsigned int k, const std::string &I, c
     BOOST_TEST_MESSAGE(strm.str());
     BOOST_CHECK(retOpt == solns);
     BOOST_CHECK(retOpt == ret);
+
+    // And so should the optimised solver running on several threads
+    std::set<std::vector<uint32_t>> retPar;
+    std::function<bool(std::vector<unsigned char>)> validBlockPar =
+            [&retPar, cBitLen](std::vector<unsigned char> soln) {
+        retPar.insert(GetIndicesFromMinimal(soln, cBitLen));
+        return false;
+    };
+    EhOptimisedSolveUncancellable(n, k, state, validBlockPar, 4);
+    BOOST_TEST_MESSAGE("[Optimised, 4 threads] Number of solutions: " << retPar.size());
+    BOOST_CHECK(retPar == solns);
 }
 #endif
 
@@ -7,6 +7,7 @@
 #include "util/strencodings.h"
 #include "test/test_bitcoin.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <boost/test/unit_test.hpp>
@@ -125,4 +126,23 @@ BOOST_AUTO_TEST_CASE(siphash)
     }
 }
 
+BOOST_AUTO_TEST_CASE(hash160_batch)
+{
+    // Compressed public keys are 33 bytes.
+    for (size_t len : {0, 33, 65}) {
+        for (size_t n = 0; n <= 17; ++n) {
+            std::vector<unsigned char> in(len * n);
+            for (auto& c : in) {
+                c = InsecureRandBits(8);
+            }
+            std::vector<unsigned char> out(20 * n);
+            Hash160Batch(out.data(), in.data(), len, n);
+            for (size_t j = 0; j < n; ++j) {
+                uint160 expected = Hash160(in.begin() + len * j, in.begin() + len * (j + 1));
+                BOOST_CHECK(std::equal(out.begin() + 20 * j, out.begin() + 20 * (j + 1), expected.begin()));
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
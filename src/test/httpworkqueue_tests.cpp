@@ -0,0 +1,140 @@
+// Copyright (c) 2026 The Zcash developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#include "httpworkqueue.h"
+#include "test/test_bitcoin.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_FIXTURE_TEST_SUITE(httpworkqueue_tests, BasicTestingSetup)
+
+/** Records what happened to each work item, by its name. */
+struct WorkLog
+{
+    std::mutex cs;
+    std::vector<std::string> run;
+    std::vector<std::string> rejected;
+    std::vector<std::string> expired;
+
+    void Add(std::vector<std::string>& v, const std::string& name)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        v.push_back(name);
+    }
+    size_t Handled()
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        return run.size() + rejected.size() + expired.size();
+    }
+};
+
+struct FakeWorkItem
+{
+    WorkLog& log;
+    std::string name;
+
+    FakeWorkItem(WorkLog& log, const std::string& name) : log(log), name(name) {}
+    void operator()() { log.Add(log.run, name); }
+    void Reject() { log.Add(log.rejected, name); }
+    void RejectExpired() { log.Add(log.expired, name); }
+};
+
+/** Runs the queue on one thread until n items have been handled. */
+static void RunUntilHandled(WorkQueue<FakeWorkItem>& queue, WorkLog& log, size_t n)
+{
+    std::thread worker([&] { queue.Run(); });
+    while (log.Handled() < n) {
+        MilliSleep(1);
+    }
+    queue.Interrupt();
+    worker.join();
+}
+
+BOOST_AUTO_TEST_CASE(serves_clients_in_turn)
+{
+    WorkLog log;
+    WorkQueue<FakeWorkItem> queue(100, 0);
+    for (const std::string name : {"a1", "a2", "a3"}) {
+        BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, name), "10.0.0.1"));
+    }
+    for (const std::string name : {"b1", "b2", "b3"}) {
+        BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, name), "10.0.0.2"));
+    }
+    RunUntilHandled(queue, log, 6);
+
+    std::vector<std::string> expected = {"a1", "b1", "a2", "b2", "a3", "b3"};
+    BOOST_CHECK(log.run == expected);
+    BOOST_CHECK(log.rejected.empty());
+}
+
+BOOST_AUTO_TEST_CASE(overflow_waits_and_is_served)
+{
+    WorkLog log;
+    // Overflow requests may wait for up to 10 seconds.
+    WorkQueue<FakeWorkItem> queue(2, 10 * 1000 * 1000);
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "1"), "10.0.0.1", true));
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "2"), "10.0.0.1", true));
+    // Beyond the depth, only requests that may wait are accepted, and only
+    // as many again as the depth.
+    FakeWorkItem noWait(log, "no wait");
+    BOOST_CHECK(!queue.Enqueue(&noWait, "10.0.0.1", false));
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "3"), "10.0.0.1", true));
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "4"), "10.0.0.2", true));
+    FakeWorkItem full(log, "full");
+    BOOST_CHECK(!queue.Enqueue(&full, "10.0.0.2", true));
+
+    BOOST_CHECK(queue.Expire().empty());
+    RunUntilHandled(queue, log, 4);
+
+    BOOST_CHECK_EQUAL(log.run.size(), 4);
+    BOOST_CHECK(log.expired.empty());
+}
+
+BOOST_AUTO_TEST_CASE(overflow_expires_after_wait)
+{
+    WorkLog log;
+    // Overflow requests may wait for up to 50 milliseconds.
+    WorkQueue<FakeWorkItem> queue(1, 50 * 1000);
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "queued"), "10.0.0.1", true));
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "overflow"), "10.0.0.2", true));
+    BOOST_CHECK(queue.Expire().empty());
+
+    MilliSleep(100);
+    auto expired = queue.Expire();
+    BOOST_REQUIRE_EQUAL(expired.size(), 1);
+    BOOST_CHECK_EQUAL(expired[0]->name, "overflow");
+
+    // The expired request no longer counts towards the depth.
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "overflow 2"), "10.0.0.2", true));
+    MilliSleep(100);
+
+    // A worker that takes an expired request rejects it instead of running it.
+    RunUntilHandled(queue, log, 2);
+    std::vector<std::string> expectedRun = {"queued"};
+    std::vector<std::string> expectedExpired = {"overflow 2"};
+    BOOST_CHECK(log.run == expectedRun);
+    BOOST_CHECK(log.expired == expectedExpired);
+}
+
+BOOST_AUTO_TEST_CASE(no_wait_rejects_immediately)
+{
+    WorkLog log;
+    // With -rpcworkqueuewait=0, requests beyond the depth are rejected.
+    WorkQueue<FakeWorkItem> queue(1, 0);
+    BOOST_CHECK(queue.Enqueue(new FakeWorkItem(log, "queued"), "10.0.0.1", true));
+    FakeWorkItem overflow(log, "overflow");
+    BOOST_CHECK(!queue.Enqueue(&overflow, "10.0.0.2", true));
+
+    BOOST_CHECK(queue.Expire().empty());
+    RunUntilHandled(queue, log, 1);
+    BOOST_CHECK_EQUAL(log.run.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -162,6 +162,54 @@ BOOST_AUTO_TEST_CASE(key_test1)
     BOOST_CHECK(detsigc == ParseHex("2052d8a32079c11e79db95af63bb9600c5b04f21a9ca33dc129c2bfa8ac9dc1cd561d8ae5e0f6c1a16bde3719c64c2fd70e404b6428ab9a69566962e8771b5944d"));
 }
 
+BOOST_AUTO_TEST_CASE(key_batch_verify)
+{
+    KeyIO keyIO(Params());
+    CKey key1C = keyIO.DecodeSecret(strSecret1C);
+    CKey key2 = keyIO.DecodeSecret(strSecret2);
+    CPubKey pubkey1C = key1C.GetPubKey();
+    CPubKey pubkey2 = key2.GetPubKey();
+
+    CPubKeyBatchVerifier batch;
+    BOOST_CHECK(batch.Verify());
+
+    std::vector<uint256> hashes;
+    std::vector<vector<unsigned char>> sigs;
+    for (int n = 0; n < 8; n++) {
+        string strMsg = strprintf("Very batched message %i", n);
+        hashes.push_back(Hash(strMsg.begin(), strMsg.end()));
+        sigs.emplace_back();
+        // Alternate keys, so that some keys are reused and some are not
+        CKey& key = (n % 3 == 2) ? key2 : key1C;
+        BOOST_CHECK(key.Sign(hashes.back(), sigs.back()));
+        batch.Add((n % 3 == 2) ? pubkey2 : pubkey1C, hashes.back(), sigs.back());
+    }
+    BOOST_CHECK_EQUAL(batch.size(), 8);
+    BOOST_CHECK(batch.Verify());
+
+    // One signature by the wrong key fails the whole batch
+    CPubKeyBatchVerifier badKey = batch;
+    badKey.Add(pubkey2, hashes[0], sigs[0]);
+    BOOST_CHECK(!badKey.Verify());
+
+    // As do a signature of another message, an empty signature and an invalid key
+    CPubKeyBatchVerifier badHash = batch;
+    badHash.Add(pubkey1C, hashes[1], sigs[0]);
+    BOOST_CHECK(!badHash.Verify());
+
+    CPubKeyBatchVerifier emptySig = batch;
+    emptySig.Add(pubkey1C, hashes[0], vector<unsigned char>());
+    BOOST_CHECK(!emptySig.Verify());
+
+    CPubKeyBatchVerifier invalidKey;
+    invalidKey.Add(CPubKey(), hashes[0], sigs[0]);
+    BOOST_CHECK(!invalidKey.Verify());
+
+    batch.clear();
+    BOOST_CHECK_EQUAL(batch.size(), 0);
+    BOOST_CHECK(batch.Verify());
+}
+
 BOOST_AUTO_TEST_CASE(zc_address_test)
 {
     KeyIO keyIO(Params());
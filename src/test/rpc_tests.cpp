@@ -6,6 +6,7 @@
 #include "rpc/server.h"
 #include "rpc/client.h"
 
+#include "checkpoints.h"
 #include "experimental_features.h"
 #include "key_io.h"
 #include "main.h"
@@ -17,6 +18,8 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <thread>
+
 #include <univalue.h>
 
 using namespace std;
@@ -313,6 +316,106 @@ BOOST_AUTO_TEST_CASE(rpc_getnetworksolps)
     BOOST_CHECK_NO_THROW(CallRPC("getnetworksolps 120 -1"));
 }
 
+BOOST_AUTO_TEST_CASE(rpc_chaintip_snapshot)
+{
+    // The methods that read the published snapshot of the chain tip must
+    // agree with the chain state as seen under cs_main.
+    int nBlockCount = CallRPC("getblockcount").get_int();
+    std::string bestBlockHash = CallRPC("getbestblockhash").get_str();
+    UniValue info = CallRPC("getblockchaininfo");
+
+    const CChainParams& chainparams = Params();
+    LOCK(cs_main);
+    BOOST_CHECK_EQUAL(nBlockCount, chainActive.Height());
+    BOOST_CHECK_EQUAL(bestBlockHash, chainActive.Tip()->GetBlockHash().GetHex());
+    BOOST_CHECK_EQUAL(find_value(info, "blocks").get_int(), chainActive.Height());
+    BOOST_CHECK_EQUAL(find_value(info, "bestblockhash").get_str(), chainActive.Tip()->GetBlockHash().GetHex());
+    BOOST_CHECK_EQUAL(find_value(info, "headers").get_int(), pindexBestHeader->nHeight);
+    BOOST_CHECK_EQUAL(
+        find_value(info, "initial_block_download_complete").get_bool(),
+        !IsInitialBlockDownload(chainparams.GetConsensus()));
+    BOOST_CHECK_EQUAL(
+        find_value(info, "verificationprogress").get_real(),
+        Checkpoints::GuessVerificationProgress(chainparams.Checkpoints(), chainActive.Tip()));
+    BOOST_CHECK_EQUAL(find_value(info, "size_on_disk").get_int64(), CalculateCurrentUsage());
+
+    SproutMerkleTree tree;
+    BOOST_CHECK(pcoinsTip->GetSproutAnchorAt(pcoinsTip->GetBestAnchor(SPROUT), tree));
+    BOOST_CHECK_EQUAL(find_value(info, "commitments").get_int64(), tree.size());
+}
+
+BOOST_AUTO_TEST_CASE(rpc_batch_concurrent)
+{
+    UniValue vReq(UniValue::VARR);
+    auto addRequest = [&](const std::string& method, const UniValue& params) {
+        UniValue req(UniValue::VOBJ);
+        req.pushKV("method", method);
+        req.pushKV("params", params);
+        req.pushKV("id", (int)vReq.size());
+        vReq.push_back(req);
+    };
+    UniValue noParams(UniValue::VARR);
+    UniValue script(UniValue::VARR);
+    script.push_back("51");
+    UniValue helpParams(UniValue::VARR);
+    helpParams.push_back("stop");
+
+    addRequest("getblockcount", noParams);
+    addRequest("decodescript", script);
+    addRequest("getblockcount", script); // too many parameters
+    addRequest("help", helpParams);      // not concurrent
+    addRequest("getbestblockhash", noParams);
+    addRequest("getblockcount", noParams);
+    addRequest("decodescript", script);
+    vReq.push_back("not an object");
+
+    BOOST_CHECK(tableRPC.isConcurrent("getblockcount"));
+    BOOST_CHECK(!tableRPC.isConcurrent("help"));
+
+    std::string strSerial = JSONRPCExecBatch(vReq);
+    UniValue serial;
+    BOOST_CHECK(serial.read(strSerial));
+    BOOST_CHECK_EQUAL(serial.size(), vReq.size());
+    for (size_t i = 0; i + 1 < serial.size(); i++) {
+        BOOST_CHECK_EQUAL(find_value(serial[i], "id").get_int(), (int)i);
+    }
+
+    // Helpers running on other threads.
+    std::vector<std::thread> threads;
+    RPCTaskDispatcher spawn = [&](const std::function<void()>& task) {
+        threads.emplace_back(task);
+        return true;
+    };
+    BOOST_CHECK_EQUAL(JSONRPCExecBatch(vReq, spawn, 3), strSerial);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Helpers that only start after the batch has completed must do nothing.
+    std::vector<std::function<void()>> deferred;
+    RPCTaskDispatcher defer = [&](const std::function<void()>& task) {
+        deferred.push_back(task);
+        return true;
+    };
+    BOOST_CHECK_EQUAL(JSONRPCExecBatch(vReq, defer, 3), strSerial);
+    BOOST_CHECK(!deferred.empty());
+    for (auto& task : deferred) {
+        task();
+    }
+
+    // Helpers that cannot be scheduled.
+    RPCTaskDispatcher refuse = [](const std::function<void()>&) { return false; };
+    BOOST_CHECK_EQUAL(JSONRPCExecBatch(vReq, refuse, 3), strSerial);
+
+    UniValue info = CallRPC("getrpcinfo");
+    UniValue batches = find_value(info, "batches");
+    BOOST_CHECK(find_value(batches, "calls").get_int() >= 4);
+    // Two runs of concurrent requests, in each of the three parallel batches.
+    BOOST_CHECK(find_value(batches, "concurrent_requests").get_int() >= 3 * 6);
+    UniValue methods = find_value(info, "methods");
+    BOOST_CHECK(find_value(find_value(methods, "getblockcount"), "errors").get_int() >= 4);
+}
+
 // Test parameter processing (not functionality).
 // These tests also ensure that src/rpc/client.cpp has the correct entries.
 BOOST_AUTO_TEST_CASE(rpc_insightexplorer)
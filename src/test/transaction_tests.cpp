@@ -668,6 +668,72 @@ BOOST_AUTO_TEST_CASE(test_big_overwinter_transaction) {
     threadGroup.join_all();
 }
 
+BOOST_AUTO_TEST_CASE(test_batched_script_check) {
+    uint32_t consensusBranchId = NetworkUpgradeInfo[Consensus::UPGRADE_OVERWINTER].nBranchId;
+    CMutableTransaction mtx;
+    mtx.fOverwintered = true;
+    mtx.nVersion = OVERWINTER_TX_VERSION;
+    mtx.nVersionGroupId = OVERWINTER_VERSION_GROUP_ID;
+
+    CKey key = CKey::TestOnlyRandomKey(true);
+    CBasicKeyStore keystore;
+    keystore.AddKeyPubKey(key, key.GetPubKey());
+    CScript scriptPubKey = GetScriptForDestination(key.GetPubKey().GetID());
+
+    // a transaction with inputs that all spend outputs sent to one address
+    for (uint32_t i = 0; i < 8; i++) {
+        uint256 prevId;
+        prevId.SetHex("0000000000000000000000000000000000000000000000000000000000000100");
+        mtx.vin.resize(i + 1);
+        mtx.vin[i].prevout = COutPoint(prevId, i);
+        mtx.vout.resize(i + 1);
+        mtx.vout[i].nValue = 1000;
+        mtx.vout[i].scriptPubKey = CScript() << OP_1;
+    }
+
+    std::vector<CTxOut> allPrevOutputs;
+    allPrevOutputs.resize(mtx.vin.size());
+    PrecomputedTransactionData txdata(mtx, allPrevOutputs);
+    for (uint32_t i = 0; i < mtx.vin.size(); i++) {
+        BOOST_CHECK(SignSignature(keystore, scriptPubKey, mtx, txdata, i, 1000, SIGHASH_ALL, consensusBranchId));
+    }
+
+    CCoins coins;
+    coins.nVersion = 1;
+    coins.fCoinBase = false;
+    for (uint32_t i = 0; i < mtx.vin.size(); i++) {
+        CTxOut txout;
+        txout.nValue = 1000;
+        txout.scriptPubKey = scriptPubKey;
+        coins.vout.push_back(txout);
+    }
+
+    auto batchCheck = [&](const CTransaction& tx, PrecomputedTransactionData& data) {
+        CScriptCheck check(coins, tx, 0, SCRIPT_VERIFY_P2SH, false, consensusBranchId, &data);
+        for (uint32_t i = 1; i < tx.vin.size(); i++) {
+            check.AddBatchInput(i, 1000);
+        }
+        BOOST_CHECK_EQUAL(check.GetBatchSize(), tx.vin.size());
+        bool result = check();
+        return std::make_pair(result, check.GetScriptError());
+    };
+
+    CTransaction tx(mtx);
+    auto result = batchCheck(tx, txdata);
+    BOOST_CHECK(result.first);
+    BOOST_CHECK_EQUAL(result.second, SCRIPT_ERR_OK);
+
+    // Replacing one signature with that of another input invalidates the
+    // batch, and checking the inputs one at a time reports the error.
+    CMutableTransaction mtxBad(mtx);
+    mtxBad.vin[5].scriptSig = mtx.vin[4].scriptSig;
+    CTransaction txBad(mtxBad);
+    PrecomputedTransactionData txdataBad(txBad, allPrevOutputs);
+    result = batchCheck(txBad, txdataBad);
+    BOOST_CHECK(!result.first);
+    BOOST_CHECK_EQUAL(result.second, SCRIPT_ERR_EVAL_FALSE);
+}
+
 BOOST_AUTO_TEST_CASE(test_IsStandard)
 {
     LOCK(cs_main);
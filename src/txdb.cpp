@@ -55,6 +55,8 @@ static const char DB_ADDRESSUNSPENTINDEX = 'u';
 static const char DB_SPENTINDEX = 'p';
 static const char DB_TIMESTAMPINDEX = 'T';
 static const char DB_BLOCKHASHINDEX = 'h';
+static const char DB_ADDRESSBALANCEINDEX = 'g';
+static const char DB_INSIGHTINDEXBEST = 'i';
 
 CCoinsViewDB::CCoinsViewDB(std::string dbName, size_t nCacheSize, bool fMemory, bool fWipe) : db(GetDataDir() / dbName, nCacheSize, fMemory, fWipe) {
 }
@@ -537,17 +539,31 @@ bool CBlockTreeDB::UpdateAddressUnspentIndex(const std::vector<CAddressUnspentDb
     return WriteBatch(batch);
 }
 
-bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &unspentOutputs)
+bool CBlockTreeDB::ReadAddressUnspentIndex(
+        uint160 addressHash, int type,
+        std::vector<CAddressUnspentDbEntry> &unspentOutputs,
+        size_t nLimit, std::optional<CAddressUnspentKey>* pCursor)
 {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    if (pCursor && pCursor->has_value()) {
+        pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, pCursor->value()));
+        pCursor->reset();
+    } else {
+        pcursor->Seek(make_pair(DB_ADDRESSUNSPENTINDEX, CAddressIndexIteratorKey(type, addressHash)));
+    }
 
+    const size_t nInitialSize = unspentOutputs.size();
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressUnspentKey> key;
         if (!(pcursor->GetKey(key) && key.first == DB_ADDRESSUNSPENTINDEX && key.second.hashBytes == addressHash))
             break;
+        if (nLimit > 0 && unspentOutputs.size() - nInitialSize == nLimit) {
+            if (pCursor)
+                *pCursor = key.second;
+            break;
+        }
         CAddressUnspentValue nValue;
         if (!pcursor->GetValue(nValue))
             return error("failed to get address unspent value");
@@ -557,8 +573,58 @@ bool CBlockTreeDB::ReadAddressUnspentIndex(uint160 addressHash, int type, std::v
     return true;
 }
 
+void CBlockTreeDB::UpdateAddressBalances(
+        CDBBatch &batch, const std::vector<CAddressIndexDbEntry> &vect, bool fErase) const
+{
+    typedef std::pair<unsigned int, uint160> AddressKey;
+    std::map<AddressKey, CAddressBalanceValue> deltas;
+    std::set<std::pair<AddressKey, uint256>> txs;
+    // Whether the entries at each block height are already indexed.
+    std::map<int, bool> indexed;
+    const int sign = fErase ? -1 : 1;
+    for (const auto& entry : vect) {
+        // A block can be connected again after an unclean shutdown, so only
+        // count entries that this batch actually adds or removes. Batches are
+        // atomic, so this is all or nothing for each block, and one read of
+        // its first entry decides it for the rest.
+        auto it = indexed.find(entry.first.blockHeight);
+        if (it == indexed.end()) {
+            it = indexed.emplace(entry.first.blockHeight, Exists(make_pair(DB_ADDRESSINDEX, entry.first))).first;
+        }
+        if (it->second != fErase)
+            continue;
+        AddressKey address(entry.first.type, entry.first.hashBytes);
+        CAddressBalanceValue& delta = deltas[address];
+        delta.balance += sign * entry.second;
+        if (entry.first.spending) {
+            delta.utxoCount -= sign;
+        } else {
+            delta.received += sign * entry.second;
+            delta.utxoCount += sign;
+        }
+        if (txs.insert(std::make_pair(address, entry.first.txhash)).second) {
+            delta.txCount += sign;
+        }
+    }
+    for (const auto& it : deltas) {
+        CAddressBalanceValue balance;
+        ReadAddressBalance(it.first.second, it.first.first, balance);
+        balance.balance += it.second.balance;
+        balance.received += it.second.received;
+        balance.txCount += it.second.txCount;
+        balance.utxoCount += it.second.utxoCount;
+        auto key = make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(it.first.first, it.first.second));
+        if (balance.IsNull()) {
+            batch.Erase(key);
+        } else {
+            batch.Write(key, balance);
+        }
+    }
+}
+
 bool CBlockTreeDB::WriteAddressIndex(const std::vector<CAddressIndexDbEntry> &vect) {
     CDBBatch batch(*this);
+    UpdateAddressBalances(batch, vect, false);
     for (std::vector<CAddressIndexDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++)
         batch.Write(make_pair(DB_ADDRESSINDEX, it->first), it->second);
     return WriteBatch(batch);
@@ -566,6 +632,7 @@ bool CBlockTreeDB::WriteAddressIndex(const std::vector<CAddressIndexDbEntry> &ve
 
 bool CBlockTreeDB::EraseAddressIndex(const std::vector<CAddressIndexDbEntry> &vect) {
     CDBBatch batch(*this);
+    UpdateAddressBalances(batch, vect, true);
     for (std::vector<CAddressIndexDbEntry>::const_iterator it=vect.begin(); it!=vect.end(); it++)
         batch.Erase(make_pair(DB_ADDRESSINDEX, it->first));
     return WriteBatch(batch);
@@ -574,16 +641,21 @@ bool CBlockTreeDB::EraseAddressIndex(const std::vector<CAddressIndexDbEntry> &ve
 bool CBlockTreeDB::ReadAddressIndex(
         uint160 addressHash, int type,
         std::vector<CAddressIndexDbEntry> &addressIndex,
-        int start, int end)
+        int start, int end,
+        size_t nLimit, std::optional<CAddressIndexKey>* pCursor)
 {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    if (start > 0 && end > 0) {
+    if (pCursor && pCursor->has_value()) {
+        pcursor->Seek(make_pair(DB_ADDRESSINDEX, pCursor->value()));
+        pCursor->reset();
+    } else if (start > 0 && end > 0) {
         pcursor->Seek(make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorHeightKey(type, addressHash, start)));
     } else {
         pcursor->Seek(make_pair(DB_ADDRESSINDEX, CAddressIndexIteratorKey(type, addressHash)));
     }
 
+    const size_t nInitialSize = addressIndex.size();
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         std::pair<char,CAddressIndexKey> key;
@@ -591,6 +663,11 @@ bool CBlockTreeDB::ReadAddressIndex(
             break;
         if (end > 0 && key.second.blockHeight > end)
             break;
+        if (nLimit > 0 && addressIndex.size() - nInitialSize == nLimit) {
+            if (pCursor)
+                *pCursor = key.second;
+            break;
+        }
         CAmount nValue;
         if (!pcursor->GetValue(nValue))
             return error("failed to get address index value");
@@ -600,6 +677,82 @@ bool CBlockTreeDB::ReadAddressIndex(
     return true;
 }
 
+bool CBlockTreeDB::ReadAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &balance) const {
+    balance.SetNull();
+    // Addresses without any index entries have no balance entry.
+    Read(make_pair(DB_ADDRESSBALANCEINDEX, CAddressIndexIteratorKey(type, addressHash)), balance);
+    return true;
+}
+
+bool CBlockTreeDB::RebuildAddressBalanceIndex() {
+    {
+        // Remove any stale aggregates first.
+        CDBBatch batch(*this);
+        boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+        pcursor->Seek(DB_ADDRESSBALANCEINDEX);
+        while (pcursor->Valid()) {
+            std::pair<char, CAddressIndexIteratorKey> key;
+            if (!(pcursor->GetKey(key) && key.first == DB_ADDRESSBALANCEINDEX))
+                break;
+            batch.Erase(key);
+            pcursor->Next();
+        }
+        if (!WriteBatch(batch))
+            return false;
+    }
+
+    boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
+    pcursor->Seek(DB_ADDRESSINDEX);
+
+    // Index keys are ordered by address and then by (height, txindex), so
+    // each address's entries, and each transaction's entries for an
+    // address, are consecutive.
+    std::vector<std::pair<CAddressIndexIteratorKey, CAddressBalanceValue>> pending;
+    auto writePending = [&]() {
+        CDBBatch batch(*this);
+        for (const auto& it : pending)
+            batch.Write(make_pair(DB_ADDRESSBALANCEINDEX, it.first), it.second);
+        pending.clear();
+        return WriteBatch(batch);
+    };
+    std::optional<CAddressIndexKey> prev;
+    CAddressBalanceValue balance;
+    while (pcursor->Valid()) {
+        boost::this_thread::interruption_point();
+        std::pair<char, CAddressIndexKey> key;
+        if (!(pcursor->GetKey(key) && key.first == DB_ADDRESSINDEX))
+            break;
+        CAmount nValue;
+        if (!pcursor->GetValue(nValue))
+            return error("failed to get address index value");
+
+        const CAddressIndexKey& entry = key.second;
+        bool fNewAddress = !prev.has_value() || prev->type != entry.type || prev->hashBytes != entry.hashBytes;
+        if (fNewAddress && prev.has_value()) {
+            if (!balance.IsNull())
+                pending.emplace_back(CAddressIndexIteratorKey(prev->type, prev->hashBytes), balance);
+            balance.SetNull();
+            if (pending.size() >= 10000 && !writePending())
+                return false;
+        }
+        if (fNewAddress || prev->blockHeight != entry.blockHeight || prev->txindex != entry.txindex) {
+            balance.txCount++;
+        }
+        balance.balance += nValue;
+        if (entry.spending) {
+            balance.utxoCount--;
+        } else {
+            balance.received += nValue;
+            balance.utxoCount++;
+        }
+        prev = entry;
+        pcursor->Next();
+    }
+    if (prev.has_value() && !balance.IsNull())
+        pending.emplace_back(CAddressIndexIteratorKey(prev->type, prev->hashBytes), balance);
+    return writePending();
+}
+
 bool CBlockTreeDB::ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) const {
     return Read(make_pair(DB_SPENTINDEX, key), value);
 }
@@ -623,18 +776,30 @@ bool CBlockTreeDB::WriteTimestampIndex(const CTimestampIndexKey &timestampIndex)
 }
 
 bool CBlockTreeDB::ReadTimestampIndex(unsigned int high, unsigned int low,
-    const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes)
+    const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &hashes,
+    size_t nLimit, std::optional<CTimestampIndexKey>* pCursor)
 {
     boost::scoped_ptr<CDBIterator> pcursor(NewIterator());
 
-    pcursor->Seek(make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+    if (pCursor && pCursor->has_value()) {
+        pcursor->Seek(make_pair(DB_TIMESTAMPINDEX, pCursor->value()));
+        pCursor->reset();
+    } else {
+        pcursor->Seek(make_pair(DB_TIMESTAMPINDEX, CTimestampIndexIteratorKey(low)));
+    }
 
+    const size_t nInitialSize = hashes.size();
     while (pcursor->Valid()) {
         boost::this_thread::interruption_point();
         std::pair<char, CTimestampIndexKey> key;
         if (!(pcursor->GetKey(key) && key.first == DB_TIMESTAMPINDEX && key.second.timestamp < high)) {
             break;
         }
+        if (nLimit > 0 && hashes.size() - nInitialSize == nLimit) {
+            if (pCursor)
+                *pCursor = key.second;
+            break;
+        }
         if (fActiveOnly) {
             CBlockIndex* pblockindex = mapBlockIndex[key.second.blockHash];
             if (chainActive.Contains(pblockindex)) {
@@ -665,6 +830,18 @@ bool CBlockTreeDB::ReadTimestampBlockIndex(const uint256 &hash, unsigned int &lt
     ltimestamp = lts.ltimestamp;
     return true;
 }
+
+bool CBlockTreeDB::WriteInsightIndexBest(const uint256 &hash) {
+    return Write(DB_INSIGHTINDEXBEST, hash);
+}
+
+bool CBlockTreeDB::ReadInsightIndexBest(uint256 &hash) const {
+    return Read(DB_INSIGHTINDEXBEST, hash);
+}
+
+bool CBlockTreeDB::EraseInsightIndexBest() {
+    return Erase(DB_INSIGHTINDEXBEST);
+}
 // END insightexplorer
 
 bool CBlockTreeDB::WriteFlag(const std::string &name, bool fValue) {
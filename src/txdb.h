@@ -12,6 +12,7 @@
 #include "chain.h"
 
 #include <map>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +28,7 @@ struct CAddressUnspentValue;
 struct CAddressIndexKey;
 struct CAddressIndexIteratorKey;
 struct CAddressIndexIteratorHeightKey;
+struct CAddressBalanceValue;
 struct CSpentIndexKey;
 struct CSpentIndexValue;
 struct CTimestampIndexKey;
@@ -135,19 +137,35 @@ public:
     bool WriteTxIndex(const std::vector<std::pair<uint256, CDiskTxPos> > &vect);
 
     // START insightexplorer
+    //
+    // The Read*Index functions below that take nLimit and pCursor read at
+    // most nLimit entries (or all of them if nLimit is 0). If pCursor is
+    // given and set, reading starts at that key. On return, it is set to the
+    // key of the first entry that was not read, or reset if none remain.
     bool UpdateAddressUnspentIndex(const std::vector<CAddressUnspentDbEntry> &vect);
-    bool ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &vect);
+    bool ReadAddressUnspentIndex(uint160 addressHash, int type, std::vector<CAddressUnspentDbEntry> &vect,
+            size_t nLimit = 0, std::optional<CAddressUnspentKey>* pCursor = nullptr);
     bool WriteAddressIndex(const std::vector<CAddressIndexDbEntry> &vect);
     bool EraseAddressIndex(const std::vector<CAddressIndexDbEntry> &vect);
-    bool ReadAddressIndex(uint160 addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0);
+    bool ReadAddressIndex(uint160 addressHash, int type, std::vector<CAddressIndexDbEntry> &addressIndex, int start = 0, int end = 0,
+            size_t nLimit = 0, std::optional<CAddressIndexKey>* pCursor = nullptr);
+    // The address balance index is updated by WriteAddressIndex and
+    // EraseAddressIndex, in the same batch as the address index entries.
+    bool ReadAddressBalance(uint160 addressHash, int type, CAddressBalanceValue &balance) const;
+    bool RebuildAddressBalanceIndex();
     bool ReadSpentIndex(CSpentIndexKey &key, CSpentIndexValue &value) const;
     bool UpdateSpentIndex(const std::vector<CSpentIndexDbEntry> &vect);
     bool WriteTimestampIndex(const CTimestampIndexKey &timestampIndex);
     bool ReadTimestampIndex(unsigned int high, unsigned int low,
-            const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &vect);
+            const bool fActiveOnly, std::vector<std::pair<uint256, unsigned int> > &vect,
+            size_t nLimit = 0, std::optional<CTimestampIndexKey>* pCursor = nullptr);
     bool WriteTimestampBlockIndex(const CTimestampBlockIndexKey &blockhashIndex,
             const CTimestampBlockIndexValue &logicalts);
     bool ReadTimestampBlockIndex(const uint256 &hash, unsigned int &logicalTS) const;
+    // The last block that a background build of the insight indexes has indexed.
+    bool WriteInsightIndexBest(const uint256 &hash);
+    bool ReadInsightIndexBest(uint256 &hash) const;
+    bool EraseInsightIndexBest();
     // END insightexplorer
 
     bool WriteFlag(const std::string &name, bool fValue);
@@ -155,6 +173,9 @@ public:
     bool LoadBlockIndexGuts(
         std::function<CBlockIndex*(const uint256&)> insertBlockIndex,
         const CChainParams& chainParams);
+
+private:
+    void UpdateAddressBalances(CDBBatch &batch, const std::vector<CAddressIndexDbEntry> &vect, bool fErase) const;
 };
 
 #endif // BITCOIN_TXDB_H
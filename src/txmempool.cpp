@@ -443,6 +443,8 @@ bool CTxMemPool::addUnchecked(const uint256& hash, const CTxMemPoolEntry &entry,
     nTransactionsUpdated++;
     totalTxSize += entry.GetTxSize();
 
+    GetMainSignals().TransactionAddedToMempool(tx, ++nMempoolSequence);
+
     return true;
 }
 
@@ -553,9 +555,12 @@ void CTxMemPool::removeSpentIndex(const uint256 txhash)
 }
 // END insightexplorer
 
-void CTxMemPool::removeUnchecked(txiter it)
+void CTxMemPool::removeUnchecked(txiter it, bool fForBlock)
 {
     const uint256 hash = it->GetTx().GetHash();
+    if (!fForBlock) {
+        GetMainSignals().TransactionRemovedFromMempool(it->GetTx(), ++nMempoolSequence);
+    }
     mapRecentlyAddedTx.erase(hash);
     for (const CTxIn& txin : it->GetTx().vin)
         mapNextTx.erase(txin.prevout);
@@ -820,8 +825,13 @@ void CTxMemPool::removeForBlock(const std::vector<CTransaction>& vtx, unsigned i
     }
     for (const CTransaction& tx : vtx)
     {
-        std::list<CTransaction> dummy;
-        remove(tx, dummy, false);
+        indexed_transaction_set::iterator i = mapTx.find(tx.GetHash());
+        if (i != mapTx.end()) {
+            setEntries stage;
+            stage.insert(i);
+            RemoveStaged(stage, true);
+            limitSet->remove(tx.GetHash());
+        }
         removeConflicts(tx, conflicts);
         ClearPrioritisation(tx.GetHash());
     }
@@ -1353,11 +1363,11 @@ void CTxMemPool::EnsureSizeLimit() {
     }
 }
 
-void CTxMemPool::RemoveStaged(setEntries &stage) {
+void CTxMemPool::RemoveStaged(setEntries &stage, bool fForBlock) {
     AssertLockHeld(cs);
     UpdateForRemoveFromMempool(stage);
     for (const txiter& it : stage) {
-        removeUnchecked(it);
+        removeUnchecked(it, fForBlock);
     }
 }
 
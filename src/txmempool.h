@@ -352,6 +352,8 @@ private:
     std::map<uint256, const CTransaction*> mapRecentlyAddedTx;
     uint64_t nRecentlyAddedSequence = 0;
     uint64_t nNotifiedSequence = 0;
+    //! Counts the additions, and removals other than for a block, published to listeners.
+    uint64_t nMempoolSequence = 0;
 
     std::map<uint256, const CTransaction*> mapSproutNullifiers;
     std::map<libzcash::nullifier_t, const CTransaction*> mapSaplingNullifiers;
@@ -527,8 +529,10 @@ public:
 public:
     /** Remove a set of transactions from the mempool.
      *  If a transaction is in this set, then all in-mempool descendants must
-     *  also be in the set.*/
-    void RemoveStaged(setEntries &stage);
+     *  also be in the set. fForBlock is set when the transactions were
+     *  included in a connected block, in which case listeners are not
+     *  notified of their removal.*/
+    void RemoveStaged(setEntries &stage, bool fForBlock = false);
 
     /** When adding transactions from a disconnected block back to the mempool,
      *  new mempool entries may have children in the mempool (which is generally
@@ -636,7 +640,7 @@ private:
      *  transactions in a chain before we've updated all the state for the
      *  removal.
      */
-    void removeUnchecked(txiter entry);
+    void removeUnchecked(txiter entry, bool fForBlock = false);
 };
 
 /**
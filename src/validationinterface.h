@@ -92,6 +92,10 @@ protected:
     virtual void UpdatedTransaction(const uint256 &hash) {}
     virtual void ResendWalletTransactions(int64_t nBestBlockTime) {}
     virtual void BlockChecked(const CBlock&, const CValidationState&) {}
+    virtual void BlockConnected(const CBlockIndex *pindex) {}
+    virtual void BlockDisconnected(const CBlockIndex *pindex) {}
+    virtual void TransactionAddedToMempool(const CTransaction &tx, uint64_t nMempoolSequence) {}
+    virtual void TransactionRemovedFromMempool(const CTransaction &tx, uint64_t nMempoolSequence) {}
     virtual void GetAddressForMining(std::optional<MinerAddress>&) {};
     friend void ::RegisterValidationInterface(CValidationInterface*);
     friend void ::UnregisterValidationInterface(CValidationInterface*);
@@ -160,6 +164,28 @@ struct CMainSignals {
     boost::signals2::signal<void (int64_t nBestBlockTime)> Broadcast;
     /** Notifies listeners of a block validation result */
     boost::signals2::signal<void (const CBlock&, const CValidationState&)> BlockChecked;
+    /**
+     * Notifies listeners, with cs_main held, of each block as it is connected
+     * to the active chain, including during initial block download.
+     */
+    boost::signals2::signal<void (const CBlockIndex *)> BlockConnected;
+    /**
+     * Notifies listeners, with cs_main held, of each block as it is
+     * disconnected from the active chain, before its transactions are
+     * returned to the mempool.
+     */
+    boost::signals2::signal<void (const CBlockIndex *)> BlockDisconnected;
+    /**
+     * Notifies listeners, with mempool.cs held, of each transaction added to
+     * the mempool, and the mempool sequence number after adding it.
+     */
+    boost::signals2::signal<void (const CTransaction &, uint64_t nMempoolSequence)> TransactionAddedToMempool;
+    /**
+     * Notifies listeners, with mempool.cs held, of each transaction removed
+     * from the mempool other than for inclusion in a connected block, and the
+     * mempool sequence number after removing it.
+     */
+    boost::signals2::signal<void (const CTransaction &, uint64_t nMempoolSequence)> TransactionRemovedFromMempool;
     /** Notifies listeners that an address for mining is required (coinbase) */
     boost::signals2::signal<void (std::optional<MinerAddress>&)> AddressForMining;
 };
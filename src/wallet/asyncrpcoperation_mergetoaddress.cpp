@@ -69,6 +69,7 @@ main_impl(
         const TransactionStrategy& strategy,
         const TransactionEffects& effects,
         const std::string& id,
+        AsyncRPCOperationTimings& timings,
         bool testmode);
 
 void AsyncRPCOperation_mergetoaddress::main()
@@ -89,7 +90,7 @@ void AsyncRPCOperation_mergetoaddress::main()
     try {
         UniValue sendResult;
         std::tie(txid, sendResult) =
-            main_impl(Params(), *pwalletMain, strategy_, effects_, getId(), testmode);
+            main_impl(Params(), *pwalletMain, strategy_, effects_, getId(), timings_, testmode);
         set_result(sendResult);
     } catch (const UniValue& objError) {
         int code = find_value(objError, "code").get_int();
@@ -138,6 +139,7 @@ main_impl(
         const TransactionStrategy& strategy,
         const TransactionEffects& effects,
         const std::string& id,
+        AsyncRPCOperationTimings& timings,
         bool testmode)
 {
     try {
@@ -182,15 +184,22 @@ main_impl(
             FormatMoney(payments.GetOrchardTotal()));
         LogPrint("zrpc", "%s: fee: %s\n", id, FormatMoney(effects.GetFee()));
 
-        auto buildResult = effects.ApproveAndBuild(
-                chainparams,
-                wallet,
-                chainActive,
-                strategy);
+        auto provingStart = std::chrono::steady_clock::now();
+        auto buildResult = [&]() {
+            AsyncRPCProvingJob provingJob;
+            return effects.ApproveAndBuild(
+                    chainparams,
+                    wallet,
+                    chainActive,
+                    strategy);
+        }();
+        timings.add("proving", std::chrono::steady_clock::now() - provingStart);
         auto tx = buildResult.GetTxOrThrow();
         LogPrint("zrpc", "%s, conventional fee: %s\n", id, FormatMoney(tx.GetConventionalFee()));
 
+        auto broadcastStart = std::chrono::steady_clock::now();
         UniValue sendResult = SendTransaction(tx, payments.GetResolvedPayments(), std::nullopt, testmode);
+        timings.add("broadcast", std::chrono::steady_clock::now() - broadcastStart);
 
         effects.UnlockSpendable(wallet);
         return {tx.GetHash(), sendResult};
@@ -62,6 +62,10 @@ public:
 
     virtual void main();
 
+    virtual OperationPriority getPriority() const {
+        return OperationPriority::BULK;
+    }
+
     virtual UniValue getStatus() const;
 
     /// Set to true to disable sending txs and generating proofs
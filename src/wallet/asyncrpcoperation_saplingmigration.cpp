@@ -175,7 +175,13 @@ bool AsyncRPCOperation_saplingmigration::main_impl() {
                 amountToSend - fee,
                 std::nullopt);
         builder.SendChangeToSprout(changeAddr.value());
-        CTransaction tx = builder.Build().GetTxOrThrow();
+        auto provingStart = std::chrono::steady_clock::now();
+        auto buildResult = [&]() {
+            AsyncRPCProvingJob provingJob;
+            return builder.Build();
+        }();
+        timings_.add("proving", std::chrono::steady_clock::now() - provingStart);
+        CTransaction tx = buildResult.GetTxOrThrow();
         if (isCancelled()) {
             LogPrint("zrpcunsafe", "%s: Canceled. Stopping.\n", getId());
             break;
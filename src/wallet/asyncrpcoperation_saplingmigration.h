@@ -22,6 +22,10 @@ public:
 
     virtual void main();
 
+    virtual OperationPriority getPriority() const {
+        return OperationPriority::BULK;
+    }
+
     virtual void cancel();
 
     virtual UniValue getStatus() const;
@@ -134,28 +134,46 @@ void AsyncRPCOperation_sendmany::main() {
 // 1. #1159 Currently there is no limit set on the number of elements, which could
 //     make the tx too large.
 // 2. #1360 Note selection is not optimal.
-// 3. #1277 Spendable notes are not locked, so an operation running in parallel
-//    could also try to use them.
+// 3. #1277 Selected inputs are only locked while the operation runs, so once
+//    it finishes they may be selected again before the tx is mined.
 // 4. #3615 There is no padding of inputs or outputs, which may leak information.
 //
 // At least #4 differs from the Rust transaction builder.
 tl::expected<uint256, InputSelectionError>
 AsyncRPCOperation_sendmany::main_impl(CWallet& wallet) {
-    auto spendable = builder_.FindAllSpendableInputs(wallet, ztxoSelector_, mindepth_);
-
-    auto preparedTx = builder_.PrepareTransaction(
-            wallet,
-            ztxoSelector_,
-            spendable,
-            recipients_,
-            chainActive,
-            strategy_,
-            fee_,
-            anchordepth_);
+    auto selectionStart = std::chrono::steady_clock::now();
+    auto preparedTx = [&]() {
+        // Note selection runs without holding the wallet lock for its whole
+        // duration, so another worker may reserve some of the same inputs
+        // between selection and locking. In that case we select again; the
+        // inputs it reserved are now locked and will be skipped.
+        for (int attempt = 0; ; attempt++) {
+            auto spendable = builder_.FindAllSpendableInputs(wallet, ztxoSelector_, mindepth_);
+
+            auto prepared = builder_.PrepareTransaction(
+                    wallet,
+                    ztxoSelector_,
+                    spendable,
+                    recipients_,
+                    chainActive,
+                    strategy_,
+                    fee_,
+                    anchordepth_);
+            if (!prepared.has_value() || prepared.value().TryLockSpendable(wallet)) {
+                return prepared;
+            }
+            if (attempt + 1 >= MAX_NOTE_SELECTION_ATTEMPTS) {
+                throw JSONRPCError(
+                        RPC_WALLET_ERROR,
+                        "The selected inputs are in use by other operations; try again once they have completed.");
+            }
+            LogPrint("zrpc", "%s: selected inputs were reserved by another operation, reselecting\n", getId());
+        }
+    }();
+    timings_.add("note_selection", std::chrono::steady_clock::now() - selectionStart);
 
     return preparedTx
         .map([&](const TransactionEffects& effects) {
-            effects.LockSpendable(wallet);
             try {
                 const auto& spendable = effects.GetSpendable();
                 const auto& payments = effects.GetPayments();
@@ -179,15 +197,22 @@ AsyncRPCOperation_sendmany::main_impl(CWallet& wallet) {
                          fee_.has_value() ? FormatMoney(fee_.value()) : "default");
                 LogPrint("zrpc", "%s: fee: %s\n", getId(), FormatMoney(effects.GetFee()));
 
-                auto buildResult = effects.ApproveAndBuild(
-                        Params(),
-                        wallet,
-                        chainActive,
-                        strategy_);
+                auto provingStart = std::chrono::steady_clock::now();
+                auto buildResult = [&]() {
+                    AsyncRPCProvingJob provingJob;
+                    return effects.ApproveAndBuild(
+                            Params(),
+                            wallet,
+                            chainActive,
+                            strategy_);
+                }();
+                timings_.add("proving", std::chrono::steady_clock::now() - provingStart);
                 auto tx = buildResult.GetTxOrThrow();
                 LogPrint("zrpc", "%s, conventional fee: %s\n", getId(), FormatMoney(tx.GetConventionalFee()));
 
+                auto broadcastStart = std::chrono::steady_clock::now();
                 UniValue sendResult = SendTransaction(tx, payments.GetResolvedPayments(), std::nullopt, testmode);
+                timings_.add("broadcast", std::chrono::steady_clock::now() - broadcastStart);
                 set_result(sendResult);
 
                 effects.UnlockSpendable(wallet);
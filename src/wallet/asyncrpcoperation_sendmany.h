@@ -24,6 +24,12 @@
 
 using namespace libzcash;
 
+/**
+ * How many times an operation reselects its inputs when another operation
+ * reserved some of them first, before giving up.
+ */
+static const int MAX_NOTE_SELECTION_ATTEMPTS = 5;
+
 class AsyncRPCOperation_sendmany : public AsyncRPCOperation {
 public:
     AsyncRPCOperation_sendmany(
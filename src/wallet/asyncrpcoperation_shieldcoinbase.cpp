@@ -232,16 +232,23 @@ uint256 AsyncRPCOperation_shieldcoinbase::main_impl(CWallet& wallet) {
                  fee_.has_value() ? FormatMoney(fee_.value()) : "default");
         LogPrint("zrpc", "%s: fee: %s\n", getId(), FormatMoney(effects_->GetFee()));
 
-        auto buildResult = effects_->ApproveAndBuild(
-                Params(),
-                wallet,
-                chainActive,
-                strategy_);
+        auto provingStart = std::chrono::steady_clock::now();
+        auto buildResult = [&]() {
+            AsyncRPCProvingJob provingJob;
+            return effects_->ApproveAndBuild(
+                    Params(),
+                    wallet,
+                    chainActive,
+                    strategy_);
+        }();
+        timings_.add("proving", std::chrono::steady_clock::now() - provingStart);
 
         auto tx = buildResult.GetTxOrThrow();
         LogPrint("zrpc", "%s, conventional fee: %s\n", getId(), FormatMoney(tx.GetConventionalFee()));
 
+        auto broadcastStart = std::chrono::steady_clock::now();
         UniValue sendResult = SendTransaction(tx, payments.GetResolvedPayments(), std::nullopt, testmode);
+        timings_.add("broadcast", std::chrono::steady_clock::now() - broadcastStart);
         set_result(sendResult);
 
         txid = tx.GetHash();
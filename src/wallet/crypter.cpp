@@ -12,6 +12,8 @@
 #include "streams.h"
 #include "util/system.h"
 
+#include <atomic>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -224,6 +226,55 @@ static bool DecryptSaplingSpendingKey(const CKeyingMaterial& vMasterKey,
     return sk.expsk.full_viewing_key() == extfvk.fvk;
 }
 
+// Decrypts and verifies the entries of a map of crypted keys. Only the first
+// entry is checked if fCheckAll is false. The first entry is always checked on
+// its own, so that a wrong passphrase fails it before any other entry can
+// pass; the remaining entries are then spread over the available cores, and
+// the check stops early once any of them fails.
+template <typename Map, typename Check>
+static void CheckCryptedKeys(const Map& mapCrypted, bool fCheckAll, Check check, bool& keyPass, bool& keyFail)
+{
+    auto it = mapCrypted.begin();
+    if (it == mapCrypted.end())
+        return;
+    if (!check(*it)) {
+        keyFail = true;
+        return;
+    }
+    keyPass = true;
+    if (!fCheckAll)
+        return;
+
+    std::vector<const typename Map::value_type*> vEntries;
+    for (++it; it != mapCrypted.end(); ++it) {
+        vEntries.push_back(&*it);
+    }
+    if (vEntries.empty())
+        return;
+
+    std::atomic<bool> fFail(false);
+    auto checkStrided = [&](size_t nStart, size_t nStride) {
+        for (size_t i = nStart; i < vEntries.size() && !fFail; i += nStride) {
+            if (!check(*vEntries[i])) {
+                fFail = true;
+            }
+        }
+    };
+    const int nThreads = std::max(1, std::min<int>(GetNumCores(), vEntries.size()));
+    if (nThreads == 1) {
+        checkStrided(0, 1);
+    } else {
+        std::vector<std::future<void>> vChecks;
+        for (int n = 0; n < nThreads; n++) {
+            vChecks.push_back(std::async(std::launch::async, checkStrided, n, nThreads));
+        }
+        for (auto& result : vChecks) {
+            result.get();
+        }
+    }
+    keyFail |= fFail;
+}
+
 // cs_KeyStore lock must be held by caller
 bool CCryptoKeyStore::SetCrypted()
 {
@@ -277,51 +328,29 @@ bool CCryptoKeyStore::Unlock(const CKeyingMaterial& vMasterKeyIn)
                 keyPass = true;
             }
         }
-        CryptedKeyMap::const_iterator mi = mapCryptedKeys.begin();
-        for (; mi != mapCryptedKeys.end(); ++mi)
-        {
-            const CPubKey &vchPubKey = (*mi).second.first;
-            const std::vector<unsigned char> &vchCryptedSecret = (*mi).second.second;
-            CKey key;
-            if (!DecryptKey(vMasterKeyIn, vchCryptedSecret, vchPubKey, key))
-            {
-                keyFail = true;
-                break;
-            }
-            keyPass = true;
-            if (fDecryptionThoroughlyChecked)
-                break;
-        }
-        CryptedSproutSpendingKeyMap::const_iterator miSprout = mapCryptedSproutSpendingKeys.begin();
-        for (; miSprout != mapCryptedSproutSpendingKeys.end(); ++miSprout)
-        {
-            const libzcash::SproutPaymentAddress &address = (*miSprout).first;
-            const std::vector<unsigned char> &vchCryptedSecret = (*miSprout).second;
-            libzcash::SproutSpendingKey sk;
-            if (!DecryptSproutSpendingKey(vMasterKeyIn, vchCryptedSecret, address, sk))
-            {
-                keyFail = true;
-                break;
-            }
-            keyPass = true;
-            if (fDecryptionThoroughlyChecked)
-                break;
-        }
-        CryptedSaplingSpendingKeyMap::const_iterator miSapling = mapCryptedSaplingSpendingKeys.begin();
-        for (; miSapling != mapCryptedSaplingSpendingKeys.end(); ++miSapling)
-        {
-            const libzcash::SaplingExtendedFullViewingKey &extfvk = (*miSapling).first;
-            const std::vector<unsigned char> &vchCryptedSecret = (*miSapling).second;
-            libzcash::SaplingExtendedSpendingKey sk;
-            if (!DecryptSaplingSpendingKey(vMasterKeyIn, vchCryptedSecret, extfvk, sk))
-            {
-                keyFail = true;
-                break;
-            }
-            keyPass = true;
-            if (fDecryptionThoroughlyChecked)
-                break;
-        }
+        // Decrypting every key is slow for large wallets, so the keys are
+        // checked in parallel.
+        const bool fCheckAll = !fDecryptionThoroughlyChecked;
+        CheckCryptedKeys(mapCryptedKeys, fCheckAll,
+            [&](const CryptedKeyMap::value_type& entry) {
+                const CPubKey &vchPubKey = entry.second.first;
+                const std::vector<unsigned char> &vchCryptedSecret = entry.second.second;
+                CKey key;
+                return DecryptKey(vMasterKeyIn, vchCryptedSecret, vchPubKey, key);
+            },
+            keyPass, keyFail);
+        CheckCryptedKeys(mapCryptedSproutSpendingKeys, fCheckAll,
+            [&](const CryptedSproutSpendingKeyMap::value_type& entry) {
+                libzcash::SproutSpendingKey sk;
+                return DecryptSproutSpendingKey(vMasterKeyIn, entry.second, entry.first, sk);
+            },
+            keyPass, keyFail);
+        CheckCryptedKeys(mapCryptedSaplingSpendingKeys, fCheckAll,
+            [&](const CryptedSaplingSpendingKeyMap::value_type& entry) {
+                libzcash::SaplingExtendedSpendingKey sk;
+                return DecryptSaplingSpendingKey(vMasterKeyIn, entry.second, entry.first, sk);
+            },
+            keyPass, keyFail);
         if (keyPass && keyFail)
         {
             LogPrintf("The wallet is probably corrupted: Some keys decrypt but not all.\n");
@@ -485,6 +514,16 @@ bool CCryptoKeyStore::AddKeyPubKey(const CKey& key, const CPubKey &pubkey)
     return AddCryptedKey(pubkey, vchCryptedSecret);
 }
 
+void CCryptoKeyStore::RemoveKey(const CKeyID &address)
+{
+    LOCK(cs_KeyStore);
+    if (!fUseCrypto) {
+        CBasicKeyStore::RemoveKey(address);
+        return;
+    }
+    mapCryptedKeys.erase(address);
+}
+
 
 bool CCryptoKeyStore::AddCryptedKey(const CPubKey &vchPubKey, const std::vector<unsigned char> &vchCryptedSecret)
 {
@@ -576,6 +615,17 @@ bool CCryptoKeyStore::AddSaplingSpendingKey(
     return AddCryptedSaplingSpendingKey(extfvk, vchCryptedSecret);
 }
 
+void CCryptoKeyStore::RemoveSaplingSpendingKey(
+    const libzcash::SaplingExtendedFullViewingKey &extfvk)
+{
+    LOCK(cs_KeyStore);
+    if (!fUseCrypto) {
+        CBasicKeyStore::RemoveSaplingSpendingKey(extfvk);
+        return;
+    }
+    mapCryptedSaplingSpendingKeys.erase(extfvk);
+}
+
 bool CCryptoKeyStore::AddCryptedSproutSpendingKey(
     const libzcash::SproutPaymentAddress &address,
     const libzcash::ReceivingKey &rk,
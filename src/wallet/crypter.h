@@ -185,6 +185,7 @@ public:
 
     virtual bool AddCryptedKey(const CPubKey &vchPubKey, const std::vector<unsigned char> &vchCryptedSecret);
     bool AddKeyPubKey(const CKey& key, const CPubKey &pubkey);
+    void RemoveKey(const CKeyID &address);
     bool HaveKey(const CKeyID &address) const
     {
         LOCK(cs_KeyStore);
@@ -241,6 +242,7 @@ public:
         const libzcash::SaplingExtendedFullViewingKey &extfvk,
         const std::vector<unsigned char> &vchCryptedSecret);
     bool AddSaplingSpendingKey(const libzcash::SaplingExtendedSpendingKey &sk);
+    void RemoveSaplingSpendingKey(const libzcash::SaplingExtendedFullViewingKey &extfvk);
     bool HaveSaplingSpendingKey(const libzcash::SaplingExtendedFullViewingKey &extfvk) const
     {
         LOCK(cs_KeyStore);
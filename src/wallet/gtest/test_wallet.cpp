@@ -83,6 +83,12 @@ public:
     void MarkAffectedTransactionsDirty(const CTransaction& tx) {
         CWallet::MarkAffectedTransactionsDirty(tx);
     }
+    void UpdateUnspentTxIndex(const CBlock* pblock) {
+        CWallet::UpdateUnspentTxIndex(pblock);
+    }
+    bool IsInUnspentTxIndex(const uint256& txid) const {
+        return setUnspentTxs.count(txid) > 0;
+    }
 };
 
 static std::vector<SaplingOutPoint> SetSaplingNoteData(CWalletTx& wtx, uint32_t idx) {
@@ -173,6 +179,77 @@ TEST(WalletTests, WalletNetworkSerialization) {
     EXPECT_EQ(restored.LoadWallet(fFirstRunRet), DB_WRONG_NETWORK);
 }
 
+TEST(WalletTests, BatchedTxWritesReloadLikeSerialLoad) {
+    SelectParams(CBaseChainParams::REGTEST);
+
+    // Get temporary and unique path for file.
+    fs::path pathTemp = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(pathTemp);
+    mapArgs["-datadir"] = pathTemp.string();
+
+    bool fFirstRun, fFirstRunDummy;
+    CWallet dummyWallet(Params(), "wallet_batched_txs.dat");
+    dummyWallet.LoadWallet(fFirstRunDummy);
+    bitdb.RemoveDb("wallet_batched_txs.dat");
+    CWallet wallet(Params(), "wallet_batched_txs.dat");
+    ASSERT_EQ(DB_LOAD_OK, wallet.LoadWallet(fFirstRun));
+
+    // Add a block's worth of transactions the way AddToWalletIfInvolvingMe
+    // does, and write them in one batch. There are enough of them for
+    // LoadWallet to read them on several threads.
+    const size_t nTxs = 300;
+    {
+        LOCK(wallet.cs_wallet);
+        for (size_t i = 0; i < nTxs; i++) {
+            CMutableTransaction mtx;
+            mtx.vin.resize(1);
+            mtx.vin[0].prevout = COutPoint(GetRandHash(), 0);
+            mtx.vout.resize(1);
+            mtx.vout[0].nValue = i + 1;
+            CWalletTx wtx(&wallet, CTransaction(mtx));
+            ASSERT_TRUE(wallet.AddToWallet(wtx, nullptr, true));
+        }
+        wallet.WritePendingTxs();
+    }
+
+    // Read the records back one at a time, in cursor order.
+    CWallet scratch(Params());
+    std::vector<uint256> vTxHash;
+    std::vector<CWalletTx> vSerial;
+    {
+        CWalletDB walletdb("wallet_batched_txs.dat", "r");
+        ASSERT_EQ(DB_LOAD_OK, walletdb.FindWalletTxToZap(&scratch, vTxHash, vSerial));
+    }
+    ASSERT_EQ(nTxs, vSerial.size());
+
+    CWallet restored(Params(), "wallet_batched_txs.dat");
+    ASSERT_EQ(DB_LOAD_OK, restored.LoadWallet(fFirstRun));
+
+    LOCK2(wallet.cs_wallet, restored.cs_wallet);
+    ASSERT_EQ(nTxs, restored.mapWallet.size());
+    EXPECT_EQ(wallet.nOrderPosNext, restored.nOrderPosNext);
+    for (const CWalletTx& serial : vSerial) {
+        auto it = restored.mapWallet.find(serial.GetHash());
+        ASSERT_NE(it, restored.mapWallet.end());
+        const CWalletTx& loaded = it->second;
+        EXPECT_EQ(serial.vout, loaded.vout);
+        EXPECT_EQ(serial.mapValue, loaded.mapValue);
+        EXPECT_EQ(serial.nOrderPos, loaded.nOrderPos);
+        EXPECT_EQ(serial.nTimeReceived, loaded.nTimeReceived);
+        EXPECT_EQ(serial.nTimeSmart, loaded.nTimeSmart);
+        EXPECT_EQ(wallet.mapWallet.at(serial.GetHash()).nOrderPos, loaded.nOrderPos);
+    }
+
+    // The order index lists the transactions in the order they were added.
+    ASSERT_EQ(nTxs, restored.wtxOrdered.size());
+    int64_t nExpectedPos = wallet.wtxOrdered.begin()->first;
+    for (const auto& [nOrderPos, pwtx] : restored.wtxOrdered) {
+        EXPECT_EQ(nExpectedPos++, nOrderPos);
+        EXPECT_EQ(nOrderPos, pwtx->nOrderPos);
+        EXPECT_EQ(wallet.mapWallet.at(pwtx->GetHash()).nOrderPos, nOrderPos);
+    }
+}
+
 TEST(WalletTests, SproutNoteDataSerialisation) {
     auto sk = libzcash::SproutSpendingKey::random();
     auto wtx = GetValidSproutReceive(sk, 10, true);
@@ -385,6 +462,83 @@ TEST(WalletTests, FindUnspentSproutNotes) {
     mapBlockIndex.erase(blockHash3);
 }
 
+TEST(WalletTests, UnspentTxIndexSkipsSpentSproutNotes) {
+    SelectParams(CBaseChainParams::TESTNET);
+
+    TestWallet wallet(Params());
+    LOCK2(cs_main, wallet.cs_wallet);
+
+    auto sk = libzcash::SproutSpendingKey::random();
+    wallet.AddSproutSpendingKey(sk);
+
+    auto wtx = GetValidSproutReceive(sk, 10, true);
+    auto note = GetSproutNote(sk, wtx, 0, 1);
+    auto nullifier = note.nullifier(sk);
+
+    mapSproutNoteData_t noteData;
+    JSOutPoint jsoutpt {wtx.GetHash(), 0, 1};
+    SproutNoteData nd {sk.address(), nullifier};
+    noteData[jsoutpt] = nd;
+    wtx.SetSproutNoteData(noteData);
+
+    // Fake-mine the transaction
+    EXPECT_EQ(-1, chainActive.Height());
+    CBlock block;
+    block.vtx.push_back(wtx);
+    block.hashMerkleRoot = BlockMerkleRoot(block);
+    auto blockHash = block.GetHash();
+    CBlockIndex fakeIndex {block};
+    mapBlockIndex.insert(std::make_pair(blockHash, &fakeIndex));
+    chainActive.SetTip(&fakeIndex);
+
+    wtx.SetMerkleBranch(block);
+    wallet.LoadWalletTx(wtx);
+    wallet.UpdateUnspentTxIndex(&block);
+
+    // The note is unspent, so its transaction stays in the index.
+    EXPECT_TRUE(wallet.IsInUnspentTxIndex(wtx.GetHash()));
+
+    // Fake-mine a spend transaction
+    auto wtx2 = GetValidSproutSpend(sk, note, 5);
+    CBlock block2;
+    block2.vtx.push_back(wtx2);
+    block2.hashMerkleRoot = BlockMerkleRoot(block2);
+    block2.hashPrevBlock = blockHash;
+    auto blockHash2 = block2.GetHash();
+    CBlockIndex fakeIndex2 {block2};
+    mapBlockIndex.insert(std::make_pair(blockHash2, &fakeIndex2));
+    fakeIndex2.nHeight = 1;
+    chainActive.SetTip(&fakeIndex2);
+
+    wtx2.SetMerkleBranch(block2);
+    wallet.LoadWalletTx(wtx2);
+    wallet.UpdateUnspentTxIndex(&block2);
+
+    // The received note is now spent in the main chain.
+    EXPECT_FALSE(wallet.IsInUnspentTxIndex(wtx.GetHash()));
+
+    std::vector<SproutNoteEntry> sproutEntries;
+    std::vector<SaplingNoteEntry> saplingEntries;
+    std::vector<OrchardNoteMetadata> orchardEntries;
+    wallet.GetFilteredNotes(sproutEntries, saplingEntries, orchardEntries, std::nullopt, std::nullopt, 0);
+    EXPECT_EQ(0, sproutEntries.size());
+    // Spent notes are still found when they are not being ignored.
+    wallet.GetFilteredNotes(sproutEntries, saplingEntries, orchardEntries, std::nullopt, std::nullopt, 0, INT_MAX, false);
+    EXPECT_EQ(1, sproutEntries.size());
+    sproutEntries.clear();
+
+    // Disconnecting the spend makes the note unspent again.
+    chainActive.SetTip(&fakeIndex);
+    wallet.MarkAffectedTransactionsDirty(wtx2);
+    EXPECT_TRUE(wallet.IsInUnspentTxIndex(wtx.GetHash()));
+    wallet.GetFilteredNotes(sproutEntries, saplingEntries, orchardEntries, std::nullopt, std::nullopt, 0);
+    EXPECT_EQ(1, sproutEntries.size());
+
+    // Tear down
+    chainActive.SetTip(NULL);
+    mapBlockIndex.erase(blockHash);
+    mapBlockIndex.erase(blockHash2);
+}
 
 TEST(WalletTests, SetSproutNoteAddrsInCWalletTx) {
     auto sk = libzcash::SproutSpendingKey::random();
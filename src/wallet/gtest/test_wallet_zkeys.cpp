@@ -10,6 +10,7 @@
 /**
  * This test covers Sapling methods on CWallet
  * GenerateNewLegacySaplingZKey()
+ * GenerateNewLegacySaplingZKeys()
  * AddSaplingZKey()
  * AddSaplingPaymentAddress()
  * LoadSaplingZKey()
@@ -108,6 +109,48 @@ TEST(WalletZkeysTest, StoreAndLoadSaplingZkeys) {
     EXPECT_TRUE(wallet.HaveSaplingIncomingViewingKey(dpa2));
 }
 
+/**
+ * This test covers GenerateNewLegacySaplingZKeys(), which must yield the same
+ * keys, in the same order, as repeated calls to GenerateNewLegacySaplingZKey().
+ */
+TEST(WalletZkeysTest, GenerateSaplingZkeysInBatch) {
+    SelectParams(CBaseChainParams::MAIN);
+
+    CWallet wallet(Params());
+    CWallet batchWallet(Params());
+    LOCK2(wallet.cs_wallet, batchWallet.cs_wallet);
+
+    // No HD seed in the wallet
+    EXPECT_ANY_THROW(batchWallet.GenerateNewLegacySaplingZKeys(2));
+
+    wallet.GenerateNewSeed();
+    ASSERT_TRUE(batchWallet.SetMnemonicSeed(wallet.GetMnemonicSeed().value()));
+    batchWallet.SetMnemonicHDChain(wallet.GetMnemonicHDChain().value(), true);
+
+    std::vector<libzcash::SaplingPaymentAddress> expected;
+    for (int i = 0; i < 5; i++) {
+        expected.push_back(wallet.GenerateNewLegacySaplingZKey());
+    }
+
+    auto addresses = batchWallet.GenerateNewLegacySaplingZKeys(2);
+    auto more = batchWallet.GenerateNewLegacySaplingZKeys(3);
+    addresses.insert(addresses.end(), more.begin(), more.end());
+    ASSERT_EQ(expected, addresses);
+
+    std::set<libzcash::SaplingPaymentAddress> addrs;
+    batchWallet.GetSaplingPaymentAddresses(addrs);
+    ASSERT_EQ(5, addrs.size());
+    for (const auto& addr : addresses) {
+        libzcash::SaplingExtendedSpendingKey extsk;
+        EXPECT_TRUE(batchWallet.GetSaplingExtendedSpendingKey(addr, extsk));
+        EXPECT_EQ(addr, extsk.ToXFVK().DefaultAddress());
+        EXPECT_EQ(1, batchWallet.mapSaplingZKeyMetadata.count(extsk.ToXFVK().fvk.in_viewing_key()));
+    }
+    EXPECT_EQ(
+        wallet.GetMnemonicHDChain().value().GetLegacySaplingKeyCounter(),
+        batchWallet.GetMnemonicHDChain().value().GetLegacySaplingKeyCounter());
+}
+
 /**
  * This test covers methods on CWallet
  * GenerateNewSproutZKey()
@@ -3083,6 +3083,30 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
         throw JSONRPCError(RPC_TYPE_ERROR, "Invalid samplecount");
     }
 
+#ifdef ENABLE_MINING
+    if (benchmarktype == "solveequihashscaling") {
+        // Solves samplecount nonces with 1, 2, 4, ... threads, up to maxthreads.
+        int nMaxThreads = params.size() < 3 ? GetNumCores() : params[2].get_int();
+        if (nMaxThreads <= 0) {
+            throw JSONRPCError(RPC_TYPE_ERROR, "Invalid number of threads");
+        }
+        UniValue results(UniValue::VARR);
+        for (int nThreads = 1; ; nThreads = std::min(2 * nThreads, nMaxThreads)) {
+            EquihashScalingSample sample = benchmark_solve_equihash_scaling(nThreads, samplecount);
+            UniValue result(UniValue::VOBJ);
+            result.pushKV("threads", nThreads);
+            result.pushKV("runningtime", sample.time / samplecount);
+            result.pushKV("solutionspersecondpercore", sample.nSolutions / sample.time / nThreads);
+            result.pushKV("peakrss", (uint64_t)sample.nPeakRSS);
+            results.push_back(result);
+            if (nThreads == nMaxThreads) {
+                break;
+            }
+        }
+        return results;
+    }
+#endif
+
     std::vector<double> sample_times;
 
     JSDescription samplejoinsplit;
@@ -3118,6 +3142,13 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
                 std::vector<double> vals = benchmark_solve_equihash_threaded(nThreads);
                 sample_times.insert(sample_times.end(), vals.begin(), vals.end());
             }
+        } else if (benchmarktype == "solveequihashparallel") {
+            // One solver working through a single nonce on nThreads threads.
+            int nThreads = params.size() < 3 ? GetNumCores() : params[2].get_int();
+            if (nThreads <= 0) {
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid number of threads");
+            }
+            sample_times.push_back(benchmark_solve_equihash_parallel(nThreads));
 #endif
         } else if (benchmarktype == "verifyequihash") {
             sample_times.push_back(benchmark_verify_equihash());
@@ -3169,9 +3200,25 @@ UniValue zc_benchmark(const UniValue& params, bool fHelp)
         } else if (benchmarktype == "listunspent") {
             sample_times.push_back(benchmark_listunspent());
         } else if (benchmarktype == "createsaplingspend") {
-            sample_times.push_back(benchmark_create_sapling_spend());
+            // Optionally build a bundle with several spends, to measure how
+            // proof creation scales across the proving threads.
+            int nSpends = 1;
+            if (params.size() >= 3) {
+                nSpends = params[2].get_int();
+            }
+            if (nSpends <= 0) {
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid number of spends");
+            }
+            sample_times.push_back(benchmark_create_sapling_spends(nSpends));
         } else if (benchmarktype == "createsaplingoutput") {
-            sample_times.push_back(benchmark_create_sapling_output());
+            int nOutputs = 1;
+            if (params.size() >= 3) {
+                nOutputs = params[2].get_int();
+            }
+            if (nOutputs <= 0) {
+                throw JSONRPCError(RPC_TYPE_ERROR, "Invalid number of outputs");
+            }
+            sample_times.push_back(benchmark_create_sapling_outputs(nOutputs));
         } else if (benchmarktype == "verifysaplingspend") {
             sample_times.push_back(benchmark_verify_sapling_spend());
         } else if (benchmarktype == "verifysaplingoutput") {
@@ -3250,6 +3297,65 @@ UniValue z_getnewaddress(const UniValue& params, bool fHelp)
     }
 }
 
+UniValue z_getnewaddresses(const UniValue& params, bool fHelp)
+{
+    if (!EnsureWalletIsAvailable(fHelp))
+        return NullUniValue;
+
+    std::string defaultType = ADDR_TYPE_SAPLING;
+
+    if (!fEnableZGetNewAddress || fHelp || params.size() < 1 || params.size() > 2)
+        throw runtime_error(
+            "z_getnewaddresses count ( type )\n"
+            + Deprecated(fEnableZGetNewAddress,
+                         "z_getnewaddress",
+                         "Please use z_getnewaccount and z_getaddressforaccount instead.") +
+            "\nReturns count new shielded addresses for receiving payments. This is\n"
+            "equivalent to calling z_getnewaddress count times, but derives the keys in\n"
+            "parallel and writes them to the wallet in batches.\n"
+            "\nArguments:\n"
+            "1. count          (numeric, required) The number of addresses to generate.\n"
+            "2. \"type\"         (string, optional, default=\"" + defaultType + "\") The type of address. Only \""
+            + ADDR_TYPE_SAPLING + "\" is supported.\n"
+            "\nResult:\n"
+            "[\n"
+            "  \"zcashaddress\"  (string) A new shielded address.\n"
+            "  ,...\n"
+            "]\n"
+            "\nExamples:\n"
+            + HelpExampleCli("z_getnewaddresses", "100")
+            + HelpExampleCli("z_getnewaddresses", "100 " + ADDR_TYPE_SAPLING)
+            + HelpExampleRpc("z_getnewaddresses", "100")
+        );
+
+    LOCK2(cs_main, pwalletMain->cs_wallet);
+
+    const CChainParams& chainparams = Params();
+
+    EnsureWalletIsUnlocked();
+    EnsureWalletIsBackedUp(chainparams);
+
+    int count = params[0].get_int();
+    if (count <= 0) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid parameter, count must be greater than zero");
+    }
+
+    auto addrType = defaultType;
+    if (params.size() > 1) {
+        addrType = params[1].get_str();
+    }
+    if (addrType != ADDR_TYPE_SAPLING) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid address type");
+    }
+
+    KeyIO keyIO(chainparams);
+    UniValue ret(UniValue::VARR);
+    for (const auto& addr : pwalletMain->GenerateNewLegacySaplingZKeys(count)) {
+        ret.push_back(keyIO.EncodePaymentAddress(addr));
+    }
+    return ret;
+}
+
 UniValue z_getnewaccount(const UniValue& params, bool fHelp)
 {
     if (!EnsureWalletIsAvailable(fHelp))
@@ -6037,6 +6143,7 @@ static const CRPCCommand commands[] =
     { "wallet",             "z_getoperationresult",     &z_getoperationresult,     true  },
     { "wallet",             "z_listoperationids",       &z_listoperationids,       true  },
     { "wallet",             "z_getnewaddress",          &z_getnewaddress,          true  },
+    { "wallet",             "z_getnewaddresses",        &z_getnewaddresses,        true  },
     { "wallet",             "z_getnewaccount",          &z_getnewaccount,          true  },
     { "wallet",             "z_listaccounts",           &z_listaccounts,           true  },
     { "wallet",             "z_listaddresses",          &z_listaddresses,          true  },
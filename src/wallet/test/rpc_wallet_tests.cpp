@@ -30,6 +30,7 @@
 
 #include <array>
 #include <chrono>
+#include <condition_variable>
 #include <optional>
 #include <thread>
 #include <variant>
@@ -1120,6 +1121,84 @@ BOOST_AUTO_TEST_CASE(rpc_wallet_async_operations_parallel_cancel)
     BOOST_CHECK(ids.size()==0);
 }
 
+// Records the order in which operations start executing. Operations then
+// block until the test releases them.
+std::mutex gStartOrderLock;
+std::condition_variable gStartOrderCond;
+std::vector<std::string> gStartOrder;
+bool gReleaseOrdered = false;
+
+class OrderedOperation : public AsyncRPCOperation {
+public:
+    std::string name;
+    OperationPriority priority;
+    OrderedOperation(std::string name, OperationPriority priority) : name(name), priority(priority) {}
+    virtual ~OrderedOperation() {}
+    virtual OperationPriority getPriority() const {
+        return priority;
+    }
+    virtual void main() {
+        set_state(OperationStatus::EXECUTING);
+        start_execution_clock();
+        {
+            std::unique_lock<std::mutex> lock(gStartOrderLock);
+            gStartOrder.push_back(name);
+            gStartOrderCond.notify_all();
+            gStartOrderCond.wait(lock, [] { return gReleaseOrdered; });
+        }
+        stop_execution_clock();
+        set_result(UniValue(UniValue::VSTR, "done"));
+        set_state(OperationStatus::SUCCESS);
+    }
+};
+
+static void WaitForStartedOperations(size_t n)
+{
+    std::unique_lock<std::mutex> lock(gStartOrderLock);
+    gStartOrderCond.wait(lock, [n] { return gStartOrder.size() >= n; });
+}
+
+// This tests that bulk operations leave a worker free for interactive ones
+BOOST_AUTO_TEST_CASE(rpc_wallet_async_operations_priority)
+{
+    {
+        std::lock_guard<std::mutex> guard(gStartOrderLock);
+        gStartOrder.clear();
+        gReleaseOrdered = false;
+    }
+
+    std::shared_ptr<AsyncRPCQueue> q = std::make_shared<AsyncRPCQueue>();
+    q->addWorker();
+    q->addWorker();
+
+    q->addOperation(std::make_shared<OrderedOperation>("bulk1", OperationPriority::BULK));
+    WaitForStartedOperations(1);
+    q->addOperation(std::make_shared<OrderedOperation>("bulk2", OperationPriority::BULK));
+    auto interactive = std::make_shared<OrderedOperation>("interactive", OperationPriority::INTERACTIVE);
+    q->addOperation(interactive);
+
+    // With two workers only one bulk operation may run at a time, so while
+    // the first bulk operation is blocked the interactive operation starts
+    // and the second bulk operation stays queued.
+    WaitForStartedOperations(2);
+    {
+        std::lock_guard<std::mutex> guard(gStartOrderLock);
+        std::vector<std::string> expected = {"bulk1", "interactive"};
+        BOOST_CHECK(gStartOrder == expected);
+        gReleaseOrdered = true;
+    }
+    gStartOrderCond.notify_all();
+    q->finishAndWait();
+
+    std::vector<std::string> expected = {"bulk1", "interactive", "bulk2"};
+    BOOST_CHECK(gStartOrder == expected);
+
+    // The operation reports how long it waited in the queue.
+    UniValue timing = find_value(interactive->getStatus(), "timing");
+    BOOST_CHECK(timing.isObject());
+    BOOST_CHECK(find_value(timing, "queue_wait_secs").isNum());
+}
+
 // This tests z_getoperationstatus, z_getoperationresult, z_listoperationids
 BOOST_AUTO_TEST_CASE(rpc_z_getoperations)
 {
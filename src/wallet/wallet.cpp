@@ -36,6 +36,7 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <future>
 #include <numeric>
 #include <variant>
 
@@ -55,6 +56,37 @@ unsigned int nOrchardActionLimit = DEFAULT_ORCHARD_ACTION_LIMIT;
 
 const char * DEFAULT_WALLET_DAT = "wallet.dat";
 
+/**
+ * The fewest keys worth deriving on a thread of their own. Smaller batches,
+ * such as the one key that replaces a key taken from the keypool, are derived
+ * on the calling thread.
+ */
+static const unsigned int MIN_KEYS_PER_DERIVATION_THREAD = 16;
+
+//! Calls derive(i) for each i below n, spread over the cores if n is large enough.
+template <typename F>
+static void DeriveKeys(unsigned int n, F derive)
+{
+    const unsigned int nThreads = std::max(1, std::min<int>(GetNumCores(), n / MIN_KEYS_PER_DERIVATION_THREAD));
+    if (nThreads == 1) {
+        for (unsigned int i = 0; i < n; i++) {
+            derive(i);
+        }
+        return;
+    }
+    std::vector<std::future<void>> vDerive;
+    for (unsigned int t = 0; t < nThreads; t++) {
+        vDerive.push_back(std::async(std::launch::async, [&, t]() {
+            for (unsigned int i = t; i < n; i += nThreads) {
+                derive(i);
+            }
+        }));
+    }
+    for (auto& f : vDerive) {
+        f.get();
+    }
+}
+
 std::set<ReceiverType> CWallet::DefaultReceiverTypes(int nHeight) {
     // For now, just ignore the height information because the default
     // is always the same.
@@ -153,6 +185,115 @@ SaplingPaymentAddress CWallet::GenerateNewLegacySaplingZKey() {
     }
 }
 
+std::vector<SaplingPaymentAddress> CWallet::GenerateNewLegacySaplingZKeys(unsigned int count) {
+    AssertLockHeld(cs_wallet);
+
+    if (!mnemonicHDChain.has_value()) {
+        throw std::runtime_error(
+                "CWallet::GenerateNewLegacySaplingZKeys(): Wallet is missing mnemonic seed metadata.");
+    }
+    CHDChain& hdChain = mnemonicHDChain.value();
+    auto seedOpt = GetMnemonicSeed();
+    if (!seedOpt.has_value()) {
+        throw std::runtime_error(
+                "CWallet::GenerateNewLegacySaplingZKeys(): Wallet does not have a mnemonic seed.");
+    }
+    const HDSeed& seed = seedOpt.value();
+    const uint32_t coinType = BIP44CoinType();
+
+    std::vector<SaplingPaymentAddress> addrs;
+    while (addrs.size() < count) {
+        const uint32_t nStart = hdChain.GetLegacySaplingKeyCounter();
+        const unsigned int nBatch = std::min<unsigned int>(count - addrs.size(), WALLET_KEY_BATCH_SIZE);
+
+        // Deriving the keys dominates, so spread it over the cores.
+        std::vector<std::optional<std::pair<SaplingExtendedSpendingKey, HDKeyPath>>> vKeys(nBatch);
+        std::vector<std::optional<SaplingExtendedFullViewingKey>> vFVKs(nBatch);
+        DeriveKeys(nBatch, [&](unsigned int i) {
+            vKeys[i] = SaplingExtendedSpendingKey::Legacy(seed, coinType, nStart + i);
+            vFVKs[i] = vKeys[i].value().first.ToXFVK();
+        });
+
+        // If the batch cannot be started, each write is committed on its own.
+        std::optional<CWalletDB> walletdb;
+        bool fBatch = false;
+        if (fFileBacked) {
+            walletdb.emplace(strWalletFile);
+            fBatch = walletdb->TxnBegin();
+        }
+        CWalletDB* pwalletdb = walletdb.has_value() ? &walletdb.value() : nullptr;
+
+        // What this batch adds in memory, so that it can be removed again if
+        // the batch is not committed.
+        const CHDChain hdChainPrev = hdChain;
+        std::vector<SaplingExtendedFullViewingKey> vAddedKeys;
+        std::vector<SaplingIncomingViewingKey> vAddedFVKs;
+        std::vector<SaplingPaymentAddress> vAddedAddrs;
+        try {
+            for (unsigned int i = 0; i < nBatch && addrs.size() < count; i++) {
+                hdChain.IncrementLegacySaplingKeyCounter();
+                const auto& extfvk = vFVKs[i].value();
+                if (HaveSaplingSpendingKey(extfvk)) {
+                    // the key already existed, so try the next one
+                    continue;
+                }
+                auto ivk = extfvk.ToIncomingViewingKey();
+                CKeyMetadata keyMeta(GetTime());
+                keyMeta.hdKeypath = vKeys[i].value().second;
+                keyMeta.seedFp = seed.Fingerprint();
+                mapSaplingZKeyMetadata[ivk] = keyMeta;
+
+                vAddedKeys.push_back(extfvk);
+                if (!HaveSaplingFullViewingKey(ivk)) {
+                    vAddedFVKs.push_back(ivk);
+                }
+                if (!AddSaplingZKeyWithDB(pwalletdb, vKeys[i].value().first)) {
+                    throw std::runtime_error("CWallet::GenerateNewLegacySaplingZKeys(): AddSaplingZKey failed.");
+                }
+                auto addr = extfvk.DefaultAddress();
+                if (!HaveSaplingIncomingViewingKey(addr)) {
+                    vAddedAddrs.push_back(addr);
+                }
+                if (!AddSaplingPaymentAddressWithDB(pwalletdb, ivk, addr)) {
+                    throw std::runtime_error("CWallet::GenerateNewLegacySaplingZKeys(): AddSaplingPaymentAddress failed.");
+                }
+                addrs.push_back(addr);
+            }
+            if (pwalletdb != nullptr) {
+                if (!pwalletdb->WriteMnemonicHDChain(hdChain)) {
+                    throw std::runtime_error(
+                            "CWallet::GenerateNewLegacySaplingZKeys(): Writing HD chain model failed");
+                }
+                if (fBatch && !pwalletdb->TxnCommit()) {
+                    throw std::runtime_error(
+                            "CWallet::GenerateNewLegacySaplingZKeys(): Committing generated keys failed");
+                }
+            }
+        } catch (...) {
+            // Without a batch, the writes that succeeded were committed, so
+            // the wallet keeps what it has persisted.
+            if (fBatch || pwalletdb == nullptr) {
+                if (fBatch) {
+                    pwalletdb->TxnAbort();
+                }
+                for (const auto& extfvk : vAddedKeys) {
+                    RemoveSaplingSpendingKey(extfvk);
+                    mapSaplingZKeyMetadata.erase(extfvk.ToIncomingViewingKey());
+                }
+                for (const auto& ivk : vAddedFVKs) {
+                    RemoveSaplingFullViewingKey(ivk);
+                }
+                for (const auto& addr : vAddedAddrs) {
+                    RemoveSaplingPaymentAddress(addr);
+                }
+                hdChain = hdChainPrev;
+            }
+            throw;
+        }
+    }
+    return addrs;
+}
+
 std::pair<SaplingPaymentAddress, bool> CWallet::GenerateLegacySaplingZKey(uint32_t addrIndex) {
     auto seedOpt = GetMnemonicSeed();
     if (!seedOpt.has_value()) {
@@ -187,10 +328,29 @@ std::pair<SaplingPaymentAddress, bool> CWallet::GenerateLegacySaplingZKey(uint32
 
 // Add spending key to keystore
 bool CWallet::AddSaplingZKey(const libzcash::SaplingExtendedSpendingKey &sk)
+{
+    if (!fFileBacked) {
+        return AddSaplingZKeyWithDB(nullptr, sk);
+    }
+    CWalletDB walletdb(strWalletFile);
+    return AddSaplingZKeyWithDB(&walletdb, sk);
+}
+
+bool CWallet::AddSaplingZKeyWithDB(CWalletDB* pwalletdb, const libzcash::SaplingExtendedSpendingKey &sk)
 {
     AssertLockHeld(cs_wallet); // mapSaplingZKeyMetadata
 
-    if (!CCryptoKeyStore::AddSaplingSpendingKey(sk)) {
+    // CCryptoKeyStore writes the encrypted key through AddCryptedSaplingSpendingKey,
+    // which uses pwalletdbEncryption if it is set.
+    bool fTunnel = pwalletdb != nullptr && pwalletdbEncryption == nullptr;
+    if (fTunnel) {
+        pwalletdbEncryption = pwalletdb;
+    }
+    bool fAdded = CCryptoKeyStore::AddSaplingSpendingKey(sk);
+    if (fTunnel) {
+        pwalletdbEncryption = nullptr;
+    }
+    if (!fAdded) {
         return false;
     }
 
@@ -200,7 +360,7 @@ bool CWallet::AddSaplingZKey(const libzcash::SaplingExtendedSpendingKey &sk)
 
     if (!IsCrypted()) {
         auto ivk = sk.expsk.full_viewing_key().in_viewing_key();
-        return CWalletDB(strWalletFile).WriteSaplingZKey(ivk, sk, mapSaplingZKeyMetadata[ivk]);
+        return pwalletdb->WriteSaplingZKey(ivk, sk, mapSaplingZKeyMetadata[ivk]);
     }
 
     return true;
@@ -225,6 +385,18 @@ bool CWallet::AddSaplingFullViewingKey(const libzcash::SaplingExtendedFullViewin
 bool CWallet::AddSaplingPaymentAddress(
     const libzcash::SaplingIncomingViewingKey &ivk,
     const libzcash::SaplingPaymentAddress &addr)
+{
+    if (!fFileBacked) {
+        return AddSaplingPaymentAddressWithDB(nullptr, ivk, addr);
+    }
+    CWalletDB walletdb(strWalletFile);
+    return AddSaplingPaymentAddressWithDB(&walletdb, ivk, addr);
+}
+
+bool CWallet::AddSaplingPaymentAddressWithDB(
+    CWalletDB* pwalletdb,
+    const libzcash::SaplingIncomingViewingKey &ivk,
+    const libzcash::SaplingPaymentAddress &addr)
 {
     AssertLockHeld(cs_wallet); // mapSaplingZKeyMetadata
 
@@ -236,7 +408,7 @@ bool CWallet::AddSaplingPaymentAddress(
         return true;
     }
 
-    return CWalletDB(strWalletFile).WriteSaplingPaymentAddress(addr, ivk);
+    return pwalletdb->WriteSaplingPaymentAddress(addr, ivk);
 }
 
 // Add spending key to keystore
@@ -364,6 +536,124 @@ CPubKey CWallet::GenerateNewKey(bool external)
     return pubkey.value();
 }
 
+std::vector<CPubKey> CWallet::GenerateNewKeys(
+        CWalletDB& walletdb,
+        bool external,
+        unsigned int count,
+        std::vector<CKeyID>& vAdded)
+{
+    AssertLockHeld(cs_wallet); // mapKeyMetadata
+
+    if (!mnemonicHDChain.has_value()) {
+        throw std::runtime_error(
+                "CWallet::GenerateNewKeys(): Wallet is missing mnemonic seed metadata.");
+    }
+    CHDChain& hdChain = mnemonicHDChain.value();
+
+    transparent::AccountKey accountKey = this->GetLegacyAccountKey();
+    std::vector<CPubKey> pubkeys;
+    while (pubkeys.size() < count) {
+        const uint32_t nStart = hdChain.GetLegacyTKeyCounter(external);
+        const unsigned int nBatch = count - pubkeys.size();
+        auto keys = external ?
+            accountKey.DeriveExternalSpendingKeys(nStart, nBatch) :
+            accountKey.DeriveInternalSpendingKeys(nStart, nBatch);
+
+        // Computing and verifying the public keys dominates, so spread it
+        // over the cores.
+        std::vector<CPubKey> vPubKeys(nBatch);
+        DeriveKeys(nBatch, [&](unsigned int i) {
+            if (keys[i].has_value()) {
+                vPubKeys[i] = keys[i].value().GetPubKey();
+                assert(keys[i].value().VerifyPubKey(vPubKeys[i]));
+            }
+        });
+
+        // The key IDs of the batch are hashed together, several at a time
+        // where the CPU supports it.
+        const size_t PUBKEY_SIZE = CPubKey::COMPRESSED_PUBLIC_KEY_SIZE;
+        std::vector<unsigned char> vSerialized;
+        vSerialized.reserve(nBatch * PUBKEY_SIZE);
+        for (unsigned int i = 0; i < nBatch; i++) {
+            if (keys[i].has_value()) {
+                assert(vPubKeys[i].size() == PUBKEY_SIZE);
+                vSerialized.insert(vSerialized.end(), vPubKeys[i].begin(), vPubKeys[i].end());
+            }
+        }
+        const size_t nKeys = vSerialized.size() / PUBKEY_SIZE;
+        std::vector<unsigned char> vKeyIDs(CRIPEMD160::OUTPUT_SIZE * nKeys);
+        Hash160Batch(vKeyIDs.data(), vSerialized.data(), PUBKEY_SIZE, nKeys);
+
+        size_t nKey = 0;
+        for (unsigned int i = 0; i < nBatch; i++) {
+            hdChain.IncrementLegacyTKeyCounter(external);
+            // if we did not successfully generate a key, the next batch makes up for it.
+            if (keys[i].has_value()) {
+                CKeyID keyID;
+                memcpy(keyID.begin(), vKeyIDs.data() + CRIPEMD160::OUTPUT_SIZE * nKey++, CRIPEMD160::OUTPUT_SIZE);
+                if (!HaveKey(keyID)) {
+                    vAdded.push_back(keyID);
+                }
+                AddTransparentSecretKey(
+                    fFileBacked ? &walletdb : nullptr,
+                    hdChain.GetSeedFingerprint(),
+                    keys[i].value(),
+                    vPubKeys[i],
+                    transparent::AccountKey::KeyPath(BIP44CoinType(), ZCASH_LEGACY_ACCOUNT, external, nStart + i));
+                pubkeys.push_back(vPubKeys[i]);
+            }
+        }
+    }
+
+    // Update the persisted chain information
+    if (fFileBacked && !walletdb.WriteMnemonicHDChain(hdChain)) {
+        throw std::runtime_error("CWallet::GenerateNewKeys(): Writing HD chain model failed");
+    }
+
+    return pubkeys;
+}
+
+void CWallet::AddKeyPoolBatch(CWalletDB& walletdb, int64_t nIndex, unsigned int count)
+{
+    AssertLockHeld(cs_wallet); // setKeyPool
+
+    // If the batch cannot be started, each write is committed on its own.
+    bool fBatch = walletdb.TxnBegin();
+
+    // What the batch changes in memory, so that it can be undone if the
+    // batch is not committed.
+    const std::optional<CHDChain> hdChainPrev = mnemonicHDChain;
+    const int64_t nTimeFirstKeyPrev = nTimeFirstKey;
+    std::vector<CKeyID> vAdded;
+    try {
+        std::vector<CPubKey> pubkeys = GenerateNewKeys(walletdb, false, count, vAdded);
+        for (size_t i = 0; i < pubkeys.size(); i++) {
+            if (!walletdb.WritePool(nIndex + i, CKeyPool(pubkeys[i])))
+                throw runtime_error("CWallet::AddKeyPoolBatch(): writing generated key failed");
+        }
+        if (fBatch && !walletdb.TxnCommit())
+            throw runtime_error("CWallet::AddKeyPoolBatch(): committing generated keys failed");
+    } catch (...) {
+        // Without a batch, the writes that succeeded were committed, so the
+        // wallet keeps the keys it has persisted.
+        if (fBatch) {
+            walletdb.TxnAbort();
+            for (const CKeyID& keyID : vAdded) {
+                RemoveKey(keyID);
+                mapKeyMetadata.erase(keyID);
+            }
+            mnemonicHDChain = hdChainPrev;
+            nTimeFirstKey = nTimeFirstKeyPrev;
+        }
+        throw;
+    }
+
+    // The keys only become available once they are on disk.
+    for (unsigned int i = 0; i < count; i++) {
+        setKeyPool.insert(nIndex + i);
+    }
+}
+
 CPubKey CWallet::AddTransparentSecretKey(
         const uint256& seedFingerprint,
         const CKey& secret,
@@ -372,6 +662,22 @@ CPubKey CWallet::AddTransparentSecretKey(
     CPubKey pubkey = secret.GetPubKey();
     assert(secret.VerifyPubKey(pubkey));
 
+    if (!fFileBacked) {
+        AddTransparentSecretKey(nullptr, seedFingerprint, secret, pubkey, keyPath);
+    } else {
+        CWalletDB walletdb(strWalletFile);
+        AddTransparentSecretKey(&walletdb, seedFingerprint, secret, pubkey, keyPath);
+    }
+    return pubkey;
+}
+
+void CWallet::AddTransparentSecretKey(
+        CWalletDB* pwalletdb,
+        const uint256& seedFingerprint,
+        const CKey& secret,
+        const CPubKey& pubkey,
+        const HDKeyPath& keyPath)
+{
     // Create new metadata
     CKeyMetadata keyMeta(GetTime());
     keyMeta.hdKeypath = keyPath;
@@ -380,18 +686,39 @@ CPubKey CWallet::AddTransparentSecretKey(
     if (nTimeFirstKey == 0 || keyMeta.nCreateTime < nTimeFirstKey)
         nTimeFirstKey = keyMeta.nCreateTime;
 
-    if (!AddKeyPubKey(secret, pubkey))
+    if (!AddKeyPubKeyWithDB(pwalletdb, secret, pubkey))
         throw std::runtime_error("CWallet::GenerateNewKey(): AddKeyPubKey failed");
-
-    return pubkey;
 }
 
 bool CWallet::AddKeyPubKey(
         const CKey& secret,
         const CPubKey &pubkey)
+{
+    if (!fFileBacked) {
+        return AddKeyPubKeyWithDB(nullptr, secret, pubkey);
+    }
+    CWalletDB walletdb(strWalletFile);
+    return AddKeyPubKeyWithDB(&walletdb, secret, pubkey);
+}
+
+bool CWallet::AddKeyPubKeyWithDB(
+        CWalletDB* pwalletdb,
+        const CKey& secret,
+        const CPubKey &pubkey)
 {
     AssertLockHeld(cs_wallet); // mapKeyMetadata
-    if (!CCryptoKeyStore::AddKeyPubKey(secret, pubkey))
+
+    // CCryptoKeyStore writes the encrypted key through AddCryptedKey, which
+    // uses pwalletdbEncryption if it is set.
+    bool fTunnel = pwalletdb != nullptr && pwalletdbEncryption == nullptr;
+    if (fTunnel) {
+        pwalletdbEncryption = pwalletdb;
+    }
+    bool fAdded = CCryptoKeyStore::AddKeyPubKey(secret, pubkey);
+    if (fTunnel) {
+        pwalletdbEncryption = nullptr;
+    }
+    if (!fAdded)
         return false;
 
     // check if we need to remove from watch-only
@@ -407,9 +734,9 @@ bool CWallet::AddKeyPubKey(
         return true;
 
     if (!IsCrypted()) {
-        return CWalletDB(strWalletFile).WriteKey(pubkey,
-                                                 secret.GetPrivKey(),
-                                                 mapKeyMetadata[pubkey.GetID()]);
+        return pwalletdb->WriteKey(pubkey,
+                                   secret.GetPrivKey(),
+                                   mapKeyMetadata[pubkey.GetID()]);
     }
 
     return true;
@@ -1395,11 +1722,13 @@ void CWallet::ChainTipAdded(const CBlockIndex *pindex,
                             bool performConsistencyCheck)
 {
     const auto chainParams = Params();
+    WritePendingTxs();
     IncrementNoteWitnesses(
             chainParams.GetConsensus(),
             pindex, pblock,
             frontiers, performOrchardWalletUpdates, performConsistencyCheck);
     UpdateSaplingNullifierNoteMapForBlock(pblock);
+    UpdateUnspentTxIndex(pblock);
 
     // SetBestChain() can be expensive for large wallets, so do only
     // this sometimes; the wallet state will be brought up to date
@@ -1757,6 +2086,7 @@ set<uint256> CWallet::GetConflicts(const uint256& txid) const
 
 void CWallet::Flush(bool shutdown)
 {
+    WritePendingTxs();
     bitdb.Flush(shutdown);
 }
 
@@ -2269,7 +2599,9 @@ SpendableInputs CWallet::FindSpendableInputs(
     bool selectOrchard{selector.SelectsOrchard()};
 
     SpendableInputs unspent;
-    for (auto const& [wtxid, wtx] : mapWallet) {
+    for (const CWalletTx* pwtx : GetUnspentTxCandidates(asOfHeight)) {
+        const CWalletTx& wtx = *pwtx;
+        const uint256& wtxid = wtx.GetHash();
         bool isCoinbase = wtx.IsCoinBase();
         auto nDepth = wtx.GetDepthInMainChain(asOfHeight);
 
@@ -2453,6 +2785,8 @@ SpendableInputs CWallet::FindSpendableInputs(
                     continue;
                 }
 
+                if (IsLockedNote(noteMeta.GetOutPoint())) continue;
+
                 auto mit = mapWallet.find(noteMeta.GetOutPoint().hash);
 
                 // We should never get an outpoint from the Orchard wallet where
@@ -2587,6 +2921,118 @@ void CWallet::AddToSpends(const uint256& wtxid)
     // AddNotesIfInvolvingMe and LoadCaches
 }
 
+bool CWallet::IsSpentInMainChain(const CWalletTx& wtx) const
+{
+    AssertLockHeld(cs_main);
+    AssertLockHeld(cs_wallet);
+
+    auto hasMinedSpend = [&](auto range) {
+        for (auto it = range.first; it != range.second; ++it) {
+            auto mit = mapWallet.find(it->second);
+            if (mit != mapWallet.end() && mit->second.GetDepthInMainChain(std::nullopt) > 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    const uint256& hash = wtx.GetHash();
+    for (unsigned int i = 0; i < wtx.vout.size(); i++) {
+        if (IsMine(wtx.vout[i]) != ISMINE_NO &&
+            !hasMinedSpend(mapTxSpends.equal_range(COutPoint(hash, i)))) {
+            return false;
+        }
+    }
+    // Notes without a cached nullifier are treated as unspent, as in
+    // GetFilteredNotes.
+    for (const auto& [jsop, nd] : wtx.mapSproutNoteData) {
+        if (!nd.nullifier.has_value() ||
+            !hasMinedSpend(mapTxSproutNullifiers.equal_range(nd.nullifier.value()))) {
+            return false;
+        }
+    }
+    for (const auto& [op, nd] : wtx.mapSaplingNoteData) {
+        if (!nd.nullifier.has_value() ||
+            !hasMinedSpend(mapTxSaplingNullifiers.equal_range(nd.nullifier.value()))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<const CWalletTx*> CWallet::GetUnspentTxCandidates(const std::optional<int>& asOfHeight) const
+{
+    AssertLockHeld(cs_wallet);
+
+    std::vector<const CWalletTx*> candidates;
+    if (asOfHeight.has_value()) {
+        // A transaction that is fully spent at the chain tip may still have
+        // been unspent at an earlier height.
+        candidates.reserve(mapWallet.size());
+        for (const auto& [txid, wtx] : mapWallet) {
+            candidates.push_back(&wtx);
+        }
+    } else {
+        candidates.reserve(setUnspentTxs.size());
+        for (const uint256& txid : setUnspentTxs) {
+            auto mit = mapWallet.find(txid);
+            if (mit != mapWallet.end()) {
+                candidates.push_back(&mit->second);
+            }
+        }
+    }
+    return candidates;
+}
+
+void CWallet::UpdateUnspentTxIndex(const CBlock* pblock)
+{
+    LOCK2(cs_main, cs_wallet);
+
+    if (pblock == nullptr || fUnspentTxIndexStale) {
+        for (auto it = setUnspentTxs.begin(); it != setUnspentTxs.end(); ) {
+            auto mit = mapWallet.find(*it);
+            if (mit == mapWallet.end() || IsSpentInMainChain(mit->second)) {
+                it = setUnspentTxs.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        fUnspentTxIndexStale = false;
+        return;
+    }
+
+    // Only the wallet transactions in this block, and those they spend from,
+    // can have become fully spent.
+    std::set<uint256> affected;
+    for (const CTransaction& tx : pblock->vtx) {
+        if (!mapWallet.count(tx.GetHash())) continue;
+        affected.insert(tx.GetHash());
+        for (const CTxIn& txin : tx.vin) {
+            affected.insert(txin.prevout.hash);
+        }
+        for (const JSDescription& jsdesc : tx.vJoinSplit) {
+            for (const uint256& nullifier : jsdesc.nullifiers) {
+                auto it = mapSproutNullifiersToNotes.find(nullifier);
+                if (it != mapSproutNullifiersToNotes.end()) {
+                    affected.insert(it->second.hash);
+                }
+            }
+        }
+        for (const auto& spend : tx.GetSaplingSpends()) {
+            auto it = mapSaplingNullifiersToNotes.find(spend.nullifier());
+            if (it != mapSaplingNullifiersToNotes.end()) {
+                affected.insert(it->second.hash);
+            }
+        }
+    }
+    for (const uint256& txid : affected) {
+        auto mit = mapWallet.find(txid);
+        if (mit != mapWallet.end() && IsSpentInMainChain(mit->second)) {
+            setUnspentTxs.erase(txid);
+        }
+    }
+}
+
 void CWallet::ClearNoteWitnessCache()
 {
     LOCK(cs_wallet);
@@ -3229,12 +3675,40 @@ int64_t CWallet::IncOrderPosNext(CWalletDB *pwalletdb)
     return nRet;
 }
 
+void CWallet::WritePendingTxs()
+{
+    LOCK(cs_wallet);
+    if (setPendingTxWrites.empty()) return;
+
+    CWalletDB walletdb(strWalletFile, "r+", false);
+    // If the batch cannot be started, each write is committed on its own.
+    bool fBatch = walletdb.TxnBegin();
+    for (const uint256& hash : setPendingTxWrites) {
+        auto mit = mapWallet.find(hash);
+        if (mit != mapWallet.end() && !walletdb.WriteTx(mit->second)) {
+            // The transaction will be found again by the rescan on startup.
+            LogPrintf("WritePendingTxs(): Failed to write transaction %s\n", hash.ToString());
+        }
+    }
+    walletdb.WriteOrderPosNext(nOrderPosNext);
+    if (fBatch && !walletdb.TxnCommit()) {
+        LogPrintf("WritePendingTxs(): Couldn't commit batched write of %d transactions\n",
+                  setPendingTxWrites.size());
+    }
+    setPendingTxWrites.clear();
+}
+
 void CWallet::MarkDirty()
 {
     {
         LOCK(cs_wallet);
-        for (std::pair<const uint256, CWalletTx>& item : mapWallet)
+        for (std::pair<const uint256, CWalletTx>& item : mapWallet) {
             item.second.MarkDirty();
+            setUnspentTxs.insert(item.first);
+        }
+        // The set of outputs that are ours may have changed, so the index
+        // must be pruned from scratch.
+        fUnspentTxIndexStale = true;
     }
 }
 
@@ -3370,9 +3844,10 @@ void CWallet::LoadWalletTx(const CWalletTx& wtxIn) {
     wtxOrdered.insert(make_pair(wtx.nOrderPos, &wtx));
     UpdateNullifierNoteMapWithTx(mapWallet[hash]);
     AddToSpends(hash);
+    setUnspentTxs.insert(hash);
 }
 
-bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb)
+bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb, bool fDeferWrite)
 {
     { // additional scope left in place for backport whitespace compatibility
         uint256 hash = wtxIn.GetHash();
@@ -3387,7 +3862,8 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb)
         if (fInsertedNew)
         {
             wtx.nTimeReceived = GetTime();
-            wtx.nOrderPos = IncOrderPosNext(pwalletdb);
+            // When deferring, nOrderPosNext is written by WritePendingTxs.
+            wtx.nOrderPos = fDeferWrite ? nOrderPosNext++ : IncOrderPosNext(pwalletdb);
             wtxOrdered.insert(make_pair(wtx.nOrderPos, &wtx));
 
             wtx.nTimeSmart = wtx.nTimeReceived;
@@ -3459,12 +3935,17 @@ bool CWallet::AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb)
         LogPrintf("AddToWallet %s  %s%s\n", wtxIn.GetHash().ToString(), (fInsertedNew ? "new" : ""), (fUpdated ? "update" : ""));
 
         // Write to disk
-        if (fInsertedNew || fUpdated)
-            if (!pwalletdb->WriteTx(wtx))
+        if (fInsertedNew || fUpdated) {
+            if (fDeferWrite) {
+                setPendingTxWrites.insert(hash);
+            } else if (!pwalletdb->WriteTx(wtx)) {
                 return false;
+            }
+        }
 
         // Break debit/credit balance caches:
         wtx.MarkDirty();
+        setUnspentTxs.insert(hash);
 
         // Notify UI of new or updated transaction
         NotifyTransactionChanged(this, hash, fInsertedNew ? CT_NEW : CT_UPDATED);
@@ -3624,7 +4105,13 @@ bool CWallet::AddToWalletIfInvolvingMe(
 
             // Do not flush the wallet here for performance reasons; this is
             // safe, as in case of a crash, we rescan the necessary blocks on
-            // startup through our SetBestChain-mechanism
+            // startup through our SetBestChain-mechanism. For the same
+            // reason, the transactions found in a block are written in a
+            // single database transaction once the block has been processed
+            // (see WritePendingTxs).
+            if (pblock && fFileBacked) {
+                return AddToWallet(wtx, nullptr, true);
+            }
             CWalletDB walletdb(strWalletFile, "r+", false);
 
             return AddToWallet(wtx, &walletdb);
@@ -3744,17 +4231,21 @@ void CWallet::MarkAffectedTransactionsDirty(const CTransaction& tx)
 {
     // If a transaction changes 'conflicted' state, that changes the balance
     // available of the outputs it spends. So force those to be
-    // recomputed, also:
+    // recomputed, also. For the same reason, those outputs may no longer be
+    // spent in the main chain:
     for (const CTxIn& txin : tx.vin)
     {
-        if (mapWallet.count(txin.prevout.hash))
+        if (mapWallet.count(txin.prevout.hash)) {
             mapWallet[txin.prevout.hash].MarkDirty();
+            setUnspentTxs.insert(txin.prevout.hash);
+        }
     }
     for (const JSDescription& jsdesc : tx.vJoinSplit) {
         for (const uint256& nullifier : jsdesc.nullifiers) {
             if (mapSproutNullifiersToNotes.count(nullifier) &&
                 mapWallet.count(mapSproutNullifiersToNotes[nullifier].hash)) {
                 mapWallet[mapSproutNullifiersToNotes[nullifier].hash].MarkDirty();
+                setUnspentTxs.insert(mapSproutNullifiersToNotes[nullifier].hash);
             }
         }
     }
@@ -3765,6 +4256,7 @@ void CWallet::MarkAffectedTransactionsDirty(const CTransaction& tx)
             auto itTx = mapWallet.find(it->second.hash);
             if (itTx != mapWallet.end()) {
                 itTx->second.MarkDirty();
+                setUnspentTxs.insert(itTx->first);
             }
         }
     }
@@ -3776,8 +4268,14 @@ void CWallet::EraseFromWallet(const uint256 &hash)
         return;
     {
         LOCK(cs_wallet);
-        if (mapWallet.erase(hash))
+        auto mit = mapWallet.find(hash);
+        if (mit != mapWallet.end()) {
+            // The outputs this transaction spent are no longer spent by it.
+            MarkAffectedTransactionsDirty(mit->second);
+            setUnspentTxs.erase(hash);
+            mapWallet.erase(mit);
             CWalletDB(strWalletFile).EraseTx(hash);
+        }
     }
     return;
 }
@@ -5160,9 +5658,8 @@ CAmount CWallet::GetBalance(const std::optional<int>& asOfHeight, const isminefi
     CAmount nTotal = 0;
     {
         LOCK2(cs_main, cs_wallet);
-        for (const auto& entry : mapWallet)
+        for (const CWalletTx* pcoin : GetUnspentTxCandidates(asOfHeight))
         {
-            const CWalletTx* pcoin = &entry.second;
             if (pcoin->IsTrusted(asOfHeight) && pcoin->GetDepthInMainChain(asOfHeight) >= min_depth) {
                 nTotal += pcoin->GetAvailableCredit(asOfHeight, true, filter);
             }
@@ -5258,7 +5755,9 @@ void CWallet::AvailableCoins(vector<COutput>& vCoins,
     vCoins.clear();
 
     {
-        for (const auto& [wtxid, pcoin] : mapWallet) {
+        for (const CWalletTx* pwtx : GetUnspentTxCandidates(asOfHeight)) {
+            const CWalletTx& pcoin = *pwtx;
+            const uint256& wtxid = pcoin.GetHash();
             if (!CheckFinalTx(pcoin))
                 continue;
 
@@ -6080,11 +6579,11 @@ bool CWallet::NewKeyPool()
             return false;
 
         int64_t nKeys = max(GetArg("-keypool", DEFAULT_KEYPOOL_SIZE), (int64_t)0);
-        for (int i = 0; i < nKeys; i++)
-        {
-            int64_t nIndex = i+1;
-            walletdb.WritePool(nIndex, CKeyPool(GenerateNewKey(false)));
-            setKeyPool.insert(nIndex);
+        int64_t nIndex = 1;
+        while (nIndex <= nKeys) {
+            unsigned int nBatch = std::min<int64_t>(nKeys - nIndex + 1, WALLET_KEY_BATCH_SIZE);
+            AddKeyPoolBatch(walletdb, nIndex, nBatch);
+            nIndex += nBatch;
         }
         LogPrintf("CWallet::NewKeyPool wrote %d new keys\n", nKeys);
     }
@@ -6113,10 +6612,11 @@ bool CWallet::TopUpKeyPool(unsigned int kpSize)
             int64_t nEnd = 1;
             if (!setKeyPool.empty())
                 nEnd = *(--setKeyPool.end()) + 1;
-            if (!walletdb.WritePool(nEnd, CKeyPool(GenerateNewKey(false))))
-                throw runtime_error("TopUpKeyPool(): writing generated key failed");
-            setKeyPool.insert(nEnd);
-            LogPrintf("keypool added key %d, size=%u\n", nEnd, setKeyPool.size());
+            // Generate the missing keys in batches, each of which is written
+            // in one transaction.
+            unsigned int nBatch = std::min<size_t>(nTargetSize + 1 - setKeyPool.size(), WALLET_KEY_BATCH_SIZE);
+            AddKeyPoolBatch(walletdb, nEnd, nBatch);
+            LogPrintf("keypool added keys %d to %d, size=%u\n", nEnd, nEnd + nBatch - 1, setKeyPool.size());
         }
     }
     return true;
@@ -6499,6 +6999,37 @@ std::vector<SaplingOutPoint> CWallet::ListLockedSaplingNotes()
     return vOutputs;
 }
 
+void CWallet::LockNote(const OrchardOutPoint& output)
+{
+    AssertLockHeld(cs_wallet);
+    setLockedOrchardNotes.insert(output);
+}
+
+void CWallet::UnlockNote(const OrchardOutPoint& output)
+{
+    AssertLockHeld(cs_wallet);
+    setLockedOrchardNotes.erase(output);
+}
+
+void CWallet::UnlockAllOrchardNotes()
+{
+    AssertLockHeld(cs_wallet);
+    setLockedOrchardNotes.clear();
+}
+
+bool CWallet::IsLockedNote(const OrchardOutPoint& output) const
+{
+    AssertLockHeld(cs_wallet);
+    return (setLockedOrchardNotes.count(output) > 0);
+}
+
+std::vector<OrchardOutPoint> CWallet::ListLockedOrchardNotes()
+{
+    AssertLockHeld(cs_wallet);
+    std::vector<OrchardOutPoint> vOutputs(setLockedOrchardNotes.begin(), setLockedOrchardNotes.end());
+    return vOutputs;
+}
+
 /** @} */ // end of Actions
 
 class CAffectedKeysVisitor {
@@ -6833,6 +7364,10 @@ bool CWallet::InitLoadWallet(const CChainParams& params, bool clearWitnessCaches
             }
         }
     }
+    // Drop the transactions that were fully spent before startup from the
+    // index of transactions with unspent outputs.
+    walletInstance->UpdateUnspentTxIndex(nullptr);
+
     walletInstance->SetBroadcastTransactions(GetBoolArg("-walletbroadcast", DEFAULT_WALLETBROADCAST));
 
     pwalletMain = walletInstance;
@@ -7094,9 +7629,20 @@ void CWallet::GetFilteredNotes(
 
     LOCK2(cs_main, cs_wallet);
 
+    // Fully spent transactions can only be skipped when spent notes are.
+    std::vector<const CWalletTx*> wtxs;
+    if (ignoreSpent) {
+        wtxs = GetUnspentTxCandidates(asOfHeight);
+    } else {
+        wtxs.reserve(mapWallet.size());
+        for (const auto& [txid, wtx] : mapWallet) {
+            wtxs.push_back(&wtx);
+        }
+    }
+
     KeyIO keyIO(Params());
-    for (auto & p : mapWallet) {
-        CWalletTx wtx = p.second;
+    for (const CWalletTx* pwtx : wtxs) {
+        const CWalletTx& wtx = *pwtx;
 
         // Filter the transactions before checking for notes
         if (!CheckFinalTx(wtx) ||
@@ -7234,6 +7780,11 @@ void CWallet::GetFilteredNotes(
             continue;
         }
 
+        // skip locked notes
+        if (ignoreLocked && IsLockedNote(noteMeta.GetOutPoint())) {
+            continue;
+        }
+
         auto wtx = GetWalletTx(noteMeta.GetOutPoint().hash);
         if (wtx) {
             auto confirmations = wtx->GetDepthInMainChain(asOfHeight);
@@ -60,6 +60,8 @@ extern unsigned int nAnchorConfirmations;
 extern unsigned int nOrchardActionLimit;
 
 static const unsigned int DEFAULT_KEYPOOL_SIZE = 100;
+//! Maximum number of keys that are generated and written in one wallet database transaction
+static const unsigned int WALLET_KEY_BATCH_SIZE = 1000;
 //! -paytxfee default
 static const CAmount DEFAULT_TRANSACTION_FEE = 0;
 //! minimum change amount
@@ -1274,6 +1276,19 @@ private:
     void AddToSaplingSpends(const uint256& nullifier, const uint256& wtxid);
     void AddToSpends(const uint256& wtxid);
 
+    /**
+     * Returns true if every transparent output, Sprout note and Sapling note
+     * in `wtx` that belongs to this wallet is spent by a transaction mined in
+     * the main chain.
+     */
+    bool IsSpentInMainChain(const CWalletTx& wtx) const;
+    /**
+     * Returns the wallet transactions that may hold unspent outputs or notes
+     * as of `asOfHeight`. The index reflects the chain tip, so this returns
+     * every wallet transaction when `asOfHeight` is set.
+     */
+    std::vector<const CWalletTx*> GetUnspentTxCandidates(const std::optional<int>& asOfHeight) const;
+
 public:
     /*
      * Size of the incremental witness cache for the notes in our wallet.
@@ -1379,6 +1394,24 @@ private:
             const uint256& seedFingerprint,
             const CKey& secret,
             const HDKeyPath& keyPath);
+    /* As above, for a key whose public key has already been computed and
+     * verified, writing it to pwalletdb. */
+    void AddTransparentSecretKey(
+            CWalletDB* pwalletdb,
+            const uint256& seedFingerprint,
+            const CKey& secret,
+            const CPubKey& pubkey,
+            const HDKeyPath& keyPath);
+
+    /* Variants of AddKeyPubKey, AddSaplingZKey and AddSaplingPaymentAddress
+     * that write to pwalletdb, which may have a transaction open. pwalletdb
+     * must be null if and only if the wallet is not file-backed. */
+    bool AddKeyPubKeyWithDB(CWalletDB* pwalletdb, const CKey& key, const CPubKey &pubkey);
+    bool AddSaplingZKeyWithDB(CWalletDB* pwalletdb, const libzcash::SaplingExtendedSpendingKey &key);
+    bool AddSaplingPaymentAddressWithDB(
+        CWalletDB* pwalletdb,
+        const libzcash::SaplingIncomingViewingKey &ivk,
+        const libzcash::SaplingPaymentAddress &addr);
 
     std::map<libzcash::OrchardIncomingViewingKey, CKeyMetadata> mapOrchardZKeyMetadata;
 
@@ -1386,6 +1419,43 @@ protected:
     bool UpdatedNoteData(const CWalletTx& wtxIn, CWalletTx& wtx);
     void MarkAffectedTransactionsDirty(const CTransaction& tx);
 
+    /**
+     * Index of the transactions in mapWallet that may still hold an unspent
+     * transparent output, Sprout note or Sapling note as of the chain tip.
+     *
+     * A transaction is only removed from the index once every output and
+     * note it holds for us has been spent by a transaction that is mined in
+     * the main chain, so that balance and note queries with no `asOfHeight`
+     * can skip the (typically much larger) spent history of the wallet. Any
+     * event that could make an output unspent again (a spending transaction
+     * being disconnected or conflicted, keys being imported) puts the
+     * affected transactions back into the index. Orchard notes are tracked
+     * separately by orchardWallet.
+     */
+    std::set<uint256> setUnspentTxs;
+    /**
+     * Set when every transaction in mapWallet has been put back into
+     * setUnspentTxs; the next call to UpdateUnspentTxIndex prunes the whole
+     * index rather than only the transactions touched by a block.
+     */
+    bool fUnspentTxIndexStale = false;
+
+    /**
+     * Transactions added to or updated in the wallet while scanning a block,
+     * which have not yet been written to the wallet database. They are
+     * written together once the block has been processed; see
+     * WritePendingTxs.
+     */
+    std::set<uint256> setPendingTxWrites;
+
+    /**
+     * Removes from setUnspentTxs the wallet transactions in `pblock`, and the
+     * wallet transactions whose outputs or notes they spend, that are now
+     * fully spent in the main chain. If `pblock` is null or the index is
+     * stale, the whole index is pruned.
+     */
+    void UpdateUnspentTxIndex(const CBlock* pblock);
+
     /* the hd chain metadata for keys derived from the mnemonic seed */
     std::optional<CHDChain> mnemonicHDChain;
 
@@ -1541,6 +1611,7 @@ public:
     std::set<COutPoint> setLockedCoins;
     std::set<JSOutPoint> setLockedSproutNotes;
     std::set<SaplingOutPoint> setLockedSaplingNotes;
+    std::set<OrchardOutPoint> setLockedOrchardNotes;
 
     int64_t nTimeFirstKey;
 
@@ -1678,11 +1749,37 @@ public:
     void UnlockAllSaplingNotes();
     std::vector<SaplingOutPoint> ListLockedSaplingNotes();
 
+    bool IsLockedNote(const OrchardOutPoint& output) const;
+    void LockNote(const OrchardOutPoint& output);
+    void UnlockNote(const OrchardOutPoint& output);
+    void UnlockAllOrchardNotes();
+    std::vector<OrchardOutPoint> ListLockedOrchardNotes();
+
     /**
      * keystore implementation
      * Generate a new key
      */
     CPubKey GenerateNewKey(bool external);
+    /**
+     * Generate count new keys, deriving them together and computing their
+     * public keys on several threads, and write them and the updated HD
+     * chain to walletdb. The caller should open a transaction on walletdb
+     * so that they are committed together. The IDs of keys that were not
+     * already in the wallet are appended to vAdded, so that the caller can
+     * remove them if the transaction is not committed.
+     */
+    std::vector<CPubKey> GenerateNewKeys(
+            CWalletDB& walletdb,
+            bool external,
+            unsigned int count,
+            std::vector<CKeyID>& vAdded);
+    /**
+     * Generate count new internal keys and write them to the keypool at
+     * nIndex onwards, in one transaction on walletdb. The keys are added to
+     * setKeyPool once the transaction is committed; if it is not, the keys
+     * and the HD chain counter are restored in memory as well.
+     */
+    void AddKeyPoolBatch(CWalletDB& walletdb, int64_t nIndex, unsigned int count);
     //! Adds a key to the store, and saves it to disk.
     bool AddKeyPubKey(const CKey& key, const CPubKey &pubkey);
     //! Adds a key to the store, without saving it to disk (used by LoadWallet)
@@ -1750,6 +1847,10 @@ public:
     //! Generates new Sapling key, stores the newly generated spending
     //! key to the wallet, and returns the default address for the newly generated key.
     libzcash::SaplingPaymentAddress GenerateNewLegacySaplingZKey();
+    //! Generates count new Sapling keys in the same way, deriving them on
+    //! several threads and writing them in batched database transactions,
+    //! and returns their default addresses.
+    std::vector<libzcash::SaplingPaymentAddress> GenerateNewLegacySaplingZKeys(unsigned int count);
     //! Generates Sapling key at the specified address index, and stores that
     //! key to the wallet if it has not already been persisted. Returns the
     //! default address for the key, and a flag that is true when the key
@@ -1904,7 +2005,17 @@ public:
     void UpdateSaplingNullifierNoteMapWithTx(CWalletTx& wtx);
     void UpdateSaplingNullifierNoteMapForBlock(const CBlock* pblock);
     void LoadWalletTx(const CWalletTx& wtxIn);
-    bool AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb);
+    /**
+     * Adds or updates a transaction in the wallet. If `fDeferWrite` is set,
+     * the transaction is not written to `pwalletdb` (which may be null) but
+     * is queued for the next call to WritePendingTxs.
+     */
+    bool AddToWallet(const CWalletTx& wtxIn, CWalletDB* pwalletdb, bool fDeferWrite = false);
+    /**
+     * Writes the transactions queued by AddToWallet to the wallet database in
+     * a single database transaction.
+     */
+    void WritePendingTxs();
     BatchScanner* GetBatchScanner();
     bool AddToWalletIfInvolvingMe(
             const Consensus::Params& consensus,
@@ -1147,7 +1147,6 @@ TransactionBuilderResult TransactionEffects::ApproveAndBuild(
     return result;
 }
 
-// TODO: Lock Orchard notes (#6226)
 void TransactionEffects::LockSpendable(CWallet& wallet) const
 {
     LOCK2(cs_main, wallet.cs_wallet);
@@ -1161,9 +1160,30 @@ void TransactionEffects::LockSpendable(CWallet& wallet) const
     for (auto note : spendable.saplingNoteEntries) {
         wallet.LockNote(note.op);
     }
+    for (auto note : spendable.orchardNoteMetadata) {
+        wallet.LockNote(note.GetOutPoint());
+    }
+}
+
+bool TransactionEffects::TryLockSpendable(CWallet& wallet) const
+{
+    LOCK2(cs_main, wallet.cs_wallet);
+    for (auto utxo : spendable.utxos) {
+        if (wallet.IsLockedCoin(utxo.tx->GetHash(), utxo.i)) return false;
+    }
+    for (auto note : spendable.sproutNoteEntries) {
+        if (wallet.IsLockedNote(note.jsop)) return false;
+    }
+    for (auto note : spendable.saplingNoteEntries) {
+        if (wallet.IsLockedNote(note.op)) return false;
+    }
+    for (auto note : spendable.orchardNoteMetadata) {
+        if (wallet.IsLockedNote(note.GetOutPoint())) return false;
+    }
+    LockSpendable(wallet);
+    return true;
 }
 
-// TODO: Unlock Orchard notes (#6226)
 void TransactionEffects::UnlockSpendable(CWallet& wallet) const
 {
     LOCK2(cs_main, wallet.cs_wallet);
@@ -1177,4 +1197,7 @@ void TransactionEffects::UnlockSpendable(CWallet& wallet) const
     for (auto note : spendable.saplingNoteEntries) {
         wallet.UnlockNote(note.op);
     }
+    for (auto note : spendable.orchardNoteMetadata) {
+        wallet.UnlockNote(note.GetOutPoint());
+    }
 }
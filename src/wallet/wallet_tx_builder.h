@@ -199,6 +199,15 @@ public:
      */
     void LockSpendable(CWallet& wallet) const;
 
+    /**
+     * Locks the notes that will be spent in the built transaction, unless any
+     * of them is already locked, in which case nothing is locked and this
+     * returns false. This lets callers select inputs without holding
+     * `cs_wallet` across selection, and reselect if another operation reserved
+     * the same inputs in the meantime.
+     */
+    bool TryLockSpendable(CWallet& wallet) const;
+
     /**
      * This should be called when we are finished with the transaction (whether it succeeds or
      * fails).
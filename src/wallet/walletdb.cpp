@@ -24,6 +24,7 @@
 #include <boost/thread.hpp>
 #include <atomic>
 #include <string>
+#include <thread>
 
 using namespace std;
 
@@ -361,6 +362,127 @@ public:
     }
 };
 
+/**
+ * Deserializes and checks a "tx" record, whose type has already been read
+ * from ssKey. Sets fUpgraded if the record used the pre-31600 format and
+ * must be rewritten.
+ */
+static bool ReadWalletTx(CDataStream& ssKey, CDataStream& ssValue,
+                         uint256& hash, CWalletTx& wtx, bool& fUpgraded, string& strErr)
+{
+    fUpgraded = false;
+    ssKey >> hash;
+    ssValue >> wtx;
+    CValidationState state;
+    auto verifier = ProofVerifier::Strict();
+    if (!(
+        CheckTransaction(wtx, state, verifier) &&
+        (wtx.GetHash() == hash) &&
+        state.IsValid())
+    ) {
+        return false;
+    }
+
+    // Undo serialize changes in 31600
+    if (31404 <= wtx.fTimeReceivedIsTxTime && wtx.fTimeReceivedIsTxTime <= 31703)
+    {
+        if (!ssValue.empty())
+        {
+            char fTmp;
+            char fUnused;
+            std::string unused_string;
+            ssValue >> fTmp >> fUnused >> unused_string;
+            strErr = strprintf("LoadWallet() upgrading tx ver=%d %d %s",
+                               wtx.fTimeReceivedIsTxTime, fTmp, hash.ToString());
+            wtx.fTimeReceivedIsTxTime = fTmp;
+        }
+        else
+        {
+            strErr = strprintf("LoadWallet() repairing tx ver=%d %s", wtx.fTimeReceivedIsTxTime, hash.ToString());
+            wtx.fTimeReceivedIsTxTime = 0;
+        }
+        fUpgraded = true;
+    }
+    return true;
+}
+
+/**
+ * A "tx" record whose deserialization and checks are deferred until a batch
+ * of records has been read from the wallet database, so that they can be run
+ * in parallel.
+ */
+struct WalletTxRecord {
+    CDataStream ssKey;
+    CDataStream ssValue;
+    uint256 hash;
+    CWalletTx wtx;
+    bool fValid = false;
+    bool fUpgraded = false;
+    string strErr;
+
+    WalletTxRecord(CDataStream ssKeyIn, CDataStream ssValueIn) :
+        ssKey(std::move(ssKeyIn)), ssValue(std::move(ssValueIn)) {}
+};
+
+/** Minimum number of "tx" records handled by each thread in ReadWalletTxs. */
+static const size_t WALLET_TX_RECORDS_PER_THREAD = 64;
+
+/**
+ * Number of "tx" records that LoadWallet reads before deserializing them and
+ * adding them to the wallet. This bounds how many serialized records are held
+ * alongside their deserialized copies, while leaving enough records to keep
+ * every core busy.
+ */
+static const size_t WALLET_TX_RECORDS_PER_BATCH = 4096;
+
+/**
+ * Deserializes and checks the given "tx" records, using up to one thread per
+ * core. CheckTransaction (which verifies any Sprout proofs) dominates the
+ * time taken to load wallets with a long transaction history.
+ */
+static void ReadWalletTxs(std::vector<WalletTxRecord>& records)
+{
+    std::atomic<size_t> nNext{0};
+    auto worker = [&]() {
+        size_t i;
+        while ((i = nNext++) < records.size()) {
+            WalletTxRecord& record = records[i];
+            try {
+                string strType;
+                record.ssKey >> strType;
+                record.fValid = ReadWalletTx(
+                    record.ssKey, record.ssValue,
+                    record.hash, record.wtx, record.fUpgraded, record.strErr);
+            } catch (...) {
+                record.fValid = false;
+            }
+            // The serialized record is no longer needed.
+            record.ssKey = CDataStream(SER_DISK, CLIENT_VERSION);
+            record.ssValue = CDataStream(SER_DISK, CLIENT_VERSION);
+        }
+    };
+
+    size_t nThreads = std::min(
+        (size_t)std::max(GetNumCores(), 1),
+        (records.size() + WALLET_TX_RECORDS_PER_THREAD - 1) / WALLET_TX_RECORDS_PER_THREAD);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < nThreads; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+static bool IsTxRecord(const CDataStream& ssKey)
+{
+    CDataStream ssType(ssKey);
+    string strType;
+    ssType >> strType;
+    return strType == "tx";
+}
+
 bool
 ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
              CWalletScanState &wss, string& strType, string& strErr)
@@ -387,39 +509,13 @@ ReadKeyValue(CWallet* pwallet, CDataStream& ssKey, CDataStream& ssValue,
         else if (strType == "tx")
         {
             uint256 hash;
-            ssKey >> hash;
             CWalletTx wtx;
-            ssValue >> wtx;
-            CValidationState state;
-            auto verifier = ProofVerifier::Strict();
-            if (!(
-                CheckTransaction(wtx, state, verifier) &&
-                (wtx.GetHash() == hash) &&
-                state.IsValid())
-            ) {
+            bool fUpgraded;
+            if (!ReadWalletTx(ssKey, ssValue, hash, wtx, fUpgraded, strErr)) {
                 return false;
             }
-
-            // Undo serialize changes in 31600
-            if (31404 <= wtx.fTimeReceivedIsTxTime && wtx.fTimeReceivedIsTxTime <= 31703)
-            {
-                if (!ssValue.empty())
-                {
-                    char fTmp;
-                    char fUnused;
-                    std::string unused_string;
-                    ssValue >> fTmp >> fUnused >> unused_string;
-                    strErr = strprintf("LoadWallet() upgrading tx ver=%d %d %s",
-                                       wtx.fTimeReceivedIsTxTime, fTmp, hash.ToString());
-                    wtx.fTimeReceivedIsTxTime = fTmp;
-                }
-                else
-                {
-                    strErr = strprintf("LoadWallet() repairing tx ver=%d %s", wtx.fTimeReceivedIsTxTime, hash.ToString());
-                    wtx.fTimeReceivedIsTxTime = 0;
-                }
+            if (fUpgraded)
                 wss.vWalletUpgrade.push_back(hash);
-            }
 
             if (wtx.nOrderPos == -1)
                 wss.fAnyUnordered = true;
@@ -944,6 +1040,32 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
             return DB_CORRUPT;
         }
 
+        // Deserialize and check a batch of transaction records in parallel,
+        // then add them to the wallet in the order they were read.
+        std::vector<WalletTxRecord> vTxRecords;
+        auto loadTxRecords = [&]() {
+            ReadWalletTxs(vTxRecords);
+            for (WalletTxRecord& record : vTxRecords) {
+                if (!record.fValid) {
+                    // Leave errors alone, if we try to fix them we might make things worse.
+                    fNoncriticalErrors = true;
+                    // Rescan if there is a bad transaction record:
+                    LogPrintf("LoadWallet: Malformed transaction data encountered; starting with -rescan.");
+                    SoftSetBoolArg("-rescan", true);
+                } else {
+                    if (record.fUpgraded)
+                        wss.vWalletUpgrade.push_back(record.hash);
+                    if (record.wtx.nOrderPos == -1)
+                        wss.fAnyUnordered = true;
+                    pwallet->LoadWalletTx(record.wtx);
+                }
+                if (!record.strErr.empty())
+                    LogPrintf("LoadWallet: %s", record.strErr);
+            }
+            vTxRecords.clear();
+        };
+
+        vTxRecords.reserve(WALLET_TX_RECORDS_PER_BATCH);
         while (true)
         {
             // Read next record
@@ -958,6 +1080,14 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
                 return DB_CORRUPT;
             }
 
+            if (IsTxRecord(ssKey)) {
+                vTxRecords.emplace_back(std::move(ssKey), std::move(ssValue));
+                if (vTxRecords.size() == WALLET_TX_RECORDS_PER_BATCH) {
+                    loadTxRecords();
+                }
+                continue;
+            }
+
             // Try to be tolerant of single corrupt records:
             string strType, strErr;
             if (!ReadKeyValue(pwallet, ssKey, ssValue, wss, strType, strErr))
@@ -983,6 +1113,7 @@ DBErrors CWalletDB::LoadWallet(CWallet* pwallet)
                 LogPrintf("LoadWallet: %s", strErr);
         }
         pcursor->close();
+        loadTxRecords();
 
         // Load unified address/account/key caches based on what was loaded
         if (!pwallet->LoadCaches()) {
@@ -112,6 +112,27 @@ std::optional<CKey> AccountKey::DeriveInternalSpendingKey(uint32_t addrIndex) co
     return childKey.value().key;
 }
 
+static std::vector<std::optional<CKey>> DeriveSpendingKeys(const CExtKey& parent, uint32_t addrIndex, uint32_t count) {
+    std::vector<std::optional<CKey>> keys;
+    keys.reserve(count);
+    for (const auto& childKey : parent.DeriveRange(addrIndex, count)) {
+        if (childKey.has_value()) {
+            keys.push_back(childKey.value().key);
+        } else {
+            keys.push_back(std::nullopt);
+        }
+    }
+    return keys;
+}
+
+std::vector<std::optional<CKey>> AccountKey::DeriveExternalSpendingKeys(uint32_t addrIndex, uint32_t count) const {
+    return DeriveSpendingKeys(external, addrIndex, count);
+}
+
+std::vector<std::optional<CKey>> AccountKey::DeriveInternalSpendingKeys(uint32_t addrIndex, uint32_t count) const {
+    return DeriveSpendingKeys(internal, addrIndex, count);
+}
+
 AccountPubKey AccountKey::ToAccountPubKey() const {
     // The .value() call is safe here because we never derive
     // non-compressed public keys.
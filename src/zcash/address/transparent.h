@@ -87,6 +87,12 @@ public:
      */
     std::optional<CKey> DeriveExternalSpendingKey(uint32_t addrIndex) const;
 
+    /**
+     * Generate the keys at count consecutive indices, starting at addrIndex, at
+     * the "external child" level of the TRANSPARENT path for the account.
+     */
+    std::vector<std::optional<CKey>> DeriveExternalSpendingKeys(uint32_t addrIndex, uint32_t count) const;
+
     /**
      * Generate the key corresponding to the specified index at the "internal child"
      * level of the TRANSPARENT path for the account. This should probably only usually be
@@ -95,6 +101,12 @@ public:
      */
     std::optional<CKey> DeriveInternalSpendingKey(uint32_t addrIndex = 0) const;
 
+    /**
+     * Generate the keys at count consecutive indices, starting at addrIndex, at
+     * the "internal child" level of the TRANSPARENT path for the account.
+     */
+    std::vector<std::optional<CKey>> DeriveInternalSpendingKeys(uint32_t addrIndex, uint32_t count) const;
+
     /**
      * Return the public key associated with this spending key.
      */
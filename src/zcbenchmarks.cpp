@@ -1,4 +1,5 @@
 #include <cstdio>
+#include <fstream>
 #include <future>
 #include <map>
 #include <thread>
@@ -172,6 +173,12 @@ double benchmark_verify_joinsplit(const JSDescription &joinsplit)
 
 #ifdef ENABLE_MINING
 double benchmark_solve_equihash()
+{
+    return benchmark_solve_equihash_parallel(1);
+}
+
+/** Solves one random nonce on nThreads threads, adding the solutions found to nSolutions. */
+static double SolveEquihashSample(int nThreads, size_t& nSolutions)
 {
     CBlock pblock;
     CEquihashInput I{pblock};
@@ -189,12 +196,54 @@ double benchmark_solve_equihash()
 
     struct timeval tv_start;
     timer_start(tv_start);
-    std::set<std::vector<unsigned int>> solns;
     EhOptimisedSolveUncancellable(n, k, eh_state,
-                                  [](std::vector<unsigned char> soln) { return false; });
+                                  [&](std::vector<unsigned char> soln) { nSolutions++; return false; },
+                                  nThreads);
     return timer_stop(tv_start);
 }
 
+double benchmark_solve_equihash_parallel(int nThreads)
+{
+    size_t nSolutions = 0;
+    return SolveEquihashSample(nThreads, nSolutions);
+}
+
+/** Resets the peak resident set size of the process, where the OS allows it. */
+static void ResetPeakRSS()
+{
+#ifdef __linux__
+    // Writing 5 to clear_refs resets VmHWM to the current resident set size.
+    std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+}
+
+/** Returns the peak resident set size of the process in bytes, or 0 where it is not available. */
+static size_t GetPeakRSS()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+        }
+    }
+#endif
+    return 0;
+}
+
+EquihashScalingSample benchmark_solve_equihash_scaling(int nThreads, int nSolves)
+{
+    EquihashScalingSample sample;
+    sample.nThreads = nThreads;
+    ResetPeakRSS();
+    for (int i = 0; i < nSolves; i++) {
+        sample.time += SolveEquihashSample(nThreads, sample.nSolutions);
+    }
+    sample.nPeakRSS = GetPeakRSS();
+    return sample;
+}
+
 std::vector<double> benchmark_solve_equihash_threaded(int nThreads)
 {
     std::vector<double> ret;
@@ -804,34 +853,46 @@ double benchmark_listunspent()
     return timer_stop(tv_start);
 }
 
-double benchmark_create_sapling_spend()
+double benchmark_create_sapling_spends(size_t nSpends)
 {
     auto sk = libzcash::SaplingSpendingKey::random();
-    auto expsk = sk.expanded_spending_key();
     auto address = sk.default_address();
-    SaplingNote note(address, GetRand(MAX_MONEY), libzcash::Zip212Enabled::BeforeZip212);
+
+    // All spends in a bundle share an anchor, so witness every note against
+    // the same tree.
+    std::vector<SaplingNote> notes;
+    std::vector<SaplingWitness> witnesses;
     SaplingMerkleTree tree;
-    auto maybe_cmu = note.cmu();
-    tree.append(maybe_cmu.value());
-    auto witness = tree.witness();
+    for (size_t i = 0; i < nSpends; i++) {
+        SaplingNote note(address, GetRand(MAX_MONEY / nSpends), libzcash::Zip212Enabled::BeforeZip212);
+        auto cmu = note.cmu().value();
+        tree.append(cmu);
+        for (auto& witness : witnesses) {
+            witness.append(cmu);
+        }
+        witnesses.push_back(tree.witness());
+        notes.push_back(note);
+    }
     auto anchor = tree.root().GetRawBytes();
 
     CDataStream ssExtSk(SER_NETWORK, PROTOCOL_VERSION);
     ssExtSk << sk;
 
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    ss << witness.path();
-    std::array<unsigned char, 1065> witnessChars;
-    std::move(ss.begin(), ss.end(), witnessChars.begin());
-
     auto nHeight = Params().GetConsensus().vUpgrades[Consensus::UPGRADE_SAPLING].nActivationHeight;
     auto builder = sapling::new_builder(*Params().RustNetwork(), nHeight, anchor, false);
-    builder->add_spend(
-        {reinterpret_cast<uint8_t*>(ssExtSk.data()), ssExtSk.size()},
-        address.GetRawBytes(),
-        note.value(),
-        note.rcm().GetRawBytes(),
-        witnessChars);
+    for (size_t i = 0; i < nSpends; i++) {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << witnesses[i].path();
+        std::array<unsigned char, 1065> witnessChars;
+        std::move(ss.begin(), ss.end(), witnessChars.begin());
+
+        builder->add_spend(
+            {reinterpret_cast<uint8_t*>(ssExtSk.data()), ssExtSk.size()},
+            address.GetRawBytes(),
+            notes[i].value(),
+            notes[i].rcm().GetRawBytes(),
+            witnessChars);
+    }
 
     struct timeval tv_start;
     timer_start(tv_start);
@@ -842,7 +903,7 @@ double benchmark_create_sapling_spend()
     return t;
 }
 
-double benchmark_create_sapling_output()
+double benchmark_create_sapling_outputs(size_t nOutputs)
 {
     auto sk = libzcash::SaplingSpendingKey::random();
     auto address = sk.default_address();
@@ -850,11 +911,13 @@ double benchmark_create_sapling_output()
 
     auto nHeight = Params().GetConsensus().vUpgrades[Consensus::UPGRADE_SAPLING].nActivationHeight;
     auto builder = sapling::new_builder(*Params().RustNetwork(), nHeight, anchor, false);
-    builder->add_recipient(
-        uint256().GetRawBytes(),
-        address.GetRawBytes(),
-        GetRand(MAX_MONEY),
-        libzcash::Memo::ToBytes(std::nullopt));
+    for (size_t i = 0; i < nOutputs; i++) {
+        builder->add_recipient(
+            uint256().GetRawBytes(),
+            address.GetRawBytes(),
+            GetRand(MAX_MONEY / nOutputs),
+            libzcash::Memo::ToBytes(std::nullopt));
+    }
 
     struct timeval tv_start;
     timer_start(tv_start);
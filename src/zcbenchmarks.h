@@ -9,6 +9,18 @@ extern double benchmark_create_joinsplit();
 extern std::vector<double> benchmark_create_joinsplit_threaded(int nThreads);
 extern double benchmark_solve_equihash();
 extern std::vector<double> benchmark_solve_equihash_threaded(int nThreads);
+extern double benchmark_solve_equihash_parallel(int nThreads);
+
+/** The result of solving several nonces with the same number of solver threads. */
+struct EquihashScalingSample {
+    int nThreads = 0;
+    /** Total time of the solves, in seconds */
+    double time = 0;
+    size_t nSolutions = 0;
+    /** Peak resident set size of the process during the solves, in bytes (0 if unknown) */
+    size_t nPeakRSS = 0;
+};
+extern EquihashScalingSample benchmark_solve_equihash_scaling(int nThreads, int nSolves);
 extern double benchmark_verify_joinsplit(const JSDescription &joinsplit);
 extern double benchmark_verify_equihash();
 extern double benchmark_large_tx(size_t nInputs);
@@ -22,8 +34,8 @@ extern double benchmark_connectblock_orchard();
 extern double benchmark_sendtoaddress(CAmount amount);
 extern double benchmark_loadwallet();
 extern double benchmark_listunspent();
-extern double benchmark_create_sapling_spend();
-extern double benchmark_create_sapling_output();
+extern double benchmark_create_sapling_spends(size_t nSpends);
+extern double benchmark_create_sapling_outputs(size_t nOutputs);
 extern double benchmark_verify_sapling_spend();
 extern double benchmark_verify_sapling_output();
 
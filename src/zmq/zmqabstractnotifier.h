@@ -36,6 +36,14 @@ public:
     virtual bool NotifyBlock(const CBlockIndex *pindex);
     virtual bool NotifyBlock(const CBlock& pblock);
     virtual bool NotifyTransaction(const CTransaction &transaction);
+    //! Called for each block connected to the active chain, including during initial block download
+    virtual bool NotifyBlockConnect(const CBlockIndex *pindex);
+    //! Called for each block disconnected from the active chain
+    virtual bool NotifyBlockDisconnect(const CBlockIndex *pindex);
+    //! Called for each transaction added to the mempool
+    virtual bool NotifyTransactionAcceptance(const CTransaction &transaction, uint64_t nMempoolSequence);
+    //! Called for each transaction removed from the mempool, other than for inclusion in a block
+    virtual bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t nMempoolSequence);
 
 protected:
     void *psocket;
@@ -16,7 +16,8 @@ void zmqError(const char *str)
     LogPrint("zmq", "zmq: Error: %s, errno=%s\n", str, zmq_strerror(errno));
 }
 
-CZMQNotificationInterface::CZMQNotificationInterface() : pcontext(NULL)
+CZMQNotificationInterface::CZMQNotificationInterface() :
+    pcontext(NULL), nMaxQueueSize(DEFAULT_ZMQ_PUB_QUEUE_SIZE), queuePolicy(ZMQQueuePolicy::DROP)
 {
 }
 
@@ -39,8 +40,10 @@ CZMQNotificationInterface* CZMQNotificationInterface::CreateWithArguments(const
     factories["pubhashblock"] = CZMQAbstractNotifier::Create<CZMQPublishHashBlockNotifier>;
     factories["pubhashtx"] = CZMQAbstractNotifier::Create<CZMQPublishHashTransactionNotifier>;
     factories["pubrawblock"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockNotifier>;
+    factories["pubrawblockcompact"] = CZMQAbstractNotifier::Create<CZMQPublishRawBlockCompactNotifier>;
     factories["pubrawtx"] = CZMQAbstractNotifier::Create<CZMQPublishRawTransactionNotifier>;
     factories["pubcheckedblock"] = CZMQAbstractNotifier::Create<CZMQPublishCheckedBlockNotifier>;
+    factories["pubsequence"] = CZMQAbstractNotifier::Create<CZMQPublishSequenceNotifier>;
 
     for (std::map<std::string, CZMQNotifierFactory>::const_iterator i=factories.begin(); i!=factories.end(); ++i)
     {
@@ -61,6 +64,17 @@ CZMQNotificationInterface* CZMQNotificationInterface::CreateWithArguments(const
         notificationInterface = new CZMQNotificationInterface();
         notificationInterface->notifiers = notifiers;
 
+        std::map<std::string, std::string>::const_iterator j = args.find("-zmqpubqueuesize");
+        if (j != args.end())
+        {
+            notificationInterface->nMaxQueueSize = std::max<int64_t>(atoi64(j->second), 1);
+        }
+        j = args.find("-zmqpubqueuepolicy");
+        if (j != args.end() && !ParseZMQQueuePolicy(j->second, notificationInterface->queuePolicy))
+        {
+            LogPrintf("zmq: Unknown -zmqpubqueuepolicy '%s', using '%s'\n", j->second, DEFAULT_ZMQ_PUB_QUEUE_POLICY);
+        }
+
         if (!notificationInterface->Initialize())
         {
             delete notificationInterface;
@@ -109,6 +123,8 @@ bool CZMQNotificationInterface::Initialize()
         return false;
     }
 
+    StartZMQPublisher(nMaxQueueSize, queuePolicy);
+
     return true;
 }
 
@@ -118,6 +134,9 @@ void CZMQNotificationInterface::Shutdown()
     LogPrint("zmq", "zmq: Shutdown notification interface\n");
     if (pcontext)
     {
+        // Send what is still queued before the sockets are closed.
+        StopZMQPublisher();
+
         for (std::list<CZMQAbstractNotifier*>::iterator i=notifiers.begin(); i!=notifiers.end(); ++i)
         {
             CZMQAbstractNotifier *notifier = *i;
@@ -147,6 +166,52 @@ void CZMQNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindex)
     }
 }
 
+template <typename Function>
+void CZMQNotificationInterface::TryForEachAndRemoveFailed(Function func)
+{
+    for (std::list<CZMQAbstractNotifier*>::iterator i = notifiers.begin(); i!=notifiers.end(); )
+    {
+        CZMQAbstractNotifier *notifier = *i;
+        if (func(notifier))
+        {
+            i++;
+        }
+        else
+        {
+            notifier->Shutdown();
+            i = notifiers.erase(i);
+        }
+    }
+}
+
+void CZMQNotificationInterface::BlockConnected(const CBlockIndex *pindex)
+{
+    TryForEachAndRemoveFailed([pindex](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockConnect(pindex);
+    });
+}
+
+void CZMQNotificationInterface::BlockDisconnected(const CBlockIndex *pindex)
+{
+    TryForEachAndRemoveFailed([pindex](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyBlockDisconnect(pindex);
+    });
+}
+
+void CZMQNotificationInterface::TransactionAddedToMempool(const CTransaction &tx, uint64_t nMempoolSequence)
+{
+    TryForEachAndRemoveFailed([&tx, nMempoolSequence](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyTransactionAcceptance(tx, nMempoolSequence);
+    });
+}
+
+void CZMQNotificationInterface::TransactionRemovedFromMempool(const CTransaction &tx, uint64_t nMempoolSequence)
+{
+    TryForEachAndRemoveFailed([&tx, nMempoolSequence](CZMQAbstractNotifier* notifier) {
+        return notifier->NotifyTransactionRemoval(tx, nMempoolSequence);
+    });
+}
+
 void CZMQNotificationInterface::BlockChecked(const CBlock& block, const CValidationState& state)
 {
     if (state.IsInvalid()) {
@@ -8,6 +8,7 @@
 
 #include "validationinterface.h"
 #include "consensus/validation.h"
+#include "zmqpublishnotifier.h"
 #include <string>
 #include <map>
 
@@ -29,12 +30,22 @@ protected:
     void SyncTransaction(const CTransaction &tx, const CBlock *pblock, const int nHeight);
     void UpdatedBlockTip(const CBlockIndex *pindex);
     void BlockChecked(const CBlock& block, const CValidationState& state);
+    void BlockConnected(const CBlockIndex *pindex);
+    void BlockDisconnected(const CBlockIndex *pindex);
+    void TransactionAddedToMempool(const CTransaction &tx, uint64_t nMempoolSequence);
+    void TransactionRemovedFromMempool(const CTransaction &tx, uint64_t nMempoolSequence);
 
 private:
     CZMQNotificationInterface();
 
+    //! Calls func for each notifier, and shuts down the notifiers for which it fails
+    template <typename Function>
+    void TryForEachAndRemoveFailed(Function func);
+
     void *pcontext;
     std::list<CZMQAbstractNotifier*> notifiers;
+    size_t nMaxQueueSize;
+    ZMQQueuePolicy queuePolicy;
 };
 
 #endif // BITCOIN_ZMQ_ZMQNOTIFICATIONINTERFACE_H
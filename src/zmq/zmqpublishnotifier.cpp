@@ -8,13 +8,226 @@
 #include "main.h"
 #include "util/system.h"
 
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 static std::multimap<std::string, CZMQAbstractPublishNotifier*> mapPublishNotifiers;
 
 static const char *MSG_HASHBLOCK = "hashblock";
 static const char *MSG_HASHTX    = "hashtx";
 static const char *MSG_RAWBLOCK  = "rawblock";
+static const char *MSG_RAWBLOCKCOMPACT = "rawblockcompact";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_CHECKEDBLOCK = "checkedblock";
+static const char *MSG_SEQUENCE  = "sequence";
+
+/** Number of recently serialized blocks kept for the block notifiers. */
+static const size_t ZMQ_BLOCK_CACHE_SIZE = 4;
+
+namespace {
+
+struct CZMQQueuedMessage
+{
+    CZMQAbstractPublishNotifier *notifier;
+    const char *command;
+    std::function<ZMQMessageData()> getData;
+    uint32_t nSequence;
+};
+
+/**
+ * The publisher thread, and the queue of messages waiting for it. The thread
+ * takes the whole queue each time it wakes up, so that messages queued in a
+ * burst (such as the transactions of a block) are sent together.
+ *
+ * The thread never takes cs_main, so a notifier can wait for space in the
+ * queue while holding it.
+ */
+class CZMQPublisher
+{
+private:
+    std::mutex cs;
+    std::condition_variable condMessages;
+    std::condition_variable condSpace;
+    std::deque<CZMQQueuedMessage> queue;
+    size_t nMaxQueueSize = DEFAULT_ZMQ_PUB_QUEUE_SIZE;
+    ZMQQueuePolicy policy = ZMQQueuePolicy::DROP;
+    bool fRunning = false;
+    bool fStopping = false;
+    uint64_t nDropped = 0;
+    std::thread thread;
+
+    void Run()
+    {
+        RenameThread("zcash-zmqpub");
+        while (true) {
+            std::deque<CZMQQueuedMessage> batch;
+            {
+                std::unique_lock<std::mutex> lock(cs);
+                condMessages.wait(lock, [&] { return fStopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                batch.swap(queue);
+            }
+            condSpace.notify_all();
+
+            for (const CZMQQueuedMessage& msg : batch) {
+                if (msg.notifier->IsFailed()) {
+                    continue;
+                }
+                ZMQMessageData data = msg.getData();
+                if (!data) {
+                    continue;
+                }
+                if (!msg.notifier->SendQueuedMessage(msg.command, data, msg.nSequence)) {
+                    msg.notifier->SetFailed();
+                }
+            }
+        }
+    }
+
+public:
+    void Start(size_t nMaxQueueSizeIn, ZMQQueuePolicy policyIn)
+    {
+        std::lock_guard<std::mutex> lock(cs);
+        assert(!fRunning);
+        nMaxQueueSize = std::max<size_t>(nMaxQueueSizeIn, 1);
+        policy = policyIn;
+        fRunning = true;
+        fStopping = false;
+        nDropped = 0;
+        thread = std::thread(&CZMQPublisher::Run, this);
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(cs);
+            if (!fRunning) {
+                return;
+            }
+            fStopping = true;
+        }
+        condMessages.notify_all();
+        condSpace.notify_all();
+        thread.join();
+
+        std::lock_guard<std::mutex> lock(cs);
+        fRunning = false;
+        if (nDropped > 0) {
+            LogPrint("zmq", "zmq: Dropped %d messages because the queue was full\n", nDropped);
+        }
+    }
+
+    /**
+     * Queues a message, and assigns it the notifier's next sequence number.
+     * Sequence numbers are assigned under the queue lock, so that messages
+     * of a notifier are queued in sequence order.
+     */
+    void Push(CZMQAbstractPublishNotifier *notifier, const char *command,
+              std::function<ZMQMessageData()> getData, uint32_t& nSequence)
+    {
+        {
+            std::unique_lock<std::mutex> lock(cs);
+            if (policy == ZMQQueuePolicy::BLOCK) {
+                condSpace.wait(lock, [&] { return fStopping || queue.size() < nMaxQueueSize; });
+            }
+            uint32_t nMsgSequence = nSequence++;
+            if (!fRunning || fStopping || queue.size() >= nMaxQueueSize) {
+                nDropped++;
+                LogPrint("zmq", "zmq: Queue full, dropping %s message %d\n", command, nMsgSequence);
+                return;
+            }
+            queue.push_back(CZMQQueuedMessage{notifier, command, std::move(getData), nMsgSequence});
+        }
+        condMessages.notify_one();
+    }
+};
+
+CZMQPublisher zmqPublisher;
+
+std::mutex csBlockCache;
+std::deque<std::pair<uint256, ZMQMessageData>> blockCache;
+
+void CacheSerializedBlock(const uint256& hash, const ZMQMessageData& data)
+{
+    std::lock_guard<std::mutex> lock(csBlockCache);
+    for (const auto& entry : blockCache) {
+        if (entry.first == hash) {
+            return;
+        }
+    }
+    blockCache.emplace_back(hash, data);
+    if (blockCache.size() > ZMQ_BLOCK_CACHE_SIZE) {
+        blockCache.pop_front();
+    }
+}
+
+ZMQMessageData SerializeBlock(const CBlock& block)
+{
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << block;
+    return std::make_shared<const std::vector<unsigned char>>(ss.begin(), ss.end());
+}
+
+/**
+ * Returns the serialized block, reading it from disk unless a notifier has
+ * serialized it recently. Called on the publisher thread.
+ */
+ZMQMessageData GetSerializedBlock(const uint256& hash, const CDiskBlockPos& pos)
+{
+    {
+        std::lock_guard<std::mutex> lock(csBlockCache);
+        for (const auto& entry : blockCache) {
+            if (entry.first == hash) {
+                return entry.second;
+            }
+        }
+    }
+
+    CBlock block;
+    if (!ReadBlockFromDisk(block, pos, Params().GetConsensus()) || block.GetHash() != hash)
+    {
+        zmqError("Can't read block from disk");
+        return nullptr;
+    }
+    ZMQMessageData data = SerializeBlock(block);
+    CacheSerializedBlock(hash, data);
+    return data;
+}
+
+CDiskBlockPos GetBlockPos(const CBlockIndex *pindex)
+{
+    LOCK(cs_main);
+    return pindex->GetBlockPos();
+}
+
+} // anon namespace
+
+bool ParseZMQQueuePolicy(const std::string& str, ZMQQueuePolicy& policy)
+{
+    if (str == "drop") {
+        policy = ZMQQueuePolicy::DROP;
+    } else if (str == "block") {
+        policy = ZMQQueuePolicy::BLOCK;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void StartZMQPublisher(size_t nMaxQueueSize, ZMQQueuePolicy policy)
+{
+    zmqPublisher.Start(nMaxQueueSize, policy);
+}
+
+void StopZMQPublisher()
+{
+    zmqPublisher.Stop();
+}
 
 // Internal function to send multipart message
 static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
@@ -125,20 +338,35 @@ void CZMQAbstractPublishNotifier::Shutdown()
     psocket = 0;
 }
 
+bool CZMQAbstractPublishNotifier::SendMessage(const char *command, std::function<ZMQMessageData()> getData)
+{
+    assert(psocket);
+
+    if (fFailed)
+        return false;
+
+    zmqPublisher.Push(this, command, std::move(getData), nSequence);
+    return true;
+}
+
 bool CZMQAbstractPublishNotifier::SendMessage(const char *command, const void* data, size_t size)
+{
+    const unsigned char *begin = static_cast<const unsigned char*>(data);
+    ZMQMessageData msgdata = std::make_shared<const std::vector<unsigned char>>(begin, begin + size);
+    return SendMessage(command, [msgdata]() { return msgdata; });
+}
+
+bool CZMQAbstractPublishNotifier::SendQueuedMessage(const char *command, const ZMQMessageData& data, uint32_t nMsgSequence)
 {
     assert(psocket);
 
     /* send three parts, command & data & a LE 4byte sequence number */
     unsigned char msgseq[sizeof(uint32_t)];
-    WriteLE32(&msgseq[0], nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), (void*)0);
+    WriteLE32(&msgseq[0], nMsgSequence);
+    int rc = zmq_send_multipart(psocket, command, strlen(command), data->data(), data->size(), msgseq, (size_t)sizeof(uint32_t), (void*)0);
     if (rc == -1)
         return false;
 
-    /* increment memory only sequence number after sending */
-    nSequence++;
-
     return true;
 }
 
@@ -164,36 +392,49 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &t
 
 bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
-    LogPrint("zmq", "zmq: Publish rawblock %s\n", pindex->GetBlockHash().GetHex());
+    uint256 hash = pindex->GetBlockHash();
+    LogPrint("zmq", "zmq: Publish rawblock %s\n", hash.GetHex());
 
-    const Consensus::Params& consensusParams = Params().GetConsensus();
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        CBlock block;
-        if(!ReadBlockFromDisk(block, pindex, consensusParams))
-        {
-            zmqError("Can't read block from disk");
-            return false;
-        }
+    CDiskBlockPos pos = GetBlockPos(pindex);
+    return SendMessage(MSG_RAWBLOCK, [hash, pos]() {
+        return GetSerializedBlock(hash, pos);
+    });
+}
 
-        ss << block;
-    }
+bool CZMQPublishRawBlockCompactNotifier::NotifyBlock(const CBlockIndex *pindex)
+{
+    uint256 hash = pindex->GetBlockHash();
+    LogPrint("zmq", "zmq: Publish rawblockcompact %s\n", hash.GetHex());
 
-    return SendMessage(MSG_RAWBLOCK, &(*ss.begin()), ss.size());
+    CDiskBlockPos pos = GetBlockPos(pindex);
+    return SendMessage(MSG_RAWBLOCKCOMPACT, [hash, pos]() -> ZMQMessageData {
+        ZMQMessageData blockdata = GetSerializedBlock(hash, pos);
+        if (!blockdata)
+            return nullptr;
+
+        CBlock block;
+        CDataStream ssBlock(*blockdata, SER_NETWORK, PROTOCOL_VERSION);
+        ssBlock >> block;
+
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << block.GetBlockHeader();
+        WriteCompactSize(ss, block.vtx.size());
+        for (const CTransaction& tx : block.vtx)
+            ss << tx.GetHash();
+        return std::make_shared<const std::vector<unsigned char>>(ss.begin(), ss.end());
+    });
 }
 
 bool CZMQPublishCheckedBlockNotifier::NotifyBlock(const CBlock& block)
 {
-    LogPrint("zmq", "zmq: Publish checkedblock %s\n", block.GetHash().GetHex());
-
-    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
-    {
-        LOCK(cs_main);
-        ss << block;
-    }
-
-    return SendMessage(MSG_CHECKEDBLOCK, &(*ss.begin()), ss.size());
+    uint256 hash = block.GetHash();
+    LogPrint("zmq", "zmq: Publish checkedblock %s\n", hash.GetHex());
+
+    // The block is only valid for the duration of the call, so serialize it
+    // here; the block notifiers reuse the bytes if it becomes the tip.
+    ZMQMessageData data = SerializeBlock(block);
+    CacheSerializedBlock(hash, data);
+    return SendMessage(MSG_CHECKEDBLOCK, [data]() { return data; });
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
@@ -204,3 +445,47 @@ bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &tr
     ss << transaction;
     return SendMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
 }
+
+/** Publishes a hash and a label, followed by the mempool sequence number for transactions. */
+static bool SendSequenceMessage(CZMQAbstractPublishNotifier& notifier, const uint256& hash, char label,
+                                std::optional<uint64_t> nMempoolSequence = std::nullopt)
+{
+    unsigned char data[sizeof(uint256) + 1 + sizeof(uint64_t)];
+    for (unsigned int i = 0; i < sizeof(uint256); i++)
+        data[sizeof(uint256) - 1 - i] = hash.begin()[i];
+    data[sizeof(uint256)] = label;
+    size_t size = sizeof(uint256) + 1;
+    if (nMempoolSequence.has_value()) {
+        WriteLE64(data + size, nMempoolSequence.value());
+        size += sizeof(uint64_t);
+    }
+    return notifier.SendMessage(MSG_SEQUENCE, data, size);
+}
+
+bool CZMQPublishSequenceNotifier::NotifyBlockConnect(const CBlockIndex *pindex)
+{
+    uint256 hash = pindex->GetBlockHash();
+    LogPrint("zmq", "zmq: Publish sequence block connect %s\n", hash.GetHex());
+    return SendSequenceMessage(*this, hash, 'C');
+}
+
+bool CZMQPublishSequenceNotifier::NotifyBlockDisconnect(const CBlockIndex *pindex)
+{
+    uint256 hash = pindex->GetBlockHash();
+    LogPrint("zmq", "zmq: Publish sequence block disconnect %s\n", hash.GetHex());
+    return SendSequenceMessage(*this, hash, 'D');
+}
+
+bool CZMQPublishSequenceNotifier::NotifyTransactionAcceptance(const CTransaction &transaction, uint64_t nMempoolSequence)
+{
+    uint256 hash = transaction.GetHash();
+    LogPrint("zmq", "zmq: Publish sequence mempool acceptance %s\n", hash.GetHex());
+    return SendSequenceMessage(*this, hash, 'A', nMempoolSequence);
+}
+
+bool CZMQPublishSequenceNotifier::NotifyTransactionRemoval(const CTransaction &transaction, uint64_t nMempoolSequence)
+{
+    uint256 hash = transaction.GetHash();
+    LogPrint("zmq", "zmq: Publish sequence mempool removal %s\n", hash.GetHex());
+    return SendSequenceMessage(*this, hash, 'R', nMempoolSequence);
+}
@@ -8,23 +8,67 @@
 
 #include "zmqabstractnotifier.h"
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
 class CBlockIndex;
 
+/** Default for -zmqpubqueuesize, the maximum number of messages waiting to be sent */
+static const size_t DEFAULT_ZMQ_PUB_QUEUE_SIZE = 1000;
+/** Default for -zmqpubqueuepolicy */
+static const char* const DEFAULT_ZMQ_PUB_QUEUE_POLICY = "drop";
+
+typedef std::shared_ptr<const std::vector<unsigned char>> ZMQMessageData;
+
+/**
+ * Notifications are sent by a publisher thread, so that serializing them and
+ * slow subscribers don't hold up validation. Messages wait for that thread in
+ * a bounded queue; when it is full, the policy decides whether a new message
+ * is dropped (the default) or the notifying thread waits for space.
+ */
+enum class ZMQQueuePolicy {
+    DROP,
+    BLOCK,
+};
+
+bool ParseZMQQueuePolicy(const std::string& str, ZMQQueuePolicy& policy);
+
+/** Starts the publisher thread. Must be called before any notifier sends. */
+void StartZMQPublisher(size_t nMaxQueueSize, ZMQQueuePolicy policy);
+/** Sends all queued messages and stops the publisher thread. */
+void StopZMQPublisher();
+
 class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
-    uint32_t nSequence; //! upcounting per message sequence number
+    uint32_t nSequence = 0; //! upcounting per message sequence number
+    std::atomic<bool> fFailed{false}; //! set by the publisher thread when a send fails
 
 public:
 
-    /* send zmq multipart message
+    /* queue zmq multipart message for the publisher thread
        parts:
           * command
           * data
           * message sequence number
+
+       The sequence number is assigned when the message is queued, so a
+       message that is dropped because the queue is full leaves a gap that
+       subscribers can detect. getData is called on the publisher thread, and
+       returns null if the data can't be produced. Returns false if an
+       earlier message of this notifier failed to send.
     */
+    bool SendMessage(const char *command, std::function<ZMQMessageData()> getData);
+    //! Queues a copy of the data
     bool SendMessage(const char *command, const void* data, size_t size);
 
+    //! Sends a queued message on the publisher thread
+    bool SendQueuedMessage(const char *command, const ZMQMessageData& data, uint32_t nMsgSequence);
+    void SetFailed() { fFailed = true; }
+    bool IsFailed() const { return fFailed; }
+
     bool Initialize(void *pcontext);
     void Shutdown();
 };
@@ -47,6 +91,17 @@ public:
     bool NotifyBlock(const CBlockIndex *pindex);
 };
 
+/**
+ * Publishes the header of each new tip, followed by the ids of the block's
+ * transactions, so that subscribers that follow the mempool can reconstruct
+ * the block without receiving it in full.
+ */
+class CZMQPublishRawBlockCompactNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlock(const CBlockIndex *pindex);
+};
+
 class CZMQPublishRawTransactionNotifier : public CZMQAbstractPublishNotifier
 {
 public:
@@ -59,4 +114,21 @@ public:
     bool NotifyBlock(const CBlock &block);
 };
 
+/**
+ * Publishes a hash and a one-byte label for each block connected to ('C') or
+ * disconnected from ('D') the active chain, and for each transaction added to
+ * ('A') or removed from ('R') the mempool other than by being mined. The
+ * labels of transactions are followed by the mempool sequence number. Block
+ * events are queued with cs_main held and mempool events with mempool.cs
+ * held, so they are published in the order in which they happen.
+ */
+class CZMQPublishSequenceNotifier : public CZMQAbstractPublishNotifier
+{
+public:
+    bool NotifyBlockConnect(const CBlockIndex *pindex);
+    bool NotifyBlockDisconnect(const CBlockIndex *pindex);
+    bool NotifyTransactionAcceptance(const CTransaction &transaction, uint64_t nMempoolSequence);
+    bool NotifyTransactionRemoval(const CTransaction &transaction, uint64_t nMempoolSequence);
+};
+
 #endif // BITCOIN_ZMQ_ZMQPUBLISHNOTIFIER_H